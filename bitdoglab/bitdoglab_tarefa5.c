@@ -1,13 +1,33 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
 #include "hardware/spi.h"
 #include "hardware/i2c.h"
 #include "hardware/pio.h"
 #include "hardware/uart.h"
 #include <string.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include "inc/lora_RFM95.h"
 #include "inc/ssd1306.h"
+#include "inc/lowpower.h"
+#include "inc/tdma_master.h"
+#include "inc/dedup.h"
+#include "inc/repeater.h"
+#include "inc/pktbuf.h"
+#include "inc/node_table.h"
+#include "inc/history.h"
+#include "inc/sparkline.h"
+#include "inc/dashboard.h"
+#include "inc/logview.h"
+#include "inc/flash_log.h"
+#include "inc/stream_out.h"
+#include "inc/trace.h"
+#include "inc/tlog.h"
+#include "hardware/structs/systick.h"
+#include "fmt_int.h"
+#include "lora_proto.h"
+#include "report_policy.h"
 
 // SPI Defines
 // We are going to use SPI 0, and allocate it to the following GPIO pins
@@ -30,18 +50,47 @@
 #define PIN_DIO0 8
 #define LORA_FREQUENCY 915E6
 
+// Recepção em ciclos (economia de bateria em receptores/repetidores).
+// O preâmbulo é o dos transmissores: LORA_PROTO_NODE_PREAMBLE, o mesmo nos dois firmwares.
+#define LORA_RX_DUTY_CYCLE   false
+#define LORA_SENDER_PREAMBLE LORA_PROTO_NODE_PREAMBLE
+
 ssd1306_t disp;
+static tdma_master_t tdma;
+static dedup_cache_t recent_frames; // descarta cópias que chegam direto e via repetidor
+static uint32_t duplicates = 0;
 #include "blink.pio.h"
 
 #define SEND_INTERVAL_MS 10000 
+#define LOOP_PERIOD_MS   100   // período máximo entre passagens do laço (animação e RX por ciclos)
+#define SYNC_BEACON_INTERVAL_MS 30000 // período dos beacons de sincronismo para os nós FPGA (sem TDMA)
+#define TDMA_SLOTS       8     // slots de dados por superquadro (0 = nós transmitem livremente)
 
-typedef struct {
+// Modo repetidor: retransmite amostras (com cabeçalho de saltos/TTL) para um
+// receptor fora do alcance dos nós. Não envia beacons nem atribui slots.
+#define REPEATER_MODE    false
+#define REPEATER_STATS_INTERVAL_MS 60000
+
+// Saída dos pacotes recebidos: texto (printf) ou registros binários COBS
+// (common/lora_stream.h) no USB. Pode ser trocada pelo console: "bin"/"texto".
+#define OUTPUT_BINARY    false
+static bool binary_output = OUTPUT_BINARY;
+
+// Captura crua de cada recepção (registros LORA_STREAM_TYPE_CAPTURE), em
+// qualquer um dos modos de saída; host/replay reproduz a captura gravada.
+static bool capture_output = false;
+
+TRACE_DEFINE_RING()
+
+// Lido direto do buffer recebido, que pode estar em endereço ímpar (depois
+// do cabeçalho de repetição): packed evita a falha de acesso desalinhado do M0+
+typedef struct __attribute__((packed)) {
     int16_t temperatura;
 	int16_t umidade;
 } aht10_dados;
 
 void print_texto(char *msg, uint pos_x, uint pos_y, uint scale){
-    ssd1306_draw_string(&disp, pos_x, pos_y, scale, (uint8_t*)msg); // cast para uint8_t* se draw_string espera isso
+    ssd1306_draw_string(&disp, pos_x, pos_y, scale, msg);
 }
 
 void to_binary_string(uint8_t val, char *str) {
@@ -63,20 +112,560 @@ static int center_x_for(const char* s, int scale) {
 
 static void print_texto_centered(const char* msg, int y, int scale) {
     int x = center_x_for(msg, scale);
-    ssd1306_draw_string(&disp, x, y, (uint)scale, (const uint8_t*)msg);
+    ssd1306_draw_string(&disp, x, y, (uint)scale, msg);
 }
 
-static void show_temp_umid(float temp_c, float umid_pct) {
-    char line[32];
+// "T 25.34C": centésimos direto para dígitos (common/fmt_int.h), sem float
+static int reading_line(char *line, char tag, int16_t centi, const char *unit) {
+    line[0] = tag;
+    line[1] = ' ';
+    int n = 2 + fmt_centi(line + 2, centi);
+    return n + fmt_str(line + n, unit);
+}
+
+// Tela com dados: cada grandeza ocupa 4 páginas, texto em escala 2 (páginas
+// 0-1 e 4-5) e, logo abaixo, o gráfico das últimas leituras (2-3 e 6-7)
+#define DISPLAY_PAGE_TEMP   0
+#define DISPLAY_PAGE_UMID   4
+#define GRAPH_MIN_SPAN_TEMP 50    // 0,50 °C na altura do gráfico, no mínimo
+#define GRAPH_MIN_SPAN_UMID 200   // 2,00 %
+
+// Limpa as duas páginas do texto e escreve a linha centralizada
+static void draw_text_row(uint8_t page, const char *line, int n) {
+    memset(&disp.buffer[disp.width * page], 0, 2u * disp.width);
+    int x = (128 - n * 6 * 2) / 2;
+    ssd1306_draw_string_fast(&disp, x < 0 ? 0 : x, page * 8u, 2, line);
+}
+
+// Só preenche o framebuffer; quem chama decide quando fazer o ssd1306_show
+static void show_temp_umid(int16_t temp_centi, int16_t umid_centi) {
+    char line[FMT_CENTI_MAX + 4];
+    TRACE_BEGIN(DISPLAY_DRAW);
+    draw_text_row(DISPLAY_PAGE_TEMP, line, reading_line(line, 'T', temp_centi, "C"));
+    draw_text_row(DISPLAY_PAGE_UMID, line, reading_line(line, 'U', umid_centi, "%"));
+    TRACE_END(DISPLAY_DRAW);
+}
+
+// Telas depois do primeiro dado: as do painel de nós (inc/dashboard.h), uma a
+// cada DASH_NODES_PER_PAGE nós, a do nó acompanhado, com os gráficos, e o
+// log de eventos (inc/logview.h).
+// Passam sozinhas a cada DISPLAY_ROTATE_MS ou pelo botão A.
+#define DISPLAY_ROTATE_MS 5000
+#define PIN_BUTTON_A      5      // ativo em nível baixo (pull-up interno)
+
+typedef enum {
+    SHOWN_NONE,     // framebuffer com outra coisa: a próxima tela é redesenhada inteira
+    SHOWN_DASH,     // alguma tela do painel (as linhas se atualizam pelo conteúdo)
+    SHOWN_GRAPH,
+    SHOWN_LOG,
+} display_shown_t;
+
+static bool got_first_data = false;
+static uint8_t display_screen = 0;
+static uint32_t display_screen_since_ms = 0;
+static display_shown_t display_shown = SHOWN_NONE;
+static bool button_was_down = false;
+
+// Pacotes, erros de CRC e nós sem notícias, uma linha cada. Fora da tela do
+// log só o texto é guardado; nela, cada linha rola a tela pela start line do
+// display e envia uma página.
+static logview_t event_log;
+
+// Na tela do nó acompanhado, a leitura vai para o framebuffer assim que o
+// pacote é tratado (formatar e desenhar custa poucos µs); só o ssd1306_show,
+// o trecho mais lento do laço (I2C do display), fica para o tick, então uma
+// rajada de pacotes custa um único envio ao display
+static bool display_dirty = false;
+static aht10_dados display_last;   // leitura no framebuffer
+static uint32_t display_ready_last_us = 0, display_ready_max_us = 0; // RxDone -> framebuffer pronto
+
+// O display acompanha um nó (o primeiro que chegar, ou o escolhido com
+// "grafico <no>"): só as leituras dele entram no histórico e na tela
+static bool graph_have_node = false;
+static uint8_t graph_node = 0;
+static history_t hist_temp, hist_umid;
+static sparkline_t spark_temp, spark_umid;
+
+static void graph_follow(uint8_t node_id) {
+    graph_have_node = true;
+    graph_node = node_id;
+    history_init(&hist_temp);
+    history_init(&hist_umid);
+    sparkline_init(&spark_temp, DISPLAY_PAGE_TEMP + 2, 2, GRAPH_MIN_SPAN_TEMP);
+    sparkline_init(&spark_umid, DISPLAY_PAGE_UMID + 2, 2, GRAPH_MIN_SPAN_UMID);
+}
+
+// Tela do nó acompanhado inteira
+static void graph_screen_draw(void) {
     ssd1306_clear(&disp);
-    int y_top = (64 - (16 * 2)) / 2;
-    snprintf(line, sizeof(line), "T %.2fC", temp_c);
-    print_texto_centered(line, y_top, 2);
-    snprintf(line, sizeof(line), "U %.2f%%", umid_pct);
-    print_texto_centered(line, y_top + 20, 2); 
+    if (history_count(&hist_temp)) {
+        show_temp_umid(display_last.temperatura, display_last.umidade);
+        sparkline_redraw(&spark_temp, &disp, &hist_temp);
+        sparkline_redraw(&spark_umid, &disp, &hist_umid);
+    }
+    display_dirty = true;
+}
+
+static void display_post(const aht10_dados *rec, uint8_t node_id, uint32_t rx_time_us) {
+    if (!graph_have_node) graph_follow(node_id);
+    if (node_id != graph_node) return;
+    display_last = *rec;
+    history_push(&hist_temp, rec->temperatura);
+    history_push(&hist_umid, rec->umidade);
+    if (display_shown != SHOWN_GRAPH) return; // desenhada inteira quando a tela aparecer
+    show_temp_umid(rec->temperatura, rec->umidade);
+    sparkline_push(&spark_temp, &disp, &hist_temp);
+    sparkline_push(&spark_umid, &disp, &hist_umid);
+    display_ready_last_us = time_us_32() - rx_time_us;
+    if (display_ready_last_us > display_ready_max_us) display_ready_max_us = display_ready_last_us;
+    display_dirty = true;
+}
+
+// Linha do log para uma leitura: "12 25.3C 45% -80" (nó, T, U, RSSI)
+static void log_event_reading(uint8_t node_id, const aht10_dados *rec, int16_t rssi_dbm) {
+    char line[48];
+    int n = fmt_u32(line, node_id);
+    line[n++] = ' ';
+    n += fmt_deci(line + n, rec->temperatura);
+    n += fmt_str(line + n, "C ");
+    n += fmt_i32(line + n, (rec->umidade + 50) / 100);
+    n += fmt_str(line + n, "% ");
+    fmt_i32(line + n, rssi_dbm);
+    logview_add(&event_log, &disp, line);
+}
+
+// "CRC 12B -97" (tamanho e RSSI do quadro perdido)
+static void log_event_crc(int len, int16_t rssi_dbm) {
+    char line[32];
+    int n = fmt_str(line, "CRC ");
+    n += fmt_i32(line + n, len);
+    n += fmt_str(line + n, "B ");
+    fmt_i32(line + n, rssi_dbm);
+    logview_add(&event_log, &disp, line);
+}
+
+// No tick: troca de tela (tempo ou botão) e envio ao display
+static void display_service(void) {
+    if (!got_first_data) return; // animação de espera
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    uint8_t dash_pages = dashboard_pages();
+    uint8_t log_screen = (uint8_t)(dash_pages + (graph_have_node ? 1 : 0));
+    uint8_t screens = (uint8_t)(log_screen + 1);
+
+    bool down = !gpio_get(PIN_BUTTON_A);
+    bool pressed = down && !button_was_down;
+    button_was_down = down;
+    if (pressed || now - display_screen_since_ms >= DISPLAY_ROTATE_MS) {
+        display_screen++;
+        display_screen_since_ms = now;
+    }
+    if (display_screen >= screens) display_screen = 0;
+
+    if (display_screen == log_screen) {
+        if (display_shown != SHOWN_LOG) logview_show(&event_log, &disp);
+        display_shown = SHOWN_LOG;
+        logview_flush(&event_log, &disp);
+        return;
+    }
+    logview_hide(&event_log, &disp); // as outras telas desenham com a start line em 0
+
+    if (display_screen < dash_pages) {
+        if (display_shown != SHOWN_DASH) dashboard_invalidate();
+        display_shown = SHOWN_DASH;
+        uint8_t first, last;
+        dashboard_render(&disp, display_screen, now, &first, &last);
+        if (first <= last) ssd1306_show_pages(&disp, first, last);
+        return;
+    }
+    if (display_shown != SHOWN_GRAPH) {
+        graph_screen_draw();
+        display_shown = SHOWN_GRAPH;
+    }
+    if (!display_dirty) return;
     ssd1306_show(&disp);
+    display_dirty = false;
+}
+
+static void print_dashboard_stats(void) {
+    dashboard_stats_t st;
+    dashboard_get_stats(&st);
+    printf("Display: tela %u de %u (%u do painel, %u nos por tela), troca a cada %u ms ou pelo botao A\n",
+           display_screen + 1u, dashboard_pages() + (graph_have_node ? 2u : 1u), dashboard_pages(),
+           DASH_NODES_PER_PAGE, DISPLAY_ROTATE_MS);
+    printf("Painel: %lu atualizacoes, %lu linhas redesenhadas; render ultimo %lu us, max %lu us\n",
+           (unsigned long)st.renders, (unsigned long)st.lines_drawn, (unsigned long)st.render_us_last,
+           (unsigned long)st.render_us_max);
+    printf("Envios ao display: %lu, ultimo %lu bytes, max %lu (tela inteira %u), total %lu\n",
+           (unsigned long)st.flushes, (unsigned long)st.flush_bytes_last, (unsigned long)st.flush_bytes_max,
+           (unsigned)disp.bufsize, (unsigned long)st.flush_bytes_total);
+    printf("Log: %lu linhas, %lu rolagens pela start line, %lu telas inteiras, %lu bytes enviados\n",
+           (unsigned long)event_log.lines, (unsigned long)event_log.scrolls, (unsigned long)event_log.redraws,
+           (unsigned long)event_log.bytes);
+}
+
+#define DISPLAY_BENCH_CALLS 16
+#define SYSTICK_MASK 0xFFFFFFu  // contador de 24 bits, decrescente
+
+// Ciclos para formatar e desenhar uma leitura: caminho antigo (float,
+// "%.2f" e um quadrado por pixel) contra o atual, e a linha de texto do
+// pacote com "%.2f" contra fmt_int.h. Depois a tela atual é redesenhada.
+static void display_bench(void) {
+    static const int16_t temps[4] = { 2534, -512, 10000, 7 }, umids[4] = { 4510, 9999, 0, 100 };
+    static const int8_t snrs[4] = { 38, -29, 0, -77 };   // quartos de dB
+    char line[96], t[FMT_CENTI_MAX], u[FMT_CENTI_MAX], q[FMT_CENTI_MAX];
+    uint32_t old_draw = 0, new_draw = 0, old_text = 0, new_text = 0;
+
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // ENABLE | CLKSOURCE = processador
+    for (uint32_t i = 0; i < DISPLAY_BENCH_CALLS; i++) {
+        int16_t tc = temps[i & 3], uc = umids[i & 3];
+        int8_t snr = snrs[i & 3];
+        uint32_t t0 = systick_hw->cvr;
+        ssd1306_clear(&disp);
+        snprintf(line, sizeof(line), "T %.2fC", tc / 100.0f);
+        print_texto_centered(line, 16, 2);
+        snprintf(line, sizeof(line), "U %.2f%%", uc / 100.0f);
+        print_texto_centered(line, 36, 2);
+        uint32_t t1 = systick_hw->cvr;
+        show_temp_umid(tc, uc);
+        uint32_t t2 = systick_hw->cvr;
+        snprintf(line, sizeof(line), "Recebido T=%.2fC U=%.2f%% SNR=%.2f dB", tc / 100.0f, uc / 100.0f, snr / 4.0f);
+        uint32_t t3 = systick_hw->cvr;
+        fmt_centi(t, tc);
+        fmt_centi(u, uc);
+        fmt_centi(q, snr * 25);
+        snprintf(line, sizeof(line), "Recebido T=%sC U=%s%% SNR=%s dB", t, u, q);
+        uint32_t t4 = systick_hw->cvr;
+        old_draw += (t0 - t1) & SYSTICK_MASK;
+        new_draw += (t1 - t2) & SYSTICK_MASK;
+        old_text += (t2 - t3) & SYSTICK_MASK;
+        new_text += (t3 - t4) & SYSTICK_MASK;
+    }
+
+    // Gráfico da temperatura numa cópia da escala: redesenho completo contra
+    // o deslocamento de uma coluna
+    static sparkline_t bench_spark;
+    uint32_t graph_redraw = 0, graph_scroll = 0;
+    if (history_count(&hist_temp)) {
+        sparkline_init(&bench_spark, DISPLAY_PAGE_TEMP + 2, 2, GRAPH_MIN_SPAN_TEMP);
+        for (uint32_t i = 0; i < DISPLAY_BENCH_CALLS; i++) {
+            uint32_t t0 = systick_hw->cvr;
+            sparkline_redraw(&bench_spark, &disp, &hist_temp);
+            uint32_t t1 = systick_hw->cvr;
+            sparkline_push(&bench_spark, &disp, &hist_temp);
+            uint32_t t2 = systick_hw->cvr;
+            graph_redraw += (t0 - t1) & SYSTICK_MASK;
+            graph_scroll += (t1 - t2) & SYSTICK_MASK;
+        }
+    }
+    systick_hw->csr = 0;
+    printf("dispbench: desenho float+pixel %lu ciclos, inteiro+colunas %lu ciclos; linha de texto %%.2f %lu ciclos, "
+           "fmt_int %lu ciclos (media de %u)\n",
+           (unsigned long)(old_draw / DISPLAY_BENCH_CALLS), (unsigned long)(new_draw / DISPLAY_BENCH_CALLS),
+           (unsigned long)(old_text / DISPLAY_BENCH_CALLS), (unsigned long)(new_text / DISPLAY_BENCH_CALLS),
+           DISPLAY_BENCH_CALLS);
+    printf("grafico: redesenho %lu ciclos, deslocamento de uma coluna %lu ciclos\n",
+           (unsigned long)(graph_redraw / DISPLAY_BENCH_CALLS), (unsigned long)(graph_scroll / DISPLAY_BENCH_CALLS));
+    printf("RxDone -> framebuffer pronto: ultimo %lu us, max %lu us\n", (unsigned long)display_ready_last_us,
+           (unsigned long)display_ready_max_us);
+    display_shown = SHOWN_NONE;
+}
+
+static void print_graph(void) {
+    if (!graph_have_node) {
+        printf("Grafico: nenhum no acompanhado ainda\n");
+        return;
+    }
+    char mn[FMT_CENTI_MAX], mx[FMT_CENTI_MAX], avg[FMT_CENTI_MAX];
+    printf("Grafico do no %u: %u leituras (janela de %u)\n", graph_node, history_count(&hist_temp), HISTORY_LEN);
+    fmt_centi(mn, history_min(&hist_temp));
+    fmt_centi(mx, history_max(&hist_temp));
+    fmt_centi(avg, history_mean(&hist_temp));
+    printf("  T min %s max %s media %s C; deslocamentos %lu, redesenhos %lu\n", mn, mx, avg,
+           (unsigned long)spark_temp.scrolls, (unsigned long)spark_temp.redraws);
+    fmt_centi(mn, history_min(&hist_umid));
+    fmt_centi(mx, history_max(&hist_umid));
+    fmt_centi(avg, history_mean(&hist_umid));
+    printf("  U min %s max %s media %s %%; deslocamentos %lu, redesenhos %lu\n", mn, mx, avg,
+           (unsigned long)spark_umid.scrolls, (unsigned long)spark_umid.redraws);
+}
+
+static void start_rx(const lora_config_t *cfg) {
+    if (cfg->rx_duty_cycle) lora_start_rx_duty_cycle();
+    else lora_start_rx_continuous();
+}
+
+// Envia o relógio local e a tabela de slots para os transmissores.
+// O carimbo é tirado logo antes de lora_send_bytes; a escrita do FIFO até o
+// MODE_TX leva dezenas de microssegundos, bem abaixo da incerteza do polling
+// do lado do FPGA. Retorna o instante carimbado (início do superquadro).
+static absolute_time_t send_sync_beacon(void) {
+    uint8_t buf[sizeof(lora_beacon_t) + LORA_PROTO_MAX_SLOTS];
+    absolute_time_t now = get_absolute_time();
+    size_t len = tdma_master_build_beacon(&tdma, to_us_since_boot(now), buf);
+    if (!lora_send_bytes(buf, len)) {
+        TLOG(LOG_BEACON_TX_ERROR);
+    }
+    return now;
+}
+
+static void print_pktbuf_stats(void) {
+    pktbuf_stats_t st;
+    pktbuf_get_stats(&st);
+    printf("[BUFFERS] %u/%u em uso (max %u), max %u referencias por buffer, %lu pacotes adiados por pool vazio\n",
+           st.in_use, PKTBUF_COUNT, st.in_use_max, st.refs_max, (unsigned long)st.alloc_fails);
+}
+
+static void print_repeater_stats(void) {
+    repeater_stats_t st;
+    repeater_get_stats(&st);
+    uint32_t avg_ms = st.latency_count ? (uint32_t)(st.latency_sum_us / st.latency_count / 1000) : 0;
+    printf("[REPETIDOR] repassados %lu, duplicados %lu, ttl esgotado %lu, fila cheia %lu, timeouts %lu | "
+           "fila %u/%u (max %u) | latencia ultima %lu ms, media %lu ms, max %lu ms\n",
+           (unsigned long)st.forwarded, (unsigned long)duplicates, (unsigned long)st.dropped_ttl,
+           (unsigned long)st.dropped_full, (unsigned long)st.tx_timeouts,
+           st.queue_len, REPEATER_QUEUE_LEN, st.queue_max,
+           (unsigned long)(st.latency_last_us / 1000), (unsigned long)avg_ms,
+           (unsigned long)(st.latency_max_us / 1000));
+}
+
+// ============================
+// LOG EM FLASH
+// ============================
+
+static void log_reading(const aht10_dados *d, uint32_t timestamp_ms, uint8_t node_id, uint8_t seq,
+                        const lora_pkt_meta_t *meta) {
+    int rssi_neg = -meta->rssi_dbm;
+    flash_log_record_t rec = {
+        .rx_ms = to_ms_since_boot(get_absolute_time()),
+        .timestamp_ms = timestamp_ms,
+        .temperatura = d->temperatura,
+        .umidade = d->umidade,
+        .node_id = node_id,
+        .seq = seq,
+        .rssi_neg_dbm = (uint8_t)(rssi_neg < 0 ? 0 : rssi_neg > 255 ? 255 : rssi_neg),
+        .snr_qdb = meta->snr_qdb,
+    };
+    flash_log_append(&rec);
+}
+
+static void print_log_stats(void) {
+    flash_log_stats_t st;
+    flash_log_get_stats(&st);
+    printf("Log em flash: %lu/%u paginas (%u registros/pagina), %lu em RAM, boot %u\n",
+           (unsigned long)st.pages_used, FLASH_LOG_PAGES, (unsigned)FLASH_LOG_RECORDS_PER_PAGE,
+           (unsigned long)st.pending, st.boot);
+    printf("  seq %lu..%lu, paginas gravadas %lu, setores apagados %lu, cabecalhos lidos no boot %lu\n",
+           (unsigned long)st.oldest_seq, (unsigned long)st.next_seq, (unsigned long)st.pages_written,
+           (unsigned long)st.sectors_erased, (unsigned long)st.recovery_reads);
+}
+
+// Páginas vão direto ao driver USB: sem tradução LF->CRLF e sem esperar a UART
+static void usb_write(const uint8_t *data, size_t len) {
+    stdio_usb.out_chars((const char *)data, (int)len);
+}
+
+static void dump_log(void) {
+    printf("FLASHLOG INICIO\n");
+    stdio_flush();
+    uint32_t pages = flash_log_dump(usb_write);
+    stdio_flush();
+    printf("\nFLASHLOG FIM %lu paginas\n", (unsigned long)pages);
+}
+
+// ============================
+// PAYLOADS RECEBIDOS
+// ============================
+
+// Pacote em tratamento, repassado aos tratadores de payload
+typedef struct {
+    pktbuf_t *pkt;
+    const lora_pkt_meta_t *meta;
+    uint8_t hops;
+} rx_ctx_t;
+
+static uint32_t payload_counts[LORA_PAYLOAD_N_TYPES];
+static uint32_t legacy_payloads = 0;    // amostras sem cabeçalho tipado
+static uint32_t unknown_payloads = 0;   // tipo, versão ou tamanho desconhecidos
+
+// rec aponta para o buffer recebido; sample é NULL no quadro antigo de 4 bytes; heartbeat_s só vem nos quadros
+// enviados por exceção
+static void handle_reading(const rx_ctx_t *ctx, const aht10_dados *rec, const lora_sample_t *sample,
+                           uint16_t heartbeat_s) {
+    const lora_pkt_meta_t *meta = ctx->meta;
+    uint32_t sample_ms = sample ? sample->timestamp_ms : 0;
+    if (sample && node_table_update(sample->node_id, rec->temperatura, rec->umidade, meta->rssi_dbm, heartbeat_s,
+                                    to_ms_since_boot(get_absolute_time()))) {
+        TLOG(LOG_NODE_BACK, sample->node_id);
+    }
+    log_reading(rec, sample_ms, sample ? sample->node_id : 0, sample ? sample->seq : 0, meta);
+    display_post(rec, sample ? sample->node_id : 0, meta->rx_time_us);
+    log_event_reading(sample ? sample->node_id : 0, rec, meta->rssi_dbm);
+    if (!got_first_data) display_screen_since_ms = to_ms_since_boot(get_absolute_time());
+    got_first_data = true;
+    if (binary_output) return;
+
+    TRACE_BEGIN(FORMAT);
+    lowpower_stats_t lp;
+    lowpower_get_stats(&lp);
+    char temp[FMT_CENTI_MAX], umid[FMT_CENTI_MAX], snr[FMT_CENTI_MAX];
+    fmt_centi(temp, rec->temperatura);
+    fmt_centi(umid, rec->umidade);
+    fmt_centi(snr, meta->snr_qdb * 25); // quartos de dB -> centésimos
+    printf("Recebido T=%sC U=%s%% RSSI=%d dBm SNR=%s dB FEI=%ld Hz t=%lu (DIO0->FIFO %luus, max %luus)\n",
+           temp, umid, meta->rssi_dbm, snr,
+           (long)meta->freq_error_hz, (unsigned long)meta->rx_time_us,
+           (unsigned long)lp.latency_last_us, (unsigned long)lp.latency_max_us);
+    TRACE_END(FORMAT);
+    if (sample_ms) {
+        // Inclui o tempo no ar do pacote (~2.6 s em SF12)
+        printf("  No %u seq %u (%u saltos): amostra de t=%lu ms (tempo de rede), idade %ld ms\n",
+               sample->node_id, sample->seq, ctx->hops, (unsigned long)sample_ms,
+               (long)(to_ms_since_boot(get_absolute_time()) - sample_ms));
+    }
+}
+
+static void on_payload_reading(const rx_ctx_t *ctx, const lora_payload_hdr_t *hdr, const lora_reading_t *body) {
+    lora_sample_t sample = { body->temperatura, body->umidade, body->timestamp_ms, hdr->node_id, hdr->seq };
+    handle_reading(ctx, (const aht10_dados *)body, &sample, 0);
+}
+
+static void on_payload_report(const rx_ctx_t *ctx, const lora_payload_hdr_t *hdr, const lora_report_t *body) {
+    const lora_reading_t *r = &body->reading;
+    lora_sample_t sample = { r->temperatura, r->umidade, r->timestamp_ms, hdr->node_id, hdr->seq };
+    handle_reading(ctx, (const aht10_dados *)r, &sample, body->heartbeat_s);
+}
+
+// Despacho gerado do registro em lora_proto.h: um case por tipo, sem
+// tabela em RAM; falta de tratador on_payload_<nome> é erro de compilação
+#define PAYLOAD_CASE(id, NAME, name, body_t, label)          \
+    case id:                                                 \
+        payload_counts[LORA_PAYLOAD_IDX_##NAME]++;           \
+        on_payload_##name(ctx, hdr, (const body_t *)body);   \
+        break;
+
+static void dispatch_payload(const rx_ctx_t *ctx, const lora_payload_hdr_t *hdr, const uint8_t *body) {
+    switch (hdr->type) {
+    LORA_PAYLOAD_TYPES(PAYLOAD_CASE)
+    default: break; // lora_payload_parse só devolve KNOWN para tipos registrados
+    }
+}
+#undef PAYLOAD_CASE
+
+// Nós com envio por exceção que passaram do heartbeat sem nenhum quadro
+static void check_stale_nodes(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    const node_entry_t *e;
+    while ((e = node_table_next_stale(now)) != NULL) {
+        TLOG(LOG_NODE_STALE, e->node_id, (now - e->last_rx_ms) / 1000, e->heartbeat_s);
+        char line[32];
+        int n = fmt_u32(line, e->node_id);
+        fmt_str(line + n, " sem noticias");
+        logview_add(&event_log, &disp, line);
+    }
+}
+
+static void print_nodes(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    printf("%4s %8s %8s %8s %7s %8s  %s\n", "no", "T_C", "U_%", "idade_s", "hb_s", "quadros", "estado");
+    for (int i = 0; i < NODE_TABLE_LEN; i++) {
+        const node_entry_t *e = node_table_get(i);
+        if (!e) continue;
+        const char *state = e->stale ? "sem noticias" : e->heartbeat_s ? "inalterado desde o ultimo quadro" : "sem heartbeat";
+        char temp[FMT_CENTI_MAX], umid[FMT_CENTI_MAX];
+        fmt_centi(temp, e->temperatura);
+        fmt_centi(umid, e->umidade);
+        printf("%4u %8s %8s %8lu %7u %8lu  %s\n", e->node_id, temp, umid,
+               (unsigned long)((now - e->last_rx_ms) / 1000), e->heartbeat_s, (unsigned long)e->frames, state);
+    }
+}
+
+static void print_payload_stats(void) {
+#define PAYLOAD_COUNT(id, NAME, name, body_t, label) \
+    printf("  %-12s tipo %u, %u bytes: %lu\n", label, id, (unsigned)sizeof(body_t), \
+           (unsigned long)payload_counts[LORA_PAYLOAD_IDX_##NAME]);
+    printf("Payloads recebidos (cabecalho versao %u):\n", LORA_PAYLOAD_VERSION);
+    LORA_PAYLOAD_TYPES(PAYLOAD_COUNT)
+    printf("  %-12s %lu\n  %-12s %lu\n", "sem tipo", (unsigned long)legacy_payloads,
+           "desconhecido", (unsigned long)unknown_payloads);
+#undef PAYLOAD_COUNT
 }
 
+// ============================
+// CONSOLE USB
+// ============================
+
+static char *readstr(void) {
+    static char s[32];
+    static int ptr = 0;
+
+    int c = getchar_timeout_us(0);
+    if (c == PICO_ERROR_TIMEOUT) return NULL;
+    if (c == '\r' || c == '\n') {
+        s[ptr] = 0;
+        ptr = 0;
+        return s;
+    }
+    if (ptr < (int)sizeof(s) - 1) s[ptr++] = (char)c;
+    return NULL;
+}
+
+static void help(void) {
+    puts("Comandos:");
+    puts("dump      - envia o log da flash (paginas binarias, ver host/flashlog_decode)");
+    puts("log       - estado do log em flash");
+    puts("logflush  - grava agora as leituras que estao em RAM");
+    puts("logclear  - apaga o log");
+    puts("bin       - pacotes recebidos em registros binarios (ver host/stream_decode)");
+    puts("texto     - pacotes recebidos em texto");
+    puts("captura   - liga/desliga a captura crua das recepcoes (ver host/replay)");
+    puts("buffers   - ocupacao do pool de buffers de recepcao");
+    puts("tipos     - pacotes recebidos por tipo de payload");
+    puts("nos       - ultimo valor de cada no (silencio = sem mudanca ate perder o heartbeat)");
+    puts("logbench  - ciclos por chamada de printf e do log tokenizado (ver host/tlog_decode)");
+    puts("dispbench - ciclos para formatar e desenhar uma leitura (float x inteiro) e o grafico");
+    puts("grafico   - minimo, maximo e media recentes do no no display; \"grafico <no>\" troca o no");
+    puts("painel    - telas do display, custo de desenho e bytes enviados ao display");
+#if TRACE_ENABLED
+    puts("trace     - despeja o trace dos lacos quentes (ver host/trace_json)");
+#endif
+}
+
+static void console_service(void) {
+    char *cmd = readstr();
+    if (cmd == NULL || cmd[0] == 0) return;
+    if (strcmp(cmd, "dump") == 0) dump_log();
+    else if (strcmp(cmd, "log") == 0) print_log_stats();
+    else if (strcmp(cmd, "logflush") == 0) flash_log_flush();
+    else if (strcmp(cmd, "logclear") == 0) flash_log_clear();
+    else if (strcmp(cmd, "logbench") == 0) tlog_bench();
+    else if (strcmp(cmd, "dispbench") == 0) display_bench();
+    else if (strcmp(cmd, "grafico") == 0) print_graph();
+    else if (strcmp(cmd, "painel") == 0) print_dashboard_stats();
+    else if (strncmp(cmd, "grafico ", 8) == 0) {
+        graph_follow((uint8_t)atoi(cmd + 8));
+        display_shown = SHOWN_NONE;
+        print_graph();
+    }
+    else if (strcmp(cmd, "buffers") == 0) print_pktbuf_stats();
+    else if (strcmp(cmd, "tipos") == 0) print_payload_stats();
+    else if (strcmp(cmd, "nos") == 0) print_nodes();
+    else if (strcmp(cmd, "bin") == 0) binary_output = true;
+    else if (strcmp(cmd, "texto") == 0) binary_output = false;
+    else if (strcmp(cmd, "captura") == 0) {
+        capture_output = !capture_output;
+        if (!binary_output) printf("Captura %s\n", capture_output ? "ligada" : "desligada");
+    }
+#if TRACE_ENABLED
+    else if (strcmp(cmd, "trace") == 0) trace_dump();
+#endif
+    else help();
+}
+
+static uint32_t beacon_interval_us(void) {
+    return tdma.n_slots ? tdma_master_superframe_us(&tdma) : SYNC_BEACON_INTERVAL_MS * 1000u;
+}
 
 int main()
 {
@@ -88,6 +677,12 @@ int main()
     gpio_pull_up(I2C_SDA);
     disp.external_vcc = false;
     
+    gpio_init(PIN_BUTTON_A);
+    gpio_set_dir(PIN_BUTTON_A, GPIO_IN);
+    gpio_pull_up(PIN_BUTTON_A);
+    button_was_down = !gpio_get(PIN_BUTTON_A);
+    logview_init(&event_log);
+
     ssd1306_init(&disp, 128, 64, 0x3C, I2C_PORT);
     ssd1306_clear(&disp);
     print_texto_centered("Esperando dados...", (64 - 8) / 2, 1);
@@ -109,37 +704,128 @@ int main()
         .pin_mosi = PIN_MOSI,
         .pin_rst = PIN_RST,
         .pin_dio0 = PIN_DIO0,
-        .frequency = LORA_FREQUENCY
+        .frequency = LORA_FREQUENCY,
+        .rx_duty_cycle = LORA_RX_DUTY_CYCLE,
+        .sender_preamble_len = LORA_SENDER_PREAMBLE
     };
 
-    printf("Inicializando modulo LoRa (%.0f Hz)...\n", (float)LORA_FREQUENCY);
-    if (!lora_init(lora_cfg)) {
+    printf("Inicializando modulo LoRa (%lu Hz)...\n", (unsigned long)LORA_FREQUENCY);
+    bool lora_ok = lora_init(lora_cfg);
+    if (!lora_ok) {
         printf("[ERRO] Falha ao inicializar o modulo LoRa.\n");
+    } else if (lora_cfg.rx_duty_cycle) {
+        printf("[SUCESSO] Modulo LoRa inicializado. RX em ciclos: radio ligado %lu/1000 do tempo (preambulo %u simbolos)\n",
+               (unsigned long)lora_rx_duty_cycle_on_permille(LORA_SENDER_PREAMBLE), LORA_SENDER_PREAMBLE);
+        start_rx(&lora_cfg);
     } else {
         printf("[SUCESSO] Modulo LoRa inicializado. Colocando em RX contínuo...\n");
-        lora_start_rx_continuous();
+        start_rx(&lora_cfg);
+    }
+
+    lowpower_init();
+    flash_log_init();
+    print_log_stats();
+    dedup_init(&recent_frames);
+    pktbuf_init();
+    node_table_init();
+    repeater_init();
+    tdma_master_init(&tdma, REPEATER_MODE ? 0 : TDMA_SLOTS);
+    if (REPEATER_MODE) {
+        printf("Modo repetidor: ttl %u, fila de %u quadros\n", LORA_PROTO_RELAY_TTL, REPEATER_QUEUE_LEN);
+    } else if (tdma.n_slots) {
+        printf("TDMA: %u slots de %lu ms, superquadro de %lu ms\n", tdma.n_slots,
+               (unsigned long)(tdma.slot_us / 1000), (unsigned long)(tdma_master_superframe_us(&tdma) / 1000));
     }
 
-    uint8_t rxbuf[64];
-    bool got_first_data = false;
     uint32_t anim_tick = 0;
     int dots = 1;
+    absolute_time_t next_tick = make_timeout_time_ms(LOOP_PERIOD_MS);
+    absolute_time_t next_beacon = make_timeout_time_ms(1000);
+    absolute_time_t next_stats = make_timeout_time_ms(REPEATER_STATS_INTERVAL_MS);
     while (true) {
-        int len = lora_receive_bytes(rxbuf, sizeof(rxbuf));
-        if (len == sizeof(aht10_dados)) {
-            aht10_dados rec;
-            memcpy(&rec, rxbuf, sizeof(rec));
-            float temp = rec.temperatura / 100.0f;
-            float umid = rec.umidade / 100.0f;
-            show_temp_umid(temp, umid);
-            got_first_data = true;
-            int rssi = lora_get_rssi();
-            printf("Recebido T=%.2fC U=%.2f%% RSSI=%d dBm\n", temp, umid, rssi);
-        } else if (len > 0) {
-            printf("LoRa recebeu %d bytes (raw): ", len);
-            for (int i = 0; i < len; ++i) printf("%02X ", rxbuf[i]);
-            printf("\n");
-        } else {
+        TRACE_BEGIN(LOOP);
+        lora_pkt_meta_t meta;
+        // O pacote é lido do FIFO uma vez, direto num buffer do pool; quem
+        // precisa dele depois desta passagem (a fila do repetidor) pega uma
+        // referência. Com o pool vazio o pacote espera no rádio.
+        pktbuf_t *pkt = pktbuf_alloc();
+        int len = pkt ? lora_receive_packet(pkt->data, PKTBUF_SIZE, &meta) : 0;
+        if (len > 0) pkt->len = (uint8_t)len;
+        bool tick = time_reached(next_tick);
+        if (tick) next_tick = make_timeout_time_ms(LOOP_PERIOD_MS);
+
+        if (len > 0) lowpower_record_latency(meta.rx_time_us);
+        if (len > 0 && capture_output) stream_out_capture(lora_last_rx_raw(), pkt->data, (uint8_t)len);
+
+        // Quadros repassados chegam com cabeçalho de repetição; o resto do
+        // tratamento olha só para o quadro original
+        const uint8_t *frame = pkt ? pkt->data : NULL;
+        uint8_t frame_len = (uint8_t)len;
+        lora_relay_hdr_t relay = { 0 };
+        bool relayable = len > 0 && meta.crc_ok &&
+                         lora_proto_relay_parse(pkt->data, (uint8_t)len, &relay, &frame, &frame_len);
+        bool duplicate = relayable && dedup_check_and_add(&recent_frames, relay.node_id, relay.seq);
+        if (duplicate) duplicates++;
+        else if (relayable && REPEATER_MODE) repeater_enqueue(&relay, pkt, frame, frame_len, meta.rx_time_us);
+
+        // No modo binário cada pacote (inclusive com erro de CRC ou duplicado)
+        // vira um registro e nada mais é impresso sobre ele
+        if (len > 0 && binary_output) {
+            stream_out_packet(pkt->data, (uint8_t)len, &meta, duplicate ? LORA_STREAM_FLAG_DUPLICATE : 0);
+        }
+        len = frame_len;
+
+        rx_ctx_t ctx = { .pkt = pkt, .meta = &meta, .hops = relay.hops };
+        lora_payload_hdr_t ph = { 0 };
+        const uint8_t *body = NULL;
+        uint8_t body_len = 0;
+        lora_payload_kind_t kind = len > 0 && meta.crc_ok ? lora_payload_parse(frame, (uint8_t)len, &ph, &body, &body_len)
+                                                          : LORA_PAYLOAD_UNTYPED;
+
+        if (len > 0 && !meta.crc_ok) {
+            log_event_crc(len, meta.rssi_dbm);
+            if (!binary_output) printf("Pacote com erro de CRC descartado (%d bytes, RSSI=%d dBm)\n", len, meta.rssi_dbm);
+        } else if (duplicate) {
+            if (!binary_output) {
+                printf("Copia repetida do no %u seq %u descartada (%u saltos)\n", relay.node_id, relay.seq, relay.hops);
+            }
+        } else if (!REPEATER_MODE && len == sizeof(lora_join_t) && frame[0] == LORA_PROTO_JOIN_MAGIC) {
+            int slot = tdma_master_on_join(&tdma, frame[1]);
+            if (binary_output) {
+                // o próprio quadro JOIN já foi para o fluxo binário
+            } else if (slot >= 0) {
+                printf("TDMA: no %u recebeu o slot %d (anunciado no proximo beacon)\n", frame[1], slot);
+            } else {
+                printf("TDMA: tabela cheia, pedido do no %u recusado\n", frame[1]);
+            }
+        } else if (kind == LORA_PAYLOAD_KNOWN) {
+            dispatch_payload(&ctx, &ph, body);
+        } else if (len == sizeof(aht10_dados) || len == sizeof(lora_sample_t)) {
+            // Quadros antigos, sem cabeçalho tipado: lora_sample_t começa com
+            // os mesmos 4 bytes de aht10_dados
+            legacy_payloads++;
+            handle_reading(&ctx, (const aht10_dados *)frame,
+                           len == sizeof(lora_sample_t) ? (const lora_sample_t *)frame : NULL, 0);
+        } else if (kind == LORA_PAYLOAD_UNKNOWN) {
+            // Tipo de um firmware mais novo: só contado. O quadro segue inteiro
+            // no fluxo binário e pelos repetidores.
+            unknown_payloads++;
+            if (!binary_output) {
+                printf("Payload desconhecido do no %u seq %u: tipo %u versao %u, %d bytes (ver \"bin\")\n",
+                       ph.node_id, ph.seq, ph.type, ph.version, len);
+            }
+        } else if (len > 0 && !binary_output) {
+            // Monta a linha inteira antes de imprimir (um printf por pacote)
+            static const char hex[] = "0123456789ABCDEF";
+            static char line[3 * PKTBUF_SIZE + 1];
+            for (int i = 0; i < len; ++i) {
+                line[3 * i] = hex[frame[i] >> 4];
+                line[3 * i + 1] = hex[frame[i] & 0x0F];
+                line[3 * i + 2] = ' ';
+            }
+            line[3 * len] = '\0';
+            printf("LoRa recebeu %d bytes (raw): %s\n", len, line);
+        } else if (tick) {
             if (!got_first_data) {
                 anim_tick++;
                 if ((anim_tick % 3) == 0) {
@@ -153,6 +839,39 @@ int main()
                 }
             }
         }
-        sleep_ms(100);
+        if (tick) {
+            display_service();
+            check_stale_nodes();
+        }
+
+        // Fim desta passagem: o buffer volta ao pool se ninguém o guardou
+        pktbuf_release(pkt);
+
+        console_service();
+        flash_log_service();
+        tlog_service(binary_output, 4); // mensagens do log tokenizado, fora do caminho do rádio
+        if (REPEATER_MODE) {
+            repeater_service(); // TX não bloqueante: a recepção continua entre os envios
+            if (time_reached(next_stats)) {
+                if (!binary_output) print_repeater_stats();
+                next_stats = make_timeout_time_ms(REPEATER_STATS_INTERVAL_MS);
+            }
+        } else if (lora_ok && time_reached(next_beacon) && !lora_rx_pending()) {
+            // Período fixo a partir do beacon anterior: os nós extrapolam a agenda
+            // lora_send_bytes já devolve o rádio ao modo de recepção anterior.
+            // Com um pacote esperando no FIFO o beacon fica para a próxima
+            // passagem, que lê o pacote primeiro (o carimbo é tirado no envio)
+            absolute_time_t sent_at = send_sync_beacon();
+            next_beacon = delayed_by_us(sent_at, beacon_interval_us());
+        }
+        // Fila de transmissão: inicia o próximo quadro (repasse recém-enfileirado
+        // inclusive) antes de dormir
+        lora_tx_service();
+
+        // Voltas em que nada foi gravado somem do trace
+        TRACE_END_OR_DROP(LOOP);
+
+        // Dorme até o próximo tick (ou retransmissão agendada) ou até o DIO0 sinalizar um pacote
+        lowpower_idle_until(repeater_next_deadline(next_tick));
     }
 }
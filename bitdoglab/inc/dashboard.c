@@ -0,0 +1,166 @@
+// dashboard.c
+
+#include <string.h>
+#include "dashboard.h"
+#include "node_table.h"
+#include "fmt_int.h"
+
+// Campos de uma linha: posição no texto (alinhado à direita, com espaços) e
+// coluna em pixels (6 por caractere). Com folgas de 3 px cabem os 18
+// caracteres e a linha termina no pixel 120.
+typedef struct {
+    uint8_t offset, width, x;
+} dash_field_t;
+
+static const dash_field_t fields[] = {
+    { 0, 3, 0 },      // nó ("255")
+    { 3, 5, 21 },     // temperatura ("-12.3")
+    { 8, 3, 54 },     // umidade ("100")
+    { 11, 4, 75 },    // RSSI ("-120")
+    { 15, 3, 102 },   // idade ("59s", "12m", "3h", "9d")
+};
+#define DASH_TEXT_LEN 18
+#define DASH_STALE_AT DASH_TEXT_LEN   // '!' = nó sem notícias (linha invertida)
+
+_Static_assert(DASH_TEXT_LEN + 2 <= DASH_SIG_LEN, "DASH_SIG_LEN pequeno");
+
+static char drawn[DASH_LINES][DASH_SIG_LEN];   // texto de cada linha no framebuffer
+static bool drawn_valid = false;               // false: framebuffer com outra coisa
+static dashboard_stats_t stats;
+
+void dashboard_invalidate(void) {
+    drawn_valid = false;
+}
+
+// Nós ocupados da tabela, em ordem de id (a ordem das entradas muda quando
+// um nó novo toma o lugar do mais antigo)
+static int sorted_nodes(const node_entry_t **out) {
+    int n = 0;
+    for (int i = 0; i < NODE_TABLE_LEN; i++) {
+        const node_entry_t *e = node_table_get(i);
+        if (!e) continue;
+        int j = n++;
+        while (j > 0 && out[j - 1]->node_id > e->node_id) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = e;
+    }
+    return n;
+}
+
+uint8_t dashboard_pages(void) {
+    const node_entry_t *nodes[NODE_TABLE_LEN];
+    return (uint8_t)((sorted_nodes(nodes) + DASH_NODES_PER_PAGE - 1) / DASH_NODES_PER_PAGE);
+}
+
+// Coloca s (n caracteres) alinhado à direita no campo f
+static void put_field(char *sig, int f, const char *s, int n) {
+    int w = fields[f].width;
+    if (n > w) {
+        s += n - w; // não acontece com os valores da tabela; corta à esquerda
+        n = w;
+    }
+    memset(sig + fields[f].offset, ' ', (size_t)(w - n));
+    memcpy(sig + fields[f].offset + (w - n), s, (size_t)n);
+}
+
+// Idade com a menor unidade que cabe em dois dígitos
+static int fmt_age(char *out, uint32_t s) {
+    static const char units[] = "smhd";
+    static const uint32_t div[] = { 1, 60, 3600, 86400 };
+    int u = 0;
+    while (u < 3 && s / div[u] >= 100) u++;
+    uint32_t v = s / div[u];
+    int n = fmt_u32(out, v > 99 ? 99 : v);
+    out[n++] = units[u];
+    out[n] = '\0';
+    return n;
+}
+
+static void node_line(char *sig, const node_entry_t *e, uint32_t now_ms) {
+    char tmp[FMT_CENTI_MAX];
+    put_field(sig, 0, tmp, fmt_u32(tmp, e->node_id));
+    put_field(sig, 1, tmp, fmt_deci(tmp, e->temperatura));
+    put_field(sig, 2, tmp, fmt_i32(tmp, (e->umidade + 50) / 100));
+    put_field(sig, 3, tmp, fmt_i32(tmp, e->rssi_dbm));
+    put_field(sig, 4, tmp, fmt_age(tmp, (now_ms - e->last_rx_ms) / 1000));
+    sig[DASH_STALE_AT] = e->stale ? '!' : ' ';
+    sig[DASH_STALE_AT + 1] = '\0';
+}
+
+static void header_line(char *sig, uint8_t page, uint8_t pages) {
+    char tmp[8];
+    put_field(sig, 0, "no", 2);
+    put_field(sig, 1, "T(C)", 4);
+    put_field(sig, 2, "U%", 2);
+    put_field(sig, 3, "dBm", 3);
+    int n = fmt_u32(tmp, page + 1u);
+    tmp[n++] = '/';
+    n += fmt_u32(tmp + n, pages);
+    put_field(sig, 4, tmp, n);
+    sig[DASH_STALE_AT] = ' ';
+    sig[DASH_STALE_AT + 1] = '\0';
+}
+
+static void draw_line(ssd1306_t *p, uint8_t line, const char *sig) {
+    uint8_t *row = &p->buffer[p->width * line];
+    memset(row, 0, p->width);
+    if (sig[0] == '\0') return; // linha vazia
+    for (unsigned f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+        char text[8];
+        memcpy(text, sig + fields[f].offset, fields[f].width);
+        text[fields[f].width] = '\0';
+        ssd1306_draw_string_fast(p, fields[f].x, line * 8u, 1, text);
+    }
+    if (sig[DASH_STALE_AT] == '!') {
+        for (uint32_t x = 0; x < p->width; x++) row[x] ^= 0xFF;
+    }
+}
+
+void dashboard_render(ssd1306_t *p, uint8_t page, uint32_t now_ms, uint8_t *first, uint8_t *last) {
+    uint32_t t0 = time_us_32();
+    const node_entry_t *nodes[NODE_TABLE_LEN];
+    int n = sorted_nodes(nodes);
+    uint8_t pages = (uint8_t)((n + DASH_NODES_PER_PAGE - 1) / DASH_NODES_PER_PAGE);
+    if (page >= pages) page = pages ? pages - 1 : 0;
+
+    if (!drawn_valid) {
+        for (int i = 0; i < DASH_LINES; i++) {
+            drawn[i][0] = '\x01'; // nenhum texto gerado é igual
+            drawn[i][1] = '\0';
+        }
+        drawn_valid = true;
+    }
+
+    *first = DASH_LINES;
+    *last = 0;
+    for (uint8_t line = 0; line < DASH_LINES && line < p->pages; line++) {
+        char sig[DASH_SIG_LEN];
+        int idx = page * DASH_NODES_PER_PAGE + line - 1;
+        if (line == 0) header_line(sig, page, pages ? pages : 1);
+        else if (idx < n) node_line(sig, nodes[idx], now_ms);
+        else sig[0] = '\0';
+        if (strcmp(sig, drawn[line]) == 0) continue;
+
+        memcpy(drawn[line], sig, sizeof(sig));
+        draw_line(p, line, sig);
+        stats.lines_drawn++;
+        if (line < *first) *first = line;
+        *last = line;
+    }
+
+    stats.renders++;
+    stats.render_us_last = time_us_32() - t0;
+    if (stats.render_us_last > stats.render_us_max) stats.render_us_max = stats.render_us_last;
+    if (*first <= *last) {
+        stats.flushes++;
+        stats.flush_bytes_last = (uint32_t)(*last - *first + 1) * p->width;
+        if (stats.flush_bytes_last > stats.flush_bytes_max) stats.flush_bytes_max = stats.flush_bytes_last;
+        stats.flush_bytes_total += stats.flush_bytes_last;
+    }
+}
+
+void dashboard_get_stats(dashboard_stats_t *out) {
+    *out = stats;
+}
@@ -0,0 +1,55 @@
+// dashboard.h
+
+#ifndef DASHBOARD_H_
+#define DASHBOARD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306.h"
+
+// ============================
+// PAINEL DE NÓS NO DISPLAY
+// ============================
+// Tabela da node_table em páginas de tela, fonte 5x8 em escala 1: linha 0 é o
+// cabeçalho (com a página atual) e cada uma das outras 7 é um nó, com
+// temperatura, umidade, RSSI e idade do último quadro. Nós sem notícias
+// aparecem em vídeo inverso. Cada linha da tela é uma página do ssd1306, então
+// redesenhar uma linha é limpar e escrever 128 bytes.
+#define DASH_LINES          8                    // linhas de texto = páginas do display
+#define DASH_NODES_PER_PAGE (DASH_LINES - 1)     // 7 nós por tela
+#define DASH_SIG_LEN        24                   // texto de uma linha, para saber se mudou
+
+typedef struct {
+    uint32_t renders;          // chamadas de dashboard_render
+    uint32_t lines_drawn;      // linhas redesenhadas (no máximo DASH_LINES por render)
+    uint32_t render_us_last, render_us_max;
+    uint32_t flushes;          // renders com alguma linha mudada
+    uint32_t flush_bytes_last, flush_bytes_max;
+    uint32_t flush_bytes_total;
+} dashboard_stats_t;
+
+/**
+ * @brief Telas necessárias para os nós da node_table (0 se vazia).
+ */
+uint8_t dashboard_pages(void);
+
+/**
+ * @brief Esquece o que está desenhado: o próximo dashboard_render
+ * redesenha todas as linhas (depois de outra tela usar o framebuffer).
+ */
+void dashboard_invalidate(void);
+
+/**
+ * @brief Atualiza no framebuffer a tela page do painel, redesenhando só as
+ * linhas cujo texto mudou desde o último render.
+ * @param first, last Recebem a faixa de páginas do display a enviar
+ * (ssd1306_show_pages); sem mudança, first > last.
+ */
+void dashboard_render(ssd1306_t *p, uint8_t page, uint32_t now_ms, uint8_t *first, uint8_t *last);
+
+/**
+ * @brief Custo de render e tamanho dos envios ao display.
+ */
+void dashboard_get_stats(dashboard_stats_t *out);
+
+#endif // DASHBOARD_H_
@@ -0,0 +1,58 @@
+// dedup.c
+//
+// Lógica pura (sem SDK) para também ser usada por ferramentas de host.
+
+#include <string.h>
+#include "dedup.h"
+
+#define TABLE_MASK (DEDUP_TABLE_SIZE - 1)
+
+// Hash de Fibonacci da chave de 16 bits
+static unsigned slot_of(uint16_t key) {
+    return ((uint32_t)key * 40503u) >> 10 & TABLE_MASK;
+}
+
+static int find(const dedup_cache_t *c, uint16_t key) {
+    for (unsigned i = slot_of(key);; i = (i + 1) & TABLE_MASK) {
+        if (c->table[i] == key) return (int)i;
+        if (c->table[i] == 0) return -1;
+    }
+}
+
+// Remoção com deslocamento para trás: mantém as cadeias de sondagem sem lápides
+static void table_remove(dedup_cache_t *c, uint16_t key) {
+    int found = find(c, key);
+    if (found < 0) return;
+
+    unsigned hole = (unsigned)found;
+    for (unsigned j = (hole + 1) & TABLE_MASK; c->table[j] != 0; j = (j + 1) & TABLE_MASK) {
+        unsigned home = slot_of(c->table[j]);
+        // A entrada em j só pode ir para o buraco se o seu slot de origem não
+        // estiver (circularmente) entre o buraco e j
+        bool stays = (hole < j) ? (home > hole && home <= j) : (home > hole || home <= j);
+        if (!stays) {
+            c->table[hole] = c->table[j];
+            hole = j;
+        }
+    }
+    c->table[hole] = 0;
+}
+
+void dedup_init(dedup_cache_t *c) {
+    memset(c, 0, sizeof(*c));
+}
+
+bool dedup_check_and_add(dedup_cache_t *c, uint8_t node_id, uint8_t seq) {
+    uint16_t key = (uint16_t)(node_id << 8 | seq);
+    if (key == 0 || find(c, key) >= 0) return key != 0;
+
+    if (c->count == DEDUP_CACHE_SIZE) table_remove(c, c->ring[c->head]);
+    else c->count++;
+    c->ring[c->head] = key;
+    c->head = (uint8_t)((c->head + 1) % DEDUP_CACHE_SIZE);
+
+    unsigned i = slot_of(key);
+    while (c->table[i] != 0) i = (i + 1) & TABLE_MASK;
+    c->table[i] = key;
+    return false;
+}
@@ -0,0 +1,40 @@
+// dedup.h
+
+#ifndef DEDUP_H_
+#define DEDUP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ============================
+// CACHE DE QUADROS RECENTES
+// ============================
+#define DEDUP_CACHE_SIZE   32   // quadros lembrados (os mais antigos saem primeiro)
+#define DEDUP_TABLE_SIZE   64   // potência de 2, pelo menos 2x o cache
+
+/**
+ * @brief Conjunto dos últimos DEDUP_CACHE_SIZE pares (node_id, seq).
+ * O anel guarda a ordem de chegada; a tabela hash (sondagem linear) responde
+ * "já visto?" em O(1). A chave é node_id << 8 | seq; node_id 0 é reservado
+ * (LORA_PROTO_SLOT_FREE), então 0 marca entrada vazia.
+ */
+typedef struct {
+    uint16_t ring[DEDUP_CACHE_SIZE];
+    uint8_t head;                         // próxima posição do anel
+    uint8_t count;
+    uint16_t table[DEDUP_TABLE_SIZE];
+} dedup_cache_t;
+
+/**
+ * @brief Esvazia o cache.
+ */
+void dedup_init(dedup_cache_t *c);
+
+/**
+ * @brief Verifica se o quadro já foi visto e, se não, o registra.
+ * Com o cache cheio, o quadro mais antigo é esquecido.
+ * @return true se (node_id, seq) está entre os recentes (duplicata).
+ */
+bool dedup_check_and_add(dedup_cache_t *c, uint8_t node_id, uint8_t seq);
+
+#endif // DEDUP_H_
@@ -0,0 +1,241 @@
+// flash_log.c
+//
+// As páginas são gravadas em sequência num anel de setores. Um setor só é
+// apagado quando a gravação entra nele, então todos os setores sofrem o mesmo
+// número de apagamentos e o setor seguinte ao atual guarda os dados mais
+// antigos. O seq de cada página é a sua posição global no anel, de modo que,
+// dentro de uma mesma volta, seq(página p) - seq(página q) == p - q.
+
+#include <assert.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "flash_log.h"
+#include "trace.h"
+
+#define LOG_OFFSET  (PICO_FLASH_SIZE_BYTES - FLASH_LOG_SECTORS * FLASH_SECTOR_SIZE)
+#define PPS         FLASH_LOG_PAGES_PER_SECTOR
+
+static_assert(sizeof(flash_log_page_t) == FLASH_PAGE_SIZE, "pagina do log != pagina da flash");
+static_assert(FLASH_LOG_SECTOR_SIZE == FLASH_SECTOR_SIZE, "setor do log != setor da flash");
+
+static flash_log_page_t ram_page;      // registros ainda não gravados
+static absolute_time_t ram_first_at;   // chegada do primeiro registro do buffer
+static uint32_t head = 0;              // próxima página física a gravar
+static uint32_t next_seq = 0;
+static uint32_t tail_sector = 0;       // setor com a página mais antiga
+static uint32_t oldest_seq = 0;
+static bool empty = true;
+static uint16_t boot = 0;
+static flash_log_stats_t stats;
+
+// ============================
+// ACESSO À FLASH
+// ============================
+
+static const flash_log_page_t *page_at(uint32_t p) {
+    return (const flash_log_page_t *)(XIP_BASE + LOG_OFFSET + p * FLASH_PAGE_SIZE);
+}
+
+static bool page_seq(uint32_t p, uint32_t *seq) {
+    const flash_log_page_t *page = page_at(p);
+    stats.recovery_reads++;
+    if (!flash_log_page_valid(page)) return false;
+    *seq = page->hdr.seq;
+    return true;
+}
+
+static bool page_erased(uint32_t p) {
+    const uint32_t *w = (const uint32_t *)page_at(p);
+    for (size_t i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        if (w[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+// A flash fica fora do XIP durante a operação: nada pode rodar da flash
+static void erase_sector(uint32_t s) {
+    TRACE_BEGIN(FLASH_WRITE);
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_erase(LOG_OFFSET + s * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+    restore_interrupts(irq);
+    TRACE_END(FLASH_WRITE);
+    stats.sectors_erased++;
+}
+
+static void program_page(uint32_t p, const flash_log_page_t *page) {
+    TRACE_BEGIN(FLASH_WRITE);
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_program(LOG_OFFSET + p * FLASH_PAGE_SIZE, (const uint8_t *)page, FLASH_PAGE_SIZE);
+    restore_interrupts(irq);
+    TRACE_END(FLASH_WRITE);
+    stats.pages_written++;
+}
+
+// Prepara a página em RAM para gravação/dump com o seq informado
+static void seal_ram_page(uint32_t seq) {
+    ram_page.hdr.magic = FLASH_LOG_MAGIC;
+    ram_page.hdr.reserved = 0xFF;
+    ram_page.hdr.seq = seq;
+    ram_page.hdr.boot = boot;
+    size_t used = ram_page.hdr.count * sizeof(flash_log_record_t);
+    memset((uint8_t *)ram_page.rec + used, 0xFF, sizeof(ram_page) - sizeof(ram_page.hdr) - used);
+    ram_page.hdr.crc = flash_log_page_crc(&ram_page);
+}
+
+// ============================
+// RECUPERAÇÃO
+// ============================
+
+// Primeira página do setor faz parte da volta iniciada em anchor?
+static bool sector_in_run(uint32_t s, uint32_t anchor, uint32_t anchor_seq) {
+    uint32_t seq;
+    return page_seq(s * PPS, &seq) && seq == anchor_seq + (s - anchor) * PPS;
+}
+
+void flash_log_init(void) {
+    memset(&stats, 0, sizeof(stats));
+    memset(&ram_page, 0, sizeof(ram_page));
+
+    // Âncora: setor 0, ou o setor 1 se a volta do anel apagou o setor 0 e
+    // a energia caiu antes (ou durante) a gravação da sua primeira página
+    uint32_t anchor, anchor_seq;
+    if (page_seq(0, &anchor_seq)) anchor = 0;
+    else if (page_seq(PPS, &anchor_seq)) anchor = 1;
+    else {
+        head = next_seq = tail_sector = oldest_seq = 0;
+        empty = true;
+        boot = 0;
+        return;
+    }
+
+    // Busca binária do último setor da volta mais recente: a partir da âncora
+    // os setores seguem a sequência até o setor atual e depois vêm setores de
+    // uma volta anterior (seq menor) ou apagados
+    uint32_t lo = anchor, hi = FLASH_LOG_SECTORS - 1;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi + 1) / 2;
+        if (sector_in_run(mid, anchor, anchor_seq)) lo = mid;
+        else hi = mid - 1;
+    }
+    uint32_t head_sector = lo;
+    uint32_t base_seq = anchor_seq + (head_sector - anchor) * PPS;
+
+    // Última página íntegra do setor atual (uma gravação interrompida deixa lacuna)
+    uint32_t last = 0, seq;
+    for (uint32_t i = 1; i < PPS; i++) {
+        if (page_seq(head_sector * PPS + i, &seq) && seq == base_seq + i) last = i;
+    }
+    boot = (uint16_t)(page_at(head_sector * PPS + last)->hdr.boot + 1);
+    head = head_sector * PPS + last + 1;
+    next_seq = base_seq + last + 1;
+
+    // Páginas parcialmente programadas não podem ser regravadas sem apagar o setor
+    while (head % PPS != 0 && !page_erased(head)) {
+        head++;
+        next_seq++;
+    }
+    if (head == FLASH_LOG_PAGES) head = 0;
+
+    // Dados mais antigos: setor seguinte ao atual (ou o próximo, se a energia
+    // caiu logo após apagá-lo); sem volta anterior, a própria âncora
+    tail_sector = anchor;
+    oldest_seq = anchor_seq;
+    for (uint32_t k = 1; k <= 2; k++) {
+        uint32_t s = (head_sector + k) % FLASH_LOG_SECTORS;
+        if (s != anchor && page_seq(s * PPS, &seq) && seq < anchor_seq) {
+            tail_sector = s;
+            oldest_seq = seq;
+            break;
+        }
+    }
+    empty = false;
+}
+
+// ============================
+// GRAVAÇÃO
+// ============================
+
+static void write_page(void) {
+    if (ram_page.hdr.count == 0) return;
+
+    if (head % PPS == 0) {
+        uint32_t s = head / PPS;
+        erase_sector(s);
+        if (!empty && s == tail_sector) {
+            // O setor apagado tinha os dados mais antigos: avança para o seguinte
+            tail_sector = (s + 1) % FLASH_LOG_SECTORS;
+            const flash_log_page_t *oldest = page_at(tail_sector * PPS);
+            if (flash_log_page_valid(oldest)) oldest_seq = oldest->hdr.seq;
+            else empty = true;
+        }
+    }
+    if (empty) {
+        tail_sector = head / PPS;
+        oldest_seq = next_seq;
+        empty = false;
+    }
+
+    seal_ram_page(next_seq);
+    program_page(head, &ram_page);
+    head = (head + 1) % FLASH_LOG_PAGES;
+    next_seq++;
+    memset(&ram_page, 0, sizeof(ram_page));
+}
+
+void flash_log_append(const flash_log_record_t *rec) {
+    if (ram_page.hdr.count == 0) ram_first_at = get_absolute_time();
+    ram_page.rec[ram_page.hdr.count++] = *rec;
+    if (ram_page.hdr.count == FLASH_LOG_RECORDS_PER_PAGE) write_page();
+}
+
+void flash_log_service(void) {
+    if (ram_page.hdr.count == 0) return;
+    if (absolute_time_diff_us(ram_first_at, get_absolute_time()) >= (int64_t)FLASH_LOG_FLUSH_MS * 1000) write_page();
+}
+
+void flash_log_flush(void) {
+    write_page();
+}
+
+void flash_log_clear(void) {
+    for (uint32_t s = 0; s < FLASH_LOG_SECTORS; s++) erase_sector(s);
+    head = next_seq = tail_sector = oldest_seq = 0;
+    empty = true;
+    memset(&ram_page, 0, sizeof(ram_page));
+}
+
+// ============================
+// LEITURA
+// ============================
+
+uint32_t flash_log_dump(void (*write)(const uint8_t *data, size_t len)) {
+    uint32_t pages = 0;
+    if (!empty) {
+        uint32_t first = tail_sector * PPS;
+        for (uint32_t seq = oldest_seq; seq != next_seq; seq++) {
+            const flash_log_page_t *page = page_at((first + (seq - oldest_seq)) % FLASH_LOG_PAGES);
+            if (!flash_log_page_valid(page) || page->hdr.seq != seq) continue; // lacuna de gravação interrompida
+            write((const uint8_t *)page, FLASH_PAGE_SIZE);
+            pages++;
+        }
+    }
+    if (ram_page.hdr.count) {
+        uint8_t count = ram_page.hdr.count;
+        seal_ram_page(next_seq);
+        write((const uint8_t *)&ram_page, FLASH_PAGE_SIZE);
+        ram_page.hdr.count = count;
+        pages++;
+    }
+    return pages;
+}
+
+void flash_log_get_stats(flash_log_stats_t *out) {
+    *out = stats;
+    out->pages_used = empty ? 0 : next_seq - oldest_seq;
+    out->pending = ram_page.hdr.count;
+    out->oldest_seq = oldest_seq;
+    out->next_seq = next_seq;
+    out->boot = boot;
+}
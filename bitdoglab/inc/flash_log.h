@@ -0,0 +1,130 @@
+// flash_log.h
+//
+// Log circular das leituras recebidas, numa região reservada no fim da flash.
+// O formato das páginas não depende do SDK para que ferramentas de host
+// possam decodificar o dump.
+
+#ifndef FLASH_LOG_H_
+#define FLASH_LOG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "crc16.h"
+
+// ============================
+// GEOMETRIA
+// ============================
+#define FLASH_LOG_PAGE_SIZE      256   // FLASH_PAGE_SIZE do RP2040
+#define FLASH_LOG_SECTOR_SIZE    4096  // FLASH_SECTOR_SIZE (menor unidade de apagamento)
+#define FLASH_LOG_PAGES_PER_SECTOR (FLASH_LOG_SECTOR_SIZE / FLASH_LOG_PAGE_SIZE)
+#ifndef FLASH_LOG_SECTORS
+#define FLASH_LOG_SECTORS        64    // 256 KB no fim da flash
+#endif
+#define FLASH_LOG_PAGES          (FLASH_LOG_SECTORS * FLASH_LOG_PAGES_PER_SECTOR)
+
+#define FLASH_LOG_MAGIC          0x4C46 // "FL"
+#define FLASH_LOG_FLUSH_MS       600000 // grava página parcial após 10 min sem completar
+
+// Uma leitura recebida (16 bytes)
+typedef struct __attribute__((packed)) {
+    uint32_t rx_ms;          // uptime do receptor na recepção (reinicia a cada boot)
+    uint32_t timestamp_ms;   // tempo de rede da amostra, 0 se o nó não estava sincronizado
+    int16_t temperatura;     // Temperatura * 100
+    int16_t umidade;         // Umidade * 100
+    uint8_t node_id;         // 0 = quadro antigo sem identificação
+    uint8_t seq;
+    uint8_t rssi_neg_dbm;    // -RSSI (ex.: 120 = -120 dBm)
+    int8_t snr_qdb;          // SNR em passos de 0.25 dB
+} flash_log_record_t;
+
+// Cabeçalho de cada página gravada (12 bytes)
+typedef struct __attribute__((packed)) {
+    uint16_t magic;          // FLASH_LOG_MAGIC
+    uint8_t count;           // registros válidos na página
+    uint8_t reserved;        // 0xFF
+    uint32_t seq;            // posição global da página: +1 a cada página do anel
+    uint16_t boot;           // boots desde a criação do log (separa os rx_ms)
+    uint16_t crc;            // CRC16 do cabeçalho (sem este campo) e dos registros
+} flash_log_page_hdr_t;
+
+#define FLASH_LOG_RECORDS_PER_PAGE \
+    ((FLASH_LOG_PAGE_SIZE - sizeof(flash_log_page_hdr_t)) / sizeof(flash_log_record_t)) // 15
+
+typedef struct {
+    flash_log_page_hdr_t hdr;
+    flash_log_record_t rec[FLASH_LOG_RECORDS_PER_PAGE];
+    uint8_t pad[FLASH_LOG_PAGE_SIZE - sizeof(flash_log_page_hdr_t)
+                - FLASH_LOG_RECORDS_PER_PAGE * sizeof(flash_log_record_t)];
+} flash_log_page_t;
+
+// Estado do log
+typedef struct {
+    uint32_t pages_used;     // páginas entre a mais antiga e a mais recente
+    uint32_t pending;        // registros ainda só em RAM
+    uint32_t oldest_seq;     // seq da página mais antiga
+    uint32_t next_seq;       // seq da próxima página a gravar
+    uint16_t boot;
+    uint32_t pages_written;  // neste boot
+    uint32_t sectors_erased; // neste boot
+    uint32_t recovery_reads; // cabeçalhos lidos na recuperação do início do log
+} flash_log_stats_t;
+
+/**
+ * @brief Calcula o CRC de uma página (cabeçalho sem o campo crc + registros).
+ */
+static inline uint16_t flash_log_page_crc(const flash_log_page_t *page) {
+    uint16_t crc = crc16_ccitt((const uint8_t *)&page->hdr, offsetof(flash_log_page_hdr_t, crc));
+    uint8_t count = page->hdr.count <= FLASH_LOG_RECORDS_PER_PAGE ? page->hdr.count : 0;
+    return crc16_update(crc, (const uint8_t *)page->rec, count * sizeof(flash_log_record_t));
+}
+
+/**
+ * @brief Indica se a página está íntegra (magic, contagem e CRC).
+ */
+static inline bool flash_log_page_valid(const flash_log_page_t *page) {
+    return page->hdr.magic == FLASH_LOG_MAGIC && page->hdr.count > 0 &&
+           page->hdr.count <= FLASH_LOG_RECORDS_PER_PAGE && page->hdr.crc == flash_log_page_crc(page);
+}
+
+/**
+ * @brief Localiza a página mais recente (busca binária pelos setores) e
+ * prepara a próxima gravação. Chamar uma vez na inicialização.
+ */
+void flash_log_init(void);
+
+/**
+ * @brief Acrescenta uma leitura ao buffer em RAM; grava a página quando enche.
+ */
+void flash_log_append(const flash_log_record_t *rec);
+
+/**
+ * @brief Grava a página parcial se ela está no buffer há mais de FLASH_LOG_FLUSH_MS.
+ * Deve ser chamada periodicamente no laço principal.
+ */
+void flash_log_service(void);
+
+/**
+ * @brief Grava imediatamente o buffer em RAM (página parcial).
+ */
+void flash_log_flush(void);
+
+/**
+ * @brief Entrega todas as páginas íntegras, da mais antiga para a mais
+ * recente, incluindo o buffer em RAM como última página (sem gravá-lo).
+ * @param write Destino dos bytes (cada chamada recebe uma página inteira).
+ * @return Número de páginas entregues.
+ */
+uint32_t flash_log_dump(void (*write)(const uint8_t *data, size_t len));
+
+/**
+ * @brief Apaga toda a região do log.
+ */
+void flash_log_clear(void);
+
+/**
+ * @brief Copia o estado atual do log.
+ */
+void flash_log_get_stats(flash_log_stats_t *out);
+
+#endif // FLASH_LOG_H_
@@ -0,0 +1,68 @@
+// history.c
+//
+// Lógica pura (sem SDK).
+
+#include <string.h>
+#include "history.h"
+
+#define HISTORY_MASK (HISTORY_LEN - 1)
+
+_Static_assert((HISTORY_LEN & HISTORY_MASK) == 0, "HISTORY_LEN precisa ser potência de 2");
+
+void history_init(history_t *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+static int16_t value_at(const history_t *h, uint32_t idx) {
+    return h->values[idx & HISTORY_MASK];
+}
+
+void history_push(history_t *h, int16_t v) {
+    uint32_t idx = h->seq;
+
+    // Janela cheia: a mais antiga sai da soma e, se for o extremo, da frente da fila
+    if (idx >= HISTORY_LEN) {
+        uint32_t old = idx - HISTORY_LEN;
+        h->sum -= value_at(h, old);
+        if (h->min_len && h->min_q[h->min_head] == old) {
+            h->min_head = (h->min_head + 1) & HISTORY_MASK;
+            h->min_len--;
+        }
+        if (h->max_len && h->max_q[h->max_head] == old) {
+            h->max_head = (h->max_head + 1) & HISTORY_MASK;
+            h->max_len--;
+        }
+    }
+    h->values[idx & HISTORY_MASK] = v;
+    h->sum += v;
+
+    // Quem não é menor (maior) que a nova leitura nunca mais será o mínimo (máximo)
+    while (h->min_len && value_at(h, h->min_q[(h->min_head + h->min_len - 1) & HISTORY_MASK]) >= v) h->min_len--;
+    h->min_q[(h->min_head + h->min_len++) & HISTORY_MASK] = idx;
+    while (h->max_len && value_at(h, h->max_q[(h->max_head + h->max_len - 1) & HISTORY_MASK]) <= v) h->max_len--;
+    h->max_q[(h->max_head + h->max_len++) & HISTORY_MASK] = idx;
+
+    h->seq++;
+}
+
+uint16_t history_count(const history_t *h) {
+    return h->seq < HISTORY_LEN ? (uint16_t)h->seq : HISTORY_LEN;
+}
+
+int16_t history_get(const history_t *h, uint16_t age) {
+    return value_at(h, h->seq - 1 - age);
+}
+
+int16_t history_min(const history_t *h) {
+    return h->min_len ? value_at(h, h->min_q[h->min_head]) : 0;
+}
+
+int16_t history_max(const history_t *h) {
+    return h->max_len ? value_at(h, h->max_q[h->max_head]) : 0;
+}
+
+int16_t history_mean(const history_t *h) {
+    int32_t n = history_count(h);
+    if (n == 0) return 0;
+    return (int16_t)(h->sum >= 0 ? (h->sum + n / 2) / n : -((-h->sum + n / 2) / n));
+}
@@ -0,0 +1,56 @@
+// history.h
+
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include <stdint.h>
+
+// ============================
+// HISTÓRICO DE UMA GRANDEZA
+// ============================
+#define HISTORY_LEN   128   // leituras guardadas (potência de 2; uma coluna do display cada)
+
+/**
+ * @brief Últimas HISTORY_LEN leituras de uma grandeza (centésimos), com
+ * mínimo, máximo e média da janela em O(1). Mínimo e máximo vêm de filas
+ * monotônicas de índices: a frente é sempre o extremo da janela, e cada
+ * leitura entra e sai de cada fila no máximo uma vez.
+ */
+typedef struct {
+    int16_t values[HISTORY_LEN];
+    uint32_t seq;                    // leituras já inseridas (índice da próxima)
+    int32_t sum;                     // soma da janela
+    uint32_t min_q[HISTORY_LEN];     // índices com valores crescentes
+    uint32_t max_q[HISTORY_LEN];     // índices com valores decrescentes
+    uint16_t min_head, min_len;
+    uint16_t max_head, max_len;
+} history_t;
+
+/**
+ * @brief Esvazia o histórico.
+ */
+void history_init(history_t *h);
+
+/**
+ * @brief Acrescenta uma leitura; com a janela cheia, a mais antiga sai.
+ */
+void history_push(history_t *h, int16_t v);
+
+/**
+ * @brief Leituras na janela (até HISTORY_LEN).
+ */
+uint16_t history_count(const history_t *h);
+
+/**
+ * @brief Leitura de idade age (0 = a mais recente, < history_count).
+ */
+int16_t history_get(const history_t *h, uint16_t age);
+
+/**
+ * @brief Mínimo, máximo e média (arredondada) da janela; 0 se vazia.
+ */
+int16_t history_min(const history_t *h);
+int16_t history_max(const history_t *h);
+int16_t history_mean(const history_t *h);
+
+#endif // HISTORY_H_
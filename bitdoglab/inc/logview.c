@@ -0,0 +1,102 @@
+// logview.c
+//
+// A start line do SSD1306 dá a volta na linha 64 da RAM: o anel de páginas
+// só coincide com a tela num display de 64 linhas. Em outras alturas cada
+// envio redesenha a tela inteira em ordem.
+
+#include <string.h>
+#include "logview.h"
+
+void logview_init(logview_t *lv) {
+    memset(lv, 0, sizeof(*lv));
+}
+
+static bool ring_ok(const ssd1306_t *p) {
+    return p->height == 64;
+}
+
+static void draw_page(ssd1306_t *p, uint8_t page, const char *text) {
+    memset(&p->buffer[p->width * page], 0, p->width);
+    ssd1306_draw_string_fast(p, 0, page * 8u, 1, text);
+}
+
+// Tela inteira com a start line em 0: a linha mais nova na última página
+static void draw_all(logview_t *lv, ssd1306_t *p) {
+    for (uint8_t page = 0; page < p->pages; page++) {
+        uint8_t age = (uint8_t)(p->pages - 1 - page);
+        if (age < lv->count) {
+            draw_page(p, page, lv->text[(lv->head + LOGVIEW_MAX_LINES - 1 - age) % LOGVIEW_MAX_LINES]);
+        } else {
+            memset(&p->buffer[p->width * page], 0, p->width);
+        }
+    }
+    lv->top = 0;
+    lv->pending = 0;
+}
+
+void logview_add(logview_t *lv, ssd1306_t *p, const char *text) {
+    char *line = lv->text[lv->head];
+    size_t n = strlen(text);
+    if (n > LOGVIEW_COLS) n = LOGVIEW_COLS;
+    memcpy(line, text, n);
+    line[n] = '\0';
+    lv->head = (uint8_t)((lv->head + 1) % LOGVIEW_MAX_LINES);
+    if (lv->count < LOGVIEW_MAX_LINES) lv->count++;
+    lv->lines++;
+    if (!lv->shown) return;
+
+    // A k-ésima linha pendente vai para a página top + k: depois da rolagem
+    // de k + 1 linhas ela é a última da tela. Numa rajada maior que a tela,
+    // as linhas mais novas sobrescrevem as pendentes mais antigas, e pending
+    // continua a valer módulo pages.
+    draw_page(p, (uint8_t)((lv->top + lv->pending) % p->pages), line);
+    lv->pending++;
+    if (lv->pending >= 2 * p->pages) lv->pending -= p->pages;
+}
+
+void logview_show(logview_t *lv, ssd1306_t *p) {
+    draw_all(lv, p);
+    ssd1306_set_start_line(p, 0);
+    ssd1306_show(p);
+    lv->shown = true;
+    lv->redraws++;
+    lv->bytes += p->bufsize;
+}
+
+void logview_flush(logview_t *lv, ssd1306_t *p) {
+    if (!lv->shown || lv->pending == 0) return;
+    if (!ring_ok(p)) {
+        draw_all(lv, p);
+        ssd1306_show(p);
+        lv->redraws++;
+        lv->bytes += p->bufsize;
+        return;
+    }
+
+    // A linha nova é escrita antes de a start line mudar: por um instante
+    // (o envio de uma página, ~3 ms a 400 kHz) ela aparece no topo, no
+    // lugar da mais antiga
+    uint8_t n = lv->pending < p->pages ? lv->pending : p->pages;
+    uint8_t first = lv->top, last = (uint8_t)(lv->top + n - 1);
+    if (n == p->pages) {
+        ssd1306_show(p);
+    } else if (last < p->pages) {
+        ssd1306_show_pages(p, first, last);
+    } else {
+        ssd1306_show_pages(p, first, p->pages - 1);
+        ssd1306_show_pages(p, 0, last - p->pages);
+    }
+    lv->top = (uint8_t)((lv->top + lv->pending) % p->pages);
+    lv->pending = 0;
+    ssd1306_set_start_line(p, lv->top * 8u);
+    lv->scrolls++;
+    lv->bytes += (uint32_t)n * p->width;
+}
+
+void logview_hide(logview_t *lv, ssd1306_t *p) {
+    if (!lv->shown) return;
+    if (lv->top != 0) ssd1306_set_start_line(p, 0);
+    lv->top = 0;
+    lv->pending = 0;
+    lv->shown = false;
+}
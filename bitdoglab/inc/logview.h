@@ -0,0 +1,61 @@
+// logview.h
+
+#ifndef LOGVIEW_H_
+#define LOGVIEW_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306.h"
+
+// ============================
+// LOG DE EVENTOS NO DISPLAY
+// ============================
+// Uma linha de texto (fonte 5x8) por página do ssd1306, a mais nova embaixo.
+// A RAM do display é usada como anel: a linha nova é escrita na página que
+// está no topo (a mais antiga) e a start line do controlador passa para a
+// página seguinte, então rolar uma linha custa 128 bytes de dados e um
+// comando, em vez da tela inteira. O framebuffer fica com as páginas na ordem
+// da RAM, não na da tela; as outras telas voltam a start line para 0 com
+// logview_hide e se redesenham inteiras.
+#define LOGVIEW_COLS      21   // 128 px / 6 px por caractere
+#define LOGVIEW_MAX_LINES 8
+
+typedef struct {
+    char text[LOGVIEW_MAX_LINES][LOGVIEW_COLS + 1]; // últimas linhas (anel), para redesenhar a tela
+    uint8_t head;          // próxima posição de text
+    uint8_t count;
+    uint8_t top;           // página da RAM no topo da tela (start line = top * 8)
+    uint8_t pending;       // linhas no framebuffer ainda não enviadas
+    bool shown;            // o display está com o log (e a start line deslocada)
+    uint32_t lines;        // linhas recebidas
+    uint32_t scrolls;      // envios por rolagem (só as páginas novas)
+    uint32_t redraws;      // envios da tela inteira
+    uint32_t bytes;        // bytes de pixels enviados ao display
+} logview_t;
+
+void logview_init(logview_t *lv);
+
+/**
+ * @brief Acrescenta uma linha (cortada em LOGVIEW_COLS caracteres). Com o
+ * log na tela, ela já é desenhada no framebuffer, na página que vai aparecer
+ * embaixo; o envio fica para logview_flush.
+ */
+void logview_add(logview_t *lv, ssd1306_t *p, const char *text);
+
+/**
+ * @brief Desenha as linhas guardadas, com a start line em 0, e envia a tela
+ * inteira. Chamado quando o log volta à tela.
+ */
+void logview_show(logview_t *lv, ssd1306_t *p);
+
+/**
+ * @brief Envia as páginas das linhas novas e move a start line (no tick).
+ */
+void logview_flush(logview_t *lv, ssd1306_t *p);
+
+/**
+ * @brief Devolve a start line para 0 antes de outra tela usar o display.
+ */
+void logview_hide(logview_t *lv, ssd1306_t *p);
+
+#endif // LOGVIEW_H_
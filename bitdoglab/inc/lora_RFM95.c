@@ -1,10 +1,13 @@
 // lora_RFM95.c
 
-#include <stdio.h>
+#include <assert.h>
 #include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/irq.h"
 #include "lora_RFM95.h"
+#include "lora_proto.h"
+#include "trace.h"
+#include "tlog.h"
 
 // ============================
 // DEFINIÇÕES E REGISTRADORES INTERNOS
@@ -29,6 +32,7 @@
 #define REG_RX_NB_BYTES          0x13 // Indica o número de bytes de payload recebidos no último pacote. [cite: 2177, 2431]
 #define REG_MODEM_CONFIG_1       0x1D // Configura parâmetros do modem: Largura de Banda (BW), Taxa de Codificação (CR) e Modo de Cabeçalho (Explícito/Implícito). [cite: 2182, 2444]
 #define REG_MODEM_CONFIG_2       0x1E // Configura parâmetros do modem: Spreading Factor (SF) e ativa o CRC no payload. [cite: 2182, 2450]
+#define REG_SYMB_TIMEOUT_LSB     0x1F // Timeout do RX single em símbolos (bits 7:0). Os bits 9:8 ficam em REG_MODEM_CONFIG_2[1:0].
 #define REG_PREAMBLE_MSB         0x20 // Byte mais significativo (MSB) do comprimento do preâmbulo. [cite: 2182, 2452]
 #define REG_PREAMBLE_LSB         0x21 // Byte menos significativo (LSB) do comprimento do preâmbulo. [cite: 2182, 2452]
 #define REG_PAYLOAD_LENGTH       0x22 // Define o comprimento do payload. Usado em modo de cabeçalho implícito e para o pacote a ser transmitido. [cite: 2182, 2453]
@@ -41,22 +45,70 @@
 #define MODE_STDBY               0x01
 #define MODE_TX                  0x03
 #define MODE_RX_CONTINUOUS       0x05
+#define MODE_RX_SINGLE           0x06
 
 // IRQ FLAGS
 #define IRQ_TX_DONE_MASK         0x08
 #define IRQ_PAYLOAD_CRC_ERROR_MASK 0x20
 #define IRQ_RX_DONE_MASK         0x40
+#define IRQ_RX_TIMEOUT_MASK      0x80
 
+#define MODEM_CONFIG_2_VALUE     LORA_PROTO_MODEM_CONFIG_2 // SF, CRC on, SymbTimeout(9:8) = 0
+
+#define REG_PKT_SNR_VALUE        0x19 // SNR do último pacote, em passos de 0.25 dB (complemento de 2).
 #define REG_PKT_RSSI_VALUE       0x1A // Contém o valor do RSSI do pacote mais recente.
+#define REG_FEI_MSB              0x28 // Erro de frequência estimado (bits 19:16).
+#define REG_FEI_MID              0x29
+#define REG_FEI_LSB              0x2A
+
+// Janela lida em rajada após um RxDone: endereço do pacote, flags, tamanho,
+// SNR, RSSI e erro de frequência numa única transação SPI.
+#define RX_META_FIRST_REG        REG_FIFO_RX_CURRENT_ADDR
+#define RX_META_LAST_REG         REG_FEI_LSB
+#define RX_META_LEN              (RX_META_LAST_REG - RX_META_FIRST_REG + 1)
+
+static_assert(RX_META_FIRST_REG == LORA_RX_REGS_FIRST && RX_META_LEN == LORA_RX_REGS_LEN, "janela de RX != lora_rx_raw_t");
+
+// Mapeamento dos DIOs em RX: DIO0 -> RxDone, DIO3 -> ValidHeader
+#define DIO_MAPPING_RX           0x01
 
 
 // ============================
 // VARIÁVEIS PRIVADAS (STATIC)
 // ============================
 static lora_config_t lora;
-volatile static bool tx_done = false;
-volatile static bool rx_done = false;
-volatile static bool dio0_event = false;
+static volatile bool tx_done = false;
+static volatile bool rx_done = false;
+static volatile bool dio0_event = false;
+static volatile uint32_t dio0_time_us = 0;
+static volatile uint32_t dio3_time_us = 0;
+static uint8_t rx_irq_flags = 0;    // flags do pacote pendente em rx_done
+static uint32_t rx_time_us = 0;     // instante do RxDone do pacote pendente
+static lora_rx_raw_t last_rx;       // rajada de registradores do último pacote
+
+// Modulação programada, lida de volta dos registradores em lora_init: a
+// duração do símbolo dimensiona o sleep da recepção por ciclos e a banda
+// converte o FEI, então as duas seguem o que o rádio usa de fato
+static uint32_t modem_bw_hz = 125000;
+static uint32_t symbol_us = 32768;
+
+// Estado da recepção por ciclos
+typedef enum {
+    RX_DC_OFF,     // RX contínuo (ou rádio parado)
+    RX_DC_LISTEN,  // janela de RX single aberta
+    RX_DC_SLEEP    // rádio em sleep até rx_dc_wake_time
+} rx_dc_state_t;
+
+static rx_dc_state_t rx_dc_state = RX_DC_OFF;
+static absolute_time_t rx_dc_wake_time;
+static uint32_t rx_dc_sleep_us = 0;
+
+// Transmissão não bloqueante e fila de quadros (lora_tx_service)
+static lora_txq_t txq;
+static bool txq_ready = false;
+static bool tx_busy = false;
+static bool tx_resume_duty_cycle = false; // modo de RX a retomar após o TxDone
+static absolute_time_t tx_deadline;
 
 // ============================
 // PROTÓTIPOS DE FUNÇÕES PRIVADAS
@@ -66,11 +118,18 @@ static void lora_write_reg(uint8_t reg, uint8_t value);
 static uint8_t lora_read_reg(uint8_t reg);
 static void lora_write_fifo(const uint8_t *data, uint8_t len);
 static void lora_read_fifo(uint8_t *data, uint8_t len);
+static void lora_read_burst(uint8_t reg, uint8_t *data, uint8_t len);
 static void lora_set_mode(uint8_t mode);
+static void lora_tx_begin(const uint8_t *data, uint8_t len);
 static void cs_select();
 static void cs_deselect();
 static void dio0_irq_handler(uint gpio, uint32_t events);
-static void handle_dio0_events();
+static uint8_t handle_dio0_events();
+static uint8_t lora_poll_irq(void);
+static uint16_t rx_dc_window_symbols(void);
+static void lora_read_modem_timing(void);
+static void rx_dc_open_window(void);
+static void rx_dc_step(uint8_t irq_flags);
 
 // ============================
 // IMPLEMENTAÇÃO DAS FUNÇÕES
@@ -80,6 +139,7 @@ static void handle_dio0_events();
 
 bool lora_init(lora_config_t config) {
     lora = config; // Copia a configuração para a variável estática
+    TRACE_BEGIN(LORA_INIT);
 
     // --- Inicialização do Hardware ---
     spi_init(lora.spi_instance, 5E6);
@@ -92,6 +152,11 @@ bool lora_init(lora_config_t config) {
     gpio_init(lora.pin_dio0); gpio_set_dir(lora.pin_dio0, GPIO_IN);
     gpio_pull_down(lora.pin_dio0);
     gpio_set_irq_enabled_with_callback(lora.pin_dio0, GPIO_IRQ_EDGE_RISE, true, &dio0_irq_handler);
+    if (lora.use_dio3_valid_header) {
+        gpio_init(lora.pin_dio3); gpio_set_dir(lora.pin_dio3, GPIO_IN);
+        gpio_pull_down(lora.pin_dio3);
+        gpio_set_irq_enabled(lora.pin_dio3, GPIO_IRQ_EDGE_RISE, true); // mesmo callback do DIO0
+    }
 
     lora_reset();
     
@@ -108,11 +173,11 @@ bool lora_init(lora_config_t config) {
     // Configurações para longo alcance e robustez
     lora_write_reg(REG_PA_CONFIG, 0xFF); // PaConfig: Max Power (+17dBm on PA_BOOST)
     lora_write_reg(REG_PA_DAC, 0x87); // PaDac: Ativa +20dBm
-    lora_write_reg(REG_MODEM_CONFIG_1, 0x78); // ModemConfig1: BW 62.5kHz, CR 4/8
-    lora_write_reg(REG_MODEM_CONFIG_2, 0xC4); // ModemConfig2: SF12, CRC on
-    lora_write_reg(REG_MODEM_CONFIG_3, 0x0C); // ModemConfig3: LDO on, AGC on
-    lora_write_reg(REG_PREAMBLE_MSB, 0x00);
-    lora_write_reg(REG_PREAMBLE_LSB, 0x0C);
+    lora_write_reg(REG_MODEM_CONFIG_1, LORA_PROTO_MODEM_CONFIG_1); // ModemConfig1: BW 125kHz, CR 4/8
+    lora_write_reg(REG_MODEM_CONFIG_2, MODEM_CONFIG_2_VALUE); // ModemConfig2: SF12, CRC on
+    lora_write_reg(REG_MODEM_CONFIG_3, LORA_PROTO_MODEM_CONFIG_3); // ModemConfig3: LDO on, AGC on
+    lora_write_reg(REG_PREAMBLE_MSB, (uint8_t)(LORA_PROTO_PREAMBLE >> 8));
+    lora_write_reg(REG_PREAMBLE_LSB, (uint8_t)(LORA_PROTO_PREAMBLE & 0xFF));
 
     lora_write_reg(0x0B, 0x37); // OCP default
     lora_write_reg(0x39, 0x12);
@@ -126,7 +191,9 @@ bool lora_init(lora_config_t config) {
     
     //lora_set_mode(MODE_STDBY);
     
+    lora_read_modem_timing();
     uint8_t version = lora_read_reg(REG_VERSION);
+    TRACE_END(LORA_INIT);
     return (version == 0x12);
 }
 
@@ -159,109 +226,216 @@ bool lora_send(const char *msg) {
 }
 
 int lora_receive(char *buf, size_t maxlen) {
-    // Tenta tratar evento por interrupção
-    handle_dio0_events();
-    // Fallback: se DIO0 não estiver ligado, faça polling do registrador de IRQs
-    if (!rx_done) {
-        uint8_t irq_flags = lora_read_reg(REG_IRQ_FLAGS);
-        if (irq_flags) {
-            lora_write_reg(REG_IRQ_FLAGS, 0xFF); // limpa todas as flags
-            if ((irq_flags & IRQ_RX_DONE_MASK) && !(irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK)) {
-                rx_done = true;
-            } else if (irq_flags & IRQ_TX_DONE_MASK) {
-                tx_done = true;
-            }
-        }
-    }
-    if (!rx_done) return 0;
-    rx_done = false;
+    if (maxlen == 0) return 0;
+    int len = lora_receive_bytes((uint8_t*)buf, maxlen - 1);
+    if (len > 0) buf[len] = '\0';
+    return len;
+}
 
-    uint8_t len = lora_read_reg(REG_RX_NB_BYTES);
-    if (len > maxlen - 1) {
-        printf("[AVISO] Pacote de %u bytes truncado para %u.\n", len, (unsigned)(maxlen - 1));
-        len = (uint8_t)(maxlen - 1);
+// <<< ADICIONAR IMPLEMENTAÇÃO DAS NOVAS FUNÇÕES >>>
+bool lora_send_bytes(const uint8_t *data, size_t len) {
+    if (lora_rx_pending()) return false; // ninguém leria o pacote enquanto este laço espera
+    lora_txq_handle_t h = lora_tx_submit(data, len, LORA_TXQ_PRIO_HIGH);
+    lora_txq_status_t status;
+    while ((status = lora_tx_status(h)) == LORA_TXQ_QUEUED || status == LORA_TXQ_SENDING) {
+        lora_tx_service();
+        tight_loop_contents();
     }
+    return status == LORA_TXQ_SENT;
+}
 
-    uint8_t fifo_addr = lora_read_reg(REG_FIFO_RX_CURRENT_ADDR);
-    lora_write_reg(REG_FIFO_ADDR_PTR, fifo_addr);
+static lora_txq_t *tx_queue(void) {
+    if (!txq_ready) {
+        lora_txq_init(&txq);
+        txq_ready = true;
+    }
+    return &txq;
+}
 
-    lora_read_fifo((uint8_t*)buf, len);
-    buf[len] = '\0';
+lora_txq_handle_t lora_tx_submit(const uint8_t *data, size_t len, uint8_t prio) {
+    return lora_txq_submit(tx_queue(), data, len, prio);
+}
 
-    return len;
+lora_txq_status_t lora_tx_status(lora_txq_handle_t handle) {
+    return lora_txq_status(tx_queue(), handle);
 }
 
-// <<< ADICIONAR IMPLEMENTAÇÃO DAS NOVAS FUNÇÕES >>>
-bool lora_send_bytes(const uint8_t *data, size_t len) {
-    if (len > 255) return false;
+void lora_tx_service(void) {
+    lora_txq_t *q = tx_queue();
+    if (q->sending != LORA_TXQ_NONE) {
+        lora_tx_status_t status = lora_tx_poll();
+        if (status == LORA_TX_BUSY) return;
+        lora_txq_finish(q, status == LORA_TX_DONE);
+    }
 
-    lora_set_mode(MODE_STDBY);
-    lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
-    lora_write_fifo(data, len); // Usa a função existente de escrita no FIFO
-    lora_write_reg(REG_PAYLOAD_LENGTH, len);
+    // Com um pacote recebido ainda não lido o quadro espera na fila: o TX
+    // usaria o mesmo FIFO
+    if (lora_rx_pending()) return;
+    const lora_txq_buf_t *b;
+    while ((b = lora_txq_next(q)) != NULL) {
+        if (lora_tx_start(b->data, b->len)) return;
+        lora_txq_finish(q, false); // rádio ocupado por um lora_tx_start() fora da fila
+    }
+}
 
-    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
-    lora_write_reg(REG_DIO_MAPPING_1, 0x40); // DIO0 -> TxDone
+unsigned lora_tx_pending(void) {
+    return lora_txq_pending(tx_queue());
+}
 
-    tx_done = false;
-    lora_set_mode(MODE_TX);
+void lora_tx_get_stats(lora_txq_stats_t *out) {
+    *out = tx_queue()->stats;
+}
 
-    absolute_time_t start_time = get_absolute_time();
-    while (!tx_done) {
-        handle_dio0_events();
-        if (absolute_time_diff_us(start_time, get_absolute_time()) > (TX_TIMEOUT_MS * 1000)) {
-            lora_set_mode(MODE_STDBY);
-            return false;
-        }
-        tight_loop_contents();
-    }
+bool lora_rx_pending(void) {
+    lora_poll_irq();
+    return rx_done;
+}
 
-    lora_set_mode(MODE_STDBY);
+bool lora_tx_start(const uint8_t *data, size_t len) {
+    // O quadro vai para o FIFO a partir do endereço 0, a mesma base do RX: um
+    // RxDone ainda não lido seria sobrescrito e as flags dele apagadas
+    if (len > 255 || tx_busy || lora_rx_pending()) return false;
+
+    TRACE_BEGIN(LORA_TX);
+    tx_resume_duty_cycle = (rx_dc_state != RX_DC_OFF);
+    rx_dc_state = RX_DC_OFF; // o ciclo de RX fica parado durante o TX
+    lora_tx_begin(data, (uint8_t)len);
+    tx_deadline = make_timeout_time_ms(TX_TIMEOUT_MS);
+    tx_busy = true;
     return true;
 }
 
+lora_tx_status_t lora_tx_poll(void) {
+    if (!tx_busy) return LORA_TX_IDLE;
+
+    lora_poll_irq();
+    lora_tx_status_t status;
+    if (tx_done) status = LORA_TX_DONE;
+    else if (time_reached(tx_deadline)) status = LORA_TX_TIMEOUT;
+    else return LORA_TX_BUSY;
+
+    tx_busy = false;
+    if (tx_resume_duty_cycle) lora_start_rx_duty_cycle();
+    else lora_start_rx_continuous();
+    TRACE_END(LORA_TX);
+    return status;
+}
+
 int lora_receive_bytes(uint8_t *buf, size_t maxlen) {
-    // Tenta tratar evento por interrupção
-    handle_dio0_events();
-    // Fallback: se DIO0 não estiver ligado, faça polling do registrador de IRQs
-    if (!rx_done) {
-        uint8_t irq_flags = lora_read_reg(REG_IRQ_FLAGS);
-        if (irq_flags) {
-            lora_write_reg(REG_IRQ_FLAGS, 0xFF); // limpa todas as flags
-            if ((irq_flags & IRQ_RX_DONE_MASK) && !(irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK)) {
-                rx_done = true;
-            } else if (irq_flags & IRQ_TX_DONE_MASK) {
-                tx_done = true;
-            }
-        }
-    }
+    lora_pkt_meta_t meta;
+    int len = lora_receive_packet(buf, maxlen, &meta);
+    return (len > 0 && meta.crc_ok) ? len : 0; // descarta pacotes com erro de CRC
+}
+
+int lora_receive_packet(uint8_t *buf, size_t maxlen, lora_pkt_meta_t *meta) {
+    lora_poll_irq();
     if (!rx_done) return 0;
     rx_done = false;
+    TRACE_BEGIN(LORA_RX);
+
+    lora_read_burst(RX_META_FIRST_REG, last_rx.regs, RX_META_LEN);
+    last_rx.rx_time_us = rx_time_us;
+    last_rx.header_time_us = lora.use_dio3_valid_header ? dio3_time_us : 0;
+    last_rx.irq_flags = rx_irq_flags;
+#define RX_META(reg) last_rx.regs[(reg) - RX_META_FIRST_REG]
 
-    uint8_t len = lora_read_reg(REG_RX_NB_BYTES);
+    uint8_t len = RX_META(REG_RX_NB_BYTES);
     if (len > maxlen) {
-        printf("[AVISO] Pacote de %u bytes truncado para %u.\n", len, (unsigned)maxlen);
+        TLOG(LOG_LORA_TRUNCATED, len, maxlen);
         len = (uint8_t)maxlen;
     }
 
-    uint8_t fifo_addr = lora_read_reg(REG_FIFO_RX_CURRENT_ADDR);
-    lora_write_reg(REG_FIFO_ADDR_PTR, fifo_addr);
-
+    lora_write_reg(REG_FIFO_ADDR_PTR, RX_META(REG_FIFO_RX_CURRENT_ADDR));
     lora_read_fifo(buf, len); // Lê os bytes brutos
 
+    if (meta) {
+        int8_t snr_raw = (int8_t)RX_META(REG_PKT_SNR_VALUE);
+        int rssi = RX_META(REG_PKT_RSSI_VALUE) - 157; // seção 5.5.5 do datasheet
+        if (snr_raw < 0) rssi += snr_raw / 4;         // abaixo do ruído o RSSI é corrigido pelo SNR
+
+        // FEI: 20 bits com sinal; Ferr = FEI * 2^24 / Fxtal * BW / 500 kHz
+        int32_t fei = ((int32_t)(RX_META(REG_FEI_MSB) & 0x0F) << 16) |
+                      ((int32_t)RX_META(REG_FEI_MID) << 8) | RX_META(REG_FEI_LSB);
+        if (fei & 0x80000) fei -= 0x100000;
+
+        meta->rx_time_us = last_rx.rx_time_us;
+        meta->header_time_us = last_rx.header_time_us;
+        meta->rssi_dbm = (int16_t)rssi;
+        meta->snr_qdb = snr_raw;
+        meta->freq_error_hz = (int32_t)(((int64_t)fei * (1 << 24) * modem_bw_hz) / (32000000LL * 500000));
+        meta->crc_ok = !(rx_irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK);
+        meta->irq_flags = last_rx.irq_flags;
+        meta->len = RX_META(REG_RX_NB_BYTES);
+    }
+#undef RX_META
+
+    if (rx_dc_state != RX_DC_OFF) rx_dc_open_window(); // FIFO já lido, reabre a janela
+
+    TRACE_END(LORA_RX);
     return len;
 }
 
 
 void lora_start_rx_continuous(void) {
+    rx_dc_state = RX_DC_OFF;
     lora_write_reg(REG_IRQ_FLAGS, 0xFF);
-    lora_write_reg(REG_DIO_MAPPING_1, 0x00); // DIO0 -> RxDone
+    lora_write_reg(REG_DIO_MAPPING_1, DIO_MAPPING_RX); // DIO0 -> RxDone
     lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
     lora_set_mode(MODE_RX_CONTINUOUS);
 }
 
+uint32_t lora_rx_duty_cycle_sleep_us(uint16_t preamble_len) {
+    // Uma janela precisa começar enquanto ainda restam símbolos de preâmbulo
+    // suficientes para a detecção (a própria janela). Logo o período
+    // janela + sleep não pode passar de (preâmbulo - janela) símbolos, menos
+    // o atraso com que o laço principal percebe o fim do sleep.
+    uint16_t window = rx_dc_window_symbols();
+    if (preamble_len <= 2 * window) return 0;
+    uint32_t budget_us = (uint32_t)(preamble_len - 2 * window) * symbol_us;
+    if (budget_us <= LORA_RX_DC_MARGIN_US) return 0;
+    return budget_us - LORA_RX_DC_MARGIN_US;
+}
+
+uint32_t lora_rx_duty_cycle_on_permille(uint16_t preamble_len) {
+    uint32_t sleep_us = lora_rx_duty_cycle_sleep_us(preamble_len);
+    uint32_t on_us = (uint32_t)rx_dc_window_symbols() * symbol_us;
+    if (sleep_us == 0) return 1000;
+    return (uint32_t)(((uint64_t)on_us * 1000) / (on_us + sleep_us));
+}
+
+void lora_start_rx_duty_cycle(void) {
+    uint16_t preamble = lora.sender_preamble_len ? lora.sender_preamble_len : LORA_RX_DC_DEFAULT_PREAMBLE;
+    rx_dc_sleep_us = lora.rx_sleep_ms ? lora.rx_sleep_ms * 1000 : lora_rx_duty_cycle_sleep_us(preamble);
+    if (rx_dc_sleep_us == 0) {
+        // Preâmbulo curto demais para dormir sem perder pacotes
+        lora_start_rx_continuous();
+        return;
+    }
+
+    uint16_t window = rx_dc_window_symbols();
+    lora_write_reg(REG_MODEM_CONFIG_2, MODEM_CONFIG_2_VALUE | ((window >> 8) & 0x03));
+    lora_write_reg(REG_SYMB_TIMEOUT_LSB, (uint8_t)(window & 0xFF));
+    rx_dc_open_window();
+}
+
 // --- Funções Privadas ---
 
+// Carrega o FIFO e coloca o rádio em TX com o DIO0 mapeado para TxDone
+static void lora_tx_begin(const uint8_t *data, uint8_t len) {
+    lora_set_mode(MODE_STDBY);
+    lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    TRACE_BEGIN(LORA_FIFO_WRITE);
+    lora_write_fifo(data, len);
+    TRACE_END(LORA_FIFO_WRITE);
+    lora_write_reg(REG_PAYLOAD_LENGTH, len);
+
+    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
+    lora_write_reg(REG_DIO_MAPPING_1, 0x40); // DIO0 -> TxDone
+
+    tx_done = false;
+    lora_set_mode(MODE_TX);
+}
+
 static void cs_select() { gpio_put(lora.pin_cs, 0); }
 static void cs_deselect() { gpio_put(lora.pin_cs, 1); }
 
@@ -302,28 +476,115 @@ static void lora_read_fifo(uint8_t *data, uint8_t len) {
     cs_deselect();
 }
 
+static void lora_read_burst(uint8_t reg, uint8_t *data, uint8_t len) {
+    // Em modo LoRa o endereço é incrementado automaticamente a cada byte
+    cs_select();
+    uint8_t addr = reg & 0x7F;
+    spi_write_blocking(lora.spi_instance, &addr, 1);
+    spi_read_blocking(lora.spi_instance, 0x00, data, len);
+    cs_deselect();
+}
+
 static void lora_set_mode(uint8_t mode) {
     lora_write_reg(REG_OP_MODE, (0x80 | mode)); // Bit 7 (LongRangeMode) sempre deve ser 1
 }
 
 static void dio0_irq_handler(uint gpio, uint32_t events) {
-    (void)gpio; (void)events;
+    (void)events;
+    uint32_t now = time_us_32();
+    if (lora.use_dio3_valid_header && gpio == lora.pin_dio3) {
+        dio3_time_us = now;
+        return;
+    }
+    dio0_time_us = now;
     dio0_event = true;
 }
 
-static void handle_dio0_events() {
-    if (!dio0_event) return;
+static uint8_t handle_dio0_events() {
+    if (!dio0_event) return 0;
     dio0_event = false;
 
     uint8_t irq_flags = lora_read_reg(REG_IRQ_FLAGS);
     lora_write_reg(REG_IRQ_FLAGS, 0xFF); // Limpa todas as flags escrevendo 1s
 
-    if ((irq_flags & IRQ_RX_DONE_MASK) && !(irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK)) {
+    if (irq_flags & IRQ_RX_DONE_MASK) {
         rx_done = true;
+        rx_irq_flags = irq_flags;
+        rx_time_us = dio0_time_us;
+        if (irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK) TLOG(LOG_LORA_CRC_ERROR);
     } else if (irq_flags & IRQ_TX_DONE_MASK) {
         tx_done = true;
-    } else if (irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK) {
-        printf("[LORA_LIB] Erro de CRC no pacote!\n");
+    }
+    return irq_flags;
+}
+
+// Trata eventos do DIO0 e, como fallback (DIO0 não ligado ou flags que não
+// passam pelo DIO0, como RxTimeout), faz polling do registrador de IRQs.
+static uint8_t lora_poll_irq(void) {
+    uint8_t irq_flags = handle_dio0_events();
+    // Com um pacote pendente o registrador só é lido durante um TX (o TxDone
+    // sem DIO0 só seria visto no timeout); em RX ele apagaria as flags do
+    // próximo pacote antes de o pendente ser lido
+    if (!irq_flags && (!rx_done || tx_busy)) {
+        irq_flags = lora_read_reg(REG_IRQ_FLAGS);
+        if (irq_flags) {
+            lora_write_reg(REG_IRQ_FLAGS, 0xFF); // limpa todas as flags
+            if (irq_flags & IRQ_RX_DONE_MASK) {
+                rx_done = true;
+                rx_irq_flags = irq_flags;
+                rx_time_us = time_us_32(); // sem DIO0: instante em que o polling percebeu
+            } else if (irq_flags & IRQ_TX_DONE_MASK) {
+                tx_done = true;
+            }
+        }
+    }
+    rx_dc_step(irq_flags);
+    return irq_flags;
+}
+
+// Códigos de BW do REG_MODEM_CONFIG_1 (bits 7:4), em Hz
+static const uint32_t bw_table_hz[10] = { 7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000 };
+
+static void lora_read_modem_timing(void) {
+    uint8_t bw = lora_read_reg(REG_MODEM_CONFIG_1) >> 4;
+    uint8_t sf = lora_read_reg(REG_MODEM_CONFIG_2) >> 4;
+    if (bw < 10) modem_bw_hz = bw_table_hz[bw];
+    if (sf >= 6 && sf <= 12) symbol_us = (uint32_t)((1000000ULL << sf) / modem_bw_hz);
+}
+
+uint32_t lora_symbol_us(void) {
+    return symbol_us;
+}
+
+static uint16_t rx_dc_window_symbols(void) {
+    uint16_t window = lora.rx_window_symbols ? lora.rx_window_symbols : LORA_RX_DC_DEFAULT_WINDOW;
+    return window > 0x3FF ? 0x3FF : window; // SymbTimeout tem 10 bits
+}
+
+static void rx_dc_open_window(void) {
+    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
+    lora_write_reg(REG_DIO_MAPPING_1, DIO_MAPPING_RX); // DIO0 -> RxDone
+    lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    lora_set_mode(MODE_RX_SINGLE);
+    rx_dc_state = RX_DC_LISTEN;
+}
+
+// Avança o ciclo janela/sleep. Após um RxDone o rádio fica em standby e a
+// janela só é reaberta depois que o FIFO for lido (lora_receive_packet).
+static void rx_dc_step(uint8_t irq_flags) {
+    switch (rx_dc_state) {
+    case RX_DC_LISTEN:
+        if (irq_flags & IRQ_RX_TIMEOUT_MASK) {
+            lora_set_mode(MODE_SLEEP);
+            rx_dc_wake_time = make_timeout_time_us(rx_dc_sleep_us);
+            rx_dc_state = RX_DC_SLEEP;
+        }
+        break;
+    case RX_DC_SLEEP:
+        if (time_reached(rx_dc_wake_time)) rx_dc_open_window();
+        break;
+    default:
+        break;
     }
 }
 
@@ -336,3 +597,11 @@ int lora_get_rssi(void) {
     // Veja a seção 5.5.5 do datasheet do SX1276/7/8/9.
     return rssi_raw - 157;
 }
+
+const lora_rx_raw_t *lora_last_rx_raw(void) {
+    return &last_rx;
+}
+
+bool lora_event_pending(void) {
+    return dio0_event || rx_done;
+}
@@ -7,12 +7,21 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "hardware/spi.h"
+#include "lora_txq.h"
+#include "lora_proto.h"
 
 // ============================
 // CONFIGURAÇÕES DE TEMPO (ms)
 // ============================
 #define TX_TIMEOUT_MS       5000   // tempo máximo esperando TxDone
 
+// ============================
+// RECEPÇÃO EM CICLOS (DUTY CYCLE)
+// ============================
+#define LORA_RX_DC_DEFAULT_PREAMBLE   LORA_PROTO_NODE_PREAMBLE // preâmbulo padrão dos transmissores
+#define LORA_RX_DC_DEFAULT_WINDOW     5      // janela de escuta padrão (símbolos)
+#define LORA_RX_DC_MARGIN_US          100000 // atraso máximo do laço que chama lora_receive_bytes
+
 // Struct de configuração para tornar a biblioteca mais portável
 typedef struct {
     spi_inst_t *spi_instance;
@@ -23,8 +32,42 @@ typedef struct {
     uint pin_rst;
     uint pin_dio0;
     long frequency; // Frequência em Hz (ex: 915E6)
+
+    // Recepção em ciclos: alterna janelas curtas de RX single com o rádio em sleep.
+    bool rx_duty_cycle;           // true = usa lora_start_rx_duty_cycle() em vez de RX contínuo
+    uint16_t sender_preamble_len; // preâmbulo (símbolos) usado pelos transmissores, 0 = padrão
+    uint16_t rx_window_symbols;   // duração da janela (REG_SYMB_TIMEOUT), 0 = padrão
+    uint32_t rx_sleep_ms;         // sleep entre janelas, 0 = calculado a partir do preâmbulo
+
+    // DIO3 (opcional) mapeado para ValidHeader, para carimbar o início do pacote
+    bool use_dio3_valid_header;
+    uint pin_dio3;
 } lora_config_t;
 
+// Metadados de um pacote recebido, lidos junto com o payload
+typedef struct {
+    uint32_t rx_time_us;     // borda do RxDone (time_us_32), capturada na ISR do DIO0
+    uint32_t header_time_us; // borda do ValidHeader no DIO3, 0 se não configurado
+    int16_t rssi_dbm;        // RSSI do pacote (corrigido pelo SNR quando SNR < 0)
+    int8_t snr_qdb;          // SNR em passos de 0.25 dB
+    int32_t freq_error_hz;   // erro de frequência estimado pelo rádio
+    bool crc_ok;             // false se o CRC do payload falhou
+    uint8_t irq_flags;       // REG_IRQ_FLAGS no RxDone
+    uint8_t len;             // tamanho recebido pelo rádio (antes de truncar em maxlen)
+} lora_pkt_meta_t;
+
+// Janela de registradores lida em rajada após o RxDone (FIFO_RX_CURRENT_ADDR..FEI_LSB)
+#define LORA_RX_REGS_FIRST  0x10
+#define LORA_RX_REGS_LEN    27
+
+// O que o driver leu do rádio para o último pacote, sem interpretação
+typedef struct {
+    uint32_t rx_time_us;
+    uint32_t header_time_us;
+    uint8_t irq_flags;
+    uint8_t regs[LORA_RX_REGS_LEN];
+} lora_rx_raw_t;
+
 /**
  * @brief Inicializa o módulo LoRa com as configurações fornecidas.
  * * @param config A struct com as configurações de pinos, SPI e frequência.
@@ -53,13 +96,110 @@ int lora_receive(char *buf, size_t maxlen);
 void lora_start_rx_continuous(void);
 
 /**
- * @brief Envia um buffer de bytes via LoRa.
+ * @brief Coloca o rádio em recepção por ciclos (RX single + sleep).
+ * A janela de escuta usa REG_SYMB_TIMEOUT e o sleep é dimensionado para que
+ * nenhum preâmbulo do transmissor caia inteiro entre duas janelas. O ciclo
+ * avança dentro de lora_receive_bytes(), que deve continuar sendo chamada
+ * periodicamente (no máximo a cada LORA_RX_DC_MARGIN_US).
+ */
+void lora_start_rx_duty_cycle(void);
+
+/**
+ * @brief Duração de um símbolo da modulação programada em lora_init (lida
+ * de volta de REG_MODEM_CONFIG_1/2), em microssegundos.
+ */
+uint32_t lora_symbol_us(void);
+
+/**
+ * @brief Calcula o tempo de sleep entre janelas para um dado preâmbulo.
+ * @param preamble_len Preâmbulo dos transmissores, em símbolos.
+ * @return Sleep em microssegundos (0 se o preâmbulo é curto demais e o RX deve ser contínuo).
+ */
+uint32_t lora_rx_duty_cycle_sleep_us(uint16_t preamble_len);
+
+/**
+ * @brief Fração esperada de tempo com o rádio ligado em recepção por ciclos.
+ * @param preamble_len Preâmbulo dos transmissores, em símbolos.
+ * @return Fração em partes por mil (1000 = rádio sempre ligado).
+ */
+uint32_t lora_rx_duty_cycle_on_permille(uint16_t preamble_len);
+
+/**
+ * @brief Envia um buffer de bytes via LoRa e espera o fim da transmissão:
+ * lora_tx_submit() com prioridade alta seguido de lora_tx_service() até o
+ * quadro sair (ou falhar). Ao voltar, o rádio está de novo em recepção.
  * @param data Ponteiro para os dados.
  * @param len Número de bytes a serem enviados.
- * @return true se o envio foi iniciado com sucesso.
+ * @return true se o TxDone chegou; false também, sem enviar, se há um pacote
+ *         recebido ainda não lido (ver lora_rx_pending).
  */
 bool lora_send_bytes(const uint8_t *data, size_t len);
 
+/**
+ * @brief Coloca um quadro na fila de transmissão (common/lora_txq.h) sem
+ * bloquear; os dados são copiados para um buffer do pool.
+ * @param prio LORA_TXQ_PRIO_HIGH, _NORMAL ou _LOW.
+ * @return Identificador para lora_tx_status(), 0 se o pool está cheio ou len inválido.
+ */
+lora_txq_handle_t lora_tx_submit(const uint8_t *data, size_t len, uint8_t prio);
+
+/**
+ * @brief Estado de um quadro enviado com lora_tx_submit().
+ */
+lora_txq_status_t lora_tx_status(lora_txq_handle_t handle);
+
+/**
+ * @brief Alimenta o rádio com a fila: acompanha o quadro no ar e inicia o
+ * próximo assim que ele termina. Não bloqueia; deve ser chamada a cada
+ * passagem do laço principal (o TxDone acorda o laço pelo DIO0).
+ */
+void lora_tx_service(void);
+
+/**
+ * @brief Quadros na fila ou no ar.
+ */
+unsigned lora_tx_pending(void);
+
+/**
+ * @brief Copia os contadores da fila de transmissão.
+ */
+void lora_tx_get_stats(lora_txq_stats_t *out);
+
+// Estado de uma transmissão iniciada com lora_tx_start()
+typedef enum {
+    LORA_TX_IDLE,     // nenhuma transmissão em andamento
+    LORA_TX_BUSY,     // aguardando TxDone
+    LORA_TX_DONE,     // terminou (informado uma única vez)
+    LORA_TX_TIMEOUT   // TxDone não veio em TX_TIMEOUT_MS (informado uma única vez)
+} lora_tx_status_t;
+
+/**
+ * @brief Inicia uma transmissão sem bloquear (nível baixo: é o que
+ * lora_tx_service() usa; não misturar com a fila).
+ * Ao terminar (ou estourar TX_TIMEOUT_MS), lora_tx_poll() devolve o rádio
+ * ao modo de recepção em uso antes do envio (contínuo ou por ciclos).
+ * @param data Ponteiro para os dados (copiados para o FIFO na chamada).
+ * @param len Número de bytes a serem enviados.
+ * @return false se já há uma transmissão em andamento, se há um pacote
+ *         recebido ainda não lido (tentar de novo depois de
+ *         lora_receive_packet) ou se len > 255.
+ */
+bool lora_tx_start(const uint8_t *data, size_t len);
+
+/**
+ * @brief Indica se há um pacote recebido ainda não lido por
+ * lora_receive_packet. Enquanto houver, nenhum TX começa: o quadro usaria o
+ * mesmo FIFO.
+ */
+bool lora_rx_pending(void);
+
+/**
+ * @brief Acompanha a transmissão iniciada com lora_tx_start().
+ * @return Estado atual; LORA_TX_DONE/LORA_TX_TIMEOUT aparecem uma vez e
+ *         depois o estado volta a LORA_TX_IDLE.
+ */
+lora_tx_status_t lora_tx_poll(void);
+
 /**
  * @brief Tenta receber um buffer de bytes.
  * @param buf Buffer para armazenar os dados.
@@ -68,10 +208,36 @@ bool lora_send_bytes(const uint8_t *data, size_t len);
  */
 int lora_receive_bytes(uint8_t *buf, size_t maxlen);
 
+/**
+ * @brief Recebe um pacote junto com seus metadados. Função não bloqueante.
+ * Os metadados vêm de uma única leitura em rajada dos registradores
+ * (0x10..0x2A), sem transações SPI extras. Diferente de lora_receive_bytes,
+ * pacotes com erro de CRC também são entregues, com meta->crc_ok == false.
+ * @param buf Buffer para armazenar os dados.
+ * @param maxlen Tamanho máximo do buffer.
+ * @param meta Destino dos metadados (pode ser NULL).
+ * @return O número de bytes recebidos, ou 0.
+ */
+int lora_receive_packet(uint8_t *buf, size_t maxlen, lora_pkt_meta_t *meta);
+
+/**
+ * @brief Registradores crus do último pacote entregue por lora_receive_packet.
+ * A rajada já é lida direto neste buffer; serve para gravar capturas que o
+ * host/replay devolve ao driver pelo mesmo caminho SPI.
+ */
+const lora_rx_raw_t *lora_last_rx_raw(void);
+
 /**
  * @brief Obtém o RSSI (Received Signal Strength Indication) do último pacote recebido.
  * @return O valor do RSSI em dBm.
  */
 int lora_get_rssi(void); // <<< ADICIONE ESTA LINHA
 
+/**
+ * @brief Indica se há borda do DIO0 ainda não tratada ou pacote recebido
+ * ainda não lido. Usada pelo modo de baixo consumo para não dormir com um
+ * evento pendente.
+ */
+bool lora_event_pending(void);
+
 #endif // LORA_RFM95_H_
\ No newline at end of file
@@ -0,0 +1,82 @@
+// lowpower.c
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "hardware/structs/scb.h"
+#include "lowpower.h"
+#include "lora_RFM95.h"
+
+// ============================
+// CLOCKS MANTIDOS DURANTE O SLEEP
+// ============================
+// O gating volta ao normal (WAKE_EN) assim que o núcleo acorda, então não há
+// custo de reconfigurar PLLs como no modo dormant.
+#define SLEEP_EN0_KEEP ( \
+    CLOCKS_SLEEP_EN0_CLK_SYS_SRAM3_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_SRAM2_BITS | \
+    CLOCKS_SLEEP_EN0_CLK_SYS_SRAM1_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_SRAM0_BITS | \
+    CLOCKS_SLEEP_EN0_CLK_SYS_PLL_USB_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_PLL_SYS_BITS | \
+    CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS | \
+    CLOCKS_SLEEP_EN0_CLK_SYS_CLOCKS_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_BUSFABRIC_BITS | \
+    CLOCKS_SLEEP_EN0_CLK_SYS_BUSCTRL_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_SIO_BITS | \
+    CLOCKS_SLEEP_EN0_CLK_SYS_PSM_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_RESETS_BITS)
+
+#define SLEEP_EN1_KEEP ( \
+    CLOCKS_SLEEP_EN1_CLK_SYS_SRAM5_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_SRAM4_BITS | \
+    CLOCKS_SLEEP_EN1_CLK_SYS_XOSC_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_WATCHDOG_BITS | \
+    CLOCKS_SLEEP_EN1_CLK_SYS_TIMER_BITS | \
+    CLOCKS_SLEEP_EN1_CLK_USB_USBCTRL_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_USBCTRL_BITS | \
+    CLOCKS_SLEEP_EN1_CLK_SYS_UART0_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART0_BITS)
+
+static lowpower_stats_t stats;
+static volatile bool alarm_fired = false;
+
+static int64_t wake_alarm_cb(alarm_id_t id, void *user_data) {
+    (void)id; (void)user_data;
+    alarm_fired = true;
+    return 0; // não repete
+}
+
+void lowpower_init(void) {
+    memset(&stats, 0, sizeof(stats));
+    clocks_hw->sleep_en0 = SLEEP_EN0_KEEP;
+    clocks_hw->sleep_en1 = SLEEP_EN1_KEEP;
+}
+
+void lowpower_idle_until(absolute_time_t deadline) {
+    if (time_reached(deadline) || lora_event_pending()) return;
+
+    alarm_fired = false;
+    alarm_id_t alarm = add_alarm_at(deadline, wake_alarm_cb, NULL, true);
+    if (alarm <= 0) return; // deadline já passou
+
+    uint64_t t0 = time_us_64();
+    scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+    while (true) {
+        // Com as interrupções mascaradas, uma IRQ que chegue entre o teste e o
+        // WFI continua pendente e faz o WFI retornar imediatamente.
+        uint32_t save = save_and_disable_interrupts();
+        bool wake = alarm_fired || lora_event_pending();
+        if (!wake) __wfi();
+        restore_interrupts(save);
+        if (wake) break;
+        stats.wakeups++;
+    }
+    scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+
+    if (!alarm_fired) cancel_alarm(alarm);
+    stats.idle_us += time_us_64() - t0;
+}
+
+void lowpower_record_latency(uint32_t dio0_time_us) {
+    uint32_t latency = time_us_32() - dio0_time_us;
+    stats.latency_last_us = latency;
+    if (latency > stats.latency_max_us) stats.latency_max_us = latency;
+    stats.latency_sum_us += latency;
+    stats.latency_count++;
+}
+
+void lowpower_get_stats(lowpower_stats_t *out) {
+    *out = stats;
+}
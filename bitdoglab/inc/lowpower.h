@@ -0,0 +1,46 @@
+// lowpower.h
+
+#ifndef LOWPOWER_H_
+#define LOWPOWER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+// Estatísticas do modo de baixo consumo
+typedef struct {
+    uint32_t wakeups;           // quantas vezes o núcleo saiu do sleep
+    uint64_t idle_us;           // tempo total dormindo
+    uint32_t latency_count;     // pacotes medidos
+    uint32_t latency_last_us;   // borda do DIO0 -> FIFO lido (último pacote)
+    uint32_t latency_max_us;    // pior caso observado
+    uint64_t latency_sum_us;    // soma para cálculo da média
+} lowpower_stats_t;
+
+/**
+ * @brief Configura quais clocks continuam ligados enquanto o RP2040 dorme.
+ * Mantém apenas o necessário para acordar (IO/GPIO, timer, XOSC/PLLs) e para
+ * não derrubar o stdio (USB e UART0). SPI, I2C, PIO, ADC etc. são desligados.
+ */
+void lowpower_init(void);
+
+/**
+ * @brief Dorme (WFI com SLEEPDEEP) até o deadline ou até uma borda do DIO0.
+ * Outras interrupções (ex.: tarefa do stdio USB) acordam o núcleo, mas a
+ * função volta a dormir enquanto não houver evento do rádio nem deadline.
+ * @param deadline Instante máximo para retornar (ex.: próximo refresh do OLED).
+ */
+void lowpower_idle_until(absolute_time_t deadline);
+
+/**
+ * @brief Registra a latência entre a borda do DIO0 e o fim da leitura do FIFO.
+ * @param dio0_time_us Instante da borda (lora_pkt_meta_t.rx_time_us).
+ */
+void lowpower_record_latency(uint32_t dio0_time_us);
+
+/**
+ * @brief Copia as estatísticas acumuladas.
+ */
+void lowpower_get_stats(lowpower_stats_t *stats);
+
+#endif // LOWPOWER_H_
@@ -0,0 +1,57 @@
+// node_table.c
+//
+// Lógica pura (sem SDK): o relógio vem de quem chama.
+
+#include <string.h>
+#include "node_table.h"
+#include "report_policy.h"
+
+static node_entry_t nodes[NODE_TABLE_LEN];
+
+void node_table_init(void) {
+    memset(nodes, 0, sizeof(nodes));
+}
+
+static node_entry_t *find_or_add(uint8_t node_id) {
+    node_entry_t *oldest = &nodes[0];
+    for (int i = 0; i < NODE_TABLE_LEN; i++) {
+        node_entry_t *e = &nodes[i];
+        if (e->node_id == node_id) return e;
+        // Entrada livre ganha de qualquer ocupada
+        if (oldest->node_id != 0 && (e->node_id == 0 || e->last_rx_ms < oldest->last_rx_ms)) oldest = e;
+    }
+    memset(oldest, 0, sizeof(*oldest));
+    oldest->node_id = node_id;
+    return oldest;
+}
+
+bool node_table_update(uint8_t node_id, int16_t temperatura, int16_t umidade, int16_t rssi_dbm, uint16_t heartbeat_s,
+                       uint32_t now_ms) {
+    if (node_id == 0) return false;
+    node_entry_t *e = find_or_add(node_id);
+    bool was_stale = e->stale;
+    e->stale = false;
+    e->heartbeat_s = heartbeat_s;
+    e->temperatura = temperatura;
+    e->umidade = umidade;
+    e->rssi_dbm = rssi_dbm;
+    e->last_rx_ms = now_ms;
+    e->frames++;
+    return was_stale;
+}
+
+const node_entry_t *node_table_next_stale(uint32_t now_ms) {
+    for (int i = 0; i < NODE_TABLE_LEN; i++) {
+        node_entry_t *e = &nodes[i];
+        if (e->node_id == 0 || e->stale || e->heartbeat_s == 0) continue;
+        if (now_ms - e->last_rx_ms > report_stale_after_ms(e->heartbeat_s)) {
+            e->stale = true;
+            return e;
+        }
+    }
+    return NULL;
+}
+
+const node_entry_t *node_table_get(int i) {
+    return nodes[i].node_id ? &nodes[i] : NULL;
+}
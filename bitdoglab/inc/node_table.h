@@ -0,0 +1,55 @@
+// node_table.h
+
+#ifndef NODE_TABLE_H_
+#define NODE_TABLE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ============================
+// ÚLTIMO VALOR DE CADA NÓ
+// ============================
+#define NODE_TABLE_LEN   16   // nós acompanhados (o mais antigo sai quando enche)
+
+/**
+ * @brief Último valor recebido de um nó. Com envio por exceção
+ * (common/report_policy.h) o silêncio quer dizer "sem mudança": o valor
+ * continua valendo até report_stale_after_ms(heartbeat_s) sem nenhum quadro.
+ */
+typedef struct {
+    uint8_t node_id;        // 0 = entrada livre
+    bool stale;             // heartbeat perdido: valor não é mais garantido
+    uint16_t heartbeat_s;   // 0 = nó sem heartbeat (amostras antigas)
+    int16_t temperatura;
+    int16_t umidade;
+    int16_t rssi_dbm;       // do último quadro
+    uint32_t last_rx_ms;    // relógio do receptor
+    uint32_t frames;
+} node_entry_t;
+
+/**
+ * @brief Esvazia a tabela.
+ */
+void node_table_init(void);
+
+/**
+ * @brief Registra uma leitura recebida.
+ * @param heartbeat_s Heartbeat anunciado no quadro, 0 se o quadro não traz.
+ * @return true se o nó estava sem notícias e voltou.
+ */
+bool node_table_update(uint8_t node_id, int16_t temperatura, int16_t umidade, int16_t rssi_dbm, uint16_t heartbeat_s,
+                       uint32_t now_ms);
+
+/**
+ * @brief Procura um nó que acabou de perder o heartbeat e o marca.
+ * Chamar até devolver NULL.
+ * @return Entrada recém-marcada como sem notícias, ou NULL.
+ */
+const node_entry_t *node_table_next_stale(uint32_t now_ms);
+
+/**
+ * @brief Entrada i da tabela (0..NODE_TABLE_LEN-1), NULL se livre.
+ */
+const node_entry_t *node_table_get(int i);
+
+#endif // NODE_TABLE_H_
@@ -0,0 +1,44 @@
+// pktbuf.c
+//
+// Lógica pura (sem SDK); só é usada no laço principal, nunca em ISRs.
+
+#include <string.h>
+#include "pktbuf.h"
+
+static pktbuf_t pool[PKTBUF_COUNT];
+static pktbuf_stats_t stats;
+
+void pktbuf_init(void) {
+    memset(pool, 0, sizeof(pool));
+    memset(&stats, 0, sizeof(stats));
+}
+
+pktbuf_t *pktbuf_alloc(void) {
+    for (int i = 0; i < PKTBUF_COUNT; i++) {
+        pktbuf_t *p = &pool[i];
+        if (p->refs == 0) {
+            p->refs = 1;
+            p->len = 0;
+            if (++stats.in_use > stats.in_use_max) stats.in_use_max = stats.in_use;
+            if (stats.refs_max == 0) stats.refs_max = 1;
+            return p;
+        }
+    }
+    stats.alloc_fails++;
+    return NULL;
+}
+
+pktbuf_t *pktbuf_ref(pktbuf_t *p) {
+    p->refs++;
+    if (p->refs > stats.refs_max) stats.refs_max = p->refs;
+    return p;
+}
+
+void pktbuf_release(pktbuf_t *p) {
+    if (p == NULL || p->refs == 0) return;
+    if (--p->refs == 0) stats.in_use--;
+}
+
+void pktbuf_get_stats(pktbuf_stats_t *out) {
+    *out = stats;
+}
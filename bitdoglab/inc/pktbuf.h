@@ -0,0 +1,60 @@
+// pktbuf.h
+
+#ifndef PKTBUF_H_
+#define PKTBUF_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ============================
+// POOL DE BUFFERS DE PACOTE
+// ============================
+#define PKTBUF_COUNT   8     // buffers no pool
+#define PKTBUF_SIZE    256   // cabe qualquer pacote do rádio (até 255 bytes)
+
+/**
+ * @brief Buffer de um pacote recebido, lido do FIFO uma única vez.
+ * Quem guarda o pacote além da passagem atual do laço (fila do repetidor)
+ * pega uma referência com pktbuf_ref() e a devolve com pktbuf_release();
+ * o buffer volta ao pool quando a última é devolvida.
+ */
+typedef struct {
+    uint8_t data[PKTBUF_SIZE];
+    uint8_t len;
+    uint8_t refs;
+} pktbuf_t;
+
+typedef struct {
+    uint32_t alloc_fails;    // pool vazio (pacote deixado no rádio)
+    uint8_t in_use;          // buffers com alguma referência
+    uint8_t in_use_max;      // maior ocupação observada
+    uint8_t refs_max;        // maior número de referências num buffer
+} pktbuf_stats_t;
+
+/**
+ * @brief Esvazia o pool e zera as estatísticas.
+ */
+void pktbuf_init(void);
+
+/**
+ * @brief Pega um buffer livre, com uma referência (de quem chamou).
+ * @return NULL se todos estão em uso.
+ */
+pktbuf_t *pktbuf_alloc(void);
+
+/**
+ * @brief Acrescenta uma referência e devolve o próprio buffer.
+ */
+pktbuf_t *pktbuf_ref(pktbuf_t *p);
+
+/**
+ * @brief Devolve uma referência; a última libera o buffer. Aceita NULL.
+ */
+void pktbuf_release(pktbuf_t *p);
+
+/**
+ * @brief Copia as estatísticas do pool.
+ */
+void pktbuf_get_stats(pktbuf_stats_t *out);
+
+#endif // PKTBUF_H_
@@ -0,0 +1,100 @@
+// repeater.c
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/rand.h"
+#include "repeater.h"
+#include "lora_RFM95.h"
+
+typedef struct {
+    lora_relay_hdr_t hdr;         // cabeçalho já com hops + 1 e ttl - 1
+    pktbuf_t *pkt;                // referência ao buffer recebido
+    uint8_t inner_off;            // quadro original dentro de pkt->data
+    uint8_t inner_len;
+    uint32_t rx_time_us;          // RxDone do quadro original
+    absolute_time_t not_before;   // fim do atraso aleatório
+} relay_entry_t;
+
+static relay_entry_t queue[REPEATER_QUEUE_LEN];
+static uint8_t q_head = 0;        // próximo a transmitir
+static lora_txq_handle_t tx_handle = 0; // queue[q_head] entregue à fila do rádio, 0 se nenhum
+static repeater_stats_t stats;
+
+void repeater_init(void) {
+    for (int i = 0; i < stats.queue_len; i++) pktbuf_release(queue[(q_head + i) % REPEATER_QUEUE_LEN].pkt);
+    q_head = 0;
+    tx_handle = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool repeater_enqueue(const lora_relay_hdr_t *hdr, pktbuf_t *pkt, const uint8_t *inner, uint8_t inner_len, uint32_t rx_time_us) {
+    if (hdr->ttl == 0) {
+        stats.dropped_ttl++;
+        return false;
+    }
+    if (stats.queue_len == REPEATER_QUEUE_LEN || inner_len > REPEATER_MAX_FRAME - sizeof(lora_relay_hdr_t)) {
+        stats.dropped_full++;
+        return false;
+    }
+
+    relay_entry_t *e = &queue[(q_head + stats.queue_len) % REPEATER_QUEUE_LEN];
+    e->hdr = *hdr;
+    e->hdr.magic = LORA_PROTO_RELAY_MAGIC;
+    e->hdr.hops++;
+    e->hdr.ttl--;
+    e->pkt = pktbuf_ref(pkt);
+    e->inner_off = (uint8_t)(inner - pkt->data);
+    e->inner_len = inner_len;
+    e->rx_time_us = rx_time_us;
+    e->not_before = make_timeout_time_ms(get_rand_32() % (REPEATER_JITTER_MS + 1));
+
+    stats.queue_len++;
+    if (stats.queue_len > stats.queue_max) stats.queue_max = stats.queue_len;
+    return true;
+}
+
+void repeater_service(void) {
+    if (tx_handle) {
+        lora_txq_status_t st = lora_tx_status(tx_handle);
+        if (st == LORA_TXQ_QUEUED || st == LORA_TXQ_SENDING) return;
+        if (st == LORA_TXQ_SENT) stats.forwarded++;
+        else stats.tx_timeouts++;
+        tx_handle = 0;
+        q_head = (q_head + 1) % REPEATER_QUEUE_LEN;
+        stats.queue_len--;
+    }
+
+    if (stats.queue_len == 0) return;
+    relay_entry_t *e = &queue[q_head];
+    if (!time_reached(e->not_before)) return;
+
+    // O quadro só é montado aqui, direto da referência ao buffer recebido;
+    // lora_tx_submit copia para a fila do rádio e a referência é devolvida.
+    uint8_t frame[REPEATER_MAX_FRAME];
+    memcpy(frame, &e->hdr, sizeof(e->hdr));
+    memcpy(frame + sizeof(e->hdr), e->pkt->data + e->inner_off, e->inner_len);
+
+    // Prioridade baixa: beacons e amostras próprias passam na frente. Com o
+    // pool cheio, tenta na próxima passagem.
+    tx_handle = lora_tx_submit(frame, sizeof(e->hdr) + e->inner_len, LORA_TXQ_PRIO_LOW);
+    if (!tx_handle) return;
+    pktbuf_release(e->pkt);
+    e->pkt = NULL;
+
+    uint32_t latency = time_us_32() - e->rx_time_us;
+    stats.latency_count++;
+    stats.latency_last_us = latency;
+    if (latency > stats.latency_max_us) stats.latency_max_us = latency;
+    stats.latency_sum_us += latency;
+}
+
+absolute_time_t repeater_next_deadline(absolute_time_t limit) {
+    // Durante o TX quem acorda o laço é o DIO0 (TxDone)
+    if (tx_handle || stats.queue_len == 0) return limit;
+    absolute_time_t due = queue[q_head].not_before;
+    return absolute_time_diff_us(due, limit) > 0 ? due : limit;
+}
+
+void repeater_get_stats(repeater_stats_t *out) {
+    *out = stats;
+}
@@ -0,0 +1,72 @@
+// repeater.h
+
+#ifndef REPEATER_H_
+#define REPEATER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "lora_proto.h"
+#include "pktbuf.h"
+
+// ============================
+// FILA DE REPETIÇÃO
+// ============================
+#define REPEATER_QUEUE_LEN   4    // quadros aguardando retransmissão
+#define REPEATER_MAX_FRAME   255  // cabeçalho + quadro original (limite do FIFO)
+#define REPEATER_JITTER_MS   400  // atraso aleatório máximo antes de repassar
+
+// Estatísticas do repetidor
+typedef struct {
+    uint32_t forwarded;         // quadros retransmitidos
+    uint32_t dropped_ttl;       // chegaram com ttl esgotado
+    uint32_t dropped_full;      // fila cheia
+    uint32_t tx_timeouts;       // TxDone não veio
+    uint8_t queue_len;          // ocupação atual da fila
+    uint8_t queue_max;          // maior ocupação observada
+    uint32_t latency_count;     // retransmissões medidas
+    uint32_t latency_last_us;   // RxDone do quadro original -> início do TX
+    uint32_t latency_max_us;
+    uint64_t latency_sum_us;    // soma para cálculo da média
+} repeater_stats_t;
+
+/**
+ * @brief Esvazia a fila e zera as estatísticas.
+ */
+void repeater_init(void);
+
+/**
+ * @brief Agenda a retransmissão de um quadro recebido (já filtrado como não duplicado).
+ * O quadro sai com hops + 1 e ttl - 1, depois de um atraso aleatório de até
+ * REPEATER_JITTER_MS para que repetidores vizinhos não transmitam juntos.
+ * O quadro não é copiado: a fila guarda uma referência ao buffer recebido
+ * até entregá-lo à fila do rádio.
+ * @param hdr Cabeçalho efetivo (de lora_proto_relay_parse).
+ * @param pkt Buffer onde o quadro foi recebido.
+ * @param inner Quadro original, dentro de pkt->data.
+ * @param inner_len Tamanho do quadro original.
+ * @param rx_time_us Instante do RxDone (lora_pkt_meta_t.rx_time_us).
+ * @return false se o ttl acabou, o quadro é grande demais ou a fila está cheia.
+ */
+bool repeater_enqueue(const lora_relay_hdr_t *hdr, pktbuf_t *pkt, const uint8_t *inner, uint8_t inner_len, uint32_t rx_time_us);
+
+/**
+ * @brief Avança a fila sem bloquear: passa o próximo quadro vencido para a
+ * fila do rádio (lora_tx_submit, prioridade baixa) e acompanha o resultado.
+ * Deve ser chamada a cada passagem do laço principal, junto com lora_tx_service().
+ */
+void repeater_service(void);
+
+/**
+ * @brief Próximo instante em que repeater_service() tem algo a fazer.
+ * @param limit Valor devolvido se nada vence antes dele.
+ */
+absolute_time_t repeater_next_deadline(absolute_time_t limit);
+
+/**
+ * @brief Copia as estatísticas acumuladas.
+ */
+void repeater_get_stats(repeater_stats_t *out);
+
+#endif // REPEATER_H_
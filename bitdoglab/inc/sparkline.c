@@ -0,0 +1,95 @@
+// sparkline.c
+//
+// A escala vem de history_min/history_max, que olham as HISTORY_LEN últimas
+// leituras: com HISTORY_LEN igual à largura do display, exatamente as
+// colunas visíveis.
+
+#include <string.h>
+#include "sparkline.h"
+
+void sparkline_init(sparkline_t *s, uint8_t page0, uint8_t pages, int16_t min_span) {
+    memset(s, 0, sizeof(*s));
+    s->page0 = page0;
+    s->pages = pages > SPARKLINE_MAX_PAGES ? SPARKLINE_MAX_PAGES : pages;
+    s->min_span = min_span > 0 ? min_span : 1;
+}
+
+// Linha de um valor na escala desenhada (0 = topo da faixa)
+static uint32_t value_row(const sparkline_t *s, int16_t v) {
+    int32_t bottom = s->pages * 8 - 1;
+    if (v <= s->lo) return (uint32_t)bottom;
+    if (v >= s->hi) return 0;
+    return (uint32_t)(bottom - ((int32_t)(v - s->lo) * bottom + (s->hi - s->lo) / 2) / (s->hi - s->lo));
+}
+
+// Segmento vertical da leitura anterior até a atual (linha contínua)
+static uint32_t column_bits(const sparkline_t *s, int16_t prev, int16_t cur) {
+    uint32_t a = value_row(s, prev), b = value_row(s, cur);
+    if (a > b) {
+        uint32_t t = a;
+        a = b;
+        b = t;
+    }
+    uint32_t upto_b = b >= 31 ? 0xFFFFFFFFu : (1u << (b + 1)) - 1;
+    return upto_b & ~((1u << a) - 1);
+}
+
+static void write_column(const sparkline_t *s, ssd1306_t *p, uint32_t x, uint32_t bits) {
+    for (uint8_t k = 0; k < s->pages; k++, bits >>= 8) p->buffer[x + p->width * (s->page0 + k)] = (uint8_t)bits;
+}
+
+// Escala da janela atual, com folga de 1/8 da faixa de cada lado para que
+// uma leitura um pouco além do extremo não force outro redesenho
+static void set_scale(sparkline_t *s, const history_t *h) {
+    int32_t lo = history_min(h), hi = history_max(h);
+    if (hi - lo < s->min_span) {
+        lo = (lo + hi) / 2 - s->min_span / 2;
+        hi = lo + s->min_span;
+    } else {
+        int32_t pad = (hi - lo) / 8;
+        lo -= pad;
+        hi += pad;
+    }
+    s->lo = (int16_t)(lo < INT16_MIN ? INT16_MIN : lo);
+    s->hi = (int16_t)(hi > INT16_MAX ? INT16_MAX : hi);
+}
+
+void sparkline_redraw(sparkline_t *s, ssd1306_t *p, const history_t *h) {
+    uint16_t n = history_count(h);
+    set_scale(s, h);
+    for (uint32_t x = 0; x < p->width; x++) {
+        uint32_t age = p->width - 1 - x;
+        uint32_t bits = 0;
+        if (age < n) {
+            int16_t cur = history_get(h, (uint16_t)age);
+            bits = column_bits(s, age + 1 < n ? history_get(h, (uint16_t)(age + 1)) : cur, cur);
+        }
+        write_column(s, p, x, bits);
+    }
+    s->drawn = true;
+    s->redraws++;
+}
+
+void sparkline_push(sparkline_t *s, ssd1306_t *p, const history_t *h) {
+    uint16_t n = history_count(h);
+    if (n == 0) return;
+    int32_t lo = history_min(h), hi = history_max(h), span = s->hi - s->lo;
+    if (!s->drawn || lo < s->lo || hi > s->hi || ((hi - lo) * 4 < span && span > s->min_span)) {
+        sparkline_redraw(s, p, h);
+        return;
+    }
+
+    // Desloca as colunas uma posição para a esquerda (a mais antiga sai)
+    for (uint8_t k = 0; k < s->pages; k++) {
+        uint8_t *row = &p->buffer[p->width * (s->page0 + k)];
+        memmove(row, row + 1, p->width - 1u);
+    }
+    int16_t cur = history_get(h, 0);
+    write_column(s, p, p->width - 1u, column_bits(s, n > 1 ? history_get(h, 1) : cur, cur));
+    // A primeira coluna perdeu a leitura anterior: vira um ponto, como no redesenho
+    if (n >= p->width) {
+        int16_t first = history_get(h, (uint16_t)(p->width - 1u));
+        write_column(s, p, 0, column_bits(s, first, first));
+    }
+    s->scrolls++;
+}
@@ -0,0 +1,50 @@
+// sparkline.h
+
+#ifndef SPARKLINE_H_
+#define SPARKLINE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306.h"
+#include "history.h"
+
+// ============================
+// GRÁFICO DE LINHA NO DISPLAY
+// ============================
+#define SPARKLINE_MAX_PAGES 4   // altura máxima (32 linhas): a coluna cabe em 32 bits
+
+/**
+ * @brief Gráfico de um history_t numa faixa de páginas do ssd1306_t, uma
+ * coluna por leitura, a mais recente à direita. Desenha direto nas páginas
+ * do buffer: a cada leitura as colunas andam uma posição para a esquerda
+ * (memmove de cada página) e só a coluna nova é desenhada. Tudo é
+ * redesenhado apenas quando a escala muda: a janela passou dos limites
+ * desenhados ou ficou com menos de um quarto da faixa.
+ */
+typedef struct {
+    uint8_t page0, pages;     // faixa do buffer ocupada pelo gráfico
+    int16_t min_span;         // faixa mínima da escala (centésimos), contra ruído ampliado
+    int16_t lo, hi;           // escala desenhada
+    bool drawn;               // false: o próximo sparkline_push redesenha tudo
+    uint32_t scrolls;         // atualizações incrementais
+    uint32_t redraws;         // redesenhos completos
+} sparkline_t;
+
+/**
+ * @brief Prepara o gráfico nas páginas page0..page0+pages-1 (pages até
+ * SPARKLINE_MAX_PAGES).
+ */
+void sparkline_init(sparkline_t *s, uint8_t page0, uint8_t pages, int16_t min_span);
+
+/**
+ * @brief Atualiza o gráfico depois de um history_push: desloca uma coluna e
+ * desenha a nova, ou redesenha tudo se a escala precisa mudar.
+ */
+void sparkline_push(sparkline_t *s, ssd1306_t *p, const history_t *h);
+
+/**
+ * @brief Redesenha o gráfico inteiro (depois de limpar o buffer, por exemplo).
+ */
+void sparkline_redraw(sparkline_t *s, ssd1306_t *p, const history_t *h);
+
+#endif // SPARKLINE_H_
@@ -32,6 +32,7 @@ SOFTWARE.
 
 #include "ssd1306.h"
 #include "font.h"
+#include "trace.h"
 
 inline static void swap(int32_t *a, int32_t *b) {
     int32_t *t=a;
@@ -136,6 +137,33 @@ inline void ssd1306_invert(ssd1306_t *p, uint8_t inv) {
     ssd1306_write(p, SET_NORM_INV | (inv & 1));
 }
 
+void ssd1306_set_start_line(ssd1306_t *p, uint8_t line) {
+    ssd1306_write(p, SET_DISP_START_LINE | (line & 0x3F));
+}
+
+void ssd1306_scroll_start(ssd1306_t *p, bool left, uint8_t first, uint8_t last, ssd1306_scroll_interval_t interval,
+                          uint8_t vertical_offset) {
+    // the setup commands are only accepted with the scroll deactivated
+    ssd1306_write(p, SET_SCROLL_OFF);
+    if(vertical_offset) {
+        uint8_t cmds[]= {
+            SET_VSCROLL_AREA, 0, p->height,     // no fixed rows on top
+            SET_VHSCROLL + (left ? 1 : 0), 0x00, first, interval, last, vertical_offset & 0x3F,
+        };
+        for(size_t i=0; i<sizeof(cmds); ++i)
+            ssd1306_write(p, cmds[i]);
+    } else {
+        uint8_t cmds[]= {SET_HSCROLL + (left ? 1 : 0), 0x00, first, interval, last, 0x00, 0xFF};
+        for(size_t i=0; i<sizeof(cmds); ++i)
+            ssd1306_write(p, cmds[i]);
+    }
+    ssd1306_write(p, SET_SCROLL_ON);
+}
+
+void ssd1306_scroll_stop(ssd1306_t *p) {
+    ssd1306_write(p, SET_SCROLL_OFF);
+}
+
 inline void ssd1306_clear(ssd1306_t *p) {
     memset(p->buffer, 0, p->bufsize);
 }
@@ -227,6 +255,46 @@ void ssd1306_draw_string(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, c
     ssd1306_draw_string_with_font(p, x, y, scale, font_8x5, s);
 }
 
+// Stretch an 8-pixel font column vertically: each bit becomes scale bits
+static inline uint32_t ssd1306_stretch_column(uint8_t col, uint32_t scale) {
+    if(scale==1)
+        return col;
+    uint32_t out=0, run=(1u<<scale)-1;
+    for(uint32_t j=0; col; ++j, col>>=1) {
+        if(col & 1)
+            out|=run<<(j*scale);
+    }
+    return out;
+}
+
+uint32_t ssd1306_draw_string_fast(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const char *s) {
+    if(scale<1 || scale>3) { // stretched column plus shift only fits in 32 bits up to 3x
+        ssd1306_draw_string(p, x, y, scale, s);
+        return x+(uint32_t)strlen(s)*(font_8x5[1]+font_8x5[2])*scale;
+    }
+
+    const uint32_t page=y>>3, shift=y&7;
+    for(; *s; ++s) {
+        char c=*s;
+        if(c>=font_8x5[3] && c<=font_8x5[4]) {
+            const uint8_t *glyph=&font_8x5[5+(c-font_8x5[3])*font_8x5[1]];
+            for(uint8_t w=0; w<font_8x5[1]; ++w) {
+                uint32_t bits=ssd1306_stretch_column(glyph[w], scale)<<shift;
+                for(uint32_t sx=0; sx<scale; ++sx) {
+                    uint32_t col=x+w*scale+sx;
+                    if(col>=p->width)
+                        break;
+                    // A column touches up to 4 pages (3x with a shift)
+                    for(uint32_t pg=page, b=bits; b && pg<p->pages; ++pg, b>>=8)
+                        p->buffer[col+p->width*pg]|=(uint8_t)b;
+                }
+            }
+        }
+        x+=(font_8x5[1]+font_8x5[2])*scale;
+    }
+    return x;
+}
+
 static inline uint32_t ssd1306_bmp_get_val(const uint8_t *data, const size_t offset, uint8_t size) {
     switch(size) {
     case 1:
@@ -291,6 +359,7 @@ inline void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long
 }
 
 void ssd1306_show(ssd1306_t *p) {
+    TRACE_BEGIN(SSD1306_SHOW);
     uint8_t payload[]= {SET_COL_ADDR, 0, p->width-1, SET_PAGE_ADDR, 0, p->pages-1};
     if(p->width==64) {
         payload[1]+=32;
@@ -303,5 +372,32 @@ void ssd1306_show(ssd1306_t *p) {
     *(p->buffer-1)=0x40;
 
     fancy_write(p->i2c_i, p->address, p->buffer-1, p->bufsize+1, "ssd1306_show");
+    TRACE_END(SSD1306_SHOW);
+}
+
+void ssd1306_show_pages(ssd1306_t *p, uint8_t first, uint8_t last) {
+    if(last>=p->pages)
+        last=p->pages-1;
+    if(first>last)
+        return;
+    TRACE_BEGIN(SSD1306_SHOW);
+    uint8_t payload[]= {SET_COL_ADDR, 0, p->width-1, SET_PAGE_ADDR, first, last};
+    if(p->width==64) {
+        payload[1]+=32;
+        payload[2]+=32;
+    }
+
+    for(size_t i=0; i<sizeof(payload); ++i)
+        ssd1306_write(p, payload[i]);
+
+    // The I2C control byte goes right before the first page sent; in the
+    // middle of the buffer that byte belongs to the previous page, so it is
+    // saved and restored after the write
+    uint8_t *start=p->buffer+(size_t)first*p->width;
+    uint8_t saved=*(start-1);
+    *(start-1)=0x40;
+    fancy_write(p->i2c_i, p->address, start-1, (size_t)(last-first+1)*p->width+1, "ssd1306_show_pages");
+    *(start-1)=saved;
+    TRACE_END(SSD1306_SHOW);
 }
 
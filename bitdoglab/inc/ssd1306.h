@@ -53,9 +53,28 @@ typedef enum {
     SET_DISP_CLK_DIV = 0xD5,
     SET_PRECHARGE = 0xD9,
     SET_VCOM_DESEL = 0xDB,
-    SET_CHARGE_PUMP = 0x8D
+    SET_CHARGE_PUMP = 0x8D,
+    SET_HSCROLL = 0x26,             // right, + 1 for left
+    SET_VHSCROLL = 0x29,            // vertical and right, + 1 for vertical and left
+    SET_SCROLL_OFF = 0x2E,
+    SET_SCROLL_ON = 0x2F,
+    SET_VSCROLL_AREA = 0xA3
 } ssd1306_command_t;
 
+/**
+*	@brief interval between two steps of the continuous scroll, in frames
+*/
+typedef enum {
+    SSD1306_SCROLL_2_FRAMES = 0x07,
+    SSD1306_SCROLL_3_FRAMES = 0x04,
+    SSD1306_SCROLL_4_FRAMES = 0x05,
+    SSD1306_SCROLL_5_FRAMES = 0x00,
+    SSD1306_SCROLL_25_FRAMES = 0x06,
+    SSD1306_SCROLL_64_FRAMES = 0x01,
+    SSD1306_SCROLL_128_FRAMES = 0x02,
+    SSD1306_SCROLL_256_FRAMES = 0x03
+} ssd1306_scroll_interval_t;
+
 /**
 *	@brief holds the configuration
 */
@@ -135,6 +154,53 @@ void ssd1306_invert(ssd1306_t *p, uint8_t inv);
 */
 void ssd1306_show(ssd1306_t *p);
 
+/**
+	@brief send only pages first..last of the buffer to the display
+
+	@param[in] p : instance of display
+	@param[in] first : first page (0..pages-1)
+	@param[in] last : last page, inclusive
+*/
+void ssd1306_show_pages(ssd1306_t *p, uint8_t first, uint8_t last);
+
+/**
+	@brief set the RAM row shown on the top line of the display
+
+	The display shows RAM rows line..line+height-1, wrapping at row 64, so
+	on a 64 line display changing the start line scrolls the whole screen
+	without sending any pixel data. The buffer is not touched.
+
+	@param[in] p : instance of display
+	@param[in] line : RAM row (0..63)
+*/
+void ssd1306_set_start_line(ssd1306_t *p, uint8_t line);
+
+/**
+	@brief start the continuous hardware scroll of pages first..last
+
+	The controller keeps moving those pages one column per step on its own,
+	wrapping around horizontally; with vertical_offset != 0 the whole display
+	also moves vertical_offset rows per step (diagonal scroll). The RAM must
+	not be written while the scroll is active: call ssd1306_scroll_stop and
+	then send the buffer again, since the RAM is left scrolled.
+
+	@param[in] p : instance of display
+	@param[in] left : scroll to the left instead of to the right
+	@param[in] first : first page
+	@param[in] last : last page, inclusive
+	@param[in] interval : time between steps
+	@param[in] vertical_offset : rows per step (0..63), 0 for horizontal only
+*/
+void ssd1306_scroll_start(ssd1306_t *p, bool left, uint8_t first, uint8_t last, ssd1306_scroll_interval_t interval,
+                          uint8_t vertical_offset);
+
+/**
+	@brief stop the continuous hardware scroll
+
+	@param[in] p : instance of display
+*/
+void ssd1306_scroll_stop(ssd1306_t *p);
+
 /**
 	@brief clear display buffer
 
@@ -271,6 +337,23 @@ void ssd1306_draw_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_
 */
 void ssd1306_draw_string(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const char *s);
 
+/**
+	@brief draw string with builtin font straight into the buffer pages
+
+	Same result as ssd1306_draw_string, but ORs whole font columns into the
+	page buffer instead of drawing one square per pixel. Scales above 3 fall
+	back to ssd1306_draw_string.
+
+	@param[in] p : instance of display
+	@param[in] x : x starting position of text
+	@param[in] y : y starting position of text
+	@param[in] scale : scale font to n times of original size
+	@param[in] s : text to draw
+
+	@return x position after the last char
+*/
+uint32_t ssd1306_draw_string_fast(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const char *s);
+
 void texto(uint8_t valor);
 
 #endif
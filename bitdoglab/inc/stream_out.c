@@ -0,0 +1,83 @@
+// stream_out.c
+
+#include <assert.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "stream_out.h"
+#include "cobs.h"
+#include "trace.h"
+
+static uint8_t record[LORA_STREAM_MAX_RECORD];
+static uint8_t frame[COBS_MAX_ENCODED(LORA_STREAM_MAX_RECORD) + 2]; // + delimitadores
+static uint16_t seq = 0;
+
+static_assert(LORA_CAPTURE_FIRST_REG == LORA_RX_REGS_FIRST && LORA_CAPTURE_REGS == LORA_RX_REGS_LEN,
+              "captura != janela de RX do driver");
+
+// Acrescenta o CRC ao registro montado em record[0..n) e o envia num quadro COBS
+static void send_record(size_t n) {
+    TRACE_BEGIN(STREAM_OUT);
+    uint16_t crc = crc16_ccitt(record, n);
+    record[n++] = (uint8_t)crc;
+    record[n++] = (uint8_t)(crc >> 8);
+
+    frame[0] = 0x00;
+    size_t out = 1 + cobs_encode(record, n, frame + 1);
+    frame[out++] = 0x00;
+    stdio_usb.out_chars((const char *)frame, (int)out);
+    TRACE_END(STREAM_OUT);
+}
+
+void stream_out_packet(const uint8_t *payload, uint8_t len, const lora_pkt_meta_t *meta, uint8_t flags) {
+    lora_stream_packet_t hdr = {
+        .type = LORA_STREAM_TYPE_PACKET,
+        .flags = flags,
+        .seq = seq++,
+        .rx_time_us = meta->rx_time_us,
+        .freq_error_hz = meta->freq_error_hz,
+        .rssi_dbm = meta->rssi_dbm,
+        .snr_qdb = meta->snr_qdb,
+        .len = len,
+    };
+    if (meta->crc_ok) hdr.flags |= LORA_STREAM_FLAG_CRC_OK;
+    if (meta->len > len) hdr.flags |= LORA_STREAM_FLAG_TRUNCATED;
+
+    size_t n = sizeof(hdr);
+    memcpy(record, &hdr, sizeof(hdr));
+    memcpy(record + n, payload, len);
+    send_record(n + len);
+}
+
+void stream_out_capture(const lora_rx_raw_t *raw, const uint8_t *fifo, uint8_t len) {
+    lora_stream_capture_t hdr = {
+        .type = LORA_STREAM_TYPE_CAPTURE,
+        .irq_flags = raw->irq_flags,
+        .seq = seq++,
+        .rx_time_us = raw->rx_time_us,
+        .header_time_us = raw->header_time_us,
+        .len = len,
+    };
+    memcpy(hdr.regs, raw->regs, sizeof(hdr.regs));
+
+    memcpy(record, &hdr, sizeof(hdr));
+    memcpy(record + sizeof(hdr), fifo, len);
+    send_record(sizeof(hdr) + len);
+}
+
+void stream_out_log(const tlog_entry_t *e) {
+    lora_stream_log_t hdr = {
+        .type = LORA_STREAM_TYPE_LOG,
+        .id = e->id,
+        .seq = seq++,
+        .time_us = e->time_us,
+        .nargs = e->nargs,
+    };
+    memcpy(record, &hdr, sizeof(hdr));
+    memcpy(record + sizeof(hdr), e->args, e->nargs * sizeof(uint32_t));
+    send_record(sizeof(hdr) + e->nargs * sizeof(uint32_t));
+}
+
+uint16_t stream_out_count(void) {
+    return seq;
+}
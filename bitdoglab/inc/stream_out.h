@@ -0,0 +1,44 @@
+// stream_out.h
+
+#ifndef STREAM_OUT_H_
+#define STREAM_OUT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lora_RFM95.h"
+#include "lora_stream.h"
+#include "tlog_ring.h"
+
+/**
+ * @brief Envia um pacote recebido como registro binário (common/lora_stream.h).
+ * O registro é montado e codificado em buffers estáticos e sai numa única
+ * escrita no driver USB, sem passar pelo printf, pela tradução LF->CRLF nem
+ * pela cópia na UART.
+ * @param payload Bytes recebidos do rádio.
+ * @param len Tamanho de payload.
+ * @param meta Metadados do pacote.
+ * @param flags LORA_STREAM_FLAG_* adicionais (CRC_OK e TRUNCATED vêm de meta).
+ */
+void stream_out_packet(const uint8_t *payload, uint8_t len, const lora_pkt_meta_t *meta, uint8_t flags);
+
+/**
+ * @brief Envia a captura crua de um pacote (LORA_STREAM_TYPE_CAPTURE): flags
+ * de IRQ, a rajada de registradores e os bytes lidos do FIFO, para o
+ * host/replay reproduzir a recepção.
+ * @param raw Registradores do pacote (lora_last_rx_raw()).
+ * @param fifo Bytes lidos do FIFO.
+ * @param len Tamanho de fifo.
+ */
+void stream_out_capture(const lora_rx_raw_t *raw, const uint8_t *fifo, uint8_t len);
+
+/**
+ * @brief Envia uma mensagem do log tokenizado (LORA_STREAM_TYPE_LOG).
+ */
+void stream_out_log(const tlog_entry_t *e);
+
+/**
+ * @brief Registros enviados desde o boot (o próximo seq).
+ */
+uint16_t stream_out_count(void);
+
+#endif // STREAM_OUT_H_
@@ -0,0 +1,40 @@
+// tdma_master.c
+//
+// Lógica pura (sem SDK) para também ser usada pelo simulador de host.
+
+#include <string.h>
+#include "tdma_master.h"
+
+void tdma_master_init(tdma_master_t *m, uint8_t n_slots) {
+    memset(m, 0, sizeof(*m));
+    m->n_slots = n_slots > LORA_PROTO_MAX_SLOTS ? LORA_PROTO_MAX_SLOTS : n_slots;
+    m->slot_us = lora_proto_slot_us();
+}
+
+int tdma_master_on_join(tdma_master_t *m, uint8_t node_id) {
+    int free_slot = -1;
+    if (node_id == LORA_PROTO_SLOT_FREE) return -1;
+    for (int i = 0; i < m->n_slots; i++) {
+        if (m->slots[i] == node_id) return i;
+        if (free_slot < 0 && m->slots[i] == LORA_PROTO_SLOT_FREE) free_slot = i;
+    }
+    if (free_slot >= 0) m->slots[free_slot] = node_id;
+    return free_slot;
+}
+
+size_t tdma_master_build_beacon(tdma_master_t *m, uint64_t time_us, uint8_t *buf) {
+    lora_beacon_t beacon = {
+        .magic = LORA_PROTO_BEACON_MAGIC,
+        .seq = m->seq++,
+        .time_us = time_us,
+        .slot_us = m->n_slots ? m->slot_us : 0,
+        .n_slots = m->n_slots,
+    };
+    memcpy(buf, &beacon, sizeof(beacon));
+    memcpy(buf + sizeof(beacon), m->slots, m->n_slots);
+    return sizeof(beacon) + m->n_slots;
+}
+
+uint32_t tdma_master_superframe_us(const tdma_master_t *m) {
+    return lora_proto_superframe_us(m->n_slots, m->slot_us);
+}
@@ -0,0 +1,45 @@
+// tdma_master.h
+
+#ifndef TDMA_MASTER_H_
+#define TDMA_MASTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "lora_proto.h"
+
+// Tabela de slots mantida pelo receptor e anunciada em cada beacon
+typedef struct {
+    uint8_t n_slots;                          // 0 = TDMA desligado (beacon só sincroniza)
+    uint8_t seq;                              // sequência do próximo beacon
+    uint32_t slot_us;                         // duração de cada slot de dados
+    uint8_t slots[LORA_PROTO_MAX_SLOTS];      // node_id dono de cada slot
+} tdma_master_t;
+
+/**
+ * @brief Inicializa a tabela com todos os slots livres.
+ * @param n_slots Número de slots de dados (até LORA_PROTO_MAX_SLOTS).
+ */
+void tdma_master_init(tdma_master_t *m, uint8_t n_slots);
+
+/**
+ * @brief Trata um pedido de slot (quadro JOIN).
+ * Um nó que já tem slot recebe o mesmo de novo.
+ * @return Índice do slot atribuído, ou -1 se a tabela está cheia.
+ */
+int tdma_master_on_join(tdma_master_t *m, uint8_t node_id);
+
+/**
+ * @brief Monta o próximo beacon (cabeçalho + tabela de slots).
+ * @param time_us Relógio do receptor no início do TX.
+ * @param buf Destino, com pelo menos sizeof(lora_beacon_t) + n_slots bytes.
+ * @return Tamanho do beacon em bytes.
+ */
+size_t tdma_master_build_beacon(tdma_master_t *m, uint64_t time_us, uint8_t *buf);
+
+/**
+ * @brief Duração do superquadro (período entre beacons) em microssegundos.
+ */
+uint32_t tdma_master_superframe_us(const tdma_master_t *m);
+
+#endif // TDMA_MASTER_H_
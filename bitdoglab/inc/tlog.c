@@ -0,0 +1,55 @@
+// tlog.c
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/structs/systick.h"
+#include "tlog.h"
+#include "stream_out.h"
+
+#define BENCH_CALLS 16          // cabe no anel junto com o que já estiver pendente
+#define SYSTICK_MASK 0xFFFFFFu  // contador de 24 bits, decrescente
+
+static tlog_ring_t ring;
+
+void tlog_write(uint8_t nargs, const uint32_t *v) {
+    tlog_ring_push(&ring, time_us_32(), (uint8_t)v[0], nargs, v + 1);
+}
+
+void tlog_service(bool binary, unsigned max) {
+    tlog_entry_t e;
+    while (max-- && tlog_ring_pop(&ring, time_us_32(), &e)) {
+        if (binary) {
+            stream_out_log(&e);
+            continue;
+        }
+        // Monta a linha inteira antes de imprimir (um printf por mensagem)
+        char line[16 + 9 * TLOG_MAX_ARGS + 8];
+        int n = snprintf(line, sizeof(line), "@L %08lx %u", (unsigned long)e.time_us, e.id);
+        for (unsigned i = 0; i < e.nargs; i++) {
+            n += snprintf(line + n, sizeof(line) - (size_t)n, " %lx", (unsigned long)e.args[i]);
+        }
+        printf("%s\n", line);
+    }
+}
+
+void tlog_bench(void) {
+    // SysTick no clock do núcleo: volta a cada 134 ms a 125 MHz, bem acima de
+    // um printf que não bloqueia na USB
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // ENABLE | CLKSOURCE = processador
+
+    uint32_t printf_cycles = 0, tlog_cycles = 0;
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        uint32_t t0 = systick_hw->cvr;
+        printf("logbench %u: %d bytes, flags 0x%02x\n", (unsigned)i, 10, 0x40);
+        uint32_t t1 = systick_hw->cvr;
+        TLOG(LOG_BENCH, i, 10, 0x40);
+        uint32_t t2 = systick_hw->cvr;
+        printf_cycles += (t0 - t1) & SYSTICK_MASK;
+        tlog_cycles += (t1 - t2) & SYSTICK_MASK;
+    }
+    systick_hw->csr = 0;
+    printf("logbench: printf %lu ciclos/chamada, TLOG %lu ciclos/chamada (media de %u chamadas)\n",
+           (unsigned long)(printf_cycles / BENCH_CALLS), (unsigned long)(tlog_cycles / BENCH_CALLS), BENCH_CALLS);
+}
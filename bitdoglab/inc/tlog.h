@@ -0,0 +1,26 @@
+// tlog.h
+//
+// Log tokenizado na BitDogLab (common/tlog_ring.h): os pontos de log gravam
+// no anel com o carimbo de time_us_32() e tlog_service(), no laço principal,
+// esvazia o anel em linhas "@L" ou, no modo binário, em registros
+// LORA_STREAM_TYPE_LOG.
+
+#ifndef TLOG_H_
+#define TLOG_H_
+
+#include <stdbool.h>
+#include "tlog_ring.h"
+
+/**
+ * @brief Esvazia até max mensagens do anel.
+ * @param binary true = registros LORA_STREAM_TYPE_LOG (stream_out); false = linhas "@L".
+ */
+void tlog_service(bool binary, unsigned max);
+
+/**
+ * @brief Mede, com o SysTick, os ciclos por chamada de printf e de TLOG para
+ * a mesma mensagem (LOG_BENCH) e imprime as médias.
+ */
+void tlog_bench(void);
+
+#endif // TLOG_H_
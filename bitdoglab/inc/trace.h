@@ -0,0 +1,24 @@
+// trace.h
+//
+// Trace dos laços quentes na BitDogLab (common/trace_ring.h). Ligado com
+// cmake -DBITDOGLAB_TRACE=ON; desligado, as macros não geram código.
+//
+// Carimbo: timer do RP2040 (1 MHz, 32 bits baixos), lido sem trava. O
+// SysTick contaria ciclos, mas tem 24 bits, volta a cada 134 ms a 125 MHz
+// e fica parado enquanto o lowpower dorme no __wfi.
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "pico/stdlib.h"
+
+#define TRACE_BOARD   "bitdoglab"
+#define TRACE_TICK_HZ 1000000u
+
+static inline uint32_t trace_now(void) {
+    return time_us_32();
+}
+
+#include "trace_ring.h"
+
+#endif // TRACE_H_
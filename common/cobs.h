@@ -0,0 +1,60 @@
+// cobs.h
+//
+// Consistent Overhead Byte Stuffing: remove os bytes 0x00 de um quadro para
+// que 0x00 possa delimitar quadros no fluxo serial. Custo: 1 byte a cada 254.
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Tamanho máximo do quadro codificado (sem o delimitador)
+#define COBS_MAX_ENCODED(n) ((n) + (n) / 254 + 1)
+
+/**
+ * @brief Codifica len bytes de in em out (sem o 0x00 final).
+ * @param out Destino com pelo menos COBS_MAX_ENCODED(len) bytes.
+ * @return Bytes escritos em out.
+ */
+static inline size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t code_pos = 0, o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[code_pos] = code;
+                code_pos = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+    return o;
+}
+
+/**
+ * @brief Decodifica um quadro (sem o 0x00 delimitador).
+ * @param out Destino com pelo menos len bytes.
+ * @return Bytes decodificados, ou 0 se o quadro é inválido.
+ */
+static inline size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t i = 0, o = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len) return 0;
+        for (uint8_t k = 1; k < code; k++) {
+            if (in[i] == 0) return 0;
+            out[o++] = in[i++];
+        }
+        if (code != 0xFF && i < len) out[o++] = 0;
+    }
+    return o;
+}
+
+#endif // COBS_H_
@@ -0,0 +1,30 @@
+// crc16.h
+//
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), usado nas páginas do log em
+// flash. Compartilhado pelos firmwares e pelas ferramentas de host.
+
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CRC16_INIT 0xFFFF
+
+/**
+ * @brief Continua o cálculo do CRC sobre mais um bloco.
+ * @param crc Valor anterior (CRC16_INIT no primeiro bloco).
+ */
+static inline uint16_t crc16_update(uint16_t crc, const uint8_t *data, size_t len) {
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int i = 0; i < 8; i++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+static inline uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
+    return crc16_update(CRC16_INIT, data, len);
+}
+
+#endif // CRC16_H_
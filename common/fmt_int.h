@@ -0,0 +1,95 @@
+// fmt_int.h
+//
+// Formatação só com inteiros dos valores das amostras (centésimos de grau e
+// de umidade, quartos de dB do SNR). Evita o ponto flutuante emulado e o
+// "%f" do printf no Cortex-M0+ da BitDogLab, que não tem FPU: cada pacote
+// mostrado passava por divisão em float e por uma formatação pesada.
+//
+// As funções escrevem a string terminada em '\0' e devolvem o tamanho, para
+// montar linhas por concatenação sem strlen.
+
+#ifndef FMT_INT_H_
+#define FMT_INT_H_
+
+#include <stdint.h>
+
+#define FMT_U32_MAX   10            // dígitos de um uint32_t
+#define FMT_CENTI_MAX 13            // "-21474836.48" + '\0'
+
+/**
+ * @brief Decimal sem sinal. out precisa de FMT_U32_MAX + 1 bytes.
+ */
+static inline int fmt_u32(char *out, uint32_t v) {
+    char tmp[FMT_U32_MAX];
+    int n = 0;
+    do {
+        uint32_t q = v / 10;
+        tmp[n++] = (char)('0' + (v - q * 10));
+        v = q;
+    } while (v);
+    for (int i = 0; i < n; i++) out[i] = tmp[n - 1 - i];
+    out[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Decimal com sinal. out precisa de FMT_U32_MAX + 2 bytes.
+ */
+static inline int fmt_i32(char *out, int32_t v) {
+    if (v >= 0) return fmt_u32(out, (uint32_t)v);
+    out[0] = '-';
+    return 1 + fmt_u32(out + 1, 0u - (uint32_t)v);
+}
+
+/**
+ * @brief Centésimos como "[-]I.FF" (2534 -> "25.34", -5 -> "-0.05").
+ * out precisa de FMT_CENTI_MAX bytes.
+ */
+static inline int fmt_centi(char *out, int32_t centi) {
+    int n = 0;
+    uint32_t a = (uint32_t)centi;
+    if (centi < 0) {
+        out[n++] = '-';
+        a = 0u - a;
+    }
+    uint32_t ip = a / 100, fp = a - ip * 100;
+    n += fmt_u32(out + n, ip);
+    out[n++] = '.';
+    out[n++] = (char)('0' + fp / 10);
+    out[n++] = (char)('0' + fp % 10);
+    out[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Centésimos arredondados para uma casa: "[-]I.F" (2534 -> "25.3",
+ * 2535 -> "25.4"). out precisa de FMT_CENTI_MAX bytes.
+ */
+static inline int fmt_deci(char *out, int32_t centi) {
+    int n = 0;
+    uint32_t a = (uint32_t)centi;
+    if (centi < 0) a = 0u - a;
+    a = (a + 5) / 10;
+    if (centi < 0 && a) out[n++] = '-';
+    uint32_t ip = a / 10;
+    n += fmt_u32(out + n, ip);
+    out[n++] = '.';
+    out[n++] = (char)('0' + (a - ip * 10));
+    out[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Copia s para out e devolve o tamanho (sem contar o '\0').
+ */
+static inline int fmt_str(char *out, const char *s) {
+    int n = 0;
+    while (s[n]) {
+        out[n] = s[n];
+        n++;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+#endif // FMT_INT_H_
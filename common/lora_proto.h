@@ -0,0 +1,446 @@
+// lora_proto.h
+//
+// Formato dos quadros trocados entre os nós FPGA (transmissores) e a
+// BitDogLab (receptor). Compartilhado pelos dois firmwares e pelas
+// ferramentas de host; ambos os MCUs são little-endian.
+
+#ifndef LORA_PROTO_H_
+#define LORA_PROTO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// ============================
+// MODULAÇÃO COMUM (lora_init dos dois lados)
+// ============================
+#define LORA_PROTO_SF              12
+#define LORA_PROTO_BW_CODE         7     // REG_MODEM_CONFIG_1 bits 7:4
+#define LORA_PROTO_BW_HZ           125000
+#define LORA_PROTO_CR              4     // 4/8
+#define LORA_PROTO_SYMBOL_US       ((1000000UL << LORA_PROTO_SF) / LORA_PROTO_BW_HZ) // 32768 us
+#define LORA_PROTO_LDRO            (LORA_PROTO_SYMBOL_US > 16000) // obrigatório com símbolo acima de 16 ms
+#define LORA_PROTO_PREAMBLE        12    // preâmbulo dos beacons da BitDogLab (símbolos)
+// Preâmbulo das transmissões dos nós (amostras e JOIN). Um preâmbulo maior
+// deixa os receptores em recepção por ciclos dormirem mais, e os slots TDMA
+// crescem junto: redefinir com o mesmo valor nos dois firmwares.
+#ifndef LORA_PROTO_NODE_PREAMBLE
+#define LORA_PROTO_NODE_PREAMBLE   LORA_PROTO_PREAMBLE
+#endif
+
+// Registradores de modulação escritos pelo lora_init dos dois firmwares
+#define LORA_PROTO_MODEM_CONFIG_1  (LORA_PROTO_BW_CODE << 4 | LORA_PROTO_CR << 1) // 0x78, cabeçalho explícito
+#define LORA_PROTO_MODEM_CONFIG_2  (LORA_PROTO_SF << 4 | 0x04)                    // 0xC4, CRC ligado
+#define LORA_PROTO_MODEM_CONFIG_3  (LORA_PROTO_LDRO ? 0x0C : 0x04)                // AGC ligado
+
+// O código de BW programado e a banda usada nas contas de tempo no ar precisam concordar
+#define LORA_PROTO_BW_CONSISTENT \
+             ((LORA_PROTO_BW_CODE == 6 && LORA_PROTO_BW_HZ == 62500) || \
+              (LORA_PROTO_BW_CODE == 7 && LORA_PROTO_BW_HZ == 125000) || \
+              (LORA_PROTO_BW_CODE == 8 && LORA_PROTO_BW_HZ == 250000) || \
+              (LORA_PROTO_BW_CODE == 9 && LORA_PROTO_BW_HZ == 500000))
+#ifdef __cplusplus
+static_assert(LORA_PROTO_BW_CONSISTENT, "LORA_PROTO_BW_CODE != LORA_PROTO_BW_HZ");
+#else
+_Static_assert(LORA_PROTO_BW_CONSISTENT, "LORA_PROTO_BW_CODE != LORA_PROTO_BW_HZ");
+#endif
+
+// ============================
+// QUADROS
+// ============================
+#define LORA_PROTO_BEACON_MAGIC    0xB5
+#define LORA_PROTO_JOIN_MAGIC      0xB6
+#define LORA_PROTO_RELAY_MAGIC     0xB7
+#define LORA_PROTO_PAYLOAD_MAGIC   0xB8
+
+#define LORA_PROTO_MAX_SLOTS       64    // entradas máximas na tabela de slots
+#define LORA_PROTO_SLOT_FREE       0     // node_id 0 é reservado para slot livre
+#define LORA_PROTO_RELAY_TTL       3     // saltos máximos de um quadro repetido
+
+/**
+ * @brief Beacon de sincronismo enviado periodicamente pela BitDogLab.
+ * time_us é o relógio do receptor (time_us_64) no início da transmissão;
+ * quem recebe soma o tempo no ar do beacon para obter a hora do RxDone.
+ *
+ * O beacon também abre um superquadro TDMA: é seguido por n_slots bytes com
+ * o node_id dono de cada slot (LORA_PROTO_SLOT_FREE = livre). Os tempos são
+ * relativos a time_us:
+ *   slot k    começa em time_us + beacon_slot + k * slot_us
+ *   slot JOIN começa em time_us + beacon_slot + n_slots * slot_us
+ * com beacon_slot = lora_proto_beacon_slot_us(tamanho do beacon).
+ * Nós sem slot pedem um com lora_join_t no slot JOIN ou em um slot livre.
+ * n_slots == 0 desliga o TDMA (os nós transmitem quando quiserem).
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t magic;      // LORA_PROTO_BEACON_MAGIC
+    uint8_t seq;        // incrementado a cada beacon
+    uint64_t time_us;   // tempo de rede no início do TX
+    uint32_t slot_us;   // duração de cada slot
+    uint8_t n_slots;    // tamanho da tabela que segue o cabeçalho
+} lora_beacon_t;
+
+/**
+ * @brief Pedido de slot, enviado no slot JOIN (ou num slot livre) por nós sem slot atribuído.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t magic;      // LORA_PROTO_JOIN_MAGIC
+    uint8_t node_id;
+} lora_join_t;
+
+/**
+ * @brief Amostra do AHT10 com carimbo de tempo de rede.
+ * Os 4 primeiros bytes são idênticos ao quadro antigo (aht10_dados).
+ * No ar, os nós atuais mandam a amostra como payload tipado
+ * (LORA_PAYLOAD_READING, ver lora_proto_sample_frame); este formato sem
+ * cabeçalho continua aceito pelo receptor e é o registro usado pelas
+ * ferramentas de host.
+ */
+typedef struct __attribute__((packed)) {
+    int16_t temperatura;   // Temperatura * 100
+    int16_t umidade;       // Umidade * 100
+    uint32_t timestamp_ms; // tempo de rede da leitura, 0 se ainda não sincronizado
+    uint8_t node_id;       // identificação do nó FPGA (NODE_ID no Makefile)
+    uint8_t seq;           // incrementado a cada amostra enviada
+} lora_sample_t;
+
+// ============================
+// PAYLOADS TIPADOS
+// ============================
+#define LORA_PAYLOAD_VERSION       1     // muda só se o cabeçalho mudar
+
+/**
+ * @brief Cabeçalho dos payloads de aplicação. O tipo diz como ler o corpo
+ * que segue; node_id/seq identificam o quadro para o filtro de duplicatas e
+ * o repetidor, que assim tratam qualquer tipo, inclusive os que não conhecem.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t magic;      // LORA_PROTO_PAYLOAD_MAGIC
+    uint8_t version;    // LORA_PAYLOAD_VERSION
+    uint8_t type;       // LORA_PAYLOAD_* (0 é reservado)
+    uint8_t node_id;    // origem do quadro
+    uint8_t seq;        // sequência na origem (comum a todos os tipos)
+} lora_payload_hdr_t;
+
+/**
+ * @brief Corpo de LORA_PAYLOAD_READING: leitura do AHT10. Começa com os
+ * mesmos 4 bytes de aht10_dados.
+ */
+typedef struct __attribute__((packed)) {
+    int16_t temperatura;   // Temperatura * 100
+    int16_t umidade;       // Umidade * 100
+    uint32_t timestamp_ms; // tempo de rede da leitura, 0 se ainda não sincronizado
+} lora_reading_t;
+
+/**
+ * @brief Corpo de LORA_PAYLOAD_REPORT: leitura enviada por exceção
+ * (common/report_policy.h). O heartbeat diz ao receptor por quanto tempo o
+ * silêncio do nó significa "sem mudança".
+ */
+typedef struct __attribute__((packed)) {
+    lora_reading_t reading;
+    uint16_t heartbeat_s;  // silêncio máximo do nó, 0 = sem heartbeat
+} lora_report_t;
+
+/**
+ * Registro dos tipos: X(id, NOME, nome, corpo, rótulo). Cada tipo tem corpo
+ * de tamanho fixo. Para acrescentar um tipo basta uma linha aqui; o receptor
+ * gera o despacho com este registro e não compila sem um tratador
+ * on_payload_<nome> para cada tipo. IDs nunca são reaproveitados.
+ */
+#define LORA_PAYLOAD_TYPES(X) \
+    X(1, READING, reading, lora_reading_t, "leitura") \
+    X(2, REPORT, report, lora_report_t, "relato")
+
+#define LORA_PAYLOAD_ID(id, NAME, name, body, label) LORA_PAYLOAD_##NAME = id,
+enum { LORA_PAYLOAD_TYPES(LORA_PAYLOAD_ID) };
+#undef LORA_PAYLOAD_ID
+
+// Posição de cada tipo no registro (para tabelas de contadores)
+#define LORA_PAYLOAD_IDX(id, NAME, name, body, label) LORA_PAYLOAD_IDX_##NAME,
+enum { LORA_PAYLOAD_TYPES(LORA_PAYLOAD_IDX) LORA_PAYLOAD_N_TYPES };
+#undef LORA_PAYLOAD_IDX
+
+/**
+ * @brief Tamanho do corpo de um tipo registrado, -1 se o tipo não é conhecido.
+ */
+static inline int lora_payload_body_len(uint8_t type) {
+#define LORA_PAYLOAD_LEN(id, NAME, name, body, label) case id: return (int)sizeof(body);
+    switch (type) {
+    LORA_PAYLOAD_TYPES(LORA_PAYLOAD_LEN)
+    default: return -1;
+    }
+#undef LORA_PAYLOAD_LEN
+}
+
+/**
+ * @brief Nome de um tipo registrado, NULL se o tipo não é conhecido.
+ */
+static inline const char *lora_payload_name(uint8_t type) {
+#define LORA_PAYLOAD_NAME(id, NAME, name, body, label) case id: return label;
+    switch (type) {
+    LORA_PAYLOAD_TYPES(LORA_PAYLOAD_NAME)
+    default: return NULL;
+    }
+#undef LORA_PAYLOAD_NAME
+}
+
+typedef enum {
+    LORA_PAYLOAD_UNTYPED,   // sem cabeçalho tipado (beacon, JOIN, amostra antiga...)
+    LORA_PAYLOAD_KNOWN,     // tipo registrado, corpo do tamanho certo
+    LORA_PAYLOAD_UNKNOWN    // cabeçalho tipado, mas tipo, versão ou tamanho desconhecidos
+} lora_payload_kind_t;
+
+/**
+ * @brief Separa o cabeçalho tipado do corpo.
+ * Um quadro antigo (4 bytes ou lora_sample_t) cujo primeiro byte coincida com
+ * o magic só é aceito como tipado se bater com um tipo registrado; fora isso
+ * continua sendo lido pelo tamanho.
+ * @param hdr Destino do cabeçalho (válido se o retorno não é UNTYPED).
+ * @param body Corpo dentro de frame.
+ * @param body_len Tamanho do corpo.
+ */
+static inline lora_payload_kind_t lora_payload_parse(const uint8_t *frame, uint8_t len, lora_payload_hdr_t *hdr,
+                                                     const uint8_t **body, uint8_t *body_len) {
+    if (len < sizeof(lora_payload_hdr_t) || frame[0] != LORA_PROTO_PAYLOAD_MAGIC) return LORA_PAYLOAD_UNTYPED;
+    *hdr = *(const lora_payload_hdr_t *)frame;
+    *body = frame + sizeof(lora_payload_hdr_t);
+    *body_len = (uint8_t)(len - sizeof(lora_payload_hdr_t));
+    if (hdr->version == LORA_PAYLOAD_VERSION && hdr->type != 0 && lora_payload_body_len(hdr->type) == *body_len) {
+        return LORA_PAYLOAD_KNOWN;
+    }
+    if (len == 4 || len == sizeof(lora_sample_t)) return LORA_PAYLOAD_UNTYPED;
+    return LORA_PAYLOAD_UNKNOWN;
+}
+
+// Tamanho no ar de uma amostra dos nós atuais (LORA_PAYLOAD_REPORT); 15
+// bytes ocupam os mesmos blocos de símbolos que os 13 de LORA_PAYLOAD_READING
+#define LORA_PROTO_SAMPLE_LEN (sizeof(lora_payload_hdr_t) + sizeof(lora_report_t))
+
+/**
+ * @brief Monta o quadro tipado (LORA_PAYLOAD_READING) de uma amostra.
+ * @param out Pelo menos LORA_PROTO_SAMPLE_LEN bytes.
+ * @return Tamanho do quadro.
+ */
+static inline uint8_t lora_proto_sample_frame(const lora_sample_t *s, uint8_t *out) {
+    // Sem inicializadores designados: o cabeçalho também é usado em C++ (host/gateway)
+    lora_payload_hdr_t h = { LORA_PROTO_PAYLOAD_MAGIC, LORA_PAYLOAD_VERSION, LORA_PAYLOAD_READING, s->node_id, s->seq };
+    lora_reading_t r = { s->temperatura, s->umidade, s->timestamp_ms };
+    memcpy(out, &h, sizeof(h));
+    memcpy(out + sizeof(h), &r, sizeof(r));
+    return (uint8_t)(sizeof(h) + sizeof(r));
+}
+
+/**
+ * @brief Monta o quadro tipado (LORA_PAYLOAD_REPORT) de uma amostra enviada por exceção.
+ * @param out Pelo menos LORA_PROTO_SAMPLE_LEN bytes.
+ * @return Tamanho do quadro.
+ */
+static inline uint8_t lora_proto_report_frame(const lora_sample_t *s, uint16_t heartbeat_s, uint8_t *out) {
+    lora_payload_hdr_t h = { LORA_PROTO_PAYLOAD_MAGIC, LORA_PAYLOAD_VERSION, LORA_PAYLOAD_REPORT, s->node_id, s->seq };
+    lora_report_t r = { { s->temperatura, s->umidade, s->timestamp_ms }, heartbeat_s };
+    memcpy(out, &h, sizeof(h));
+    memcpy(out + sizeof(h), &r, sizeof(r));
+    return (uint8_t)LORA_PROTO_SAMPLE_LEN;
+}
+
+/**
+ * @brief Lê uma amostra em qualquer dos formatos: payload tipado
+ * LORA_PAYLOAD_READING ou LORA_PAYLOAD_REPORT, ou lora_sample_t sem cabeçalho.
+ * @return false se o quadro não é uma amostra.
+ */
+static inline bool lora_proto_sample(const uint8_t *frame, uint8_t len, lora_sample_t *out) {
+    lora_payload_hdr_t h;
+    const uint8_t *body;
+    uint8_t body_len;
+    lora_payload_kind_t kind = lora_payload_parse(frame, len, &h, &body, &body_len);
+    if (kind == LORA_PAYLOAD_KNOWN) {
+        // O corpo de LORA_PAYLOAD_REPORT começa com um lora_reading_t
+        if (h.type != LORA_PAYLOAD_READING && h.type != LORA_PAYLOAD_REPORT) return false;
+        lora_reading_t r;
+        memcpy(&r, body, sizeof(r));
+        out->temperatura = r.temperatura;
+        out->umidade = r.umidade;
+        out->timestamp_ms = r.timestamp_ms;
+        out->node_id = h.node_id;
+        out->seq = h.seq;
+        return true;
+    }
+    if (kind == LORA_PAYLOAD_UNTYPED && len == sizeof(lora_sample_t)) {
+        memcpy(out, frame, sizeof(*out));
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Cabeçalho de um quadro repassado por um repetidor.
+ * Vem antes do quadro original (payload tipado ou lora_sample_t), sem alterá-lo. node_id/seq identificam o
+ * quadro original para o filtro de duplicatas; hops é incrementado e ttl
+ * decrementado a cada repetição (ttl == 0 não é mais repassado).
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t magic;      // LORA_PROTO_RELAY_MAGIC
+    uint8_t hops;       // repetições já feitas
+    uint8_t ttl;        // repetições ainda permitidas
+    uint8_t node_id;    // origem do quadro
+    uint8_t seq;        // sequência na origem
+} lora_relay_hdr_t;
+
+/**
+ * @brief Origem (node_id, seq) de um quadro original: payload tipado de
+ * qualquer tipo, conhecido ou não, ou amostra sem cabeçalho.
+ * @return false se o quadro não tem node_id/seq (beacon, JOIN, quadro antigo de 4 bytes).
+ */
+static inline bool lora_proto_frame_id(const uint8_t *frame, uint8_t len, uint8_t *node_id, uint8_t *seq) {
+    lora_payload_hdr_t h;
+    const uint8_t *body;
+    uint8_t body_len;
+    if (lora_payload_parse(frame, len, &h, &body, &body_len) != LORA_PAYLOAD_UNTYPED) {
+        *node_id = h.node_id;
+        *seq = h.seq;
+        return true;
+    }
+    // Só amostras antigas: o tamanho exato evita confundir com outro quadro
+    if (len == sizeof(lora_sample_t)) {
+        const lora_sample_t *sample = (const lora_sample_t *)frame;
+        *node_id = sample->node_id;
+        *seq = sample->seq;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Confere o tamanho de um quadro original: um tipo registrado na
+ * versão atual precisa vir com o corpo inteiro. Tipos desconhecidos não têm
+ * tamanho conferível e passam.
+ */
+static inline bool lora_proto_frame_len_ok(const uint8_t *frame, uint8_t len) {
+    lora_payload_hdr_t h;
+    const uint8_t *body;
+    uint8_t body_len;
+    if (lora_payload_parse(frame, len, &h, &body, &body_len) != LORA_PAYLOAD_UNKNOWN) return true;
+    return h.version != LORA_PAYLOAD_VERSION || lora_payload_body_len(h.type) < 0;
+}
+
+/**
+ * @brief Identifica um quadro repetível e separa o cabeçalho de repetição.
+ * Quadros repassados têm o cabeçalho retirado; quadros diretos recebem um
+ * cabeçalho implícito (hops 0, ttl LORA_PROTO_RELAY_TTL). Payloads tipados
+ * são repetíveis mesmo com tipo desconhecido.
+ * @param hdr Destino do cabeçalho (efetivo).
+ * @param inner Quadro original dentro de frame.
+ * @param inner_len Tamanho do quadro original.
+ * @return false se o quadro não tem node_id/seq (beacon, JOIN, quadro antigo de 4 bytes).
+ */
+static inline bool lora_proto_relay_parse(const uint8_t *frame, uint8_t len, lora_relay_hdr_t *hdr,
+                                          const uint8_t **inner, uint8_t *inner_len) {
+    uint8_t node_id, seq;
+    // Repassado: o quadro original tem que estar inteiro, a origem no
+    // cabeçalho de repetição tem que bater com a dele e hops/ttl têm que ser
+    // os de um repetidor (hops + ttl nunca passa de LORA_PROTO_RELAY_TTL).
+    // Isso evita confundir com um quadro direto cujo primeiro byte seja
+    // igual ao magic, ou aceitar um quadro repassado truncado
+    if (len > sizeof(lora_relay_hdr_t) && frame[0] == LORA_PROTO_RELAY_MAGIC) {
+        const lora_relay_hdr_t *h = (const lora_relay_hdr_t *)frame;
+        const uint8_t *in = frame + sizeof(lora_relay_hdr_t);
+        uint8_t in_len = (uint8_t)(len - sizeof(lora_relay_hdr_t));
+        bool hops_ok = h->hops >= 1 && h->hops + h->ttl <= LORA_PROTO_RELAY_TTL;
+        if (hops_ok && lora_proto_frame_len_ok(in, in_len) && lora_proto_frame_id(in, in_len, &node_id, &seq) &&
+            node_id == h->node_id && seq == h->seq) {
+            *hdr = *h;
+            *inner = in;
+            *inner_len = in_len;
+            return hdr->node_id != 0;
+        }
+    }
+    if (lora_proto_frame_id(frame, len, &node_id, &seq)) {
+        hdr->magic = LORA_PROTO_RELAY_MAGIC;
+        hdr->hops = 0;
+        hdr->ttl = LORA_PROTO_RELAY_TTL;
+        hdr->node_id = node_id;
+        hdr->seq = seq;
+        *inner = frame;
+        *inner_len = len;
+        return hdr->node_id != 0;
+    }
+    return false;
+}
+
+// ============================
+// TEMPO NO AR
+// ============================
+
+/**
+ * @brief Tempo no ar de um pacote LoRa (cabeçalho explícito, CRC ligado) com
+ * qualquer modulação, conforme a seção 4.1.1.7 do datasheet do SX1276. Só
+ * usa aritmética inteira.
+ * @param sf Spreading factor (6..12).
+ * @param bw_hz Largura de banda em Hz.
+ * @param cr Taxa de codificação: 1 = 4/5 .. 4 = 4/8.
+ * @param ldro Low data rate optimize ligado.
+ * @param preamble Preâmbulo programado, em símbolos.
+ * @param payload_len Tamanho do payload em bytes.
+ * @return Duração do pacote em microssegundos.
+ */
+static inline uint32_t lora_airtime_us(uint8_t sf, uint32_t bw_hz, uint8_t cr, bool ldro, uint16_t preamble,
+                                       uint8_t payload_len) {
+    const uint32_t de = ldro ? 1 : 0;
+    const uint32_t symbol_us = (1000000UL << sf) / bw_hz;
+
+    // 8*PL - 4*SF + 28 + 16*CRC - 20*IH
+    int32_t num = 8 * (int32_t)payload_len - 4 * (int32_t)sf + 28 + 16;
+    int32_t den = 4 * (int32_t)(sf - 2 * de);
+    int32_t blocks = num > 0 ? (num + den - 1) / den : 0;
+    uint32_t payload_symbols = 8 + (uint32_t)blocks * (cr + 4u);
+
+    // Preâmbulo: (Npreamble + 4.25) símbolos, em quartos de símbolo
+    uint32_t quarter_symbols = (uint32_t)preamble * 4 + 17 + payload_symbols * 4;
+    return quarter_symbols * symbol_us / 4;
+}
+
+/**
+ * @brief Tempo no ar com a modulação comum (LORA_PROTO_*).
+ */
+static inline uint32_t lora_proto_airtime_us(uint16_t preamble, uint8_t payload_len) {
+    return lora_airtime_us(LORA_PROTO_SF, LORA_PROTO_BW_HZ, LORA_PROTO_CR, LORA_PROTO_LDRO, preamble, payload_len);
+}
+
+// ============================
+// SUPERQUADRO TDMA
+// ============================
+#define LORA_PROTO_TDMA_GUARD_US   20000 // erro de sincronismo + latência para iniciar o TX
+
+/**
+ * @brief Guarda em cada lado de um pacote: fixa mais 1/64 do tempo no ar,
+ * que cobre o drift residual do cristal durante a própria transmissão.
+ */
+static inline uint32_t lora_proto_guard_us(uint32_t airtime_us) {
+    return LORA_PROTO_TDMA_GUARD_US + airtime_us / 64;
+}
+
+/**
+ * @brief Duração de um slot de dados: uma amostra no ar mais as guardas.
+ */
+static inline uint32_t lora_proto_slot_us(void) {
+    uint32_t toa = lora_proto_airtime_us(LORA_PROTO_NODE_PREAMBLE, LORA_PROTO_SAMPLE_LEN);
+    return toa + 2 * lora_proto_guard_us(toa);
+}
+
+/**
+ * @brief Duração do slot do beacon (início do superquadro).
+ * @param beacon_len Tamanho total do beacon (cabeçalho + tabela).
+ */
+static inline uint32_t lora_proto_beacon_slot_us(uint8_t beacon_len) {
+    uint32_t toa = lora_proto_airtime_us(LORA_PROTO_PREAMBLE, beacon_len);
+    return toa + lora_proto_guard_us(toa);
+}
+
+/**
+ * @brief Duração total do superquadro: beacon + n_slots de dados + slot JOIN.
+ */
+static inline uint32_t lora_proto_superframe_us(uint8_t n_slots, uint32_t slot_us) {
+    return lora_proto_beacon_slot_us((uint8_t)(sizeof(lora_beacon_t) + n_slots)) + ((uint32_t)n_slots + 1) * slot_us;
+}
+
+#endif // LORA_PROTO_H_
@@ -0,0 +1,131 @@
+// lora_stream.h
+//
+// Saída binária do receptor (modo "bin" do console da BitDogLab). Cada
+// registro vai num quadro COBS delimitado por 0x00 antes e depois, para que
+// texto solto no fluxo nunca se junte a um quadro válido:
+//
+//   0x00 | COBS( registro | crc16 LE ) | 0x00
+//
+// O CRC é o CRC-16/CCITT-FALSE de common/crc16.h sobre o registro. O seq é
+// comum a todos os tipos de registro.
+
+#ifndef LORA_STREAM_H_
+#define LORA_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "crc16.h"
+
+// ============================
+// TIPOS DE REGISTRO
+// ============================
+#define LORA_STREAM_TYPE_PACKET    0x01  // pacote LoRa recebido
+#define LORA_STREAM_TYPE_CAPTURE   0x02  // recepção crua, para host/replay (comando "captura")
+#define LORA_STREAM_TYPE_LOG       0x03  // mensagem do log tokenizado (common/tlog_ring.h)
+
+// Flags de LORA_STREAM_TYPE_PACKET
+#define LORA_STREAM_FLAG_CRC_OK    0x01  // CRC do payload LoRa correto
+#define LORA_STREAM_FLAG_DUPLICATE 0x02  // cópia já vista (direto ou via repetidor)
+#define LORA_STREAM_FLAG_TRUNCATED 0x04  // payload maior que o buffer do receptor
+
+/**
+ * @brief Cabeçalho de um pacote recebido; seguido de len bytes de payload,
+ * exatamente como vieram do rádio (inclusive o cabeçalho de repetição).
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t type;           // LORA_STREAM_TYPE_PACKET
+    uint8_t flags;          // LORA_STREAM_FLAG_*
+    uint16_t seq;           // contador de registros, para o host detectar perdas
+    uint32_t rx_time_us;    // RxDone no relógio do receptor (time_us_32)
+    int32_t freq_error_hz;
+    int16_t rssi_dbm;
+    int8_t snr_qdb;         // SNR em passos de 0.25 dB
+    uint8_t len;            // bytes de payload
+} lora_stream_packet_t;
+
+// Janela de registradores lida em rajada após o RxDone (FIFO_RX_CURRENT_ADDR..FEI_LSB)
+#define LORA_CAPTURE_FIRST_REG     0x10
+#define LORA_CAPTURE_REGS          27
+
+/**
+ * @brief Captura de uma recepção: o que o driver leu do rádio, sem
+ * interpretação, para que host/replay reproduza as mesmas transações SPI.
+ * Seguido de len bytes do FIFO (os lidos pelo receptor, já truncados).
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t type;           // LORA_STREAM_TYPE_CAPTURE
+    uint8_t irq_flags;      // REG_IRQ_FLAGS no RxDone
+    uint16_t seq;
+    uint32_t rx_time_us;    // borda do DIO0 (time_us_32)
+    uint32_t header_time_us;
+    uint8_t regs[LORA_CAPTURE_REGS]; // registradores 0x10..0x2A na ordem lida
+    uint8_t len;            // bytes do FIFO
+} lora_stream_capture_t;
+
+/**
+ * @brief Mensagem do log tokenizado; seguida de nargs argumentos uint32_t
+ * (little-endian). O texto sai da tabela TLOG_MESSAGES no host.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t type;           // LORA_STREAM_TYPE_LOG
+    uint8_t id;             // índice em TLOG_MESSAGES
+    uint16_t seq;
+    uint32_t time_us;       // instante do ponto de log (time_us_32)
+    uint8_t nargs;
+} lora_stream_log_t;
+
+#define LORA_STREAM_MAX_RECORD (sizeof(lora_stream_capture_t) + 255 + 2)
+
+/**
+ * @brief Valida o CRC de um registro já decodificado do COBS.
+ * @return Tamanho do registro sem o CRC, ou 0 se inválido.
+ */
+static inline size_t lora_stream_check(const uint8_t *rec, size_t len) {
+    if (len < 3) return 0;
+    uint16_t crc = (uint16_t)(rec[len - 2] | rec[len - 1] << 8);
+    return crc16_ccitt(rec, len - 2) == crc ? len - 2 : 0;
+}
+
+/**
+ * @brief Interpreta um registro LORA_STREAM_TYPE_PACKET validado.
+ * @return false se o tipo ou o tamanho não conferem.
+ */
+static inline bool lora_stream_parse_packet(const uint8_t *rec, size_t len, lora_stream_packet_t *hdr,
+                                            const uint8_t **payload) {
+    if (len < sizeof(*hdr) || rec[0] != LORA_STREAM_TYPE_PACKET) return false;
+    memcpy(hdr, rec, sizeof(*hdr));
+    if (len != sizeof(*hdr) + hdr->len) return false;
+    *payload = rec + sizeof(*hdr);
+    return true;
+}
+
+/**
+ * @brief Interpreta um registro LORA_STREAM_TYPE_CAPTURE validado.
+ * @return false se o tipo ou o tamanho não conferem.
+ */
+static inline bool lora_stream_parse_capture(const uint8_t *rec, size_t len, lora_stream_capture_t *hdr,
+                                             const uint8_t **fifo) {
+    if (len < sizeof(*hdr) || rec[0] != LORA_STREAM_TYPE_CAPTURE) return false;
+    memcpy(hdr, rec, sizeof(*hdr));
+    if (len != sizeof(*hdr) + hdr->len) return false;
+    *fifo = rec + sizeof(*hdr);
+    return true;
+}
+
+/**
+ * @brief Interpreta um registro LORA_STREAM_TYPE_LOG validado.
+ * @param args Recebe até max_args argumentos.
+ * @return false se o tipo ou o tamanho não conferem.
+ */
+static inline bool lora_stream_parse_log(const uint8_t *rec, size_t len, lora_stream_log_t *hdr, uint32_t *args,
+                                         unsigned max_args) {
+    if (len < sizeof(*hdr) || rec[0] != LORA_STREAM_TYPE_LOG) return false;
+    memcpy(hdr, rec, sizeof(*hdr));
+    if (len != sizeof(*hdr) + hdr->nargs * sizeof(uint32_t) || hdr->nargs > max_args) return false;
+    memcpy(args, rec + sizeof(*hdr), hdr->nargs * sizeof(uint32_t));
+    return true;
+}
+
+#endif // LORA_STREAM_H_
@@ -0,0 +1,159 @@
+// lora_txq.h
+//
+// Fila de transmissão das duas placas: cada quadro é copiado uma vez para um
+// buffer de um pool fixo e espera, em ordem de prioridade (e de chegada
+// dentro da mesma prioridade), até o rádio terminar o anterior. Aqui fica só
+// a estrutura de dados; o driver de cada placa (lora_RFM95.c) alimenta o
+// rádio em lora_tx_service() com lora_txq_next() e lora_txq_finish().
+//
+// Quem envia recebe um identificador (geração << 8 | buffer) para consultar
+// o estado do quadro. Um buffer liberado só é reusado depois dos que foram
+// liberados antes dele, então o resultado de um quadro continua legível até
+// que LORA_TXQ_LEN outros quadros terminem; depois disso o identificador
+// passa a valer LORA_TXQ_UNKNOWN.
+//
+// Não é protegida contra reentrada: não usar em ISRs.
+
+#ifndef LORA_TXQ_H_
+#define LORA_TXQ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef LORA_TXQ_LEN
+#define LORA_TXQ_LEN 8   // buffers no pool (~264 bytes cada)
+#endif
+
+_Static_assert(LORA_TXQ_LEN < 255, "LORA_TXQ_LEN precisa caber num índice de 8 bits");
+
+#define LORA_TXQ_NONE 0xFF
+
+// Prioridades: menor sai primeiro
+enum {
+    LORA_TXQ_PRIO_HIGH,     // sincronismo (beacons, slots TDMA, JOIN)
+    LORA_TXQ_PRIO_NORMAL,   // amostras
+    LORA_TXQ_PRIO_LOW       // repasses e o que puder esperar
+};
+
+typedef uint16_t lora_txq_handle_t;   // 0 = quadro recusado
+
+typedef enum {
+    LORA_TXQ_UNKNOWN,   // identificador inválido ou buffer já reusado
+    LORA_TXQ_QUEUED,    // esperando o rádio
+    LORA_TXQ_SENDING,   // no ar
+    LORA_TXQ_SENT,      // TxDone recebido
+    LORA_TXQ_FAILED     // TxDone não veio (timeout) ou o rádio recusou
+} lora_txq_status_t;
+
+typedef struct {
+    uint32_t submitted;   // quadros aceitos
+    uint32_t sent;
+    uint32_t failed;
+    uint32_t rejected;    // pool cheio ou tamanho inválido
+    uint8_t used;         // buffers na fila ou no ar
+    uint8_t max_used;     // maior ocupação observada
+} lora_txq_stats_t;
+
+typedef struct {
+    uint8_t data[255];
+    uint8_t len;
+    uint8_t prio;
+    uint8_t status;       // lora_txq_status_t
+    uint8_t gen;          // 1..255, muda a cada uso do buffer
+    uint8_t next;         // próximo na fila, LORA_TXQ_NONE no fim
+    uint32_t released;    // ordem de liberação (reusa o mais antigo)
+} lora_txq_buf_t;
+
+typedef struct {
+    lora_txq_buf_t buf[LORA_TXQ_LEN];
+    uint8_t head;         // primeiro da fila
+    uint8_t sending;      // buffer no ar, LORA_TXQ_NONE se nenhum
+    uint32_t releases;
+    lora_txq_stats_t stats;
+} lora_txq_t;
+
+static inline void lora_txq_init(lora_txq_t *q) {
+    memset(q, 0, sizeof(*q));
+    q->head = q->sending = LORA_TXQ_NONE;
+}
+
+static inline bool lora_txq_buf_free(const lora_txq_buf_t *b) {
+    return b->status != LORA_TXQ_QUEUED && b->status != LORA_TXQ_SENDING;
+}
+
+/**
+ * @brief Copia o quadro para um buffer livre e o coloca na fila depois dos
+ * de prioridade igual ou maior.
+ * @return Identificador do quadro, 0 se o pool está cheio ou len inválido.
+ */
+static inline lora_txq_handle_t lora_txq_submit(lora_txq_t *q, const uint8_t *data, size_t len, uint8_t prio) {
+    int idx = -1;
+    if (len > 0 && len <= sizeof(q->buf[0].data)) {
+        for (int i = 0; i < LORA_TXQ_LEN; i++) {
+            const lora_txq_buf_t *b = &q->buf[i];
+            if (lora_txq_buf_free(b) && (idx < 0 || b->released < q->buf[idx].released)) idx = i;
+        }
+    }
+    if (idx < 0) {
+        q->stats.rejected++;
+        return 0;
+    }
+
+    lora_txq_buf_t *b = &q->buf[idx];
+    memcpy(b->data, data, len);
+    b->len = (uint8_t)len;
+    b->prio = prio;
+    b->status = LORA_TXQ_QUEUED;
+    b->gen = (uint8_t)(b->gen == 255 ? 1 : b->gen + 1);
+
+    uint8_t *p = &q->head;
+    while (*p != LORA_TXQ_NONE && q->buf[*p].prio <= prio) p = &q->buf[*p].next;
+    b->next = *p;
+    *p = (uint8_t)idx;
+
+    q->stats.submitted++;
+    if (++q->stats.used > q->stats.max_used) q->stats.max_used = q->stats.used;
+    return (lora_txq_handle_t)(b->gen << 8 | idx);
+}
+
+static inline lora_txq_status_t lora_txq_status(const lora_txq_t *q, lora_txq_handle_t h) {
+    unsigned idx = h & 0xFF;
+    if (h == 0 || idx >= LORA_TXQ_LEN || q->buf[idx].gen != (h >> 8)) return LORA_TXQ_UNKNOWN;
+    return (lora_txq_status_t)q->buf[idx].status;
+}
+
+/**
+ * @brief Tira da fila o próximo quadro a transmitir e o marca como no ar.
+ * @return NULL se já há um quadro no ar ou a fila está vazia.
+ */
+static inline const lora_txq_buf_t *lora_txq_next(lora_txq_t *q) {
+    if (q->sending != LORA_TXQ_NONE || q->head == LORA_TXQ_NONE) return NULL;
+    lora_txq_buf_t *b = &q->buf[q->head];
+    q->sending = q->head;
+    q->head = b->next;
+    b->status = LORA_TXQ_SENDING;
+    return b;
+}
+
+/**
+ * @brief Registra o fim do quadro no ar e libera o buffer.
+ */
+static inline void lora_txq_finish(lora_txq_t *q, bool ok) {
+    if (q->sending == LORA_TXQ_NONE) return;
+    lora_txq_buf_t *b = &q->buf[q->sending];
+    b->status = ok ? LORA_TXQ_SENT : LORA_TXQ_FAILED;
+    b->released = ++q->releases;
+    q->sending = LORA_TXQ_NONE;
+    q->stats.used--;
+    if (ok) q->stats.sent++;
+    else q->stats.failed++;
+}
+
+// Quadros na fila ou no ar
+static inline unsigned lora_txq_pending(const lora_txq_t *q) {
+    return q->stats.used;
+}
+
+#endif // LORA_TXQ_H_
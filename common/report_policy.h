@@ -0,0 +1,120 @@
+// report_policy.h
+//
+// Envio por exceção das amostras: o nó só transmite quando a temperatura ou a
+// umidade se afasta do último valor transmitido mais que a banda morta, ou
+// quando passa um heartbeat inteiro sem transmitir nada. O heartbeat vai em
+// cada quadro (LORA_PAYLOAD_REPORT), então o receptor sabe por quanto tempo o
+// silêncio de cada nó quer dizer "sem mudança": passados REPORT_STALE_MISSES
+// heartbeats sem quadro nenhum, o nó é dado como sem notícias.
+//
+// Só a decisão fica aqui (lógica pura): o firmware do FPGA a usa para
+// transmitir e o host/report_sim para medir o tempo no ar economizado em
+// capturas gravadas.
+
+#ifndef REPORT_POLICY_H_
+#define REPORT_POLICY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Padrões (centésimos, como nas amostras); o FPGA ajusta pelo console
+#ifndef REPORT_DEADBAND_TEMP
+#define REPORT_DEADBAND_TEMP  20    // 0,20 °C
+#endif
+#ifndef REPORT_DEADBAND_UMID
+#define REPORT_DEADBAND_UMID  100   // 1,00 %
+#endif
+#ifndef REPORT_HEARTBEAT_S
+#define REPORT_HEARTBEAT_S    600   // silêncio máximo
+#endif
+
+#define REPORT_STALE_MISSES   2     // heartbeats perdidos até o receptor desistir do valor
+
+typedef struct {
+    uint16_t deadband_temp;   // 0 = qualquer mudança transmite
+    uint16_t deadband_umid;
+    uint16_t heartbeat_s;     // 0 = sem heartbeat (só mudanças)
+} report_cfg_t;
+
+typedef enum {
+    REPORT_SKIP,        // dentro da banda morta e do heartbeat: não transmite
+    REPORT_FIRST,       // nada transmitido ainda
+    REPORT_CHANGE,      // saiu da banda morta
+    REPORT_HEARTBEAT    // silêncio chegou ao heartbeat
+} report_reason_t;
+
+typedef struct {
+    report_cfg_t cfg;
+    bool have_last;
+    int16_t last_temp, last_umid;   // último valor transmitido
+    uint32_t last_tx_ms;
+    uint32_t readings;              // amostras avaliadas
+    uint32_t sent[4];               // por report_reason_t (sent[REPORT_SKIP] = suprimidas)
+} report_policy_t;
+
+static inline void report_policy_init(report_policy_t *p, const report_cfg_t *cfg) {
+    memset(p, 0, sizeof(*p));
+    p->cfg = *cfg;
+}
+
+static inline report_cfg_t report_default_cfg(void) {
+    report_cfg_t cfg = { REPORT_DEADBAND_TEMP, REPORT_DEADBAND_UMID, REPORT_HEARTBEAT_S };
+    return cfg;
+}
+
+static inline bool report_outside(int16_t v, int16_t last, uint16_t deadband) {
+    int32_t d = (int32_t)v - last;
+    return (d < 0 ? -d : d) > (int32_t)deadband;
+}
+
+/**
+ * @brief Decide se a amostra deve ser transmitida e, se sim, a registra
+ * como o último valor transmitido.
+ * @param now_ms Relógio monotônico do nó (ou da captura), em ms.
+ */
+static inline report_reason_t report_policy_update(report_policy_t *p, int16_t temp, int16_t umid, uint32_t now_ms) {
+    report_reason_t r;
+    if (!p->have_last) r = REPORT_FIRST;
+    else if (report_outside(temp, p->last_temp, p->cfg.deadband_temp) ||
+             report_outside(umid, p->last_umid, p->cfg.deadband_umid)) r = REPORT_CHANGE;
+    else if (p->cfg.heartbeat_s && now_ms - p->last_tx_ms >= (uint32_t)p->cfg.heartbeat_s * 1000u) r = REPORT_HEARTBEAT;
+    else r = REPORT_SKIP;
+
+    p->readings++;
+    p->sent[r]++;
+    if (r != REPORT_SKIP) {
+        p->have_last = true;
+        p->last_temp = temp;
+        p->last_umid = umid;
+        p->last_tx_ms = now_ms;
+    }
+    return r;
+}
+
+/**
+ * @brief Esquece o último valor (a transmissão falhou): a próxima amostra sai.
+ */
+static inline void report_policy_forget(report_policy_t *p) {
+    p->have_last = false;
+}
+
+/**
+ * @brief Milissegundos até o próximo heartbeat, 0 se já venceu ou não há heartbeat.
+ */
+static inline uint32_t report_policy_heartbeat_in_ms(const report_policy_t *p, uint32_t now_ms) {
+    if (!p->have_last || !p->cfg.heartbeat_s) return 0;
+    uint32_t elapsed = now_ms - p->last_tx_ms;
+    uint32_t hb = (uint32_t)p->cfg.heartbeat_s * 1000u;
+    return elapsed >= hb ? 0 : hb - elapsed;
+}
+
+/**
+ * @brief Prazo, depois do último quadro recebido de um nó, até o receptor
+ * considerar o valor perdido.
+ */
+static inline uint32_t report_stale_after_ms(uint16_t heartbeat_s) {
+    return (uint32_t)heartbeat_s * 1000u * REPORT_STALE_MISSES;
+}
+
+#endif // REPORT_POLICY_H_
@@ -0,0 +1,125 @@
+// tlog_ring.h
+//
+// Log tokenizado para os caminhos quentes das duas placas. Em vez de chamar
+// printf (que no FPGA espera a UART e no RP2040 puxa a formatação), o ponto
+// de log grava só o ID da mensagem e até TLOG_MAX_ARGS argumentos inteiros
+// num anel em RAM; uma tarefa de fundo no laço principal esvazia o anel e o
+// host expande os IDs de volta em texto (host/tlog_decode, host/stream_decode).
+//
+// As mensagens ficam numa tabela única (TLOG_MESSAGES), compilada no host
+// junto com as ferramentas: o firmware só usa os IDs e as strings de formato
+// nem entram no binário. Novas mensagens só no fim, para que logs antigos
+// continuem decodificáveis. Os argumentos são inteiros de 32 bits (%d, %u,
+// %x, %c); ponto flutuante deve ir em ponto fixo.
+//
+// Saída do anel em texto, uma linha por mensagem:
+//
+//   @L <tempo_us, 8 dígitos hex> <id> [<arg hex> ...]
+//
+// Cada placa implementa tlog_write() e a tarefa de fundo no seu tlog.c. O
+// anel não é protegido contra reentrada: não usar em ISRs.
+
+#ifndef TLOG_RING_H_
+#define TLOG_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// ============================
+// MENSAGENS
+// ============================
+#define TLOG_MESSAGES(X) \
+    X(LOG_LOST,             "[LOG] %u mensagens perdidas (anel cheio)") \
+    X(LOG_LORA_TRUNCATED,   "[AVISO] Pacote de %u bytes truncado para %u.") \
+    X(LOG_LORA_CRC_ERROR,   "[LORA_LIB] Erro de CRC no pacote!") \
+    X(LOG_LORA_TX_BAD_LEN,  "Erro LoRa: Tamanho do pacote inválido (%d bytes)") \
+    X(LOG_LORA_TX_SENDING,  "Enviando %d bytes via LoRa...") \
+    X(LOG_LORA_TX_DONE,     "Pacote enviado com sucesso!") \
+    X(LOG_LORA_TX_TIMEOUT,  "Erro: Timeout de TX! O radio foi resetado para Standby.") \
+    X(LOG_AHT10_BUSY,       "Erro: AHT10 ainda ocupado.") \
+    X(LOG_TDMA_SLOT,        "TDMA: slot %d atribuido a este no.") \
+    X(LOG_TDMA_TX_ERROR,    "Erro durante o envio LoRa no slot %d.") \
+    X(LOG_BEACON_TX_ERROR,  "[AVISO] Falha ao enviar beacon de sincronismo.") \
+    X(LOG_BENCH,            "logbench %u: %d bytes, flags 0x%02x") \
+    X(LOG_NODE_STALE,       "No %u sem noticias ha %u s (heartbeat de %u s perdido).") \
+    X(LOG_NODE_BACK,        "No %u voltou a transmitir.") \
+    X(LOG_TDMA_JOIN_DROPPED, "TDMA: pedido de slot descartado (fila de transmissao cheia).")
+
+#define TLOG_ID_ENUM(id, fmt) id,
+enum { TLOG_MESSAGES(TLOG_ID_ENUM) TLOG_N_IDS };
+#undef TLOG_ID_ENUM
+
+#define TLOG_MAX_ARGS 3
+
+#ifndef TLOG_RING_LEN
+#define TLOG_RING_LEN 32   // potência de 2; 20 bytes por mensagem
+#endif
+
+_Static_assert((TLOG_RING_LEN & (TLOG_RING_LEN - 1)) == 0, "TLOG_RING_LEN precisa ser potência de 2");
+
+typedef struct {
+    uint32_t time_us;
+    uint8_t id;
+    uint8_t nargs;
+    uint32_t args[TLOG_MAX_ARGS];
+} tlog_entry_t;
+
+typedef struct {
+    tlog_entry_t ev[TLOG_RING_LEN];
+    uint32_t head, tail;     // contadores livres; cheio quando head - tail == TLOG_RING_LEN
+    uint32_t lost;           // mensagens descartadas desde a última LOG_LOST
+} tlog_ring_t;
+
+/**
+ * @brief Grava uma mensagem no anel. Com o anel cheio a mensagem é descartada
+ * (as já gravadas ficam, na ordem) e contada para uma LOG_LOST posterior.
+ */
+static inline void tlog_ring_push(tlog_ring_t *r, uint32_t time_us, uint8_t id, uint8_t nargs, const uint32_t *args) {
+    if (r->head - r->tail == TLOG_RING_LEN) {
+        r->lost++;
+        return;
+    }
+    tlog_entry_t *e = &r->ev[r->head & (TLOG_RING_LEN - 1)];
+    e->time_us = time_us;
+    e->id = id;
+    e->nargs = nargs > TLOG_MAX_ARGS ? TLOG_MAX_ARGS : nargs;
+    memcpy(e->args, args, e->nargs * sizeof(uint32_t));
+    r->head++;
+}
+
+/**
+ * @brief Retira a mensagem mais antiga. Depois de perdas, a primeira
+ * mensagem retirada é uma LOG_LOST com a quantidade.
+ * @return false se o anel está vazio.
+ */
+static inline bool tlog_ring_pop(tlog_ring_t *r, uint32_t time_us, tlog_entry_t *out) {
+    if (r->lost && r->head - r->tail < TLOG_RING_LEN) {
+        *out = (tlog_entry_t){ .time_us = time_us, .id = LOG_LOST, .nargs = 1, .args = { r->lost } };
+        r->lost = 0;
+        return true;
+    }
+    if (r->head == r->tail) return false;
+    *out = r->ev[r->tail & (TLOG_RING_LEN - 1)];
+    r->tail++;
+    return true;
+}
+
+// Conta os argumentos de TLOG (até TLOG_MAX_ARGS)
+#define TLOG_NARGS_(_id, _1, _2, _3, n, ...) n
+#define TLOG_NARGS(...) TLOG_NARGS_(__VA_ARGS__, 3, 2, 1, 0, 0)
+
+/**
+ * @brief Ponto de log: TLOG(LOG_LORA_TX_SENDING, len). O primeiro elemento do
+ * vetor é o ID; os argumentos são convertidos para uint32_t.
+ */
+#define TLOG(...) tlog_write(TLOG_NARGS(__VA_ARGS__), (const uint32_t[]){ __VA_ARGS__ })
+
+/**
+ * @brief Implementado por placa (anel próprio e relógio da placa).
+ * @param nargs Argumentos depois do ID.
+ * @param v v[0] = ID, v[1..nargs] = argumentos.
+ */
+void tlog_write(uint8_t nargs, const uint32_t *v);
+
+#endif // TLOG_RING_H_
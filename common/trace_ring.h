@@ -0,0 +1,141 @@
+// trace_ring.h
+//
+// Trace dos laços quentes das duas placas: eventos de início/fim com IDs
+// fixos em tempo de compilação, gravados num anel em RAM com o contador de
+// tempo da placa. O comando "trace" do console despeja o anel em texto e o
+// host/trace_json converte a saída capturada numa linha do tempo do
+// Chrome/Perfetto.
+//
+// Cada placa inclui este arquivo pelo seu trace.h, que define trace_now(),
+// TRACE_BOARD e TRACE_TICK_HZ antes. Com TRACE_ENABLED 0 (padrão) as macros
+// viram ((void)0) e nada do anel é compilado. As macros não podem ser usadas
+// em ISRs: o anel não é protegido contra reentrada.
+//
+// Formato do despejo (uma linha por evento, do mais antigo ao mais novo):
+//
+//   TRACE INICIO <placa> <ticks/s> <eventos> <sobrescritos>
+//   <ticks, 8 dígitos hex> <id> <B|E|i> <arg>
+//   TRACE FIM
+
+#ifndef TRACE_RING_H_
+#define TRACE_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+// ============================
+// EVENTOS
+// ============================
+// Novos IDs só no fim, para que despejos antigos continuem decodificáveis
+#define TRACE_EVENTS(X) \
+    X(LOOP,            "laco principal") \
+    X(LORA_INIT,       "lora_init") \
+    X(LORA_RX,         "lora_receive") \
+    X(LORA_TX,         "lora_send_bytes") \
+    X(LORA_FIFO_WRITE, "lora FIFO TX (SPI)") \
+    X(AHT10_READ,      "aht10_get_data") \
+    X(SSD1306_SHOW,    "ssd1306_show") \
+    X(DISPLAY_DRAW,    "desenho no display") \
+    X(FORMAT,          "formatacao de texto") \
+    X(STREAM_OUT,      "stream_out (USB)") \
+    X(FLASH_WRITE,     "flash (apagar/gravar)")
+
+#define TRACE_ID_ENUM(id, name) TRACE_ID_##id,
+enum { TRACE_EVENTS(TRACE_ID_ENUM) TRACE_N_IDS };
+#undef TRACE_ID_ENUM
+
+#define TRACE_KIND_BEGIN 'B'
+#define TRACE_KIND_END   'E'
+#define TRACE_KIND_MARK  'i'
+
+#if TRACE_ENABLED
+
+#include <stdio.h>
+
+#ifndef TRACE_RING_LEN
+#define TRACE_RING_LEN 512   // potência de 2; 8 bytes por evento
+#endif
+
+_Static_assert((TRACE_RING_LEN & (TRACE_RING_LEN - 1)) == 0, "TRACE_RING_LEN precisa ser potência de 2");
+
+typedef struct {
+    uint32_t ts;     // trace_now()
+    uint8_t id;      // TRACE_ID_*
+    uint8_t kind;    // TRACE_KIND_*
+    uint16_t arg;
+} trace_event_t;
+
+typedef struct {
+    trace_event_t ev[TRACE_RING_LEN];
+    uint32_t count;  // eventos gravados desde o último despejo
+    bool paused;
+} trace_ring_t;
+
+extern trace_ring_t trace_ring;
+
+// Define o anel; uma vez por firmware, fora de funções (sem ';' depois)
+#define TRACE_DEFINE_RING() trace_ring_t trace_ring;
+
+static inline void trace_push(uint8_t id, uint8_t kind, uint16_t arg) {
+    if (trace_ring.paused) return;
+    trace_event_t *e = &trace_ring.ev[trace_ring.count++ & (TRACE_RING_LEN - 1)];
+    e->ts = trace_now();
+    e->id = id;
+    e->kind = kind;
+    e->arg = arg;
+}
+
+// Fecha o evento; se nada foi gravado desde o início, apaga o início, para
+// que as voltas ociosas dos laços não ocupem o anel
+static inline void trace_end_or_drop(uint8_t id) {
+    uint32_t n = trace_ring.count;
+    if (n && !trace_ring.paused) {
+        const trace_event_t *last = &trace_ring.ev[(n - 1) & (TRACE_RING_LEN - 1)];
+        if (last->id == id && last->kind == TRACE_KIND_BEGIN) {
+            trace_ring.count = n - 1;
+            return;
+        }
+    }
+    trace_push(id, TRACE_KIND_END, 0);
+}
+
+/**
+ * @brief Despeja o anel no console e o esvazia. Saem os últimos
+ * TRACE_RING_LEN - 1 eventos (a posição mais antiga pode ter sido reusada
+ * por um início apagado em trace_end_or_drop).
+ */
+static inline void trace_dump(void) {
+    trace_ring.paused = true;
+    uint32_t n = trace_ring.count;
+    uint32_t keep = n < TRACE_RING_LEN ? n : TRACE_RING_LEN - 1;
+    printf("TRACE INICIO %s %lu %lu %lu\n", TRACE_BOARD, (unsigned long)TRACE_TICK_HZ, (unsigned long)keep,
+           (unsigned long)(n - keep));
+    for (uint32_t i = n - keep; i != n; i++) {
+        const trace_event_t *e = &trace_ring.ev[i & (TRACE_RING_LEN - 1)];
+        printf("%08lx %u %c %u\n", (unsigned long)e->ts, e->id, e->kind, e->arg);
+    }
+    printf("TRACE FIM\n");
+    trace_ring.count = 0;
+    trace_ring.paused = false;
+}
+
+#define TRACE_BEGIN(id)        trace_push(TRACE_ID_##id, TRACE_KIND_BEGIN, 0)
+#define TRACE_END(id)          trace_push(TRACE_ID_##id, TRACE_KIND_END, 0)
+#define TRACE_END_OR_DROP(id)  trace_end_or_drop(TRACE_ID_##id)
+#define TRACE_MARK(id, arg)    trace_push(TRACE_ID_##id, TRACE_KIND_MARK, (uint16_t)(arg))
+
+#else
+
+#define TRACE_DEFINE_RING()
+#define TRACE_BEGIN(id)        ((void)0)
+#define TRACE_END(id)          ((void)0)
+#define TRACE_END_OR_DROP(id)  ((void)0)
+#define TRACE_MARK(id, arg)    ((void)0)
+
+#endif // TRACE_ENABLED
+
+#endif // TRACE_RING_H_
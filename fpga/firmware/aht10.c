@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <generated/csr.h>
 #include <system.h> 
+#include "trace.h"
+#include "tlog.h"
 
 static void busy_wait_ms(unsigned int ms) {
     for (unsigned int i = 0; i < ms; ++i) {
@@ -111,24 +113,28 @@ int aht10_init(void) {
     return 0;
 }
 
-bool aht10_get_data(dados *d) {
-    uint8_t data[6];
-    uint32_t raw_hum, raw_temp;
-    
-    // 1. Dispara a medição
+bool aht10_start_measure(void) {
+    TRACE_BEGIN(AHT10_READ);
     i2c_start();
-    if (!i2c_write_byte(AHT10_I2C_ADDR << 1 | 0)) { i2c_stop(); return false; } // Escrita
-    if (!i2c_write_byte(0xAC)) { i2c_stop(); return false; }
-    if (!i2c_write_byte(0x33)) { i2c_stop(); return false; }
-    if (!i2c_write_byte(0x00)) { i2c_stop(); return false; }
+    bool ok = i2c_write_byte(AHT10_I2C_ADDR << 1 | 0) && // Escrita
+              i2c_write_byte(0xAC) && i2c_write_byte(0x33) && i2c_write_byte(0x00);
     i2c_stop();
+    TRACE_END(AHT10_READ);
+    return ok;
+}
 
-    // 2. Espera pela medição
-    busy_wait_ms(80);
+bool aht10_read_result(dados *d) {
+    uint8_t data[6];
+    uint32_t raw_hum, raw_temp;
 
-    // 3. Lê os 6 bytes de dados
+    TRACE_BEGIN(AHT10_READ);
+    // 1. Lê os 6 bytes de dados
     i2c_start();
-    if (!i2c_write_byte(AHT10_I2C_ADDR << 1 | 1)) { i2c_stop(); return false; } // Leitura
+    if (!i2c_write_byte(AHT10_I2C_ADDR << 1 | 1)) { // Leitura
+        i2c_stop();
+        TRACE_END(AHT10_READ);
+        return false;
+    }
     data[0] = i2c_read_byte(true);
     data[1] = i2c_read_byte(true);
     data[2] = i2c_read_byte(true);
@@ -136,14 +142,15 @@ bool aht10_get_data(dados *d) {
     data[4] = i2c_read_byte(true);
     data[5] = i2c_read_byte(false); // NACK
     i2c_stop();
+    TRACE_END(AHT10_READ);
 
-    // 4. Verifica o bit de "busy"
+    // 2. Verifica o bit de "busy"
     if (data[0] & 0x80) {
-        printf("Erro: AHT10 ainda ocupado.\n");
+        TLOG(LOG_AHT10_BUSY);
         return false;
     }
 
-    // 5. Calcula os valores
+    // 3. Calcula os valores
     raw_hum = ((uint32_t)data[1] << 12) | ((uint32_t)data[2] << 4) | (data[3] >> 4);
     raw_temp = (((uint32_t)data[3] & 0x0F) << 16) | ((uint32_t)data[4] << 8) | data[5];
 
@@ -156,6 +163,13 @@ bool aht10_get_data(dados *d) {
     return true;
 }
 
+bool aht10_get_data(dados *d) {
+    // Dispara, espera a conversão e lê
+    if (!aht10_start_measure()) return false;
+    busy_wait_ms(AHT10_MEASURE_MS);
+    return aht10_read_result(d);
+}
+
 void aht10_read(void) {
     dados my_data;
     printf("Lendo AHT10 (modo debug)...\n");
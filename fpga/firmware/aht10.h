@@ -30,13 +30,31 @@ void i2c_scan(void);
  */
 int aht10_init(void);
 
+// Tempo de conversão entre aht10_start_measure() e aht10_read_result()
+#define AHT10_MEASURE_MS 80
+
+/**
+ * @brief Dispara uma medição (comando 0xAC) sem esperar a conversão.
+ * @return false se o sensor não respondeu.
+ */
+bool aht10_start_measure(void);
+
+/**
+ * @brief Lê o resultado da medição disparada por aht10_start_measure(),
+ * pelo menos AHT10_MEASURE_MS depois.
+ * @param d Ponteiro para a struct 'dados' onde os resultados serão armazenados.
+ * @return false se o sensor não respondeu ou ainda está ocupado.
+ */
+bool aht10_read_result(dados *d);
+
 /**
  * @brief Lê o sensor AHT10 e imprime os valores formatados (Debug).
  */
 void aht10_read(void);
 
 /**
- * @brief Obtém os dados de temperatura e umidade do AHT10.
+ * @brief Obtém os dados de temperatura e umidade do AHT10 (bloqueia
+ * AHT10_MEASURE_MS; no laço do escalonador use as duas metades acima).
  * @param d Ponteiro para a struct 'dados' onde os resultados serão armazenados.
  * @return true em sucesso, false em falha.
  */
@@ -0,0 +1,206 @@
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+#include <generated/csr.h>
+#include <generated/soc.h>
+
+#include "aht10.h"
+#include "filter.h"
+#include "lora_RFM95.h"
+#include "lora_proto.h"
+#include "tick.h"
+
+#ifndef CONFIG_CPU_HUMAN_NAME
+#define CONFIG_CPU_HUMAN_NAME "?"
+#endif
+
+#define REG_FIFO_ADDR_PTR 0x0D
+#define REG_PREAMBLE_MSB  0x20
+#define REG_PREAMBLE_LSB  0x21
+#define REG_VERSION       0x42
+
+#define REG_REPS   256
+#define FIFO_REPS  16
+#define SLOW_REPS  4     // lora_init e aht10_get_data (80 ms cada)
+#define TOA_REPS   2
+#define TOA_BYTES  16
+
+typedef struct {
+    unsigned n, failures;
+    uint64_t min, max, sum;
+} bench_stat_t;
+
+// Custo de um par de leituras de tick_cycles(), descontado de cada amostra
+static uint64_t overhead;
+
+static void stat_add(bench_stat_t *s, uint64_t cycles) {
+    cycles = cycles > overhead ? cycles - overhead : 0;
+    if (s->n == 0 || cycles < s->min) s->min = cycles;
+    if (cycles > s->max) s->max = cycles;
+    s->sum += cycles;
+    s->n++;
+}
+
+static uint64_t cycles_to_ns(uint64_t cycles) {
+    return cycles * 1000 / (CONFIG_CLOCK_FREQUENCY / 1000000);
+}
+
+static void print_op(const char *name, const bench_stat_t *s) {
+    uint64_t mean = s->n ? s->sum / s->n : 0;
+    printf("BENCH,op,%s,%u,%u,%lu,%lu,%lu,%lu\n", name, s->n, s->failures, (unsigned long)s->min,
+           (unsigned long)mean, (unsigned long)s->max, (unsigned long)cycles_to_ns(mean));
+}
+
+static void bench_soc(void) {
+    unsigned long spi_hz = 0;
+#ifdef CSR_SPI_CLK_DIVIDER_ADDR
+    uint32_t div = spi_clk_divider_read();
+    if (div) spi_hz = CONFIG_CLOCK_FREQUENCY / div;
+#endif
+#ifdef CSR_TIMER0_UPTIME_CYCLES_ADDR
+    const char *tick = "timer0_uptime";
+#else
+    const char *tick = "rdcycle";
+#endif
+    printf("BENCH,#soc,cpu,sys_clk_hz,spi_clk_hz,tick\n");
+    printf("BENCH,soc,%s,%lu,%lu,%s\n", CONFIG_CPU_HUMAN_NAME, (unsigned long)CONFIG_CLOCK_FREQUENCY, spi_hz, tick);
+}
+
+static void bench_ops(void) {
+    static uint8_t fifo[255];
+    bench_stat_t s;
+    uint64_t t0;
+
+    // Custo da própria medição (mínimo de pares vazios)
+    overhead = 0;
+    memset(&s, 0, sizeof(s));
+    for (int i = 0; i < REG_REPS; i++) {
+        t0 = tick_cycles();
+        stat_add(&s, tick_cycles() - t0);
+    }
+    printf("BENCH,#op,nome,n,falhas,min_ciclos,media_ciclos,max_ciclos,media_ns\n");
+    print_op("tick_cycles", &s);
+    overhead = s.min;
+
+    memset(&s, 0, sizeof(s));
+    for (int i = 0; i < REG_REPS; i++) {
+        t0 = tick_cycles();
+        (void)lora_read_reg(REG_VERSION);
+        stat_add(&s, tick_cycles() - t0);
+    }
+    print_op("spi_read_reg", &s);
+
+    memset(&s, 0, sizeof(s));
+    for (int i = 0; i < REG_REPS; i++) {
+        t0 = tick_cycles();
+        lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+        stat_add(&s, tick_cycles() - t0);
+    }
+    print_op("spi_write_reg", &s);
+
+    memset(&s, 0, sizeof(s));
+    lora_set_mode(0x01); // Standby: o FIFO não é acessível em Sleep
+    for (int i = 0; i < FIFO_REPS; i++) {
+        lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+        t0 = tick_cycles();
+        lora_write_fifo(fifo, sizeof(fifo));
+        stat_add(&s, tick_cycles() - t0);
+    }
+    print_op("fifo_write_255", &s);
+
+    memset(&s, 0, sizeof(s));
+    for (int i = 0; i < SLOW_REPS; i++) {
+        t0 = tick_cycles();
+        bool ok = lora_init();
+        stat_add(&s, tick_cycles() - t0);
+        if (!ok) s.failures++;
+    }
+    print_op("lora_init", &s);
+
+    memset(&s, 0, sizeof(s));
+    for (int i = 0; i < SLOW_REPS; i++) {
+        dados d;
+        t0 = tick_cycles();
+        bool ok = aht10_get_data(&d);
+        stat_add(&s, tick_cycles() - t0);
+        if (!ok) s.failures++;
+    }
+    print_op("aht10_get_data", &s);
+
+    // Filtro padrão, uma conversão por chamada (entrada sintética com um
+    // pico a cada 16 para a mediana trabalhar)
+    filter_chan_t f;
+    filter_cfg_t cfg = FILTER_DEFAULT_CFG;
+    filter_init(&f, &cfg);
+    memset(&s, 0, sizeof(s));
+    for (int i = 0; i < REG_REPS; i++) {
+        int16_t raw = (int16_t)(2500 + (i & 7) - ((i & 15) == 0 ? 3000 : 0)), out;
+        t0 = tick_cycles();
+        (void)filter_push(&f, raw, &out);
+        stat_add(&s, tick_cycles() - t0);
+    }
+    print_op("filter_push", &s);
+}
+
+// Tempo no ar medido (MODE_TX -> TxDone) contra o calculado, por perfil
+static void bench_toa(void) {
+    printf("BENCH,#toa,sf,bw_hz,cr,ldro,bytes,esperado_us,medido_us,erro_us\n");
+    if (lora_read_reg(REG_VERSION) != 0x12) {
+        printf("BENCH,toa,sem_radio\n");
+        return;
+    }
+
+    lora_modem_t saved;
+    lora_get_modem(&saved);
+
+    // A modulação programada pelo lora_init tem que ser a que as contas de
+    // tempo no ar, slots e guardas supõem (LORA_PROTO_*)
+    bool proto_ok = saved.sf == LORA_PROTO_SF && saved.bw_hz == LORA_PROTO_BW_HZ && saved.cr == LORA_PROTO_CR &&
+                    saved.ldro == LORA_PROTO_LDRO;
+    printf("BENCH,#modem,sf,bw_hz,cr,ldro,lora_proto\n");
+    printf("BENCH,modem,%u,%lu,%u,%u,%s\n", saved.sf, (unsigned long)saved.bw_hz, saved.cr, saved.ldro,
+           proto_ok ? "ok" : "diferente");
+    const lora_modem_t profiles[] = {
+        saved,                                                          // o que o lora_init programou
+        { .sf = 7,  .bw_hz = 125000, .cr = 1 },
+        { .sf = 9,  .bw_hz = 125000, .cr = 1 },
+        { .sf = LORA_PROTO_SF, .bw_hz = LORA_PROTO_BW_HZ, .cr = LORA_PROTO_CR }, // modulação comum
+    };
+    uint16_t preamble = (uint16_t)(lora_read_reg(REG_PREAMBLE_MSB) << 8 | lora_read_reg(REG_PREAMBLE_LSB));
+    uint8_t payload[TOA_BYTES];
+    for (unsigned i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t)i;
+
+    for (unsigned p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+        lora_modem_t m;
+        if (!lora_set_modem(&profiles[p])) continue;
+        lora_get_modem(&m); // LDRO decidido pelo driver
+        uint32_t expected = lora_airtime_us(m.sf, m.bw_hz, m.cr, m.ldro, preamble, TOA_BYTES);
+        uint64_t sum = 0;
+        unsigned ok = 0;
+        for (int r = 0; r < TOA_REPS; r++) {
+            uint64_t cycles;
+            if (lora_send_timed(payload, TOA_BYTES, &cycles)) {
+                sum += cycles;
+                ok++;
+            }
+        }
+        if (ok == 0) {
+            printf("BENCH,toa,%u,%lu,%u,%u,%u,%lu,timeout,\n", m.sf, (unsigned long)m.bw_hz, m.cr, m.ldro, TOA_BYTES,
+                   (unsigned long)expected);
+            continue;
+        }
+        uint32_t measured = (uint32_t)(cycles_to_ns(sum / ok) / 1000);
+        printf("BENCH,toa,%u,%lu,%u,%u,%u,%lu,%lu,%ld\n", m.sf, (unsigned long)m.bw_hz, m.cr, m.ldro, TOA_BYTES,
+               (unsigned long)expected, (unsigned long)measured, (long)measured - (long)expected);
+    }
+
+    lora_set_modem(&saved);
+    lora_start_rx_continuous();
+}
+
+void bench_run(void) {
+    bench_soc();
+    bench_ops();
+    bench_toa();
+    printf("BENCH,fim\n");
+}
@@ -0,0 +1,32 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/**
+ * @brief Mede no alvo o custo das primitivas do nó (comando "bench"):
+ * leitura e escrita de registrador pelo SPI, escrita de 255 bytes no FIFO,
+ * lora_init, aht10_get_data e o tempo no ar de fato de alguns perfis de
+ * modem (transmite pacotes de teste). Tudo em ciclos de tick_cycles().
+ *
+ * A saída é uma tabela CSV com linhas prefixadas por "BENCH," (o resto do
+ * console pode ser ignorado com grep), para comparar builds do SoC:
+ *
+ *   BENCH,soc,<cpu>,<sys_clk_hz>,<spi_clk_hz>,<timer0_uptime|rdcycle>
+ *   BENCH,op,<nome>,<n>,<falhas>,<min>,<media>,<max>,<media_ns>
+ *   BENCH,modem,<sf>,<bw_hz>,<cr>,<ldro>,<ok|diferente>
+ *   BENCH,toa,<sf>,<bw_hz>,<cr>,<ldro>,<bytes>,<esperado_us>,<medido_us>,<erro_us>
+ *   BENCH,toa,<sf>,<bw_hz>,<cr>,<ldro>,<bytes>,<esperado_us>,timeout,
+ *   BENCH,toa,sem_radio
+ *   BENCH,fim
+ *
+ * "modem" é a modulação que o lora_init deixou programada; o último campo
+ * diz se ela bate com a LORA_PROTO_* das contas de slot e guarda. Há uma
+ * linha "toa" por perfil aceito; quando nenhum TxDone chega, o medido vem
+ * como "timeout" e o erro fica vazio. Sem SX1276 (REG_VERSION != 0x12) sai
+ * só "toa,sem_radio", sem linhas "modem" nem de perfis.
+ *
+ * Linhas "BENCH,#..." trazem os nomes das colunas. O rádio volta à
+ * modulação anterior e à recepção contínua no fim.
+ */
+void bench_run(void);
+
+#endif
@@ -0,0 +1,81 @@
+#include "filter.h"
+#include <string.h>
+
+void filter_init(filter_chan_t *f, const filter_cfg_t *cfg) {
+    memset(f, 0, sizeof(*f));
+    f->cfg = *cfg;
+    if (f->cfg.median_n < 1) f->cfg.median_n = 1;
+    if (f->cfg.median_n > FILTER_MEDIAN_MAX) f->cfg.median_n = FILTER_MEDIAN_MAX;
+    if ((f->cfg.median_n & 1) == 0) f->cfg.median_n--;
+    if (f->cfg.oversample < 1) f->cfg.oversample = 1;
+    if (f->cfg.oversample > FILTER_OVERSAMPLE_MAX) f->cfg.oversample = FILTER_OVERSAMPLE_MAX;
+    if (f->cfg.ema_shift > FILTER_EMA_MAX_SHIFT) f->cfg.ema_shift = FILTER_EMA_MAX_SHIFT;
+}
+
+int16_t filter_median(const int16_t *v, uint8_t n) {
+    // Inserção numa cópia: n <= 7, mais barato que qualquer seleção
+    int16_t s[FILTER_MEDIAN_MAX];
+    for (uint8_t i = 0; i < n; i++) {
+        int16_t x = v[i];
+        uint8_t j = i;
+        while (j > 0 && s[j - 1] > x) {
+            s[j] = s[j - 1];
+            j--;
+        }
+        s[j] = x;
+    }
+    return s[n / 2];
+}
+
+// Divisão com arredondamento para o mais próximo (simétrica em torno de 0)
+static int32_t div_round(int32_t num, int32_t den) {
+    return num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+
+bool filter_push(filter_chan_t *f, int16_t raw, int16_t *out) {
+    const filter_cfg_t *c = &f->cfg;
+
+    // Mediana: até a janela encher, usa as conversões que já chegaram (com
+    // número par, a mediana é a do conjunto sem a mais antiga)
+    f->window[f->pos] = raw;
+    f->pos = (uint8_t)(f->pos + 1 == c->median_n ? 0 : f->pos + 1);
+    if (f->filled < c->median_n) f->filled++;
+    int16_t med = raw;
+    if (c->median_n > 1) {
+        uint8_t n = (uint8_t)(f->filled | 1);
+        if (n > f->filled) n -= 2;
+        // As n mais recentes terminam em pos - 1 no anel
+        int16_t recent[FILTER_MEDIAN_MAX];
+        for (uint8_t i = 0; i < n; i++) {
+            int idx = (int)f->pos - 1 - i;
+            if (idx < 0) idx += c->median_n;
+            recent[i] = f->window[idx];
+        }
+        med = filter_median(recent, n);
+    }
+
+    // Sobreamostragem: média de oversample medianas
+    f->acc += med;
+    if (++f->acc_n < c->oversample) return false;
+    int32_t avg = div_round(f->acc, c->oversample);
+    f->acc = 0;
+    f->acc_n = 0;
+
+    // EMA em ponto fixo: ema += (x - ema) / 2^shift
+    int32_t x = avg * (1 << FILTER_EMA_FRAC);
+    if (!f->ema_primed || c->ema_shift == 0) {
+        f->ema = x;
+        f->ema_primed = true;
+    } else {
+        f->ema += (x - f->ema) >> c->ema_shift; // >> aritmético em negativos (gcc)
+    }
+    int32_t y = f->ema >= 0 ? (f->ema + (1 << (FILTER_EMA_FRAC - 1))) >> FILTER_EMA_FRAC
+                            : -((-f->ema + (1 << (FILTER_EMA_FRAC - 1))) >> FILTER_EMA_FRAC);
+    *out = (int16_t)y;
+    return true;
+}
+
+void filter_abort(filter_chan_t *f) {
+    f->acc = 0;
+    f->acc_n = 0;
+}
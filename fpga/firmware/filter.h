@@ -0,0 +1,69 @@
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================
+// FILTRO DAS LEITURAS DO AHT10
+// ============================
+// Entre o sensor e o rádio, por canal (temperatura e umidade, em centésimos),
+// só com aritmética inteira (o VexRiscv não tem FPU):
+//
+//   conversão -> mediana das últimas median_n -> média de oversample
+//             -> EMA (alfa = 1/2^ema_shift) -> amostra enviada
+//
+// A mediana descarta leituras absurdas do barramento bit-bang antes que
+// entrem na média; a sobreamostragem faz oversample conversões por amostra
+// enviada (decimação); a EMA suaviza entre amostras enviadas. Com median_n,
+// oversample e ema_shift iguais a 1, 1 e 0 o filtro deixa a leitura passar.
+
+#define FILTER_MEDIAN_MAX    7    // janela máxima da mediana (ímpar)
+#define FILTER_OVERSAMPLE_MAX 16
+#define FILTER_EMA_MAX_SHIFT 6
+#define FILTER_EMA_FRAC      8    // bits fracionários do estado da EMA
+
+typedef struct {
+    uint8_t median_n;     // 1 (desligada), 3, 5 ou 7
+    uint8_t oversample;   // conversões por amostra enviada (1..FILTER_OVERSAMPLE_MAX)
+    uint8_t ema_shift;    // 0 = sem EMA
+} filter_cfg_t;
+
+// Padrão: mediana de 3, 4 conversões por amostra, EMA com alfa 1/2
+#define FILTER_DEFAULT_CFG { 3, 4, 1 }
+
+typedef struct {
+    filter_cfg_t cfg;
+    int16_t window[FILTER_MEDIAN_MAX];   // últimas conversões (anel)
+    uint8_t filled, pos;
+    uint8_t acc_n;                       // conversões já somadas nesta amostra
+    int32_t acc;
+    int32_t ema;                         // Q(FILTER_EMA_FRAC)
+    bool ema_primed;
+} filter_chan_t;
+
+/**
+ * @brief Ajusta a configuração (fora da faixa vai para o limite mais
+ * próximo; mediana par vira a ímpar abaixo) e zera o estado.
+ */
+void filter_init(filter_chan_t *f, const filter_cfg_t *cfg);
+
+/**
+ * @brief Entrega uma conversão ao filtro.
+ * @param out Recebe a amostra filtrada quando o retorno é true.
+ * @return true a cada cfg.oversample conversões.
+ */
+bool filter_push(filter_chan_t *f, int16_t raw, int16_t *out);
+
+/**
+ * @brief Descarta a amostra em andamento (conversões já somadas), por
+ * exemplo depois de uma falha de leitura. A janela da mediana e a EMA ficam.
+ */
+void filter_abort(filter_chan_t *f);
+
+/**
+ * @brief Mediana de n valores (n <= FILTER_MEDIAN_MAX), sem alterar a entrada.
+ */
+int16_t filter_median(const int16_t *v, uint8_t n);
+
+#endif
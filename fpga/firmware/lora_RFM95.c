@@ -1,10 +1,19 @@
 #include "lora_RFM95.h"
+#include "lora_proto.h"
 #include <stdio.h>
 #include <string.h>
 #include <generated/csr.h>
+#include <generated/soc.h>
 #include <system.h>
+#include "trace.h"
+#include "tlog.h"
+#include "tick.h"
 
 #define TX_TIMEOUT_MS 5000
+// O slot TDMA que a BitDogLab reserva é medido com LORA_PROTO_NODE_PREAMBLE:
+// um preâmbulo diferente faria cada amostra invadir o slot seguinte
+_Static_assert(LORA_PREAMBLE_LEN == LORA_PROTO_NODE_PREAMBLE,
+               "LORA_PREAMBLE_LEN diferente de LORA_PROTO_NODE_PREAMBLE: redefina o de lora_proto.h");
 #define SPI_MODE_MANUAL (1 << 16)
 #define SPI_CS_MASK     0x0001 
 #define REG_FIFO                 0x00
@@ -18,7 +27,9 @@
 #define REG_FIFO_TX_BASE_ADDR    0x0E
 #define REG_FIFO_RX_BASE_ADDR    0x0F
 #define REG_IRQ_FLAGS_MASK       0x11
+#define REG_FIFO_RX_CURRENT_ADDR 0x10
 #define REG_IRQ_FLAGS            0x12
+#define REG_RX_NB_BYTES          0x13
 #define REG_MODEM_CONFIG_1       0x1D
 #define REG_MODEM_CONFIG_2       0x1E
 #define REG_PREAMBLE_MSB         0x20
@@ -33,14 +44,17 @@
 #define MODE_SLEEP               0x00
 #define MODE_STDBY               0x01
 #define MODE_TX                  0x03
+#define MODE_RX_CONTINUOUS       0x05
 #define IRQ_TX_DONE_MASK         0x08
+#define IRQ_PAYLOAD_CRC_ERROR_MASK 0x20
+#define IRQ_RX_DONE_MASK         0x40
 
 static void busy_wait_ms_local(unsigned int ms);
 static void spi_master_init(void);
 static inline void spi_select(void);
 static inline void spi_deselect(void);
 static inline uint8_t spi_txrx(uint8_t tx_byte);
-static void lora_write_fifo(const uint8_t *data, uint8_t len);
+static void lora_read_fifo(uint8_t *data, uint8_t len);
 
 static void busy_wait_ms_local(unsigned int ms) {
     for (unsigned int i = 0; i < ms; ++i) {
@@ -86,7 +100,7 @@ static inline uint8_t spi_txrx(uint8_t tx_byte) {
 }
 
 
-static void lora_write_fifo(const uint8_t *data, uint8_t len) {
+void lora_write_fifo(const uint8_t *data, uint8_t len) {
     spi_select();
     spi_txrx(REG_FIFO | 0x80);
     for (uint8_t i = 0; i < len; i++) {
@@ -95,6 +109,15 @@ static void lora_write_fifo(const uint8_t *data, uint8_t len) {
     spi_deselect();
 }
 
+static void lora_read_fifo(uint8_t *data, uint8_t len) {
+    spi_select();
+    spi_txrx(REG_FIFO & 0x7F);
+    for (uint8_t i = 0; i < len; i++) {
+        data[i] = spi_txrx(0x00);
+    }
+    spi_deselect();
+}
+
 uint8_t lora_read_reg(uint8_t reg) {
     uint8_t val;
     spi_select();
@@ -120,6 +143,8 @@ void lora_set_mode(uint8_t mode) {
 
 // Inicializa LoRa (pública)
 bool lora_init(void) {
+    TRACE_BEGIN(LORA_INIT);
+
     // 1. Inicializa o barramento SPI primeiro
     spi_master_init();
 
@@ -135,6 +160,7 @@ bool lora_init(void) {
     rx = lora_read_reg(REG_VERSION);
     if (rx != 0x12) {
         printf("Falha na comunicação\n");
+        TRACE_END(LORA_INIT);
         return false; // Falha na inicialização
     }
 
@@ -147,11 +173,11 @@ bool lora_init(void) {
     lora_write_reg(REG_FRF_LSB, (uint8_t)(frf >> 0));
     lora_write_reg(REG_PA_CONFIG, 0xFF); 
     lora_write_reg(REG_PA_DAC, 0x87);
-    lora_write_reg(REG_MODEM_CONFIG_1, 0x78); 
-    lora_write_reg(REG_MODEM_CONFIG_2, 0xC4); 
-    lora_write_reg(REG_MODEM_CONFIG_3, 0x0C);
-    lora_write_reg(REG_PREAMBLE_MSB, 0x00);
-    lora_write_reg(REG_PREAMBLE_LSB, 0x0C);
+    lora_write_reg(REG_MODEM_CONFIG_1, LORA_PROTO_MODEM_CONFIG_1); // modulação comum (lora_proto.h)
+    lora_write_reg(REG_MODEM_CONFIG_2, LORA_PROTO_MODEM_CONFIG_2);
+    lora_write_reg(REG_MODEM_CONFIG_3, LORA_PROTO_MODEM_CONFIG_3);
+    lora_write_reg(REG_PREAMBLE_MSB, (uint8_t)(LORA_PREAMBLE_LEN >> 8));
+    lora_write_reg(REG_PREAMBLE_LSB, (uint8_t)(LORA_PREAMBLE_LEN & 0xFF));
     lora_write_reg(REG_SYNC_WORD, 0x12);  
     lora_write_reg(REG_OCP, 0x37);  
     lora_write_reg(REG_FIFO_TX_BASE_ADDR, 0x00);
@@ -162,52 +188,210 @@ bool lora_init(void) {
     lora_set_mode(MODE_STDBY);
     busy_wait_ms_local(10);
 
-    printf("Modulacao: BW=62.5kHz, SF=12, CR=4/8, Preamble=12, SyncWord=0x12\n");
+    printf("Modulacao: BW=%luHz, SF=%d, CR=4/%d, Preamble=%d, SyncWord=0x12\n", (unsigned long)LORA_PROTO_BW_HZ,
+           LORA_PROTO_SF, LORA_PROTO_CR + 4, LORA_PREAMBLE_LEN);
 
+    TRACE_END(LORA_INIT);
     return true; 
 }
 
 
-// Envia bytes
+// Transmissão em andamento (lora_tx_start/lora_tx_poll)
+static bool tx_busy = false;
+static uint64_t tx_deadline;    // tick_cycles()
+
+// Fila de quadros (lora_tx_service)
+static lora_txq_t txq;
+static bool txq_ready = false;
+
+static lora_txq_t *tx_queue(void) {
+    if (!txq_ready) {
+        lora_txq_init(&txq);
+        txq_ready = true;
+    }
+    return &txq;
+}
+
+// Envia bytes, esperando o TxDone
 bool lora_send_bytes(const uint8_t *data, size_t len) {
+    lora_txq_handle_t h = lora_tx_submit(data, len, LORA_TXQ_PRIO_HIGH);
+    lora_txq_status_t status;
+    while ((status = lora_tx_status(h)) == LORA_TXQ_QUEUED || status == LORA_TXQ_SENDING) {
+        lora_tx_service();
+        busy_wait_ms_local(1); // Espera 1ms antes de verificar de novo
+    }
+    return status == LORA_TXQ_SENT;
+}
+
+lora_txq_handle_t lora_tx_submit(const uint8_t *data, size_t len, uint8_t prio) {
     if (len == 0 || len > 255) {
-        printf("Erro LoRa: Tamanho do pacote inválido (%d bytes)\n", (int)len);
+        TLOG(LOG_LORA_TX_BAD_LEN, len);
+        return 0;
+    }
+    return lora_txq_submit(tx_queue(), data, len, prio);
+}
+
+lora_txq_status_t lora_tx_status(lora_txq_handle_t handle) {
+    return lora_txq_status(tx_queue(), handle);
+}
+
+void lora_tx_service(void) {
+    lora_txq_t *q = tx_queue();
+    bool finished = false;
+    if (q->sending != LORA_TXQ_NONE) {
+        lora_tx_status_t status = lora_tx_poll();
+        if (status == LORA_TX_BUSY) return;
+        lora_txq_finish(q, status == LORA_TX_DONE);
+        finished = true;
+    }
+
+    const lora_txq_buf_t *b;
+    while ((b = lora_txq_next(q)) != NULL) {
+        if (lora_tx_start(b->data, b->len)) return;
+        lora_txq_finish(q, false); // rádio ocupado por um lora_tx_start() fora da fila
+        finished = true;
+    }
+    if (finished) lora_start_rx_continuous(); // fila vazia: volta a ouvir beacons
+}
+
+unsigned lora_tx_pending(void) {
+    return lora_txq_pending(tx_queue());
+}
+
+void lora_tx_get_stats(lora_txq_stats_t *out) {
+    *out = tx_queue()->stats;
+}
+
+bool lora_tx_start(const uint8_t *data, size_t len) {
+    if (len == 0 || len > 255) {
+        TLOG(LOG_LORA_TX_BAD_LEN, len);
         return false;
     }
+    if (tx_busy) return false;
+    TRACE_BEGIN(LORA_TX);
 
     // Garante que está em Standby antes de começar
     lora_set_mode(MODE_STDBY);
 
     // Configura ponteiro FIFO e escreve os dados
     lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    TRACE_BEGIN(LORA_FIFO_WRITE);
     lora_write_fifo(data, (uint8_t)len);
+    TRACE_END(LORA_FIFO_WRITE);
     lora_write_reg(REG_PAYLOAD_LENGTH, (uint8_t)len);
 
     // Prepara para TX: limpa flags e mapeia DIO0 para TxDone
     lora_write_reg(REG_IRQ_FLAGS, 0xFF);
     lora_write_reg(REG_DIO_MAPPING_1, 0x40); // DIO0 = 01 (TxDone)
 
-    printf("Enviando %d bytes via LoRa...\n", (int)len);
+    TLOG(LOG_LORA_TX_SENDING, len);
 
     // Inicia a transmissão
     lora_set_mode(MODE_TX);
+    tx_deadline = tick_cycles() + (uint64_t)TX_TIMEOUT_MS * (CONFIG_CLOCK_FREQUENCY / 1000);
+    tx_busy = true;
+    return true;
+}
 
-    // Espera pelo TxDone (IRQ_TX_DONE_MASK = 0x08) com timeout
-    int timeout_cnt = TX_TIMEOUT_MS;
-    while (timeout_cnt > 0) {
-        // Polling na flag IRQ
-        if (lora_read_reg(REG_IRQ_FLAGS) & IRQ_TX_DONE_MASK) {
-            lora_write_reg(REG_IRQ_FLAGS, IRQ_TX_DONE_MASK); // Limpa a flag TxDone
-            lora_set_mode(MODE_STDBY); // Volta para Standby após enviar
-            printf("Pacote enviado com sucesso!\n");
-            return true; // Sucesso
-        }
-        busy_wait_ms_local(1); // Espera 1ms antes de verificar de novo
-        timeout_cnt--;
+lora_tx_status_t lora_tx_poll(void) {
+    if (!tx_busy) return LORA_TX_IDLE;
+
+    lora_tx_status_t status;
+    if (lora_read_reg(REG_IRQ_FLAGS) & IRQ_TX_DONE_MASK) {
+        lora_write_reg(REG_IRQ_FLAGS, IRQ_TX_DONE_MASK); // Limpa a flag TxDone
+        TLOG(LOG_LORA_TX_DONE);
+        status = LORA_TX_DONE;
+    } else if (tick_cycles() >= tx_deadline) {
+        TLOG(LOG_LORA_TX_TIMEOUT);
+        status = LORA_TX_TIMEOUT;
+    } else {
+        return LORA_TX_BUSY;
+    }
+
+    lora_set_mode(MODE_STDBY); // Volta para Standby (ou aborta o TX)
+    tx_busy = false;
+    TRACE_END(LORA_TX);
+    return status;
+}
+
+void lora_start_rx_continuous(void) {
+    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
+    lora_write_reg(REG_DIO_MAPPING_1, 0x00); // DIO0 = 00 (RxDone)
+    lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    lora_set_mode(MODE_RX_CONTINUOUS);
+}
+
+// Recebe bytes (polling, o DIO0 não está ligado ao SoC)
+int lora_receive_bytes(uint8_t *buf, size_t maxlen) {
+    uint8_t irq_flags = lora_read_reg(REG_IRQ_FLAGS);
+    if (!(irq_flags & IRQ_RX_DONE_MASK)) return 0;
+    TRACE_BEGIN(LORA_RX);
+    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
+
+    if (irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK) {
+        TRACE_END(LORA_RX);
+        return 0;
+    }
+
+    uint8_t len = lora_read_reg(REG_RX_NB_BYTES);
+    if (len > maxlen) len = (uint8_t)maxlen;
+
+    lora_write_reg(REG_FIFO_ADDR_PTR, lora_read_reg(REG_FIFO_RX_CURRENT_ADDR));
+    lora_read_fifo(buf, len);
+    TRACE_END(LORA_RX);
+    return len;
+}
+
+// ============================
+// PERFIL DE MODEM E TX MEDIDO
+// ============================
+
+// Códigos de BW do REG_MODEM_CONFIG_1 (bits 7:4), em Hz
+static const uint32_t bw_table_hz[10] = { 7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000 };
+
+bool lora_set_modem(const lora_modem_t *modem) {
+    int bw = -1;
+    for (int i = 0; i < 10; i++) {
+        if (bw_table_hz[i] == modem->bw_hz) bw = i;
     }
+    if (bw < 0 || modem->sf < 6 || modem->sf > 12 || modem->cr < 1 || modem->cr > 4) return false;
+
+    // LDRO obrigatório com símbolo acima de 16 ms (seção 4.1.1.6 do datasheet)
+    bool ldro = ((1000000UL << modem->sf) / modem->bw_hz) > 16000;
+    lora_set_mode(MODE_STDBY);
+    lora_write_reg(REG_MODEM_CONFIG_1, (uint8_t)(bw << 4 | modem->cr << 1));   // cabeçalho explícito
+    lora_write_reg(REG_MODEM_CONFIG_2, (uint8_t)(modem->sf << 4 | 0x04));      // CRC ligado
+    lora_write_reg(REG_MODEM_CONFIG_3, ldro ? 0x0C : 0x04);                     // AGC ligado
+    return true;
+}
+
+void lora_get_modem(lora_modem_t *modem) {
+    uint8_t mc1 = lora_read_reg(REG_MODEM_CONFIG_1);
+    uint8_t bw = mc1 >> 4;
+    modem->bw_hz = bw < 10 ? bw_table_hz[bw] : 0;
+    modem->cr = (mc1 >> 1) & 0x07;
+    modem->sf = lora_read_reg(REG_MODEM_CONFIG_2) >> 4;
+    modem->ldro = (lora_read_reg(REG_MODEM_CONFIG_3) & 0x08) != 0;
+}
+
+bool lora_send_timed(const uint8_t *data, uint8_t len, uint64_t *cycles) {
+    lora_set_mode(MODE_STDBY);
+    lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    lora_write_fifo(data, len);
+    lora_write_reg(REG_PAYLOAD_LENGTH, len);
+    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
 
-    // Se saiu do loop, ocorreu timeout
-    printf("Erro: Timeout de TX! O radio foi resetado para Standby.\n");
-    lora_set_mode(MODE_STDBY); // Tenta voltar para Standby para abortar TX
-    return false; // Falha (timeout)
-}
\ No newline at end of file
+    const uint64_t timeout = (uint64_t)TX_TIMEOUT_MS * (CONFIG_CLOCK_FREQUENCY / 1000);
+    lora_set_mode(MODE_TX);
+    uint64_t start = tick_cycles();
+    uint64_t now = start;
+    bool done = false;
+    while (!done && now - start < timeout) {
+        done = (lora_read_reg(REG_IRQ_FLAGS) & IRQ_TX_DONE_MASK) != 0;
+        now = tick_cycles();
+    }
+    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
+    lora_set_mode(MODE_STDBY);
+    *cycles = now - start;
+    return done;
+}
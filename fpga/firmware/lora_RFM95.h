@@ -4,6 +4,16 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "lora_txq.h"
+#include "lora_proto.h"
+
+// Preâmbulo em símbolos das transmissões do nó. Receptores em modo de
+// recepção por ciclos dormem entre janelas; um preâmbulo maior permite
+// sleeps maiores (ver bitdoglab). Vem de lora_proto.h, que dimensiona os
+// slots TDMA com ele.
+#ifndef LORA_PREAMBLE_LEN
+#define LORA_PREAMBLE_LEN LORA_PROTO_NODE_PREAMBLE
+#endif
 
 /**
  * @brief Inicializa o hardware SPI e o módulo LoRa SX1276/RFM95.
@@ -13,13 +23,87 @@
 bool lora_init(void);
 
 /**
- * @brief Envia um buffer de bytes via LoRa.
+ * @brief Envia um buffer de bytes via LoRa e espera o fim da transmissão:
+ * lora_tx_submit() com prioridade alta seguido de lora_tx_service() até o
+ * quadro sair (ou falhar). Ao voltar, o rádio está em recepção contínua.
  * @param data Ponteiro para o buffer de dados a ser enviado.
  * @param len Número de bytes a serem enviados (máximo 255).
  * @return true se o pacote foi enviado com sucesso (TxDone recebido), false em caso de erro ou timeout.
  */
 bool lora_send_bytes(const uint8_t *data, size_t len);
 
+/**
+ * @brief Coloca um quadro na fila de transmissão (common/lora_txq.h) sem
+ * bloquear; os dados são copiados para um buffer do pool.
+ * @param prio LORA_TXQ_PRIO_HIGH, _NORMAL ou _LOW.
+ * @return Identificador para lora_tx_status(), 0 se o pool está cheio ou len inválido.
+ */
+lora_txq_handle_t lora_tx_submit(const uint8_t *data, size_t len, uint8_t prio);
+
+/**
+ * @brief Estado de um quadro enviado com lora_tx_submit().
+ */
+lora_txq_status_t lora_tx_status(lora_txq_handle_t handle);
+
+/**
+ * @brief Alimenta o rádio com a fila: acompanha o quadro no ar (uma leitura
+ * de REG_IRQ_FLAGS) e inicia o próximo assim que ele termina. Quando a fila
+ * esvazia, o rádio volta à recepção contínua. Não bloqueia.
+ */
+void lora_tx_service(void);
+
+/**
+ * @brief Quadros na fila ou no ar.
+ */
+unsigned lora_tx_pending(void);
+
+/**
+ * @brief Copia os contadores da fila de transmissão.
+ */
+void lora_tx_get_stats(lora_txq_stats_t *out);
+
+// Estado de uma transmissão iniciada com lora_tx_start()
+typedef enum {
+    LORA_TX_IDLE,     // nenhuma transmissão em andamento
+    LORA_TX_BUSY,     // aguardando TxDone
+    LORA_TX_DONE,     // terminou (informado uma única vez)
+    LORA_TX_TIMEOUT   // TxDone não veio em TX_TIMEOUT_MS (informado uma única vez)
+} lora_tx_status_t;
+
+/**
+ * @brief Inicia uma transmissão sem bloquear (nível baixo: é o que
+ * lora_tx_service() usa; não misturar com a fila). Ao terminar,
+ * lora_tx_poll() deixa o rádio em Standby.
+ * @param data Ponteiro para os dados (copiados para o FIFO na chamada).
+ * @param len Número de bytes a serem enviados (1..255).
+ * @return false se já há uma transmissão em andamento ou len inválido.
+ */
+bool lora_tx_start(const uint8_t *data, size_t len);
+
+/**
+ * @brief Acompanha a transmissão iniciada com lora_tx_start() (uma leitura
+ * de REG_IRQ_FLAGS por chamada).
+ * @return Estado atual; LORA_TX_DONE/LORA_TX_TIMEOUT aparecem uma vez e
+ *         depois o estado volta a LORA_TX_IDLE.
+ */
+lora_tx_status_t lora_tx_poll(void);
+
+/**
+ * @brief Coloca o rádio em recepção contínua (usado para ouvir os beacons).
+ * lora_tx_poll() deixa o rádio em Standby; chame de novo após transmitir
+ * (lora_tx_service() já faz isso ao esvaziar a fila).
+ */
+void lora_start_rx_continuous(void);
+
+/**
+ * @brief Verifica (por polling do REG_IRQ_FLAGS) se chegou um pacote e o copia.
+ * Função não bloqueante; pacotes com erro de CRC são descartados.
+ * @param buf Buffer de destino.
+ * @param maxlen Tamanho do buffer (pacotes maiores são truncados).
+ * @return Número de bytes recebidos, ou 0 se não há pacote.
+ */
+int lora_receive_bytes(uint8_t *buf, size_t maxlen);
+
 /**
  * @brief Coloca o rádio LoRa em um modo de operação específico.
  * (Ex: Sleep, Standby, TX, RX contínuo)
@@ -45,5 +129,41 @@ uint8_t lora_read_reg(uint8_t reg);
  */
 void lora_write_reg(uint8_t reg, uint8_t value);
 
+/**
+ * @brief Escreve bytes no FIFO a partir do ponteiro atual (REG_FIFO_ADDR_PTR),
+ * numa única transação SPI. O rádio não pode estar em Sleep.
+ */
+void lora_write_fifo(const uint8_t *data, uint8_t len);
+
+// Modulação LoRa (perfil de modem)
+typedef struct {
+    uint8_t sf;         // spreading factor, 6..12
+    uint32_t bw_hz;     // largura de banda (7800 .. 500000)
+    uint8_t cr;         // taxa de codificação: 1 = 4/5 .. 4 = 4/8
+    bool ldro;          // low data rate optimize
+} lora_modem_t;
+
+/**
+ * @brief Programa SF, BW e CR (REG_MODEM_CONFIG_1..3), mantendo CRC e AGC
+ * ligados. O LDRO é ligado quando o símbolo passa de 16 ms, como o datasheet
+ * exige; modem->ldro é ignorado. O rádio é deixado em Standby.
+ * @return false se algum parâmetro não existe no SX1276.
+ */
+bool lora_set_modem(const lora_modem_t *modem);
+
+/**
+ * @brief Lê dos registradores a modulação programada no rádio.
+ */
+void lora_get_modem(lora_modem_t *modem);
+
+/**
+ * @brief Transmite um pacote e mede o tempo no ar de fato: ciclos de
+ * tick_cycles() entre o MODE_TX e o TxDone, com polling contínuo do
+ * REG_IRQ_FLAGS (resolução de uma leitura de registrador). Deixa o rádio em
+ * Standby.
+ * @param cycles Recebe a duração medida.
+ * @return false em caso de timeout.
+ */
+bool lora_send_timed(const uint8_t *data, uint8_t len, uint64_t *cycles);
 
 #endif // LORA_RFM95_H_
\ No newline at end of file
@@ -12,7 +12,31 @@
 #include <system.h>
 
 #include "aht10.h"
+#include "bench.h"
+#include "filter.h"
 #include "lora_RFM95.h"
+#include "lora_proto.h"
+#include "report_policy.h"
+#include "scheduler.h"
+#include "tick.h"
+#include "timesync.h"
+#include "tdma.h"
+#include "trace.h"
+#include "tlog.h"
+
+// Identificação do nó na rede (1..255), definida no Makefile
+#ifndef NODE_ID
+#define NODE_ID 1
+#endif
+
+// Períodos das tarefas do escalonador. O rádio é consultado mais vezes para
+// que o RxDone de um beacon seja percebido perto do instante real.
+#define CONSOLE_PERIOD_US 1000
+#define RADIO_PERIOD_US   200
+#define TLOG_PERIOD_US    1000
+
+// Período padrão das leituras automáticas (comando "monitor")
+#define MONITOR_PERIOD_S  10
 
 // Protótipos locais
 static char *readstr(void);
@@ -21,12 +45,61 @@ static void prompt(void);
 static void help(void);
 static void reboot(void);
 static void toggle_led(void);
-static void console_service(void);
+static void console_task(sched_task_t *task);
 static void lorainfo(void);
 
 // Novos protótipos
-static void send_sensor_data(void);
+static void send_sensor_data(bool force);
 static void busy_wait_ms(unsigned int ms);
+static void radio_service(void);
+static void timesync_info(void);
+static void tdma_service(void);
+static void tdma_info(void);
+static void sensor_task(sched_task_t *task);
+static void radio_task(sched_task_t *task);
+static void tlog_task(sched_task_t *task);
+static void tx_report(void);
+static void txq_info(void);
+static void report_cmd(char *args);
+static void monitor_cmd(char *args);
+static void filter_cmd(char *args);
+static void sample_task(sched_task_t *task);
+
+// Amostras do send (sem TDMA) na fila do rádio, para informar o resultado
+#define TX_WATCH_LEN 4
+
+TRACE_DEFINE_RING()
+
+// Relógio de rede disciplinado pelos beacons da BitDogLab
+static timesync_t net_clock;
+
+// Agenda TDMA e amostra aguardando o slot deste nó
+static tdma_t tdma;
+static lora_sample_t pending_sample;
+static bool sample_pending = false;
+static uint8_t sample_seq = 0;
+static uint64_t sample_tx_at_us = 0;  // instante (tempo de rede) do próximo TX, 0 = não agendado
+static uint64_t join_tx_at_us = 0;
+
+// Tarefas: console, leitura do AHT10 (disparada pelo send, pelo monitor e
+// pelo heartbeat), rádio (TX em andamento, RX e TDMA), saída do log
+// tokenizado, leituras periódicas e heartbeat do envio por exceção
+static sched_task_t console, sensor, radio, tlog, monitor, heartbeat;
+
+// Envio por exceção: uma leitura só sai se passou da banda morta ou se o
+// heartbeat venceu; "send forca" transmite de qualquer jeito
+static report_policy_t report;
+static bool sample_forced = false;
+
+// Filtro entre o AHT10 e o rádio (filter.h), um por canal
+static filter_cfg_t filter_cfg = FILTER_DEFAULT_CFG;
+static filter_chan_t filter_temp, filter_umid;
+
+static struct {
+    lora_txq_handle_t handle;   // 0 = posição livre
+    uint32_t timestamp_ms;
+} tx_watch[TX_WATCH_LEN];
+static lora_txq_handle_t tdma_tx = 0;   // amostra enviada no slot TDMA
 
 
 static void busy_wait_ms(unsigned int ms) {
@@ -104,9 +177,21 @@ static void help(void)
     puts("help                            - this command");
     puts("reboot                          - reboot CPU");
     puts("led                             - led test");
-    puts("send                            - ler AHT10 e enviar via LoRa");
+    puts("send [forca]                    - ler AHT10 e enviar via LoRa (se mudou alem da banda morta)");
+    puts("monitor [s]                     - leituras automaticas a cada s segundos (0 desliga)");
+    puts("report [bt bu hb]               - envio por excecao: bandas em centesimos e heartbeat em s");
+    puts("filter [m o e]                  - filtro do AHT10: mediana de m, o conversoes por envio, EMA 1/2^e");
     puts("lorainfo                        - exibir informações do módulo LoRa");
     puts("i2cscan                         - varrer barramento I2C e listar dispositivos");
+    puts("timesync                        - estado do sincronismo com a BitDogLab");
+    puts("tdma                            - agenda TDMA (slot atribuído a este nó)");
+    puts("logbench                        - ciclos por chamada de printf e do log tokenizado");
+    puts("bench                           - custo de SPI, FIFO, lora_init, AHT10 e tempo no ar (CSV)");
+    puts("sched                           - tarefas do escalonador (passos, duracao e atraso maximos)");
+    puts("txq                             - fila de transmissao do radio");
+#if TRACE_ENABLED
+    puts("trace                           - despejar o trace (ver host/trace_json)");
+#endif
 }
 
 static void reboot(void)
@@ -125,34 +210,343 @@ static void toggle_led(void)
 // ============================================
 // === Nova função: ler AHT10 e enviar via LoRa ===
 // ============================================
-static void send_sensor_data(void) {
-    dados my_data; // definido em aht10.h
+static void send_sensor_data(bool force) {
+    if (sched_pending(&sensor)) {
+        printf("Leitura do AHT10 em andamento.\n");
+        return;
+    }
     printf("Lendo dados do sensor AHT10...\n");
+    sample_forced = force;
+    sched_wake(&sensor);
+}
 
-    if (aht10_get_data(&my_data)) {
-        printf("  Temperatura: %d.%02d C\n", my_data.temperatura/100, abs(my_data.temperatura) % 100);
-        printf("  Umidade: %d.%02d %%\n", my_data.umidade/100, abs(my_data.umidade) % 100);
+static uint32_t now_ms(void) {
+    return (uint32_t)(tick_us() / 1000);
+}
 
-        if (!lora_send_bytes((uint8_t*)&my_data, sizeof(dados))) {
+// O heartbeat vence heartbeat_s depois da última transmissão
+static void heartbeat_arm(void) {
+    if (report.cfg.heartbeat_s) sched_at(&heartbeat, tick_us() + (uint64_t)report.cfg.heartbeat_s * 1000000u);
+    else sched_cancel(&heartbeat);
+}
+
+// Monitor e heartbeat: disparam uma leitura, que passa pela política de envio
+static void sample_task(sched_task_t *task) {
+    (void)task;
+    if (!sched_pending(&sensor)) sched_wake(&sensor);
+}
+
+// Dispara a medição e volta AHT10_MEASURE_MS depois para ler; repete até o
+// filtro fechar uma amostra (filter_cfg.oversample conversões)
+static void sensor_task(sched_task_t *task) {
+    static bool measuring = false;
+    dados my_data; // definido em aht10.h
+
+    if (!measuring) {
+        if (aht10_start_measure()) {
+            measuring = true;
+            sched_in(task, AHT10_MEASURE_MS * 1000);
+            return;
+        }
+    } else {
+        measuring = false;
+        if (aht10_read_result(&my_data)) {
+            int16_t temp_f, umid_f;
+            bool done = filter_push(&filter_temp, my_data.temperatura, &temp_f);
+            filter_push(&filter_umid, my_data.umidade, &umid_f);
+            if (!done) {
+                // Próxima conversão da mesma amostra
+                if (aht10_start_measure()) {
+                    measuring = true;
+                    sched_in(task, AHT10_MEASURE_MS * 1000);
+                    return;
+                }
+                filter_abort(&filter_temp);
+                filter_abort(&filter_umid);
+                printf("Erro ao ler dados do AHT10. Envio LoRa abortado.\n");
+                if (report.have_last) heartbeat_arm();
+                prompt();
+                return;
+            }
+            my_data.temperatura = temp_f;
+            my_data.umidade = umid_f;
+
+            TRACE_BEGIN(FORMAT);
+            printf("  Temperatura: %d.%02d C\n", my_data.temperatura/100, abs(my_data.temperatura) % 100);
+            printf("  Umidade: %d.%02d %%\n", my_data.umidade/100, abs(my_data.umidade) % 100);
+            TRACE_END(FORMAT);
+
+            static const char *const why_names[] = { "", "primeira", "mudanca", "heartbeat" };
+            if (sample_forced) report_policy_forget(&report);
+            sample_forced = false;
+            report_reason_t why = report_policy_update(&report, my_data.temperatura, my_data.umidade, now_ms());
+            if (why == REPORT_SKIP) {
+                printf("Dentro da banda morta: nada enviado (heartbeat em %lu s).\n",
+                       (unsigned long)(report_policy_heartbeat_in_ms(&report, now_ms()) / 1000));
+                prompt();
+                return;
+            }
+            printf("Enviando (%s).\n", why_names[why]);
+            heartbeat_arm();
+
+            uint64_t net_us;
+            lora_sample_t sample = {
+                .temperatura = my_data.temperatura,
+                .umidade = my_data.umidade,
+                .timestamp_ms = 0,
+                .node_id = NODE_ID,
+                .seq = sample_seq++,
+            };
+            if (timesync_local_to_net(&net_clock, tick_us(), &net_us)) {
+                sample.timestamp_ms = (uint32_t)(net_us / 1000);
+            }
+
+            if (tdma.have_schedule) {
+                // Com TDMA ligado só transmite no próprio slot (pedindo um, se preciso)
+                pending_sample = sample;
+                sample_pending = true;
+                sample_tx_at_us = 0;
+                printf("Amostra aguardando o slot %d do TDMA.\n", tdma.my_slot);
+            } else {
+                int w = 0;
+                while (w < TX_WATCH_LEN && tx_watch[w].handle != 0) w++;
+                if (w == TX_WATCH_LEN) {
+                    // O quadro nem chega à fila do rádio
+                    report_policy_forget(&report);
+                    printf("Erro durante o envio LoRa (%d envios ainda aguardando resultado).\n", TX_WATCH_LEN);
+                    prompt();
+                    return;
+                }
+                uint8_t frame[LORA_PROTO_SAMPLE_LEN];
+                size_t len = lora_proto_report_frame(&sample, report.cfg.heartbeat_s, frame);
+                lora_txq_handle_t h = lora_tx_submit(frame, len, LORA_TXQ_PRIO_NORMAL);
+                if (h) {
+                    // O resultado sai quando o quadro terminar (tx_report)
+                    tx_watch[w].handle = h;
+                    tx_watch[w].timestamp_ms = sample.timestamp_ms;
+                    return;
+                }
+                report_policy_forget(&report);
+                printf("Erro durante o envio LoRa (fila de transmissao cheia).\n");
+            }
+            prompt();
+            return;
+        }
+    }
+    filter_abort(&filter_temp);
+    filter_abort(&filter_umid);
+    printf("Erro ao ler dados do AHT10. Envio LoRa abortado.\n");
+    if (report.have_last) heartbeat_arm(); // tenta de novo no próximo heartbeat
+    prompt();
+}
+
+// Informa o resultado dos quadros acompanhados que já terminaram
+static void tx_report(void) {
+    for (int i = 0; i < TX_WATCH_LEN; i++) {
+        if (tx_watch[i].handle == 0) continue;
+        lora_txq_status_t status = lora_tx_status(tx_watch[i].handle);
+        if (status == LORA_TXQ_QUEUED || status == LORA_TXQ_SENDING) continue;
+        if (status == LORA_TXQ_SENT) printf("Dados enviados via LoRa (t=%lu ms).\n", (unsigned long)tx_watch[i].timestamp_ms);
+        else {
+            // O receptor não tem o valor: a próxima leitura sai
+            report_policy_forget(&report);
             printf("Erro durante o envio LoRa (verificar log da biblioteca).\n");
-        } else {
-            printf("Dados enviados via LoRa.\n");
         }
+        prompt();
+        tx_watch[i].handle = 0;
+    }
+
+    if (tdma_tx) {
+        lora_txq_status_t status = lora_tx_status(tdma_tx);
+        if (status == LORA_TXQ_QUEUED || status == LORA_TXQ_SENDING) return;
+        if (status != LORA_TXQ_SENT) {
+            TLOG(LOG_TDMA_TX_ERROR, tdma.my_slot);
+            report_policy_forget(&report);
+        }
+        tdma_tx = 0;
+    }
+}
+
+// Um passo do rádio: alimenta a fila de TX ou, com ela vazia, trata a
+// recepção e o TDMA
+static void radio_task(sched_task_t *task) {
+    (void)task;
+    lora_tx_service();
+    tx_report();
+    if (lora_tx_pending()) return; // rádio fora de RX
+    radio_service();
+    tdma_service();
+    lora_tx_service(); // quadro do slot TDMA sai neste mesmo passo
+}
+
+static void tlog_task(sched_task_t *task) {
+    (void)task;
+    tlog_service(4); // mensagens do log tokenizado, fora do caminho do rádio
+}
+
+// Trata pacotes recebidos (beacons de sincronismo e agenda TDMA)
+static void radio_service(void) {
+    uint8_t buf[sizeof(lora_beacon_t) + LORA_PROTO_MAX_SLOTS];
+    uint64_t poll_cycles = tick_cycles(); // antes da leitura do FIFO, mais perto do RxDone
+    int len = lora_receive_bytes(buf, sizeof(buf));
+
+    if (len >= (int)sizeof(lora_beacon_t) && buf[0] == LORA_PROTO_BEACON_MAGIC) {
+        uint64_t local_rx_us = tick_cycles_to_us(poll_cycles);
+        lora_beacon_t beacon;
+        memcpy(&beacon, buf, sizeof(beacon));
+        if (len != (int)(sizeof(lora_beacon_t) + beacon.n_slots)) return;
+
+        // O RxDone acontece um tempo no ar depois do instante carimbado no beacon
+        uint64_t net_rx_us = beacon.time_us + lora_proto_airtime_us(LORA_PROTO_PREAMBLE, (uint8_t)len);
+        timesync_on_beacon(&net_clock, local_rx_us, net_rx_us);
+
+        int16_t old_slot = tdma.my_slot;
+        tdma_on_beacon(&tdma, &beacon, buf + sizeof(lora_beacon_t));
+        if (tdma.my_slot != old_slot) {
+            sample_tx_at_us = 0; // reagenda no novo slot
+            if (tdma.my_slot >= 0) TLOG(LOG_TDMA_SLOT, tdma.my_slot);
+        }
+
+        // Pedido de slot só é planejado dentro do superquadro deste beacon, enquanto
+        // a tabela de slots livres ainda vale
+        uint64_t join_start;
+        uint32_t rnd = (uint32_t)tick_cycles() * 2654435761u ^ (NODE_ID * 0x9E3779B9u);
+        join_tx_at_us = 0;
+        if (tdma_next_join(&tdma, net_rx_us, rnd, &join_start)) {
+            join_tx_at_us = join_start + lora_proto_guard_us(lora_proto_airtime_us(LORA_PREAMBLE_LEN, sizeof(lora_join_t)));
+        }
+    }
+}
+
+// Dispara, no momento certo, a amostra pendente e o pedido de slot
+static void tdma_service(void) {
+    if (!tdma.have_schedule || (!sample_pending && tdma.my_slot >= 0)) return;
+
+    uint64_t now;
+    if (!timesync_local_to_net(&net_clock, tick_us(), &now)) return;
+
+    uint32_t guard = lora_proto_guard_us(lora_proto_airtime_us(LORA_PREAMBLE_LEN, LORA_PROTO_SAMPLE_LEN));
+
+    if (sample_pending && tdma.my_slot >= 0) {
+        uint64_t slot_start;
+        if (sample_tx_at_us == 0 || now > sample_tx_at_us + guard) {
+            // Não agendado ou o laço perdeu o início do slot: usa o próximo
+            if (tdma_next_slot(&tdma, now, &slot_start)) sample_tx_at_us = slot_start + guard;
+        } else if (now >= sample_tx_at_us) {
+            uint8_t frame[LORA_PROTO_SAMPLE_LEN];
+            tdma_tx = lora_tx_submit(frame, lora_proto_report_frame(&pending_sample, report.cfg.heartbeat_s, frame),
+                                     LORA_TXQ_PRIO_HIGH);
+            if (!tdma_tx) {
+                TLOG(LOG_TDMA_TX_ERROR, tdma.my_slot);
+                report_policy_forget(&report);
+            }
+            sample_pending = false;
+            sample_tx_at_us = 0;
+        }
+    }
+
+    if (tdma.my_slot < 0 && join_tx_at_us != 0 && now >= join_tx_at_us) {
+        lora_join_t join = { .magic = LORA_PROTO_JOIN_MAGIC, .node_id = NODE_ID };
+        if (!lora_tx_submit((const uint8_t*)&join, sizeof(join), LORA_TXQ_PRIO_HIGH)) {
+            TLOG(LOG_TDMA_JOIN_DROPPED); // pede de novo no próximo beacon
+        }
+        join_tx_at_us = 0;
+    }
+}
+
+static void tdma_info(void) {
+    if (!tdma.have_schedule) {
+        printf("TDMA desligado (nenhum beacon com tabela de slots).\n");
+        return;
+    }
+    printf("No %d: slot %d de %d, slot=%lu ms, superquadro=%lu ms\n", NODE_ID, tdma.my_slot, tdma.n_slots,
+           (unsigned long)(tdma.slot_us / 1000), (unsigned long)(tdma.superframe_us / 1000));
+    printf("Amostra pendente: %s\n", sample_pending ? "sim" : "nao");
+}
+
+static void txq_info(void) {
+    lora_txq_stats_t st;
+    lora_tx_get_stats(&st);
+    printf("Fila de TX: %u/%u buffers (max %u)\n", st.used, LORA_TXQ_LEN, st.max_used);
+    printf("Aceitos %lu, enviados %lu, falhas %lu, recusados %lu\n", (unsigned long)st.submitted,
+           (unsigned long)st.sent, (unsigned long)st.failed, (unsigned long)st.rejected);
+}
+
+static void report_cmd(char *args) {
+    char *bt = get_token(&args), *bu = get_token(&args), *hb = get_token(&args);
+    if (*bt) {
+        if (!*bu || !*hb) {
+            puts("Uso: report <banda_temp> <banda_umid> <heartbeat_s> (bandas em centesimos)");
+            return;
+        }
+        report.cfg.deadband_temp = (uint16_t)strtoul(bt, NULL, 0);
+        report.cfg.deadband_umid = (uint16_t)strtoul(bu, NULL, 0);
+        report.cfg.heartbeat_s = (uint16_t)strtoul(hb, NULL, 0);
+        if (report.have_last) heartbeat_arm();
+    }
+    printf("Banda morta: T %u.%02u C, U %u.%02u %%, heartbeat %u s\n",
+           report.cfg.deadband_temp / 100, report.cfg.deadband_temp % 100,
+           report.cfg.deadband_umid / 100, report.cfg.deadband_umid % 100, report.cfg.heartbeat_s);
+    printf("Leituras %lu: suprimidas %lu, primeira %lu, mudanca %lu, heartbeat %lu\n", (unsigned long)report.readings,
+           (unsigned long)report.sent[REPORT_SKIP], (unsigned long)report.sent[REPORT_FIRST],
+           (unsigned long)report.sent[REPORT_CHANGE], (unsigned long)report.sent[REPORT_HEARTBEAT]);
+}
+
+static void monitor_cmd(char *args) {
+    char *arg = get_token(&args);
+    uint32_t period_s = *arg ? strtoul(arg, NULL, 0) : MONITOR_PERIOD_S;
+    if (period_s > 3600) period_s = 3600; // period_us é de 32 bits
+    sched_cancel(&monitor);
+    monitor.period_us = period_s * 1000000u;
+    if (period_s) {
+        sched_wake(&monitor);
+        printf("Leituras automaticas a cada %lu s.\n", (unsigned long)period_s);
     } else {
-        printf("Erro ao ler dados do AHT10. Envio LoRa abortado.\n");
+        printf("Leituras automaticas desligadas.\n");
     }
 }
 
+static void filter_cmd(char *args) {
+    char *m = get_token(&args), *o = get_token(&args), *e = get_token(&args);
+    if (*m) {
+        if (!*o || !*e) {
+            puts("Uso: filter <mediana> <sobreamostragem> <ema_shift> (1 1 0 desliga)");
+            return;
+        }
+        filter_cfg.median_n = (uint8_t)strtoul(m, NULL, 0);
+        filter_cfg.oversample = (uint8_t)strtoul(o, NULL, 0);
+        filter_cfg.ema_shift = (uint8_t)strtoul(e, NULL, 0);
+        filter_init(&filter_temp, &filter_cfg);
+        filter_init(&filter_umid, &filter_cfg);
+        filter_cfg = filter_temp.cfg; // já ajustada aos limites
+    }
+    printf("Filtro: mediana de %u, %u conversoes por envio (%lu ms), EMA alfa 1/%u\n", filter_cfg.median_n,
+           filter_cfg.oversample, (unsigned long)filter_cfg.oversample * AHT10_MEASURE_MS, 1u << filter_cfg.ema_shift);
+}
+
+static void timesync_info(void) {
+    uint64_t net_us;
+    if (!timesync_local_to_net(&net_clock, tick_us(), &net_us)) {
+        printf("Sem sincronismo (nenhum beacon recebido).\n");
+        return;
+    }
+    printf("Beacons: %lu\n", (unsigned long)net_clock.beacons);
+    printf("Tempo de rede: %lu ms\n", (unsigned long)(net_us / 1000));
+    printf("Offset: %ld ms, drift: %ld ppb\n", (long)(net_clock.offset_us / 1000), (long)net_clock.drift_ppb);
+    printf("Erro da previsao no ultimo beacon: %ld us\n", (long)net_clock.last_error_us);
+}
+
 void lorainfo(void) {
     uint8_t version = lora_read_reg(0x42);
     printf("LoRa Version: 0x%02X\n", version);
 }
 // ============================================
 /* Console */
-static void console_service(void) {
+static void console_task(sched_task_t *task) {
     char *str;
     char *token;
 
+    (void)task;
     str = readstr();
     if(str == NULL) return;
     token = get_token(&str);
@@ -163,11 +557,35 @@ static void console_service(void) {
     else if(strcmp(token, "led") == 0)
         toggle_led();
     else if(strcmp(token, "send") == 0)
-        send_sensor_data();
+        send_sensor_data(strcmp(get_token(&str), "forca") == 0);
+    else if(strcmp(token, "monitor") == 0)
+        monitor_cmd(str);
+    else if(strcmp(token, "report") == 0)
+        report_cmd(str);
+    else if(strcmp(token, "filter") == 0)
+        filter_cmd(str);
     else if(strcmp(token, "lorainfo") == 0)
         lorainfo();
     else if(strcmp(token, "i2cscan") == 0)
         i2c_scan();
+    else if(strcmp(token, "timesync") == 0)
+        timesync_info();
+    else if(strcmp(token, "tdma") == 0)
+        tdma_info();
+    else if(strcmp(token, "logbench") == 0)
+        tlog_bench();
+    else if(strcmp(token, "bench") == 0) {
+        if (lora_tx_pending()) puts("Radio transmitindo, tente de novo.");
+        else bench_run();
+    }
+    else if(strcmp(token, "sched") == 0)
+        sched_info();
+    else if(strcmp(token, "txq") == 0)
+        txq_info();
+#if TRACE_ENABLED
+    else if(strcmp(token, "trace") == 0)
+        trace_dump();
+#endif
     else
         puts("Comando desconhecido. Digite 'help'.");
     prompt();
@@ -199,17 +617,29 @@ int main(void) {
 
     i2c_init();
     aht10_init();
+    timesync_init(&net_clock);
+    report_cfg_t report_cfg = report_default_cfg();
+    report_policy_init(&report, &report_cfg);
+    filter_init(&filter_temp, &filter_cfg);
+    filter_init(&filter_umid, &filter_cfg);
+    tdma_init(&tdma, NODE_ID);
     if (!lora_init()) {
         printf("ATENÇÃO: falha na inicialização do LoRa. Verifique conexões/config.\n");
         // continua para permitir uso do console
+    } else {
+        lora_start_rx_continuous();
     }
 
     help();
     prompt();
 
-    while(1) {
-        console_service();
-    }
+    sched_add(&console, "console", console_task, CONSOLE_PERIOD_US);
+    sched_add(&sensor, "sensor", sensor_task, 0);
+    sched_add(&radio, "radio", radio_task, RADIO_PERIOD_US);
+    sched_add(&tlog, "tlog", tlog_task, TLOG_PERIOD_US);
+    sched_add(&monitor, "monitor", sample_task, 0);
+    sched_add(&heartbeat, "heartbeat", sample_task, 0);
+    sched_run();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "scheduler.h"
+#include <stdio.h>
+#include "tick.h"
+#include "trace.h"
+
+static sched_task_t *queue;         // tarefas agendadas, prazo crescente
+static sched_task_t *tasks;         // todas, na ordem de registro
+static sched_task_t *running;       // passo em execução
+static bool running_cancelled;      // o passo em execução chamou sched_cancel()
+
+static void queue_remove(sched_task_t *task) {
+    for (sched_task_t **p = &queue; *p; p = &(*p)->next) {
+        if (*p == task) {
+            *p = task->next;
+            break;
+        }
+    }
+    task->due_us = SCHED_IDLE;
+}
+
+void sched_add(sched_task_t *task, const char *name, sched_fn_t fn, uint32_t period_us) {
+    task->name = name;
+    task->fn = fn;
+    task->period_us = period_us;
+    task->due_us = SCHED_IDLE;
+    task->next = NULL;
+    task->all = NULL;
+    task->runs = task->max_run_us = task->max_late_us = 0;
+
+    sched_task_t **p = &tasks;
+    while (*p) p = &(*p)->all;
+    *p = task;
+
+    if (period_us) sched_wake(task);
+}
+
+void sched_at(sched_task_t *task, uint64_t when_us) {
+    if (task->due_us != SCHED_IDLE) queue_remove(task);
+    task->due_us = when_us;
+    // Depois das que vencem no mesmo instante: ordem de chegada
+    sched_task_t **p = &queue;
+    while (*p && (*p)->due_us <= when_us) p = &(*p)->next;
+    task->next = *p;
+    *p = task;
+}
+
+void sched_in(sched_task_t *task, uint32_t delay_us) {
+    sched_at(task, tick_us() + delay_us);
+}
+
+void sched_wake(sched_task_t *task) {
+    sched_at(task, tick_us());
+}
+
+void sched_cancel(sched_task_t *task) {
+    if (task->due_us != SCHED_IDLE) queue_remove(task);
+    if (task == running) running_cancelled = true;
+}
+
+bool sched_pending(const sched_task_t *task) {
+    return task->due_us != SCHED_IDLE;
+}
+
+void sched_run(void) {
+    while (1) {
+        uint64_t now = tick_us();
+        sched_task_t *task = queue;
+        if (task == NULL || task->due_us > now) continue;
+
+        uint64_t due = task->due_us;
+        queue = task->next;
+        task->due_us = SCHED_IDLE;
+        running = task;
+        running_cancelled = false;
+
+        // Passos que não gravam nada somem do trace
+        TRACE_BEGIN(LOOP);
+        task->fn(task);
+        TRACE_END_OR_DROP(LOOP);
+
+        uint64_t end = tick_us();
+        running = NULL;
+        uint32_t run_us = (uint32_t)(end - now);
+        uint32_t late_us = (uint32_t)(now - due);
+        task->runs++;
+        if (run_us > task->max_run_us) task->max_run_us = run_us;
+        if (late_us > task->max_late_us) task->max_late_us = late_us;
+
+        // Reagendamento periódico, a menos que o passo tenha decidido outra coisa.
+        // Um passo atrasado não gera rajada: o próximo vem um período depois.
+        if (task->period_us && task->due_us == SCHED_IDLE && !running_cancelled) {
+            uint64_t next = due + task->period_us;
+            sched_at(task, next > end ? next : end + task->period_us);
+        }
+    }
+}
+
+void sched_info(void) {
+    printf("%-10s %10s %8s %10s %12s\n", "tarefa", "periodo_us", "passos", "max_us", "atraso_max_us");
+    for (sched_task_t *t = tasks; t; t = t->all) {
+        bool active = sched_pending(t) || t == running;
+        printf("%-10s %10lu %8lu %10lu %12lu%s\n", t->name, (unsigned long)t->period_us, (unsigned long)t->runs,
+               (unsigned long)t->max_run_us, (unsigned long)t->max_late_us, active ? "" : " (parada)");
+        t->runs = t->max_run_us = t->max_late_us = 0;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHED_IDLE UINT64_MAX   // tarefa fora da fila
+
+typedef struct sched_task sched_task_t;
+typedef void (*sched_fn_t)(sched_task_t *task);
+
+/**
+ * @brief Tarefa do escalonador cooperativo.
+ * O corpo (fn) não pode bloquear: faz um passo do trabalho e devolve o
+ * controle, reagendando-se com sched_in()/sched_at() quando precisa esperar
+ * (fim de medição, TxDone...). Tarefas periódicas voltam à fila sozinhas.
+ * Os campos são do escalonador; use as funções abaixo.
+ */
+struct sched_task {
+    const char *name;
+    sched_fn_t fn;
+    uint32_t period_us;     // 0 = só roda quando agendada
+    uint64_t due_us;        // prazo em tick_us(), SCHED_IDLE fora da fila
+    sched_task_t *next;     // fila de execução, ordenada por prazo
+    sched_task_t *all;      // todas as tarefas registradas (comando "sched")
+
+    // Estatísticas desde o último sched_info()
+    uint32_t runs;
+    uint32_t max_run_us;    // maior duração de um passo
+    uint32_t max_late_us;   // maior atraso entre o prazo e o início do passo
+};
+
+/**
+ * @brief Registra uma tarefa. Com period_us > 0 ela entra na fila já
+ * vencida e depois roda a cada period_us (sem rajadas para compensar
+ * atrasos); com 0 fica parada até sched_wake()/sched_in()/sched_at().
+ */
+void sched_add(sched_task_t *task, const char *name, sched_fn_t fn, uint32_t period_us);
+
+/**
+ * @brief (Re)agenda a tarefa para o instante when_us (tick_us()). Chamada
+ * de dentro do próprio corpo, substitui o reagendamento periódico deste passo.
+ */
+void sched_at(sched_task_t *task, uint64_t when_us);
+
+/**
+ * @brief (Re)agenda a tarefa para daqui a delay_us.
+ */
+void sched_in(sched_task_t *task, uint32_t delay_us);
+
+/**
+ * @brief Agenda a tarefa para já (na frente das que venceram depois).
+ */
+void sched_wake(sched_task_t *task);
+
+/**
+ * @brief Tira a tarefa da fila (uma periódica volta com sched_wake()).
+ */
+void sched_cancel(sched_task_t *task);
+
+/**
+ * @brief A tarefa está na fila esperando o prazo.
+ */
+bool sched_pending(const sched_task_t *task);
+
+/**
+ * @brief Laço do escalonador: roda, em ordem de prazo, as tarefas vencidas
+ * no relógio de tick_us(). Não retorna.
+ */
+void sched_run(void);
+
+/**
+ * @brief Imprime, por tarefa, período, passos, maior duração e maior atraso
+ * desde a última chamada, e zera os máximos.
+ */
+void sched_info(void);
+
+#endif
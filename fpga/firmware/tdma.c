@@ -0,0 +1,76 @@
+#include "tdma.h"
+
+void tdma_init(tdma_t *t, uint8_t node_id) {
+    t->node_id = node_id;
+    t->have_schedule = false;
+    t->my_slot = -1;
+    t->n_slots = 0;
+    t->slot_us = 0;
+    t->superframe_us = 0;
+    t->first_slot_us = 0;
+    t->free_mask = 0;
+    t->join_attempts = 0;
+    t->join_skip = 0;
+}
+
+void tdma_on_beacon(tdma_t *t, const lora_beacon_t *beacon, const uint8_t *slots) {
+    if (beacon->n_slots == 0 || beacon->slot_us == 0) {
+        t->have_schedule = false; // TDMA desligado no receptor
+        t->my_slot = -1;
+        return;
+    }
+
+    uint8_t beacon_len = (uint8_t)(sizeof(lora_beacon_t) + beacon->n_slots);
+    t->have_schedule = true;
+    t->n_slots = beacon->n_slots;
+    t->slot_us = beacon->slot_us;
+    t->superframe_us = lora_proto_superframe_us(beacon->n_slots, beacon->slot_us);
+    t->first_slot_us = beacon->time_us + lora_proto_beacon_slot_us(beacon_len);
+
+    t->my_slot = -1;
+    t->free_mask = 0;
+    for (uint8_t i = 0; i < beacon->n_slots; i++) {
+        if (slots[i] == t->node_id) t->my_slot = i;
+        else if (slots[i] == LORA_PROTO_SLOT_FREE) t->free_mask |= 1ull << i;
+    }
+    if (t->my_slot >= 0) t->join_attempts = 0;
+    if (t->join_skip) t->join_skip--;
+}
+
+// Primeira ocorrência de first_slot_us + offset + k * superframe que seja >= now_us
+static uint64_t next_occurrence(const tdma_t *t, uint32_t offset_us, uint64_t now_us) {
+    uint64_t start = t->first_slot_us + offset_us;
+    if (now_us > start) {
+        uint64_t periods = (now_us - start + t->superframe_us - 1) / t->superframe_us;
+        start += periods * t->superframe_us;
+    }
+    return start;
+}
+
+bool tdma_next_slot(const tdma_t *t, uint64_t now_us, uint64_t *start_us) {
+    if (!t->have_schedule || t->my_slot < 0) return false;
+    *start_us = next_occurrence(t, (uint32_t)t->my_slot * t->slot_us, now_us);
+    return true;
+}
+
+bool tdma_next_join(tdma_t *t, uint64_t now_us, uint32_t rnd, uint64_t *start_us) {
+    if (!t->have_schedule || t->my_slot >= 0 || t->join_skip) return false;
+
+    // Oportunidades: slots livres + slot JOIN (índice n_slots)
+    unsigned choices = 1;
+    for (uint64_t m = t->free_mask; m; m &= m - 1) choices++;
+    unsigned pick = (rnd & 0xFFFF) % choices;
+    unsigned slot = t->n_slots;
+    for (uint8_t i = 0; i < t->n_slots && pick; i++) {
+        if ((t->free_mask >> i) & 1) {
+            if (--pick == 0) slot = i;
+        }
+    }
+
+    unsigned exp = t->join_attempts < TDMA_JOIN_MAX_BACKOFF ? t->join_attempts : TDMA_JOIN_MAX_BACKOFF;
+    t->join_skip = (uint8_t)((rnd >> 16) % (1u << exp));
+    if (t->join_attempts < 255) t->join_attempts++;
+
+    *start_us = next_occurrence(t, slot * t->slot_us, now_us);
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef TDMA_H_
+#define TDMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_proto.h"
+
+#ifndef TDMA_JOIN_MAX_BACKOFF
+#define TDMA_JOIN_MAX_BACKOFF 4
+#endif
+
+/**
+ * @brief Agenda TDMA do nó, montada a partir do último beacon.
+ * Todos os instantes estão em tempo de rede (microssegundos). Como o
+ * receptor mantém o período do superquadro, a agenda continua valendo
+ * (extrapolada) se algum beacon for perdido.
+ */
+typedef struct {
+    uint8_t node_id;
+    bool have_schedule;       // já recebeu um beacon com TDMA ligado
+    int16_t my_slot;          // slot atribuído a este nó, -1 se nenhum
+    uint8_t n_slots;
+    uint32_t slot_us;
+    uint32_t superframe_us;
+    uint64_t first_slot_us;   // início do slot 0 no último superquadro conhecido
+    uint64_t free_mask;       // bit i = slot de dados i livre no último beacon
+    uint8_t join_attempts;    // pedidos de JOIN sem resposta (backoff exponencial)
+    uint8_t join_skip;        // beacons a esperar antes do próximo pedido
+} tdma_t;
+
+/**
+ * @brief Zera a agenda.
+ * @param node_id Identificação deste nó (1..255).
+ */
+void tdma_init(tdma_t *t, uint8_t node_id);
+
+/**
+ * @brief Atualiza a agenda com um beacon recebido.
+ * @param beacon Cabeçalho do beacon.
+ * @param slots Tabela de slots (beacon->n_slots bytes).
+ */
+void tdma_on_beacon(tdma_t *t, const lora_beacon_t *beacon, const uint8_t *slots);
+
+/**
+ * @brief Próximo início do slot deste nó a partir de now_us.
+ * @return false se o nó não tem slot.
+ */
+bool tdma_next_slot(const tdma_t *t, uint64_t now_us, uint64_t *start_us);
+
+/**
+ * @brief Escolhe quando enviar o pedido de JOIN no superquadro atual.
+ * Deve ser chamada logo após tdma_on_beacon(): o pedido vai no slot JOIN ou
+ * em algum slot de dados que este beacon anunciou livre, sorteado, para que
+ * vários nós novos entrem no mesmo superquadro. Cada pedido sem resposta
+ * dobra a janela de beacons pulados (máx. 2^TDMA_JOIN_MAX_BACKOFF).
+ * @param rnd Número aleatório fornecido pelo chamador.
+ * @return false se não há agenda, o nó já tem slot ou está em backoff.
+ */
+bool tdma_next_join(tdma_t *t, uint64_t now_us, uint32_t rnd, uint64_t *start_us);
+
+#endif
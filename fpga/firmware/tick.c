@@ -0,0 +1,29 @@
+#include "tick.h"
+#include <generated/csr.h>
+#include <generated/soc.h>
+
+#define CYCLES_PER_US (CONFIG_CLOCK_FREQUENCY / 1000000)
+
+uint64_t tick_cycles(void) {
+#ifdef CSR_TIMER0_UPTIME_CYCLES_ADDR
+    timer0_uptime_latch_write(1);
+    return timer0_uptime_cycles_read();
+#else
+    uint32_t hi, lo, hi2;
+    // Relê a parte alta para não misturar metades de antes e depois do carry
+    do {
+        __asm__ volatile ("rdcycleh %0" : "=r"(hi));
+        __asm__ volatile ("rdcycle %0" : "=r"(lo));
+        __asm__ volatile ("rdcycleh %0" : "=r"(hi2));
+    } while (hi != hi2);
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+uint64_t tick_us(void) {
+    return tick_cycles_to_us(tick_cycles());
+}
+
+uint64_t tick_cycles_to_us(uint64_t cycles) {
+    return cycles / CYCLES_PER_US;
+}
@@ -0,0 +1,25 @@
+#ifndef TICK_H_
+#define TICK_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Contador de ciclos livre de 64 bits.
+ * Usa o contador de uptime do timer0 quando o SoC é gerado com ele
+ * (CSR_TIMER0_UPTIME_CYCLES_ADDR); caso contrário usa rdcycle/rdcycleh da CPU.
+ * O valor do timer0 em si não serve como base de tempo porque busy_wait_us()
+ * reprograma o timer a cada chamada.
+ */
+uint64_t tick_cycles(void);
+
+/**
+ * @brief Tempo desde o boot em microssegundos (derivado de tick_cycles()).
+ */
+uint64_t tick_us(void);
+
+/**
+ * @brief Converte uma leitura de tick_cycles() em microssegundos.
+ */
+uint64_t tick_cycles_to_us(uint64_t cycles);
+
+#endif
@@ -0,0 +1,49 @@
+#include "timesync.h"
+#include <string.h>
+
+void timesync_init(timesync_t *ts) {
+    memset(ts, 0, sizeof(*ts));
+}
+
+static int64_t predicted_offset(const timesync_t *ts, uint64_t local_us) {
+    int64_t elapsed = (int64_t)(local_us - ts->ref_local_us);
+    return ts->offset_us + (elapsed * ts->drift_ppb) / 1000000000LL;
+}
+
+void timesync_on_beacon(timesync_t *ts, uint64_t local_rx_us, uint64_t net_rx_us) {
+    int64_t measured = (int64_t)(net_rx_us - local_rx_us);
+
+    if (!ts->synced) {
+        ts->synced = true;
+        ts->beacons = 1;
+        ts->ref_local_us = local_rx_us;
+        ts->offset_us = measured;
+        ts->drift_ppb = 0;
+        ts->last_error_us = 0;
+        return;
+    }
+
+    int64_t elapsed = (int64_t)(local_rx_us - ts->ref_local_us);
+    if (elapsed <= 0) return; // beacon repetido ou fora de ordem
+
+    ts->last_error_us = (int32_t)(measured - predicted_offset(ts, local_rx_us));
+
+    // Drift observado entre os dois últimos beacons, suavizado por média móvel
+    int32_t observed_ppb = (int32_t)(((measured - ts->offset_us) * 1000000000LL) / elapsed);
+    if (ts->beacons == 1) ts->drift_ppb = observed_ppb;
+    else ts->drift_ppb += (observed_ppb - ts->drift_ppb) >> TIMESYNC_DRIFT_SHIFT;
+
+    // A fase segue a medição; o drift só é usado para extrapolar entre beacons
+    ts->ref_local_us = local_rx_us;
+    ts->offset_us = measured;
+    ts->beacons++;
+}
+
+bool timesync_local_to_net(const timesync_t *ts, uint64_t local_us, uint64_t *net_us) {
+    if (!ts->synced) {
+        *net_us = local_us;
+        return false;
+    }
+    *net_us = (uint64_t)((int64_t)local_us + predicted_offset(ts, local_us));
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef TIMESYNC_H_
+#define TIMESYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Peso do novo drift medido na média móvel: 1/2^TIMESYNC_DRIFT_SHIFT
+#define TIMESYNC_DRIFT_SHIFT 2
+
+/**
+ * @brief Estado da disciplina de relógio do transmissor.
+ * O tempo de rede é estimado como
+ *   net = local + offset_us + (local - ref_local_us) * drift_ppb / 1e9
+ * Só usa aritmética inteira (a CPU soft não tem FPU). Não depende do
+ * hardware, então também é compilado no simulador de host.
+ */
+typedef struct {
+    bool synced;
+    uint32_t beacons;       // beacons aceitos
+    uint64_t ref_local_us;  // relógio local no último beacon
+    int64_t offset_us;      // tempo de rede - local no último beacon
+    int32_t drift_ppb;      // quanto o relógio de rede anda a mais que o local (ppb)
+    int32_t last_error_us;  // erro da previsão no último beacon (antes de corrigir)
+} timesync_t;
+
+/**
+ * @brief Zera o estado (sem sincronismo).
+ */
+void timesync_init(timesync_t *ts);
+
+/**
+ * @brief Incorpora um beacon recebido.
+ * @param local_rx_us Relógio local no instante em que o RxDone foi percebido.
+ * @param net_rx_us Tempo de rede no mesmo instante (hora do beacon + tempo no ar).
+ */
+void timesync_on_beacon(timesync_t *ts, uint64_t local_rx_us, uint64_t net_rx_us);
+
+/**
+ * @brief Converte o relógio local em tempo de rede.
+ * @return false se ainda não houve beacon (net_us recebe o próprio tempo local).
+ */
+bool timesync_local_to_net(const timesync_t *ts, uint64_t local_us, uint64_t *net_us);
+
+#endif
@@ -0,0 +1,35 @@
+#include "tlog.h"
+#include <stdio.h>
+#include "tick.h"
+
+#define BENCH_CALLS 16  // cabe no anel junto com o que já estiver pendente
+
+static tlog_ring_t ring;
+
+void tlog_write(uint8_t nargs, const uint32_t *v) {
+    tlog_ring_push(&ring, (uint32_t)tick_us(), (uint8_t)v[0], nargs, v + 1);
+}
+
+void tlog_service(unsigned max) {
+    tlog_entry_t e;
+    while (max-- && tlog_ring_pop(&ring, (uint32_t)tick_us(), &e)) {
+        printf("@L %08lx %u", (unsigned long)e.time_us, e.id);
+        for (unsigned i = 0; i < e.nargs; i++) printf(" %lx", (unsigned long)e.args[i]);
+        printf("\n");
+    }
+}
+
+void tlog_bench(void) {
+    uint64_t printf_cycles = 0, tlog_cycles = 0;
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        uint64_t t0 = tick_cycles();
+        printf("logbench %u: %d bytes, flags 0x%02x\n", (unsigned)i, 10, 0x40);
+        uint64_t t1 = tick_cycles();
+        TLOG(LOG_BENCH, i, 10, 0x40);
+        uint64_t t2 = tick_cycles();
+        printf_cycles += t1 - t0;
+        tlog_cycles += t2 - t1;
+    }
+    printf("logbench: printf %lu ciclos/chamada, TLOG %lu ciclos/chamada (media de %u chamadas)\n",
+           (unsigned long)(printf_cycles / BENCH_CALLS), (unsigned long)(tlog_cycles / BENCH_CALLS), BENCH_CALLS);
+}
@@ -0,0 +1,19 @@
+#ifndef TLOG_H_
+#define TLOG_H_
+
+#include "tlog_ring.h"
+
+/**
+ * @brief Esvazia até max mensagens do log tokenizado (common/tlog_ring.h) em
+ * linhas "@L" na UART. Chamada no laço principal, fora do caminho do rádio;
+ * o carimbo de cada mensagem é tick_us() (32 bits baixos) do ponto de log.
+ */
+void tlog_service(unsigned max);
+
+/**
+ * @brief Mede, com tick_cycles(), os ciclos por chamada de printf e de TLOG
+ * para a mesma mensagem (LOG_BENCH) e imprime as médias.
+ */
+void tlog_bench(void);
+
+#endif
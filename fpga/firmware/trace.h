@@ -0,0 +1,32 @@
+// trace.h
+//
+// Trace dos laços quentes no SoC LiteX (common/trace_ring.h). Ligado com
+// make TRACE=1; desligado, as macros não geram código.
+//
+// Carimbo em ciclos de clock (32 bits baixos, voltam a cada ~71 s a 60 MHz):
+// o mesmo contador de tick_cycles(), lido sem o laço da parte alta.
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+#include <generated/csr.h>
+#include <generated/soc.h>
+
+#define TRACE_BOARD   "fpga"
+#define TRACE_TICK_HZ CONFIG_CLOCK_FREQUENCY
+
+static inline uint32_t trace_now(void) {
+#ifdef CSR_TIMER0_UPTIME_CYCLES_ADDR
+    timer0_uptime_latch_write(1);
+    return (uint32_t)timer0_uptime_cycles_read();
+#else
+    uint32_t lo;
+    __asm__ volatile ("rdcycle %0" : "=r"(lo));
+    return lo;
+#endif
+}
+
+#include "trace_ring.h"
+
+#endif // TRACE_H_
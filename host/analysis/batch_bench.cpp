@@ -0,0 +1,211 @@
+// batch_bench.cpp
+//
+// Compara, sobre amostras sintéticas de vários nós, o laço ingênuo registro
+// a registro (decodifica a struct e atualiza um mapa (nó, janela)) com o lote
+// em colunas de sample_batch.hpp: a montagem das colunas (feita uma vez por
+// captura) e cada consulta, em cada nível SIMD disponível. Também mede só
+// os laços internos (separar os registros de 4 bytes e min/max/soma de uma
+// coluna). Todos os resultados são conferidos contra o laço ingênuo.
+//
+// Uso: batch_bench [--samples N] [--nodes N] [--janela-s S] [--repeat R]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <getopt.h>
+
+extern "C" {
+#include "lora_proto.h"
+}
+#include "sample_batch.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct NaiveAgg {
+    uint32_t count = 0;
+    int16_t tmin = INT16_MAX, tmax = INT16_MIN, umin = INT16_MAX, umax = INT16_MIN;
+    int64_t tsum = 0, usum = 0;
+};
+
+using NaiveResult = std::map<std::pair<uint8_t, uint64_t>, NaiveAgg>;
+
+// Referência: um registro por vez, como um script de análise faria
+NaiveResult naive_windows(const uint8_t *buf, size_t n, uint64_t window_ms) {
+    NaiveResult out;
+    for (size_t i = 0; i < n; i++) {
+        lora_sample_t s;
+        std::memcpy(&s, buf + i * sizeof(s), sizeof(s));
+        NaiveAgg &a = out[{ s.node_id, s.timestamp_ms - s.timestamp_ms % window_ms }];
+        a.count++;
+        if (s.temperatura < a.tmin) a.tmin = s.temperatura;
+        if (s.temperatura > a.tmax) a.tmax = s.temperatura;
+        if (s.umidade < a.umin) a.umin = s.umidade;
+        if (s.umidade > a.umax) a.umax = s.umidade;
+        a.tsum += s.temperatura;
+        a.usum += s.umidade;
+    }
+    return out;
+}
+
+bool same(const NaiveResult &ref, const std::vector<WindowAgg> &got) {
+    if (ref.size() != got.size()) return false;
+    size_t k = 0;
+    for (const auto &e : ref) {
+        const WindowAgg &w = got[k++];
+        const NaiveAgg &a = e.second;
+        if (w.node != e.first.first || w.start_ms != e.first.second || w.temp.count != a.count ||
+            w.temp.min != a.tmin || w.temp.max != a.tmax || w.temp.sum != a.tsum || w.umid.min != a.umin ||
+            w.umid.max != a.umax || w.umid.sum != a.usum) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Fn>
+double best_of(unsigned repeat, Fn &&fn) {
+    double best = 1e30;
+    for (unsigned r = 0; r < repeat; r++) {
+        auto t0 = Clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - t0).count());
+    }
+    return best;
+}
+
+void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--samples N] [--nodes N] [--janela-s S] [--repeat R]\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t samples = 8000000;
+    unsigned nodes = 16, repeat = 3;
+    uint64_t window_ms = 3600 * 1000ull;
+    static const option long_opts[] = {
+        { "samples",  required_argument, nullptr, 's' },
+        { "nodes",    required_argument, nullptr, 'n' },
+        { "janela-s", required_argument, nullptr, 'j' },
+        { "repeat",   required_argument, nullptr, 'r' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "s:n:j:r:", long_opts, nullptr)) != -1) {
+        switch (c) {
+        case 's': samples = strtoull(optarg, nullptr, 10); break;
+        case 'n': nodes = (unsigned)atoi(optarg); break;
+        case 'j': window_ms = strtoull(optarg, nullptr, 10) * 1000; break;
+        case 'r': repeat = (unsigned)atoi(optarg); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (samples == 0 || nodes == 0 || nodes > 255 || window_ms == 0 || repeat == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Amostras intercaladas dos nós, com ruído; o intervalo é reduzido se
+    // preciso para caber nos 49 dias do timestamp_ms de 32 bits
+    const uint64_t step_ms = std::min<uint64_t>(30000, (UINT32_MAX - 100000ull) / (samples / nodes + 1));
+    std::mt19937 rng(7);
+    std::vector<uint8_t> packed(samples * sizeof(lora_sample_t));
+    std::vector<uint8_t> dados4(samples * 4);
+    for (size_t i = 0; i < samples; i++) {
+        unsigned node = 1 + (unsigned)(i % nodes);
+        lora_sample_t s;
+        s.temperatura = (int16_t)(2500 + (int)(rng() % 2001) - 1000);
+        s.umidade = (int16_t)(6000 + (int)(rng() % 4001) - 2000);
+        s.timestamp_ms = (uint32_t)((i / nodes) * step_ms + node * 50);
+        s.node_id = (uint8_t)node;
+        s.seq = (uint8_t)(i / nodes);
+        std::memcpy(&packed[i * sizeof(s)], &s, sizeof(s));
+        std::memcpy(&dados4[i * 4], &s, 4); // os 4 primeiros bytes são a struct dados
+    }
+    printf("%zu amostras de %u nos a cada %.1f s, janelas de %llu s, melhor de %u\n", samples, nodes,
+           step_ms / 1000.0, (unsigned long long)(window_ms / 1000), repeat);
+
+    // ---- Consulta completa: amostras empacotadas -> agregados por nó e janela ----
+    NaiveResult ref;
+    double naive_s = best_of(repeat, [&] { ref = naive_windows(packed.data(), samples, window_ms); });
+    printf("\nagregados por no e janela (%zu janelas)\n", ref.size());
+    printf("  %-28s %8.1f ms  %7.1f M amostras/s\n", "laco ingenuo (std::map)", naive_s * 1e3, samples / naive_s / 1e6);
+
+    // O lote em colunas é montado uma vez; cada consulta depois só agrega
+    SampleBatch batch;
+    double decode_s = best_of(repeat, [&] {
+        batch.clear();
+        batch.append_samples(packed.data(), samples);
+    });
+    printf("  %-28s %8.1f ms  %7.1f M amostras/s  (uma vez por captura)\n", "montar colunas por no",
+           decode_s * 1e3, samples / decode_s / 1e6);
+
+    bool ok = true;
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 };
+    for (SimdLevel lvl : levels) {
+        if (lvl > simd_detect()) continue;
+        simd_force(lvl);
+        std::vector<WindowAgg> got;
+        double s = best_of(repeat, [&] { got = window_aggregates(batch, window_ms); });
+        bool match = same(ref, got);
+        ok = ok && match;
+        char label[40];
+        snprintf(label, sizeof(label), "consulta %s", simd_name(lvl));
+        printf("  %-28s %8.1f ms  %7.1f M amostras/s  %5.1fx  (com a montagem: %.1fx)  %s\n", label, s * 1e3,
+               samples / s / 1e6, naive_s / s, naive_s / (s + decode_s), match ? "ok" : "DIFERENTE");
+    }
+
+    // ---- Laços internos sobre registros de 4 bytes ----
+    std::vector<int16_t> temp(samples), umid(samples);
+    Agg16 ref_t, ref_u;
+    double naive4_s = best_of(repeat, [&] {
+        ref_t = Agg16();
+        ref_u = Agg16();
+        for (size_t i = 0; i < samples; i++) {
+            int16_t t, u;
+            std::memcpy(&t, &dados4[i * 4], 2);
+            std::memcpy(&u, &dados4[i * 4 + 2], 2);
+            ref_t.count++;
+            ref_u.count++;
+            if (t < ref_t.min) ref_t.min = t;
+            if (t > ref_t.max) ref_t.max = t;
+            if (u < ref_u.min) ref_u.min = u;
+            if (u > ref_u.max) ref_u.max = u;
+            ref_t.sum += t;
+            ref_u.sum += u;
+        }
+    });
+    printf("\nregistros de 4 bytes: separar em colunas + min/max/soma\n");
+    printf("  %-28s %8.1f ms  %7.1f M registros/s\n", "laco ingenuo", naive4_s * 1e3, samples / naive4_s / 1e6);
+    for (SimdLevel lvl : levels) {
+        if (lvl > simd_detect()) continue;
+        simd_force(lvl);
+        Agg16 at, au;
+        double dec_s = best_of(repeat, [&] { decode_dados(dados4.data(), samples, temp.data(), umid.data()); });
+        double agg_s = best_of(repeat, [&] {
+            at = aggregate(temp.data(), samples);
+            au = aggregate(umid.data(), samples);
+        });
+        bool match = at.count == ref_t.count && at.min == ref_t.min && at.max == ref_t.max && at.sum == ref_t.sum &&
+                     au.min == ref_u.min && au.max == ref_u.max && au.sum == ref_u.sum;
+        ok = ok && match;
+        double s = dec_s + agg_s;
+        printf("  %-28s %8.1f ms  %7.1f M registros/s  %5.1fx  (separar %.1f ms, agregar %.1f ms)  %s\n",
+               simd_name(lvl), s * 1e3, samples / s / 1e6, naive4_s / s, dec_s * 1e3, agg_s * 1e3,
+               match ? "ok" : "DIFERENTE");
+    }
+    simd_force(simd_detect());
+
+    printf("\nverificacao: %s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,359 @@
+// sample_batch.cpp
+//
+// Laços de decodificação e agregação de sample_batch.hpp. As versões SSE2 e
+// AVX2 ficam no mesmo arquivo, com o atributo target, para não exigir flags
+// de compilação: a escolha é feita em tempo de execução.
+
+#include "sample_batch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include "lora_proto.h"
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SAMPLE_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// ============================
+// ESCALAR
+// ============================
+
+void decode_dados_scalar(const uint8_t *buf, size_t n, int16_t *temp, int16_t *umid) {
+    for (size_t i = 0; i < n; i++) {
+        std::memcpy(&temp[i], buf + 4 * i, 2);
+        std::memcpy(&umid[i], buf + 4 * i + 2, 2);
+    }
+}
+
+Agg16 aggregate_scalar(const int16_t *v, size_t n) {
+    Agg16 a;
+    a.count = (uint32_t)n;
+    for (size_t i = 0; i < n; i++) {
+        a.min = std::min(a.min, v[i]);
+        a.max = std::max(a.max, v[i]);
+        a.sum += v[i];
+    }
+    return a;
+}
+
+#ifdef SAMPLE_BATCH_X86
+
+// ============================
+// SSE2
+// ============================
+
+// pmaddwd com 1 soma pares de int16 em int32 (|par| <= 65536); o acumulador
+// de 32 bits é esvaziado para 64 bits antes de poder transbordar
+constexpr size_t kSumFlushIters = 16384;
+
+__attribute__((target("sse2")))
+void decode_dados_sse2(const uint8_t *buf, size_t n, int16_t *temp, int16_t *umid) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(buf + 4 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(buf + 4 * i + 16));
+        // Cada int32 é {temperatura (baixa), umidade (alta)}
+        __m128i ta = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        __m128i tb = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        __m128i ua = _mm_srai_epi32(a, 16);
+        __m128i ub = _mm_srai_epi32(b, 16);
+        _mm_storeu_si128((__m128i *)(temp + i), _mm_packs_epi32(ta, tb));
+        _mm_storeu_si128((__m128i *)(umid + i), _mm_packs_epi32(ua, ub));
+    }
+    decode_dados_scalar(buf + 4 * i, n - i, temp + i, umid + i);
+}
+
+__attribute__((target("sse2")))
+Agg16 aggregate_sse2(const int16_t *v, size_t n) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i vmin = _mm_set1_epi16(INT16_MAX);
+    __m128i vmax = _mm_set1_epi16(INT16_MIN);
+    __m128i sum64 = _mm_setzero_si128();
+    size_t i = 0;
+    const size_t vec_end = n & ~(size_t)7;
+    while (i < vec_end) {
+        size_t stop = std::min(vec_end, i + 8 * kSumFlushIters);
+        __m128i sum32 = _mm_setzero_si128();
+        for (; i < stop; i += 8) {
+            __m128i x = _mm_loadu_si128((const __m128i *)(v + i));
+            vmin = _mm_min_epi16(vmin, x);
+            vmax = _mm_max_epi16(vmax, x);
+            sum32 = _mm_add_epi32(sum32, _mm_madd_epi16(x, ones));
+        }
+        __m128i sign = _mm_srai_epi32(sum32, 31);
+        sum64 = _mm_add_epi64(sum64, _mm_unpacklo_epi32(sum32, sign));
+        sum64 = _mm_add_epi64(sum64, _mm_unpackhi_epi32(sum32, sign));
+    }
+
+    // Redução horizontal das 8 faixas
+    vmin = _mm_min_epi16(vmin, _mm_srli_si128(vmin, 8));
+    vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 8));
+    vmin = _mm_min_epi16(vmin, _mm_srli_si128(vmin, 4));
+    vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 4));
+    vmin = _mm_min_epi16(vmin, _mm_srli_si128(vmin, 2));
+    vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 2));
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, sum64);
+
+    Agg16 a = aggregate_scalar(v + i, n - i);
+    a.count = (uint32_t)n;
+    a.min = std::min(a.min, (int16_t)_mm_extract_epi16(vmin, 0));
+    a.max = std::max(a.max, (int16_t)_mm_extract_epi16(vmax, 0));
+    a.sum += lanes[0] + lanes[1];
+    return a;
+}
+
+// ============================
+// AVX2
+// ============================
+
+__attribute__((target("avx2")))
+void decode_dados_avx2(const uint8_t *buf, size_t n, int16_t *temp, int16_t *umid) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(buf + 4 * i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(buf + 4 * i + 32));
+        __m256i ta = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+        __m256i tb = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+        __m256i ua = _mm256_srai_epi32(a, 16);
+        __m256i ub = _mm256_srai_epi32(b, 16);
+        // packs trabalha em cada metade de 128 bits: reordena os blocos de 64 bits
+        __m256i t = _mm256_permute4x64_epi64(_mm256_packs_epi32(ta, tb), 0xD8);
+        __m256i u = _mm256_permute4x64_epi64(_mm256_packs_epi32(ua, ub), 0xD8);
+        _mm256_storeu_si256((__m256i *)(temp + i), t);
+        _mm256_storeu_si256((__m256i *)(umid + i), u);
+    }
+    for (; i < n; i++) {
+        std::memcpy(&temp[i], buf + 4 * i, 2);
+        std::memcpy(&umid[i], buf + 4 * i + 2, 2);
+    }
+}
+
+__attribute__((target("avx2")))
+Agg16 aggregate_avx2(const int16_t *v, size_t n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i vmin = _mm256_set1_epi16(INT16_MAX);
+    __m256i vmax = _mm256_set1_epi16(INT16_MIN);
+    __m256i sum64 = _mm256_setzero_si256();
+    size_t i = 0;
+    const size_t vec_end = n & ~(size_t)15;
+    while (i < vec_end) {
+        size_t stop = std::min(vec_end, i + 16 * kSumFlushIters);
+        __m256i sum32 = _mm256_setzero_si256();
+        for (; i < stop; i += 16) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(v + i));
+            vmin = _mm256_min_epi16(vmin, x);
+            vmax = _mm256_max_epi16(vmax, x);
+            sum32 = _mm256_add_epi32(sum32, _mm256_madd_epi16(x, ones));
+        }
+        __m256i sign = _mm256_srai_epi32(sum32, 31);
+        sum64 = _mm256_add_epi64(sum64, _mm256_unpacklo_epi32(sum32, sign));
+        sum64 = _mm256_add_epi64(sum64, _mm256_unpackhi_epi32(sum32, sign));
+    }
+
+    // Redução horizontal (ainda em AVX, sem chamar código SSE2 com a parte alta suja)
+    __m128i min128 = _mm_min_epi16(_mm256_castsi256_si128(vmin), _mm256_extracti128_si256(vmin, 1));
+    __m128i max128 = _mm_max_epi16(_mm256_castsi256_si128(vmax), _mm256_extracti128_si256(vmax, 1));
+    min128 = _mm_min_epi16(min128, _mm_srli_si128(min128, 8));
+    max128 = _mm_max_epi16(max128, _mm_srli_si128(max128, 8));
+    min128 = _mm_min_epi16(min128, _mm_srli_si128(min128, 4));
+    max128 = _mm_max_epi16(max128, _mm_srli_si128(max128, 4));
+    min128 = _mm_min_epi16(min128, _mm_srli_si128(min128, 2));
+    max128 = _mm_max_epi16(max128, _mm_srli_si128(max128, 2));
+    __m128i sum128 = _mm_add_epi64(_mm256_castsi256_si128(sum64), _mm256_extracti128_si256(sum64, 1));
+    sum128 = _mm_add_epi64(sum128, _mm_srli_si128(sum128, 8));
+
+    Agg16 a;
+    a.count = (uint32_t)n;
+    a.min = (int16_t)_mm_extract_epi16(min128, 0);
+    a.max = (int16_t)_mm_extract_epi16(max128, 0);
+    a.sum = _mm_cvtsi128_si64(sum128);
+    for (; i < n; i++) {
+        a.min = std::min(a.min, v[i]);
+        a.max = std::max(a.max, v[i]);
+        a.sum += v[i];
+    }
+    return a;
+}
+
+#endif // SAMPLE_BATCH_X86
+
+SimdLevel g_level = simd_detect();
+
+} // namespace
+
+// ============================
+// SELEÇÃO
+// ============================
+
+SimdLevel simd_detect() {
+#ifdef SAMPLE_BATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::Sse2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel simd_level() {
+    return g_level;
+}
+
+void simd_force(SimdLevel level) {
+    g_level = std::min(level, simd_detect());
+}
+
+const char *simd_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2: return "AVX2";
+    case SimdLevel::Sse2: return "SSE2";
+    default: return "escalar";
+    }
+}
+
+void decode_dados(const uint8_t *buf, size_t n, int16_t *temp, int16_t *umid) {
+    switch (g_level) {
+#ifdef SAMPLE_BATCH_X86
+    case SimdLevel::Avx2: decode_dados_avx2(buf, n, temp, umid); return;
+    case SimdLevel::Sse2: decode_dados_sse2(buf, n, temp, umid); return;
+#endif
+    default: decode_dados_scalar(buf, n, temp, umid); return;
+    }
+}
+
+Agg16 aggregate(const int16_t *v, size_t n) {
+    switch (g_level) {
+#ifdef SAMPLE_BATCH_X86
+    case SimdLevel::Avx2: return aggregate_avx2(v, n);
+    case SimdLevel::Sse2: return aggregate_sse2(v, n);
+#endif
+    default: return aggregate_scalar(v, n);
+    }
+}
+
+void Agg16::merge(const Agg16 &o) {
+    count += o.count;
+    min = std::min(min, o.min);
+    max = std::max(max, o.max);
+    sum += o.sum;
+}
+
+// ============================
+// LOTE
+// ============================
+
+size_t SampleBatch::size() const {
+    size_t n = 0;
+    for (const NodeColumns &c : nodes) n += c.size();
+    return n;
+}
+
+void SampleBatch::clear() {
+    for (NodeColumns &c : nodes) {
+        c.ts_ms.clear();
+        c.temp.clear();
+        c.umid.clear();
+    }
+}
+
+void SampleBatch::append_samples(const uint8_t *buf, size_t n) {
+    // Passo de 10 bytes: não compensa vetorizar. Espalhar direto nas colunas
+    // de cada nó escreveria em 3 x nós fluxos que começam todos alinhados a
+    // página (mesmo conjunto da cache L1); então cada pedaço é primeiro
+    // agrupado por nó num rascunho contíguo e depois copiado em blocos.
+    constexpr size_t kChunk = 16384;
+    std::vector<uint64_t> sts(kChunk);
+    std::vector<int16_t> st(kChunk), su(kChunk);
+
+    for (size_t done = 0; done < n; done += kChunk) {
+        const uint8_t *p = buf + done * sizeof(lora_sample_t);
+        size_t m = std::min(kChunk, n - done);
+
+        size_t start[257] = {};
+        for (size_t i = 0; i < m; i++) start[p[i * sizeof(lora_sample_t) + offsetof(lora_sample_t, node_id)] + 1]++;
+        for (int id = 0; id < 256; id++) start[id + 1] += start[id];
+
+        size_t pos[256];
+        std::copy(start, start + 256, pos);
+        for (size_t i = 0; i < m; i++, p += sizeof(lora_sample_t)) {
+            lora_sample_t s;
+            std::memcpy(&s, p, sizeof(s));
+            size_t k = pos[s.node_id]++;
+            st[k] = s.temperatura;
+            su[k] = s.umidade;
+            sts[k] = s.timestamp_ms;
+        }
+
+        for (int id = 0; id < 256; id++) {
+            if (start[id] == start[id + 1]) continue;
+            NodeColumns &c = nodes[id];
+            c.ts_ms.insert(c.ts_ms.end(), sts.begin() + start[id], sts.begin() + start[id + 1]);
+            c.temp.insert(c.temp.end(), st.begin() + start[id], st.begin() + start[id + 1]);
+            c.umid.insert(c.umid.end(), su.begin() + start[id], su.begin() + start[id + 1]);
+        }
+    }
+}
+
+void SampleBatch::append_dados(const uint8_t *buf, size_t n, uint8_t node_id, const uint64_t *ts) {
+    NodeColumns &c = nodes[node_id];
+    size_t at = c.size();
+    c.ts_ms.insert(c.ts_ms.end(), ts, ts + n);
+    c.temp.resize(at + n);
+    c.umid.resize(at + n);
+    decode_dados(buf, n, c.temp.data() + at, c.umid.data() + at);
+}
+
+void window_aggregates(const NodeColumns &c, uint8_t node_id, uint64_t window_ms, std::vector<WindowAgg> &out) {
+    const size_t n = c.size();
+    const int16_t *temp = c.temp.data();
+    const int16_t *umid = c.umid.data();
+    const uint64_t *ts = c.ts_ms.data();
+
+    // Relógio fora de ordem (ex.: nó que ressincronizou): ordena uma cópia
+    std::vector<int16_t> st, su;
+    std::vector<uint64_t> sts;
+    if (!std::is_sorted(ts, ts + n)) {
+        std::vector<size_t> perm(n);
+        for (size_t k = 0; k < n; k++) perm[k] = k;
+        std::stable_sort(perm.begin(), perm.end(), [&](size_t x, size_t y) { return ts[x] < ts[y]; });
+        st.resize(n);
+        su.resize(n);
+        sts.resize(n);
+        for (size_t k = 0; k < n; k++) {
+            st[k] = temp[perm[k]];
+            su[k] = umid[perm[k]];
+            sts[k] = ts[perm[k]];
+        }
+        temp = st.data();
+        umid = su.data();
+        ts = sts.data();
+    }
+
+    for (size_t i = 0; i < n;) {
+        size_t j = n;
+        uint64_t w = ts[i];
+        if (window_ms > 0) {
+            w -= w % window_ms;
+            j = (size_t)(std::lower_bound(ts + i, ts + n, w + window_ms) - ts);
+        }
+        WindowAgg a;
+        a.node = node_id;
+        a.start_ms = w;
+        a.temp = aggregate(temp + i, j - i);
+        a.umid = aggregate(umid + i, j - i);
+        out.push_back(a);
+        i = j;
+    }
+}
+
+std::vector<WindowAgg> window_aggregates(const SampleBatch &b, uint64_t window_ms) {
+    std::vector<WindowAgg> out;
+    for (int id = 0; id < 256; id++) window_aggregates(b.nodes[id], (uint8_t)id, window_ms, out);
+    return out;
+}
@@ -0,0 +1,83 @@
+// sample_batch.hpp
+//
+// Decodificação em lote e agregados por janela das amostras gravadas.
+//
+// Os registros empacotados (struct dados de 4 bytes, ou lora_sample_t de 10)
+// são convertidos de uma vez em colunas contíguas (temperatura[], umidade[],
+// ...), e os agregados (mínimo, máximo, soma) são calculados sobre fatias
+// dessas colunas. Os laços internos têm versões SSE2 e AVX2, escolhidas em
+// tempo de execução pela CPU, e uma versão escalar para as demais.
+
+#ifndef SAMPLE_BATCH_HPP_
+#define SAMPLE_BATCH_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class SimdLevel { Scalar, Sse2, Avx2 };
+
+// Melhor nível suportado por esta CPU
+SimdLevel simd_detect();
+// Nível em uso (padrão: simd_detect()); o benchmark força cada um
+SimdLevel simd_level();
+void simd_force(SimdLevel level);
+const char *simd_name(SimdLevel level);
+
+// Mínimo, máximo e soma de uma fatia de valores * 100
+struct Agg16 {
+    uint32_t count = 0;
+    int16_t min = INT16_MAX;
+    int16_t max = INT16_MIN;
+    int64_t sum = 0;
+
+    void merge(const Agg16 &o);
+    // Média * 100, arredondada para baixo
+    int16_t mean() const { return count ? (int16_t)(sum / (int64_t)count - (sum % (int64_t)count < 0)) : 0; }
+};
+
+// Separa n registros de 4 bytes {int16 temperatura, int16 umidade} em duas colunas
+void decode_dados(const uint8_t *buf, size_t n, int16_t *temp, int16_t *umid);
+
+// Agregado de v[0..n)
+Agg16 aggregate(const int16_t *v, size_t n);
+
+// Colunas das leituras de um nó, na ordem da captura
+struct NodeColumns {
+    std::vector<uint64_t> ts_ms;
+    std::vector<int16_t> temp;
+    std::vector<int16_t> umid;
+
+    size_t size() const { return temp.size(); }
+};
+
+// Leituras de vários nós, já separadas por nó e por campo
+struct SampleBatch {
+    std::array<NodeColumns, 256> nodes;
+
+    size_t size() const;
+    void clear();
+
+    // Acrescenta n lora_sample_t (10 bytes cada) empacotados em buf; o tempo
+    // vem do timestamp_ms da amostra
+    void append_samples(const uint8_t *buf, size_t n);
+    // Acrescenta n registros de 4 bytes de um nó, com instantes ts_ms[0..n)
+    void append_dados(const uint8_t *buf, size_t n, uint8_t node_id, const uint64_t *ts_ms);
+};
+
+struct WindowAgg {
+    uint8_t node;
+    uint64_t start_ms;     // início da janela (múltiplo de window_ms)
+    Agg16 temp;
+    Agg16 umid;
+};
+
+// Agregados de um nó por janela de window_ms (0 = uma janela só), em ordem de
+// tempo. Leituras fora de ordem de tempo são ordenadas antes.
+void window_aggregates(const NodeColumns &c, uint8_t node_id, uint64_t window_ms, std::vector<WindowAgg> &out);
+
+// O mesmo para todos os nós do lote, em ordem de nó
+std::vector<WindowAgg> window_aggregates(const SampleBatch &b, uint64_t window_ms);
+
+#endif // SAMPLE_BATCH_HPP_
@@ -0,0 +1,152 @@
+// trace_query.cpp
+//
+// Consultas sobre capturas do fluxo binário da BitDogLab (modo "bin"):
+// mínimo, médio e máximo de temperatura e umidade por nó, no total ou por
+// janela de tempo. As amostras de todos os arquivos são juntadas em colunas
+// (sample_batch.hpp) e os agregados usam os laços SIMD.
+//
+// O tempo de cada leitura é o timestamp_ms da amostra (tempo de rede); sem
+// sincronismo (0) ou no quadro antigo de 4 bytes, vale o instante do RxDone.
+// Com --dados, os arquivos são registros de 4 bytes (struct dados) colados,
+// um a cada --intervalo-s segundos, atribuídos ao nó 0.
+//
+// Uso: trace_query [--janela-s S] [--node N] [--dados] [--intervalo-s S] arquivo...
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <getopt.h>
+
+#include "frame_reader.hpp"
+#include "reading.hpp"
+#include "sample_batch.hpp"
+
+namespace {
+
+struct Capture {
+    std::vector<uint8_t> samples;     // lora_sample_t empacotadas
+    std::vector<uint8_t> dados;       // quadros antigos de 4 bytes
+    std::vector<uint64_t> dados_ms;
+    uint64_t records = 0, skipped = 0;
+};
+
+// Lê um arquivo capturado do fluxo binário
+bool load_stream(const char *path, Capture &cap) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    FrameReader reader;
+    bool have_rx = false;
+    uint32_t last_rx_us = 0;
+    uint64_t rx_us = 0;          // relógio do receptor sem a volta dos 32 bits
+    uint8_t buf[1 << 16];
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) {
+        reader.feed(buf, got, [&](const uint8_t *rec, size_t len) {
+            Reading r;
+            cap.records++;
+            if (decode_reading(rec, len, r) != DecodeResult::Reading) {
+                cap.skipped++;
+                return;
+            }
+            if (have_rx) rx_us += (uint32_t)(r.rx_time_us - last_rx_us);
+            else rx_us = r.rx_time_us;
+            have_rx = true;
+            last_rx_us = r.rx_time_us;
+
+            if (!r.has_id) {
+                const uint8_t *p = reinterpret_cast<const uint8_t *>(&r.d);
+                cap.dados.insert(cap.dados.end(), p, p + sizeof(dados));
+                cap.dados_ms.push_back(rx_us / 1000);
+                return;
+            }
+            lora_sample_t s = { r.d.temperatura, r.d.umidade, r.timestamp_ms, r.node_id, r.seq };
+            if (s.timestamp_ms == 0) s.timestamp_ms = (uint32_t)(rx_us / 1000);
+            const uint8_t *p = reinterpret_cast<const uint8_t *>(&s);
+            cap.samples.insert(cap.samples.end(), p, p + sizeof(s));
+        });
+    }
+    fclose(f);
+    return true;
+}
+
+// Lê um arquivo de registros de 4 bytes colados
+bool load_dados(const char *path, unsigned interval_s, Capture &cap) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buf[1 << 16];
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) cap.dados.insert(cap.dados.end(), buf, buf + got);
+    fclose(f);
+    cap.dados.resize(cap.dados.size() / sizeof(dados) * sizeof(dados));
+    size_t n = cap.dados.size() / sizeof(dados);
+    while (cap.dados_ms.size() < n) cap.dados_ms.push_back(cap.dados_ms.size() * interval_s * 1000ull);
+    cap.records = n;
+    return true;
+}
+
+void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--janela-s S] [--node N] [--dados] [--intervalo-s S] arquivo...\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint64_t window_ms = 0;
+    int node = -1;
+    bool raw = false;
+    unsigned interval_s = 30;
+    static const option long_opts[] = {
+        { "janela-s",    required_argument, nullptr, 'j' },
+        { "node",        required_argument, nullptr, 'n' },
+        { "dados",       no_argument,       nullptr, 'd' },
+        { "intervalo-s", required_argument, nullptr, 'i' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "j:n:di:", long_opts, nullptr)) != -1) {
+        switch (c) {
+        case 'j': window_ms = strtoull(optarg, nullptr, 10) * 1000; break;
+        case 'n': node = atoi(optarg); break;
+        case 'd': raw = true; break;
+        case 'i': interval_s = (unsigned)atoi(optarg); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind >= argc || node > 255) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Capture cap;
+    for (int i = optind; i < argc; i++) {
+        if (!(raw ? load_dados(argv[i], interval_s, cap) : load_stream(argv[i], cap))) {
+            perror(argv[i]);
+            return 1;
+        }
+    }
+
+    SampleBatch batch;
+    size_t n_samples = cap.samples.size() / sizeof(lora_sample_t);
+    size_t n_dados = cap.dados_ms.size();
+    batch.append_samples(cap.samples.data(), n_samples);
+    batch.append_dados(cap.dados.data(), n_dados, 0, cap.dados_ms.data());
+    fprintf(stderr, "%llu registros, %zu leituras (%zu amostras, %zu quadros de 4 bytes), %llu ignorados, %s\n",
+            (unsigned long long)cap.records, batch.size(), n_samples, n_dados, (unsigned long long)cap.skipped,
+            simd_name(simd_level()));
+
+    printf("node_id,inicio_ms,leituras,temp_min,temp_media,temp_max,umid_min,umid_media,umid_max\n");
+    std::vector<WindowAgg> windows;
+    if (node >= 0) window_aggregates(batch.nodes[node], (uint8_t)node, window_ms, windows);
+    else windows = window_aggregates(batch, window_ms);
+
+    char b[6][8];
+    for (const WindowAgg &w : windows) {
+        printf("%u,%llu,%u,%s,%s,%s,%s,%s,%s\n", w.node, (unsigned long long)w.start_ms, w.temp.count,
+               centi(b[0], w.temp.min), centi(b[1], w.temp.mean()), centi(b[2], w.temp.max), centi(b[3], w.umid.min),
+               centi(b[4], w.umid.mean()), centi(b[5], w.umid.max));
+    }
+    return 0;
+}
@@ -0,0 +1,239 @@
+// filter_bench.c
+//
+// Confere o filtro das leituras do nó FPGA (fpga/firmware/filter.c, só
+// inteiros) contra uma implementação de referência em ponto flutuante do
+// mesmo pipeline (mediana -> média de sobreamostragem -> EMA), sobre um sinal
+// sintético de temperatura: variação lenta, ruído gaussiano e picos absurdos
+// como os de uma leitura corrompida no I2C bit-bang.
+//
+// Informa a maior diferença entre as duas saídas (em centésimos; acima de
+// --tolerancia sai com erro), o quanto cada uma se afasta do sinal verdadeiro
+// comparado com as conversões cruas, e o custo por conversão no host (ns e,
+// em x86, ciclos do TSC). O custo no VexRiscv sai do comando "bench" do
+// firmware (linha BENCH,op,filter_push).
+//
+// Uso: filter_bench [--amostras N] [--mediana M] [--sobreamostragem O] [--ema E]
+//                   [--ruido R] [--outliers P] [--tolerancia T] [--seed N]
+
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "filter.h"
+
+// Referência em double, mesma estrutura de filter_chan_t
+typedef struct {
+    filter_cfg_t cfg;
+    double window[FILTER_MEDIAN_MAX];
+    unsigned filled, pos, acc_n;
+    double acc, ema;
+    bool ema_primed;
+} ref_chan_t;
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static bool ref_push(ref_chan_t *f, double raw, double *out) {
+    const filter_cfg_t *c = &f->cfg;
+    f->window[f->pos] = raw;
+    f->pos = (f->pos + 1) % c->median_n;
+    if (f->filled < c->median_n) f->filled++;
+    double med = raw;
+    if (c->median_n > 1) {
+        unsigned n = (f->filled & 1) ? f->filled : f->filled - 1;
+        double recent[FILTER_MEDIAN_MAX];
+        for (unsigned i = 0; i < n; i++) recent[i] = f->window[(f->pos + c->median_n - 1 - i) % c->median_n];
+        qsort(recent, n, sizeof(double), cmp_double);
+        med = recent[n / 2];
+    }
+    f->acc += med;
+    if (++f->acc_n < c->oversample) return false;
+    double avg = f->acc / c->oversample;
+    f->acc = 0;
+    f->acc_n = 0;
+    if (!f->ema_primed || c->ema_shift == 0) {
+        f->ema = avg;
+        f->ema_primed = true;
+    } else {
+        f->ema += (avg - f->ema) / (double)(1u << c->ema_shift);
+    }
+    *out = f->ema;
+    return true;
+}
+
+static double uniform(void) {
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static double gaussian(void) {
+    double u = uniform() + 1e-12, v = uniform();
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--amostras N] [--mediana M] [--sobreamostragem O] [--ema E]\n"
+                    "       [--ruido R] [--outliers P] [--tolerancia T] [--seed N]\n", prog);
+    fprintf(stderr, "  amostras = conversoes do AHT10; ruido (desvio padrao) e tolerancia em centesimos;\n"
+                    "  outliers = probabilidade de uma conversao absurda (padrao 0.02)\n");
+}
+
+int main(int argc, char **argv) {
+    filter_cfg_t cfg = FILTER_DEFAULT_CFG;
+    unsigned long n_conv = 100000;
+    double noise = 5.0, p_outlier = 0.02;
+    int tolerance = 1;
+    unsigned seed = 1;
+
+    static const struct option opts[] = {
+        { "amostras", required_argument, NULL, 'n' },
+        { "mediana", required_argument, NULL, 'm' },
+        { "sobreamostragem", required_argument, NULL, 'o' },
+        { "ema", required_argument, NULL, 'e' },
+        { "ruido", required_argument, NULL, 'r' },
+        { "outliers", required_argument, NULL, 'p' },
+        { "tolerancia", required_argument, NULL, 't' },
+        { "seed", required_argument, NULL, 's' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "n:m:o:e:r:p:t:s:", opts, NULL)) != -1) {
+        switch (c) {
+        case 'n': n_conv = strtoul(optarg, NULL, 0); break;
+        case 'm': cfg.median_n = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'o': cfg.oversample = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'e': cfg.ema_shift = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'r': noise = atof(optarg); break;
+        case 'p': p_outlier = atof(optarg); break;
+        case 't': tolerance = atoi(optarg); break;
+        case 's': seed = (unsigned)strtoul(optarg, NULL, 0); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (n_conv == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    filter_chan_t fi;
+    filter_init(&fi, &cfg);
+    cfg = fi.cfg; // já ajustada aos limites
+    ref_chan_t fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.cfg = cfg;
+
+    // Sinal: 25 C +- 3 C com período de 5000 conversões, em centésimos
+    srand(seed);
+    int16_t *raw = malloc(n_conv * sizeof(int16_t));
+    double *truth = malloc(n_conv * sizeof(double));
+    if (!raw || !truth) {
+        perror("malloc");
+        return 1;
+    }
+    unsigned long outliers = 0;
+    for (unsigned long i = 0; i < n_conv; i++) {
+        truth[i] = 2500.0 + 300.0 * sin(2.0 * M_PI * (double)i / 5000.0);
+        double v = truth[i] + noise * gaussian();
+        if (uniform() < p_outlier) {
+            v = -5000.0 + uniform() * 20000.0; // faixa do AHT10: -50 C a 150 C
+            outliers++;
+        }
+        raw[i] = (int16_t)lround(v);
+    }
+
+    // Saídas lado a lado e erro contra o sinal verdadeiro
+    unsigned long outputs = 0, mismatches = 0;
+    int max_diff = 0;
+    double sum_diff = 0, se_raw = 0, se_int = 0, se_ref = 0, max_err_raw = 0, max_err_int = 0;
+    for (unsigned long i = 0; i < n_conv; i++) {
+        double err = fabs(raw[i] - truth[i]);
+        se_raw += err * err;
+        if (err > max_err_raw) max_err_raw = err;
+
+        int16_t yi;
+        double yr;
+        bool di = filter_push(&fi, raw[i], &yi);
+        bool dr = ref_push(&fr, raw[i], &yr);
+        if (di != dr) {
+            fprintf(stderr, "filter_bench: saidas fora de fase na conversao %lu\n", i);
+            return 1;
+        }
+        if (!di) continue;
+        outputs++;
+        int d = abs(yi - (int)lround(yr));
+        if (d > max_diff) max_diff = d;
+        if (d > tolerance) mismatches++;
+        sum_diff += fabs(yi - yr);
+        double ei = fabs(yi - truth[i]), er = fabs(yr - truth[i]);
+        se_int += ei * ei;
+        se_ref += er * er;
+        if (ei > max_err_int) max_err_int = ei;
+    }
+
+    // Custo por conversão (mesma entrada, filtros recomeçados)
+    volatile int16_t sink_i = 0; // mantém os laços medidos
+    volatile double sink_r = 0;
+    filter_init(&fi, &cfg);
+    double t0 = now_ns();
+#if HAVE_TSC
+    uint64_t c0 = __rdtsc();
+#endif
+    for (unsigned long i = 0; i < n_conv; i++) {
+        int16_t y;
+        if (filter_push(&fi, raw[i], &y)) sink_i ^= y;
+    }
+#if HAVE_TSC
+    uint64_t cyc_int = __rdtsc() - c0;
+#endif
+    double ns_int = now_ns() - t0;
+
+    memset(&fr, 0, sizeof(fr));
+    fr.cfg = cfg;
+    t0 = now_ns();
+#if HAVE_TSC
+    c0 = __rdtsc();
+#endif
+    for (unsigned long i = 0; i < n_conv; i++) {
+        double y;
+        if (ref_push(&fr, raw[i], &y)) sink_r += y;
+    }
+#if HAVE_TSC
+    uint64_t cyc_ref = __rdtsc() - c0;
+#endif
+    double ns_ref = now_ns() - t0;
+
+    printf("filtro: mediana de %u, %u conversoes por amostra, EMA alfa 1/%u\n", cfg.median_n, cfg.oversample,
+           1u << cfg.ema_shift);
+    printf("sinal: %lu conversoes, ruido %.1f centesimos, %lu outliers (%.2f%%); %lu amostras filtradas\n", n_conv,
+           noise, outliers, 100.0 * outliers / n_conv, outputs);
+    printf("inteiro x referencia: diferenca maxima %d, media %.3f centesimos; %lu acima da tolerancia (%d)\n",
+           max_diff, outputs ? sum_diff / outputs : 0.0, mismatches, tolerance);
+    printf("erro contra o sinal (centesimos): %12s %10s\n", "rms", "max");
+    printf("  conversoes cruas                 %12.2f %10.1f\n", sqrt(se_raw / n_conv), max_err_raw);
+    printf("  filtro inteiro                   %12.2f %10.1f\n", outputs ? sqrt(se_int / outputs) : 0.0, max_err_int);
+    printf("  referencia double                %12.2f\n", outputs ? sqrt(se_ref / outputs) : 0.0);
+    printf("custo por conversao no host: inteiro %.1f ns, double %.1f ns", ns_int / n_conv, ns_ref / n_conv);
+#if HAVE_TSC
+    printf(" (TSC: %.1f e %.1f ciclos)", (double)cyc_int / n_conv, (double)cyc_ref / n_conv);
+#endif
+    printf("\n");
+
+    free(raw);
+    free(truth);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+// flashlog_decode.c
+//
+// Converte em CSV o dump do log em flash da BitDogLab (comando "dump").
+// A saída da serial pode ser capturada direto num arquivo, por exemplo:
+//   (echo dump; sleep 5) > /dev/ttyACM0 & cat /dev/ttyACM0 > dump.bin
+//
+// Uso: flashlog_decode [arquivo]   (sem arquivo, lê da entrada padrão)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash_log.h"
+
+#define BEGIN_MARK "FLASHLOG INICIO\n"
+
+static unsigned char *read_all(FILE *f, size_t *len) {
+    size_t cap = 1 << 20, n = 0;
+    unsigned char *buf = malloc(cap);
+    size_t got;
+    while (buf && (got = fread(buf + n, 1, cap - n, f)) > 0) {
+        n += got;
+        if (n == cap) buf = realloc(buf, cap *= 2);
+    }
+    *len = n;
+    return buf;
+}
+
+int main(int argc, char **argv) {
+    FILE *in = stdin;
+    if (argc > 1 && !(in = fopen(argv[1], "rb"))) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    size_t len;
+    unsigned char *data = read_all(in, &len);
+    if (!data) {
+        fprintf(stderr, "Sem memoria\n");
+        return 1;
+    }
+
+    // O marcador pode vir depois de outras mensagens do console
+    size_t mark = strlen(BEGIN_MARK), pos = 0;
+    while (pos + mark <= len && memcmp(data + pos, BEGIN_MARK, mark) != 0) pos++;
+    if (pos + mark > len) {
+        fprintf(stderr, "Marcador '%s' nao encontrado\n", "FLASHLOG INICIO");
+        return 1;
+    }
+    pos += mark;
+
+    unsigned pages = 0, bad = 0, records = 0;
+    printf("boot,page_seq,rx_ms,timestamp_ms,node_id,seq,temperatura,umidade,rssi_dbm,snr_db\n");
+    while (pos + FLASH_LOG_PAGE_SIZE <= len) {
+        flash_log_page_t page;
+        memcpy(&page, data + pos, sizeof(page));
+        if (page.hdr.magic != FLASH_LOG_MAGIC) break; // "\nFLASHLOG FIM"
+        pos += FLASH_LOG_PAGE_SIZE;
+        if (!flash_log_page_valid(&page)) {
+            bad++;
+            continue;
+        }
+        pages++;
+        for (unsigned i = 0; i < page.hdr.count; i++) {
+            const flash_log_record_t *r = &page.rec[i];
+            printf("%u,%u,%u,%u,%u,%u,%.2f,%.2f,%d,%.2f\n", page.hdr.boot, page.hdr.seq, r->rx_ms,
+                   r->timestamp_ms, r->node_id, r->seq, r->temperatura / 100.0, r->umidade / 100.0,
+                   -(int)r->rssi_neg_dbm, r->snr_qdb / 4.0);
+            records++;
+        }
+    }
+    fprintf(stderr, "%u paginas, %u registros, %u paginas com CRC invalido\n", pages, records, bad);
+    free(data);
+    return bad ? 2 : 0;
+}
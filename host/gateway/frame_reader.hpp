@@ -0,0 +1,77 @@
+// frame_reader.hpp
+//
+// Separação incremental dos quadros COBS do fluxo binário da BitDogLab
+// (common/lora_stream.h). Os bytes chegam em pedaços arbitrários do read();
+// o quadro é acumulado num buffer fixo e decodificado no próprio buffer ao
+// chegar o delimitador, sem alocação por quadro.
+
+#ifndef FRAME_READER_HPP_
+#define FRAME_READER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include "cobs.h"
+#include "lora_stream.h"
+}
+
+struct FrameStats {
+    uint64_t bytes = 0;
+    uint64_t frames = 0;      // quadros não vazios entre delimitadores
+    uint64_t records = 0;     // quadros com COBS e CRC válidos
+    uint64_t bad_cobs = 0;    // inclui texto solto do console
+    uint64_t bad_crc = 0;
+    uint64_t oversize = 0;    // passaram do tamanho máximo de um registro
+};
+
+class FrameReader {
+public:
+    static constexpr size_t kMaxFrame = COBS_MAX_ENCODED(LORA_STREAM_MAX_RECORD);
+
+    // Entrega cada registro válido (sem o CRC) a on_record(const uint8_t*, size_t)
+    template <typename OnRecord>
+    void feed(const uint8_t *data, size_t len, OnRecord &&on_record) {
+        stats_.bytes += len;
+        for (size_t i = 0; i < len; i++) {
+            uint8_t c = data[i];
+            if (c != 0) {
+                if (len_ < buf_.size()) buf_[len_++] = c;
+                else overflow_ = true;
+                continue;
+            }
+            if (overflow_) {
+                stats_.oversize++;
+            } else if (len_ > 0) {
+                stats_.frames++;
+                // A decodificação COBS nunca escreve à frente do que leu
+                size_t n = cobs_decode(buf_.data(), len_, buf_.data());
+                if (n == 0) stats_.bad_cobs++;
+                else if ((n = lora_stream_check(buf_.data(), n)) == 0) stats_.bad_crc++;
+                else {
+                    stats_.records++;
+                    on_record(buf_.data(), n);
+                }
+            }
+            len_ = 0;
+            overflow_ = false;
+        }
+    }
+
+    // Descarta um quadro parcial (ex.: porta reaberta)
+    void reset() {
+        len_ = 0;
+        overflow_ = false;
+    }
+
+    const FrameStats &stats() const { return stats_; }
+
+private:
+    std::array<uint8_t, kMaxFrame> buf_{};
+    size_t len_ = 0;
+    bool overflow_ = false;
+    FrameStats stats_;
+};
+
+#endif // FRAME_READER_HPP_
@@ -0,0 +1,244 @@
+// gateway_loadgen.cpp
+//
+// Teste de carga do lora_gateway: cria N pseudo-terminais que fazem o papel
+// de receptores BitDogLab em modo "bin", inicia o gateway apontando para eles
+// e injeta registros na taxa pedida. Cada leitura é enviada por "copies"
+// receptores diferentes (como quando vários receptores ouvem o mesmo nó); no
+// fim confere se o gateway entregou cada leitura exatamente uma vez.
+//
+// Uso: gateway_loadgen [--gateway caminho] [--receivers N] [--rate quadros/s]
+//                      [--seconds S] [--copies K] [--seed N]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+extern "C" {
+#include "cobs.h"
+#include "lora_proto.h"
+#include "lora_stream.h"
+}
+
+namespace {
+
+struct Receiver {
+    int master = -1;
+    int slave = -1;           // mantido aberto: o pty não sinaliza HUP antes do gateway abrir
+    std::string path;
+    uint16_t stream_seq = 0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+bool open_pty(Receiver &r) {
+    r.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (r.master < 0 || grantpt(r.master) < 0 || unlockpt(r.master) < 0) return false;
+    r.path = ptsname(r.master);
+    r.slave = open(r.path.c_str(), O_RDWR | O_NOCTTY);
+    if (r.slave < 0) return false;
+    termios tio;
+    tcgetattr(r.slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(r.slave, TCSANOW, &tio);
+    return true;
+}
+
+// Monta um registro do fluxo binário com uma amostra, como o stream_out.c da BitDogLab
+size_t build_frame(Receiver &r, uint8_t node, uint8_t seq, uint32_t t_us, uint8_t *out) {
+    lora_sample_t s{};
+    s.temperatura = (int16_t)(2000 + node * 10 + seq % 10);
+    s.umidade = (int16_t)(5000 + seq);
+    s.timestamp_ms = t_us / 1000;
+    s.node_id = node;
+    s.seq = seq;
+
+    lora_stream_packet_t h{};
+    h.type = LORA_STREAM_TYPE_PACKET;
+    h.flags = LORA_STREAM_FLAG_CRC_OK;
+    h.seq = r.stream_seq++;
+    h.rx_time_us = t_us;
+    h.freq_error_hz = -250;
+    h.rssi_dbm = -105;
+    h.snr_qdb = -12;
+    h.len = sizeof(s);
+
+    uint8_t rec[sizeof(h) + sizeof(s) + 2];
+    memcpy(rec, &h, sizeof(h));
+    memcpy(rec + sizeof(h), &s, sizeof(s));
+    uint16_t crc = crc16_ccitt(rec, sizeof(h) + sizeof(s));
+    rec[sizeof(rec) - 2] = (uint8_t)crc;
+    rec[sizeof(rec) - 1] = (uint8_t)(crc >> 8);
+
+    out[0] = 0;
+    size_t n = 1 + cobs_encode(rec, sizeof(rec), out + 1);
+    out[n++] = 0;
+    return n;
+}
+
+bool write_all(int fd, const uint8_t *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) return false;
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--gateway caminho] [--receivers N] [--rate quadros/s] [--seconds S] "
+                    "[--copies K] [--seed N]\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string gateway = "./lora_gateway";
+    int receivers = 4, copies = 2, seconds = 5;
+    double rate = 5000;
+    unsigned seed = 1;
+
+    static const option long_opts[] = {
+        { "gateway",   required_argument, nullptr, 'g' },
+        { "receivers", required_argument, nullptr, 'n' },
+        { "rate",      required_argument, nullptr, 'r' },
+        { "seconds",   required_argument, nullptr, 't' },
+        { "copies",    required_argument, nullptr, 'k' },
+        { "seed",      required_argument, nullptr, 's' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "g:n:r:t:k:s:", long_opts, nullptr)) != -1) {
+        switch (c) {
+        case 'g': gateway = optarg; break;
+        case 'n': receivers = atoi(optarg); break;
+        case 'r': rate = atof(optarg); break;
+        case 't': seconds = atoi(optarg); break;
+        case 'k': copies = atoi(optarg); break;
+        case 's': seed = (unsigned)atoi(optarg); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (receivers < 1 || copies < 1 || copies > receivers || rate <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Receiver> rx(receivers);
+    for (Receiver &r : rx) {
+        if (!open_pty(r)) {
+            perror("pty");
+            return 1;
+        }
+    }
+
+    // 250 nós x 256 seq = 64000 leituras distintas antes de repetir uma chave;
+    // a janela de duplicatas precisa ser menor que esse ciclo
+    double unique_rate = rate / copies;
+    unsigned window_ms = (unsigned)(64000 / unique_rate * 1000 / 4);
+    if (window_ms < 50) window_ms = 50;
+
+    int out_pipe[2];
+    if (pipe(out_pipe) < 0) {
+        perror("pipe");
+        return 1;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(out_pipe[1], STDOUT_FILENO);
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        std::vector<std::string> args = { gateway, "--no-init", "--window-ms", std::to_string(window_ms) };
+        for (Receiver &r : rx) args.push_back(r.path);
+        std::vector<char *> argv_c;
+        for (std::string &a : args) argv_c.push_back(a.data());
+        argv_c.push_back(nullptr);
+        execv(gateway.c_str(), argv_c.data());
+        perror(gateway.c_str());
+        _exit(127);
+    }
+    close(out_pipe[1]);
+
+    // Conta as linhas de dados entregues pelo gateway
+    std::atomic<uint64_t> lines{0};
+    std::thread counter([&] {
+        char buf[1 << 16];
+        ssize_t n;
+        bool header = true;
+        while ((n = read(out_pipe[0], buf, sizeof(buf))) > 0) {
+            for (ssize_t i = 0; i < n; i++) {
+                if (buf[i] != '\n') continue;
+                if (header) header = false;
+                else lines++;
+            }
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300)); // gateway abrindo as portas
+
+    std::mt19937 rng(seed);
+    uint64_t frames = 0, unique = 0;
+    uint8_t node = 1, seq = 0;
+    uint8_t frame[64];
+    std::vector<int> order(receivers);
+    for (int i = 0; i < receivers; i++) order[i] = i;
+
+    const auto t0 = Clock::now();
+    const auto end = t0 + std::chrono::seconds(seconds);
+    const auto step = std::chrono::duration<double>(copies / rate);
+    auto next = t0;
+    while (Clock::now() < end) {
+        // Uma leitura nova, ouvida por "copies" receptores sorteados
+        std::shuffle(order.begin(), order.end(), rng);
+        uint32_t t_us = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count();
+        for (int k = 0; k < copies; k++) {
+            Receiver &r = rx[order[k]];
+            size_t n = build_frame(r, node, seq, t_us, frame);
+            if (!write_all(r.master, frame, n)) {
+                perror("write");
+                return 1;
+            }
+            frames++;
+        }
+        unique++;
+        if (++node > 250) {
+            node = 1;
+            seq++;
+        }
+        next += std::chrono::duration_cast<Clock::duration>(step);
+        std::this_thread::sleep_until(next);
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // gateway esvaziando os ptys
+    kill(pid, SIGINT);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    counter.join();
+    for (Receiver &r : rx) {
+        close(r.slave);
+        close(r.master);
+    }
+
+    uint64_t got = lines.load();
+    printf("\n%llu quadros em %.2f s (%.0f quadros/s) por %d receptores, %d copias por leitura\n",
+           (unsigned long long)frames, elapsed, frames / elapsed, receivers, copies);
+    printf("leituras unicas enviadas: %llu, entregues pelo gateway: %llu -> %s\n",
+           (unsigned long long)unique, (unsigned long long)got,
+           got == unique ? "OK (nenhuma perda ou duplicata)" : "DIVERGENCIA");
+    return got == unique ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+// lora_gateway.cpp
+//
+// Junta as leituras de vários receptores BitDogLab ligados ao mesmo host.
+// Cada porta serial (ou pty) é lida sem bloqueio via epoll; o fluxo binário
+// (modo "bin", common/lora_stream.h) é decodificado incrementalmente e cada
+// leitura sai uma única vez em CSV na saída padrão, mesmo que vários
+// receptores a tenham ouvido. Portas que somem são reabertas a cada segundo.
+// Com --db as leituras também vão para o armazenamento colunar (tsdb.hpp).
+//
+// Uso: lora_gateway [--no-init] [--window-ms N] [--stats-s N] [--db dir] porta [porta...]
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "frame_reader.hpp"
+#include "reading.hpp"
+#include "tsdb.hpp"
+
+namespace {
+
+struct Port {
+    std::string path;
+    int fd = -1;
+    FrameReader reader;
+    uint64_t readings = 0;     // leituras decodificadas nesta porta
+    uint64_t duplicates = 0;   // já entregues por outra porta
+    uint64_t crc_errors = 0;
+    uint64_t reopens = 0;
+};
+
+struct Options {
+    bool init = true;           // envia "bin" ao abrir a porta
+    uint64_t window_ms = 60000;
+    unsigned stats_s = 0;       // 0 = só no fim / SIGUSR1
+    const char *db_dir = nullptr;
+};
+
+uint64_t now_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+uint64_t wall_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+bool open_port(Port &p, int ep, const Options &opt) {
+    int fd = open(p.path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    // Modo raw: nenhum byte do fluxo binário pode ser traduzido pelo tty
+    termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetspeed(&tio, B115200); // ignorado pelo CDC USB, vale para UART
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = &p;
+    if (epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        close(fd);
+        return false;
+    }
+    if (opt.init) {
+        static const char cmd[] = "bin\r";
+        if (write(fd, cmd, sizeof(cmd) - 1) < 0) { /* porta sem console: segue lendo */ }
+    }
+    p.fd = fd;
+    p.reader.reset();
+    return true;
+}
+
+void close_port(Port &p, int ep) {
+    epoll_ctl(ep, EPOLL_CTL_DEL, p.fd, nullptr);
+    close(p.fd);
+    p.fd = -1;
+    fprintf(stderr, "[gateway] %s desconectada\n", p.path.c_str());
+}
+
+void print_stats(const std::vector<Port> &ports, uint64_t unique, uint64_t start_ms) {
+    double secs = (now_ms() - start_ms) / 1000.0;
+    fprintf(stderr, "[gateway] %llu leituras unicas em %.1f s\n", (unsigned long long)unique, secs);
+    for (const Port &p : ports) {
+        const FrameStats &f = p.reader.stats();
+        fprintf(stderr,
+                "  %s: %s, %llu bytes, %llu registros (%.0f/s), %llu leituras, %llu duplicadas, "
+                "%llu CRC LoRa, quadros invalidos %llu/%llu/%llu (COBS/CRC/longos), reaberturas %llu\n",
+                p.path.c_str(), p.fd >= 0 ? "aberta" : "fechada", (unsigned long long)f.bytes,
+                (unsigned long long)f.records, secs > 0 ? f.records / secs : 0.0,
+                (unsigned long long)p.readings, (unsigned long long)p.duplicates,
+                (unsigned long long)p.crc_errors, (unsigned long long)f.bad_cobs,
+                (unsigned long long)f.bad_crc, (unsigned long long)f.oversize, (unsigned long long)p.reopens);
+    }
+}
+
+void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--no-init] [--window-ms N] [--stats-s N] [--db dir] porta [porta...]\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opt;
+    static const option long_opts[] = {
+        { "no-init",   no_argument,       nullptr, 'n' },
+        { "window-ms", required_argument, nullptr, 'w' },
+        { "stats-s",   required_argument, nullptr, 's' },
+        { "db",        required_argument, nullptr, 'd' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "nw:s:d:", long_opts, nullptr)) != -1) {
+        switch (c) {
+        case 'n': opt.init = false; break;
+        case 'w': opt.window_ms = strtoull(optarg, nullptr, 10); break;
+        case 's': opt.stats_s = (unsigned)atoi(optarg); break;
+        case 'd': opt.db_dir = optarg; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    TsdbWriter db;
+    if (opt.db_dir && !db.open(opt.db_dir)) {
+        fprintf(stderr, "[gateway] %s: %s\n", opt.db_dir, strerror(errno));
+        return 1;
+    }
+
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    if (ep < 0) {
+        perror("epoll_create1");
+        return 1;
+    }
+
+    // Sinais entram no mesmo laço: SIGINT/SIGTERM encerram, SIGUSR1 imprime estatísticas
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &mask, nullptr);
+    int sfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    epoll_event sev{};
+    sev.events = EPOLLIN;
+    sev.data.ptr = nullptr;
+    epoll_ctl(ep, EPOLL_CTL_ADD, sfd, &sev);
+
+    // O vetor não muda de tamanho depois daqui: epoll guarda ponteiros para os elementos
+    std::vector<Port> ports(argc - optind);
+    for (size_t i = 0; i < ports.size(); i++) {
+        ports[i].path = argv[optind + i];
+        if (!open_port(ports[i], ep, opt)) {
+            fprintf(stderr, "[gateway] %s: %s (tentando de novo)\n", ports[i].path.c_str(), strerror(errno));
+        }
+    }
+
+    static char out_buf[1 << 16];
+    setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+    printf("host_ms,porta,node_id,seq,saltos,temperatura,umidade,rssi_dbm,snr_db,timestamp_ms\n");
+
+    DedupWindow dedup(opt.window_ms);
+    uint64_t unique = 0;
+    uint64_t db_errors = 0;
+    const uint64_t start = now_ms();
+    uint64_t next_retry = start + 1000;
+    uint64_t next_stats = opt.stats_s ? start + opt.stats_s * 1000ull : 0;
+    bool running = true;
+    static uint8_t rx[1 << 16];
+    epoll_event events[16];
+
+    while (running) {
+        int n = epoll_wait(ep, events, 16, 1000);
+        if (n < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            break;
+        }
+        uint64_t host_ms = wall_ms();
+        uint64_t mono_ms = now_ms();
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == nullptr) {
+                signalfd_siginfo si;
+                while (read(sfd, &si, sizeof(si)) == sizeof(si)) {
+                    if (si.ssi_signo == SIGUSR1) print_stats(ports, unique, start);
+                    else running = false;
+                }
+                continue;
+            }
+
+            Port &p = *static_cast<Port *>(events[i].data.ptr);
+            size_t idx = &p - ports.data();
+            bool hangup = false;
+
+            // Edge-triggered: lê até esvaziar
+            for (;;) {
+                ssize_t got = read(p.fd, rx, sizeof(rx));
+                if (got > 0) {
+                    p.reader.feed(rx, (size_t)got, [&](const uint8_t *rec, size_t len) {
+                        Reading r;
+                        switch (decode_reading(rec, len, r)) {
+                        case DecodeResult::CrcError: p.crc_errors++; return;
+                        case DecodeResult::Reading: break;
+                        default: return;
+                        }
+                        p.readings++;
+                        if (r.has_id && dedup.check_and_add(r.node_id, r.seq, mono_ms)) {
+                            p.duplicates++;
+                            return;
+                        }
+                        unique++;
+                        char t[8], u[8];
+                        printf("%llu,%zu,%u,%u,%u,%s,%s,%d,%.2f,%u\n", (unsigned long long)host_ms, idx,
+                               r.node_id, r.seq, r.hops, centi(t, r.d.temperatura), centi(u, r.d.umidade),
+                               r.rssi_dbm, r.snr_qdb / 4.0, r.timestamp_ms);
+                        if (opt.db_dir &&
+                            !db.append(r.node_id, TsdbRow{ host_ms, r.d.temperatura, r.d.umidade, r.seq, r.rssi_dbm })) {
+                            db_errors++;
+                        }
+                    });
+                    continue;
+                }
+                if (got < 0 && errno == EINTR) continue;
+                if (got < 0 && errno == EAGAIN) break;
+                hangup = true; // EOF ou EIO: dispositivo removido / pty fechado
+                break;
+            }
+            if (hangup || (events[i].events & (EPOLLHUP | EPOLLERR))) close_port(p, ep);
+        }
+        fflush(stdout);
+
+        if (mono_ms >= next_retry) {
+            for (Port &p : ports) {
+                if (p.fd < 0 && open_port(p, ep, opt)) {
+                    p.reopens++;
+                    fprintf(stderr, "[gateway] %s reaberta\n", p.path.c_str());
+                }
+            }
+            next_retry = mono_ms + 1000;
+            if (opt.db_dir && !db.flush()) db_errors++;
+        }
+        if (next_stats && mono_ms >= next_stats) {
+            print_stats(ports, unique, start);
+            next_stats = mono_ms + opt.stats_s * 1000ull;
+        }
+    }
+
+    fflush(stdout);
+    if (opt.db_dir && !db.flush()) db_errors++;
+    print_stats(ports, unique, start);
+    if (db_errors) fprintf(stderr, "[gateway] %llu erros gravando em %s\n", (unsigned long long)db_errors, opt.db_dir);
+    for (Port &p : ports) {
+        if (p.fd >= 0) close(p.fd);
+    }
+    close(sfd);
+    close(ep);
+    return 0;
+}
@@ -0,0 +1,97 @@
+// reading.hpp
+//
+// Leitura do AHT10 decodificada de um registro do fluxo binário, e o filtro
+// que junta as cópias ouvidas por vários receptores.
+
+#ifndef READING_HPP_
+#define READING_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "aht10.h"       // struct dados do firmware do FPGA
+#include "lora_proto.h"
+#include "lora_stream.h"
+}
+
+struct Reading {
+    dados d;                  // mesma estrutura enviada pelo FPGA (valores * 100)
+    bool has_id = false;      // false para o quadro antigo de 4 bytes
+    uint8_t node_id = 0;
+    uint8_t seq = 0;
+    uint8_t hops = 0;
+    uint32_t timestamp_ms = 0;
+    int16_t rssi_dbm = 0;
+    int8_t snr_qdb = 0;
+    uint32_t rx_time_us = 0;  // relógio do receptor
+};
+
+enum class DecodeResult { Reading, NotReading, CrcError, ReceiverDuplicate };
+
+// Interpreta um registro validado do fluxo binário
+inline DecodeResult decode_reading(const uint8_t *rec, size_t len, Reading &out) {
+    lora_stream_packet_t h;
+    const uint8_t *payload;
+    if (!lora_stream_parse_packet(rec, len, &h, &payload)) return DecodeResult::NotReading;
+    if (!(h.flags & LORA_STREAM_FLAG_CRC_OK)) return DecodeResult::CrcError;
+    if (h.flags & LORA_STREAM_FLAG_DUPLICATE) return DecodeResult::ReceiverDuplicate;
+
+    out.rssi_dbm = h.rssi_dbm;
+    out.snr_qdb = h.snr_qdb;
+    out.rx_time_us = h.rx_time_us;
+
+    lora_relay_hdr_t relay;
+    const uint8_t *inner;
+    uint8_t inner_len;
+    lora_sample_t s;
+    if (lora_proto_relay_parse(payload, h.len, &relay, &inner, &inner_len) && lora_proto_sample(inner, inner_len, &s)) {
+        out.d.temperatura = s.temperatura;
+        out.d.umidade = s.umidade;
+        out.has_id = true;
+        out.node_id = s.node_id;
+        out.seq = s.seq;
+        out.hops = relay.hops;
+        out.timestamp_ms = s.timestamp_ms;
+        return DecodeResult::Reading;
+    }
+    if (h.len == sizeof(dados)) {
+        std::memcpy(&out.d, payload, sizeof(dados));
+        out.has_id = false;
+        return DecodeResult::Reading;
+    }
+    return DecodeResult::NotReading;
+}
+
+// Valor * 100 -> "-12.34" (sem ponto flutuante, como no firmware)
+inline const char *centi(char out[8], int16_t v) {
+    int a = v < 0 ? -v : v;
+    snprintf(out, 8, "%s%d.%02d", v < 0 ? "-" : "", a / 100, a % 100);
+    return out;
+}
+
+// Lembra, para cada (node_id, seq), quando a leitura foi vista pela última
+// vez. A tabela cobre todas as 65536 chaves: consulta O(1), sem alocação
+// depois da construção. A janela deve ser menor que o tempo para o seq de um
+// nó dar a volta (256 amostras).
+class DedupWindow {
+public:
+    explicit DedupWindow(uint64_t window_ms) : window_ms_(window_ms), seen_(65536, kNever) {}
+
+    // true se a leitura já foi vista dentro da janela (cópia de outro receptor)
+    bool check_and_add(uint8_t node_id, uint8_t seq, uint64_t now_ms) {
+        uint64_t &last = seen_[(unsigned)node_id << 8 | seq];
+        bool dup = last != kNever && now_ms - last < window_ms_;
+        if (!dup) last = now_ms; // a janela conta a partir da primeira cópia
+        return dup;
+    }
+
+private:
+    static constexpr uint64_t kNever = ~0ull;
+    uint64_t window_ms_;
+    std::vector<uint64_t> seen_;
+};
+
+#endif // READING_HPP_
@@ -0,0 +1,414 @@
+// tsdb.cpp
+//
+// Gravação e leitura dos segmentos colunares descritos em tsdb.hpp.
+
+#include "tsdb.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct FileDesc {
+    const char *ext;
+    size_t elem;
+};
+
+const FileDesc kFiles[kTsdbFiles] = {
+    { "ts", sizeof(uint32_t) },
+    { "temp", sizeof(int16_t) },
+    { "umid", sizeof(int16_t) },
+    { "seq", sizeof(uint8_t) },
+    { "rssi", sizeof(int16_t) },
+    { "idx", sizeof(TsdbBlock) },
+};
+
+constexpr size_t kFlushBytes = 64 * 1024;  // buffer da coluna ts antes de gravar
+
+std::string node_dir(const std::string &dir, unsigned node_id) {
+    char name[16];
+    snprintf(name, sizeof(name), "/node_%03u", node_id);
+    return dir + name;
+}
+
+std::string segment_prefix(const std::string &node_dir, unsigned segment) {
+    char name[20];
+    snprintf(name, sizeof(name), "/seg_%06u.", segment);
+    return node_dir + name;
+}
+
+// Números dos segmentos existentes (pelos arquivos .ts), em ordem
+std::vector<unsigned> list_segments(const std::string &node_dir) {
+    std::vector<unsigned> segs;
+    DIR *d = opendir(node_dir.c_str());
+    if (!d) return segs;
+    while (dirent *e = readdir(d)) {
+        unsigned seg;
+        char ext[4];
+        if (sscanf(e->d_name, "seg_%6u.%3s", &seg, ext) == 2 && strcmp(ext, "ts") == 0) segs.push_back(seg);
+    }
+    closedir(d);
+    std::sort(segs.begin(), segs.end());
+    return segs;
+}
+
+bool write_all(int fd, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+template <typename T>
+void put(std::vector<uint8_t> &buf, T v) {
+    size_t at = buf.size();
+    buf.resize(at + sizeof(v));
+    std::memcpy(buf.data() + at, &v, sizeof(v));
+}
+
+} // namespace
+
+// ============================
+// GRAVAÇÃO
+// ============================
+
+struct TsdbWriter::Node {
+    std::string dir;
+    unsigned segment = 0;
+    uint32_t rows = 0;          // linhas do segmento, gravadas ou em buffer
+    uint32_t block_first = 0;   // primeira linha do bloco atual
+    uint64_t block_base = 0;
+    uint64_t last_ms = 0;
+    std::array<int, kTsdbFiles> fd;
+    std::array<std::vector<uint8_t>, kTsdbFiles> buf;
+
+    Node() { fd.fill(-1); }
+};
+
+TsdbWriter::TsdbWriter() = default;
+
+TsdbWriter::~TsdbWriter() {
+    flush();
+    for (auto &n : nodes_) {
+        if (n) close_node(*n);
+    }
+}
+
+bool TsdbWriter::open(const std::string &dir) {
+    if (mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST) return false;
+    dir_ = dir;
+    return true;
+}
+
+bool TsdbWriter::open_node(uint8_t node_id, Node &n) {
+    n.dir = node_dir(dir_, node_id);
+    if (mkdir(n.dir.c_str(), 0755) < 0 && errno != EEXIST) return false;
+    std::vector<unsigned> segs = list_segments(n.dir);
+    n.segment = segs.empty() ? 0 : segs.back();
+    return open_segment(node_id, n, !segs.empty());
+}
+
+// Abre o segmento n.segment. Com recover, continua um segmento existente:
+// uma gravação interrompida pode ter deixado colunas de tamanhos diferentes,
+// então todas são cortadas no menor número de linhas completas.
+bool TsdbWriter::open_segment(uint8_t node_id, Node &n, bool recover) {
+    std::string prefix = segment_prefix(n.dir, n.segment);
+    for (int f = 0; f < kTsdbFiles; f++) {
+        int flags = O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC | (recover ? 0 : O_TRUNC);
+        n.fd[f] = ::open((prefix + kFiles[f].ext).c_str(), flags, 0644);
+        if (n.fd[f] < 0) return false;
+    }
+    n.rows = 0;
+    n.block_first = 0;
+    n.block_base = 0;
+    if (!recover) return true;
+
+    struct stat st;
+    size_t rows = SIZE_MAX;
+    for (int f = 0; f < kTsdbIdx; f++) {
+        if (fstat(n.fd[f], &st) < 0) return false;
+        rows = std::min(rows, (size_t)st.st_size / kFiles[f].elem);
+    }
+    if (fstat(n.fd[kTsdbIdx], &st) < 0) return false;
+    size_t blocks = (size_t)st.st_size / sizeof(TsdbBlock);
+
+    // O índice é gravado antes das colunas: descarta blocos sem nenhuma linha
+    TsdbBlock last{};
+    while (blocks > 0) {
+        if (pread(n.fd[kTsdbIdx], &last, sizeof(last), (off_t)((blocks - 1) * sizeof(last))) != sizeof(last)) return false;
+        if (last.first_row < rows) break;
+        blocks--;
+    }
+    if (blocks == 0) rows = 0;
+
+    for (int f = 0; f < kTsdbFiles; f++) {
+        size_t len = f == kTsdbIdx ? blocks * sizeof(TsdbBlock) : rows * kFiles[f].elem;
+        if (ftruncate(n.fd[f], (off_t)len) < 0) return false;
+    }
+    if (rows == 0) return true;
+
+    uint32_t off;
+    if (pread(n.fd[kTsdbTs], &off, sizeof(off), (off_t)((rows - 1) * sizeof(off))) != sizeof(off)) return false;
+    n.rows = (uint32_t)rows;
+    n.block_first = last.first_row;
+    n.block_base = last.base_ms;
+    n.last_ms = last.base_ms + off;
+
+    if (n.rows >= kSegmentRows) {
+        close_node(n);
+        n.segment++;
+        return open_segment(node_id, n, false);
+    }
+    return true;
+}
+
+bool TsdbWriter::flush_node(Node &n) {
+    // Índice primeiro: toda linha gravada tem a base do seu bloco no disco
+    for (int f = kTsdbIdx; f >= 0; f--) {
+        if (!write_all(n.fd[f], n.buf[f].data(), n.buf[f].size())) return false;
+        n.buf[f].clear();
+    }
+    return true;
+}
+
+void TsdbWriter::close_node(Node &n) {
+    for (int &fd : n.fd) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+}
+
+bool TsdbWriter::append(uint8_t node_id, const TsdbRow &row) {
+    std::unique_ptr<Node> &slot = nodes_[node_id];
+    if (!slot) {
+        slot.reset(new Node);
+        if (!open_node(node_id, *slot)) {
+            slot.reset();
+            return false;
+        }
+    }
+    Node &n = *slot;
+
+    if (n.rows >= kSegmentRows) {
+        if (!flush_node(n)) return false;
+        close_node(n);
+        n.segment++;
+        if (!open_segment(node_id, n, false)) return false;
+    }
+
+    uint64_t ts = std::max(row.ts_ms, n.last_ms);
+    if (n.rows == 0 || n.rows - n.block_first >= kBlockRows || ts - n.block_base > UINT32_MAX) {
+        put(n.buf[kTsdbIdx], TsdbBlock{ ts, n.rows, 0 });
+        n.block_first = n.rows;
+        n.block_base = ts;
+    }
+    put(n.buf[kTsdbTs], (uint32_t)(ts - n.block_base));
+    put(n.buf[kTsdbTemp], row.temperatura);
+    put(n.buf[kTsdbUmid], row.umidade);
+    put(n.buf[kTsdbSeq], row.seq);
+    put(n.buf[kTsdbRssi], row.rssi_dbm);
+    n.rows++;
+    n.last_ms = ts;
+    rows_written_++;
+
+    if (n.buf[kTsdbTs].size() >= kFlushBytes) return flush_node(n);
+    return true;
+}
+
+bool TsdbWriter::flush() {
+    bool ok = true;
+    for (auto &n : nodes_) {
+        if (n && !flush_node(*n)) ok = false;
+    }
+    return ok;
+}
+
+// ============================
+// LEITURA
+// ============================
+
+TsdbReader::~TsdbReader() {
+    for (auto &segs : segments_) {
+        for (Segment &s : segs) unmap_segment(s);
+    }
+}
+
+void TsdbReader::unmap_segment(Segment &s) {
+    for (int f = 0; f < kTsdbFiles; f++) {
+        if (s.map[f]) munmap(s.map[f], s.map_len[f]);
+        s.map[f] = nullptr;
+    }
+}
+
+bool TsdbReader::map_segment(const std::string &prefix, Segment &s) {
+    size_t rows = SIZE_MAX;
+    for (int f = 0; f < kTsdbFiles; f++) {
+        int fd = ::open((prefix + kFiles[f].ext).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            ::close(fd);
+            return false;
+        }
+        size_t len = (size_t)st.st_size;
+        if (len > 0) {
+            void *p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                return false;
+            }
+            s.map[f] = p;
+            s.map_len[f] = len;
+        }
+        ::close(fd);
+        if (f != kTsdbIdx) rows = std::min(rows, len / kFiles[f].elem);
+    }
+    s.blocks = static_cast<const TsdbBlock *>(s.map[kTsdbIdx]);
+    s.ts = static_cast<const uint32_t *>(s.map[kTsdbTs]);
+    s.temp = static_cast<const int16_t *>(s.map[kTsdbTemp]);
+    s.umid = static_cast<const int16_t *>(s.map[kTsdbUmid]);
+    s.seq = static_cast<const uint8_t *>(s.map[kTsdbSeq]);
+    s.rssi = static_cast<const int16_t *>(s.map[kTsdbRssi]);
+
+    // Segmento ainda em gravação: considera só linhas completas com bloco no índice
+    size_t blocks = s.map_len[kTsdbIdx] / sizeof(TsdbBlock);
+    while (blocks > 0 && s.blocks[blocks - 1].first_row >= rows) blocks--;
+    s.n_blocks = blocks;
+    s.rows = blocks > 0 ? (uint32_t)rows : 0;
+    return true;
+}
+
+bool TsdbReader::open(const std::string &dir) {
+    DIR *d = opendir(dir.c_str());
+    if (!d) return false;
+    std::vector<unsigned> ids;
+    while (dirent *e = readdir(d)) {
+        unsigned id;
+        if (sscanf(e->d_name, "node_%3u", &id) == 1 && id < 256) ids.push_back(id);
+    }
+    closedir(d);
+
+    for (unsigned id : ids) {
+        std::string nd = node_dir(dir, id);
+        for (unsigned seg : list_segments(nd)) {
+            Segment s;
+            bool ok = map_segment(segment_prefix(nd, seg), s);
+            if (!ok || s.rows == 0) {
+                unmap_segment(s);
+                if (!ok) return false;
+                continue;
+            }
+            segments_[id].push_back(s);
+        }
+    }
+    return true;
+}
+
+std::vector<uint8_t> TsdbReader::nodes() const {
+    std::vector<uint8_t> out;
+    for (unsigned id = 0; id < 256; id++) {
+        if (!segments_[id].empty()) out.push_back((uint8_t)id);
+    }
+    return out;
+}
+
+uint64_t TsdbReader::rows(uint8_t node_id) const {
+    uint64_t n = 0;
+    for (const Segment &s : segments_[node_id]) n += s.rows;
+    return n;
+}
+
+size_t TsdbReader::mapped_bytes() const {
+    size_t n = 0;
+    for (const auto &segs : segments_) {
+        for (const Segment &s : segs) {
+            for (size_t len : s.map_len) n += len;
+        }
+    }
+    return n;
+}
+
+uint32_t TsdbReader::Segment::lower_row(uint64_t t) const {
+    // Primeiro bloco que começa em t ou depois; a resposta está no anterior ou no início dele
+    size_t lo = 0, hi = n_blocks;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (blocks[mid].base_ms < t) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return 0;
+    size_t b = lo - 1;
+    uint32_t end = block_end(b);
+    uint64_t off = t - blocks[b].base_ms;
+    if (off > UINT32_MAX) return end;
+    return (uint32_t)(std::lower_bound(ts + blocks[b].first_row, ts + end, (uint32_t)off) - ts);
+}
+
+uint64_t TsdbReader::Segment::row_ms(uint32_t row) const {
+    return blocks[block_of(row)].base_ms + ts[row];
+}
+
+size_t TsdbReader::Segment::block_of(uint32_t row) const {
+    size_t b = 0, hi = n_blocks;
+    while (hi - b > 1) {
+        size_t mid = (b + hi) / 2;
+        if (blocks[mid].first_row <= row) b = mid;
+        else hi = mid;
+    }
+    return b;
+}
+
+TsdbSummary TsdbReader::summarize(uint8_t node_id, uint64_t from_ms, uint64_t to_ms) const {
+    TsdbSummary sum;
+    sum.temp_min = sum.umid_min = INT16_MAX;
+    sum.temp_max = sum.umid_max = INT16_MIN;
+
+    for (const Segment &s : segments_[node_id]) {
+        if (s.last_ms() < from_ms || s.first_ms() >= to_ms) continue;
+        uint32_t row = s.lower_row(from_ms);
+        uint32_t end = s.lower_row(to_ms);
+        if (row >= end) continue;
+
+        // Laços simples sobre cada coluna: o compilador vetoriza
+        int16_t tmin = INT16_MAX, tmax = INT16_MIN, umin = INT16_MAX, umax = INT16_MIN;
+        int64_t tsum = 0, usum = 0;
+        for (uint32_t i = row; i < end; i++) {
+            int16_t v = s.temp[i];
+            tmin = std::min(tmin, v);
+            tmax = std::max(tmax, v);
+            tsum += v;
+        }
+        for (uint32_t i = row; i < end; i++) {
+            int16_t v = s.umid[i];
+            umin = std::min(umin, v);
+            umax = std::max(umax, v);
+            usum += v;
+        }
+
+        if (sum.count == 0) sum.first_ms = s.row_ms(row);
+        sum.last_ms = s.row_ms(end - 1);
+        sum.count += end - row;
+        sum.temp_min = std::min(sum.temp_min, tmin);
+        sum.temp_max = std::max(sum.temp_max, tmax);
+        sum.umid_min = std::min(sum.umid_min, umin);
+        sum.umid_max = std::max(sum.umid_max, umax);
+        sum.temp_sum += tsum;
+        sum.umid_sum += usum;
+    }
+    return sum;
+}
@@ -0,0 +1,162 @@
+// tsdb.hpp
+//
+// Armazenamento colunar das leituras do gateway, por nó e por campo.
+//
+// Cada nó tem um diretório (node_NNN) com segmentos de até kSegmentRows
+// linhas. Um segmento é um arquivo por coluna, só com acréscimos no fim:
+//   seg_NNNNNN.ts    uint32  instante em ms relativo ao início do bloco
+//   seg_NNNNNN.temp  int16   temperatura * 100 (unidade do firmware)
+//   seg_NNNNNN.umid  int16   umidade * 100
+//   seg_NNNNNN.seq   uint8   sequência do nó
+//   seg_NNNNNN.rssi  int16   RSSI em dBm
+//   seg_NNNNNN.idx   índice de tempo: um TsdbBlock a cada kBlockRows linhas
+// O tempo fica codificado como delta em relação à base do bloco (4 bytes em
+// vez de 8), o que mantém acesso aleatório: a busca por intervalo faz uma
+// busca binária no índice e outra dentro de um único bloco, e só as páginas
+// desse trecho de cada coluna mapeada são lidas.
+//
+// Os instantes de um nó precisam ser não decrescentes; um relógio que volta
+// (ajuste do NTP) é travado no último valor gravado.
+
+#ifndef TSDB_HPP_
+#define TSDB_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct TsdbRow {
+    uint64_t ts_ms;
+    int16_t temperatura;   // * 100
+    int16_t umidade;       // * 100
+    uint8_t seq;
+    int16_t rssi_dbm;
+};
+
+// Entrada do índice de tempo de um segmento
+struct TsdbBlock {
+    uint64_t base_ms;      // instante da primeira linha do bloco
+    uint32_t first_row;
+    uint32_t reserved;
+};
+
+struct TsdbSummary {
+    uint64_t count = 0;
+    uint64_t first_ms = 0;
+    uint64_t last_ms = 0;
+    int16_t temp_min = 0, temp_max = 0;
+    int16_t umid_min = 0, umid_max = 0;
+    int64_t temp_sum = 0, umid_sum = 0;
+};
+
+enum TsdbFile { kTsdbTs, kTsdbTemp, kTsdbUmid, kTsdbSeq, kTsdbRssi, kTsdbIdx, kTsdbFiles };
+
+constexpr uint32_t kSegmentRows = 1u << 20;  // ~1 ano de amostras a cada 30 s
+constexpr uint32_t kBlockRows = 4096;        // linhas por entrada do índice
+
+class TsdbWriter {
+public:
+    TsdbWriter();
+    ~TsdbWriter();
+    TsdbWriter(const TsdbWriter &) = delete;
+    TsdbWriter &operator=(const TsdbWriter &) = delete;
+
+    // Cria o diretório se preciso; segmentos existentes continuam de onde pararam
+    bool open(const std::string &dir);
+
+    // Acrescenta uma linha ao nó (em memória até flush ou o buffer encher)
+    bool append(uint8_t node_id, const TsdbRow &row);
+
+    // Grava os buffers de todos os nós (índice antes das colunas)
+    bool flush();
+
+    uint64_t rows_written() const { return rows_written_; }
+
+private:
+    struct Node;
+    bool open_node(uint8_t node_id, Node &n);
+    bool open_segment(uint8_t node_id, Node &n, bool recover);
+    bool flush_node(Node &n);
+    void close_node(Node &n);
+
+    std::string dir_;
+    std::array<std::unique_ptr<Node>, 256> nodes_;
+    uint64_t rows_written_ = 0;
+};
+
+class TsdbReader {
+public:
+    TsdbReader() = default;
+    ~TsdbReader();
+    TsdbReader(const TsdbReader &) = delete;
+    TsdbReader &operator=(const TsdbReader &) = delete;
+
+    // Mapeia (somente leitura) todos os segmentos existentes: uma foto do banco
+    bool open(const std::string &dir);
+
+    std::vector<uint8_t> nodes() const;
+    uint64_t rows(uint8_t node_id) const;
+
+    // Chama fn(const TsdbRow &) para cada linha do nó com from_ms <= ts < to_ms
+    template <typename Fn>
+    uint64_t scan(uint8_t node_id, uint64_t from_ms, uint64_t to_ms, Fn &&fn) const;
+
+    // Contagem, mínimos, máximos e somas no intervalo, direto sobre as colunas
+    TsdbSummary summarize(uint8_t node_id, uint64_t from_ms, uint64_t to_ms) const;
+
+    // Bytes mapeados (tamanho total dos arquivos)
+    size_t mapped_bytes() const;
+
+private:
+    struct Segment {
+        uint32_t rows = 0;
+        size_t n_blocks = 0;
+        const TsdbBlock *blocks = nullptr;
+        const uint32_t *ts = nullptr;
+        const int16_t *temp = nullptr;
+        const int16_t *umid = nullptr;
+        const uint8_t *seq = nullptr;
+        const int16_t *rssi = nullptr;
+        std::array<void *, kTsdbFiles> map{};
+        std::array<size_t, kTsdbFiles> map_len{};
+
+        uint64_t first_ms() const { return blocks[0].base_ms; }
+        uint64_t last_ms() const { return blocks[n_blocks - 1].base_ms + ts[rows - 1]; }
+        uint32_t block_end(size_t b) const { return b + 1 < n_blocks ? blocks[b + 1].first_row : rows; }
+        uint32_t lower_row(uint64_t t) const;   // primeira linha com ts >= t
+        size_t block_of(uint32_t row) const;    // bloco que contém a linha
+        uint64_t row_ms(uint32_t row) const;
+    };
+
+    static bool map_segment(const std::string &prefix, Segment &s);
+    static void unmap_segment(Segment &s);
+
+    std::array<std::vector<Segment>, 256> segments_;
+};
+
+template <typename Fn>
+uint64_t TsdbReader::scan(uint8_t node_id, uint64_t from_ms, uint64_t to_ms, Fn &&fn) const {
+    uint64_t n = 0;
+    for (const Segment &s : segments_[node_id]) {
+        if (s.last_ms() < from_ms || s.first_ms() >= to_ms) continue;
+        uint32_t row = s.lower_row(from_ms);
+        uint32_t end = s.lower_row(to_ms);
+        if (row >= end) continue;
+        n += end - row;
+
+        for (size_t b = s.block_of(row); row < end; b++) {
+            uint32_t stop = s.block_end(b) < end ? s.block_end(b) : end;
+            uint64_t base = s.blocks[b].base_ms;
+            for (; row < stop; row++) {
+                TsdbRow r{ base + s.ts[row], s.temp[row], s.umid[row], s.seq[row], s.rssi[row] };
+                fn(r);
+            }
+        }
+    }
+    return n;
+}
+
+#endif // TSDB_HPP_
@@ -0,0 +1,210 @@
+// tsdb_bench.cpp
+//
+// Benchmark do armazenamento colunar (tsdb.hpp): grava meses de leituras
+// sintéticas de vários nós na ordem em que o gateway as receberia, depois
+// mede consultas de um dia em pontos aleatórios (latência e páginas tocadas,
+// pelas page faults num mapeamento novo) e a varredura completa. Confere as
+// contagens e os resumos contra os valores gerados.
+//
+// Uso: tsdb_bench [--dir caminho] [--nodes N] [--days D] [--interval-s S]
+//                 [--queries Q] [--keep]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include <ftw.h>
+#include <getopt.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "tsdb.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+long minor_faults() {
+    rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt + ru.ru_majflt;
+}
+
+// Leitura sintética determinística: ciclo diário de temperatura e umidade
+TsdbRow make_row(unsigned node, uint64_t i, uint64_t ts_ms) {
+    int day_phase = (int)(i % 2880);
+    int tri = day_phase < 1440 ? day_phase : 2880 - day_phase;
+    return TsdbRow{ ts_ms, (int16_t)(1800 + tri + (int)node * 10), (int16_t)(8000 - tri * 2),
+                    (uint8_t)i, (int16_t)(-60 - (int)(node % 40)) };
+}
+
+int remove_entry(const char *path, const struct stat *, int, FTW *) {
+    return remove(path);
+}
+
+void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--dir caminho] [--nodes N] [--days D] [--interval-s S] [--queries Q] [--keep]\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string dir;
+    unsigned nodes = 16, days = 180, interval_s = 30, queries = 2000;
+    bool keep = false;
+    static const option long_opts[] = {
+        { "dir",        required_argument, nullptr, 'd' },
+        { "nodes",      required_argument, nullptr, 'n' },
+        { "days",       required_argument, nullptr, 'D' },
+        { "interval-s", required_argument, nullptr, 'i' },
+        { "queries",    required_argument, nullptr, 'q' },
+        { "keep",       no_argument,       nullptr, 'k' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "d:n:D:i:q:k", long_opts, nullptr)) != -1) {
+        switch (c) {
+        case 'd': dir = optarg; break;
+        case 'n': nodes = (unsigned)atoi(optarg); break;
+        case 'D': days = (unsigned)atoi(optarg); break;
+        case 'i': interval_s = (unsigned)atoi(optarg); break;
+        case 'q': queries = (unsigned)atoi(optarg); break;
+        case 'k': keep = true; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (nodes == 0 || nodes > 255 || days == 0 || interval_s == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (dir.empty()) {
+        char tmpl[] = "/tmp/tsdb_bench_XXXXXX";
+        if (!mkdtemp(tmpl)) {
+            perror("mkdtemp");
+            return 1;
+        }
+        dir = tmpl;
+    }
+
+    const uint64_t start_ms = 1700000000000ull;
+    const uint64_t step_ms = interval_s * 1000ull;
+    const uint64_t per_node = days * 86400ull / interval_s;
+    const uint64_t total = per_node * nodes;
+
+    // ---- Gravação: nós intercalados, como chegam ao gateway ----
+    auto t0 = Clock::now();
+    {
+        TsdbWriter w;
+        if (!w.open(dir)) {
+            perror(dir.c_str());
+            return 1;
+        }
+        for (uint64_t i = 0; i < per_node; i++) {
+            for (unsigned n = 1; n <= nodes; n++) {
+                uint64_t ts = start_ms + i * step_ms + n * 37; // nós defasados dentro do intervalo
+                if (!w.append((uint8_t)n, make_row(n, i, ts))) {
+                    perror("append");
+                    return 1;
+                }
+            }
+        }
+        if (!w.flush()) {
+            perror("flush");
+            return 1;
+        }
+    }
+    double ingest_s = seconds_since(t0);
+
+    TsdbReader db;
+    if (!db.open(dir)) {
+        perror(dir.c_str());
+        return 1;
+    }
+    size_t bytes = db.mapped_bytes();
+    printf("%u nos x %u dias a cada %u s = %llu leituras, %.1f MB em disco (%.1f bytes/leitura)\n", nodes, days,
+           interval_s, (unsigned long long)total, bytes / 1e6, (double)bytes / total);
+    printf("gravacao: %.2f s, %.2f M leituras/s\n", ingest_s, total / ingest_s / 1e6);
+
+    bool ok = true;
+    for (unsigned n = 1; n <= nodes; n++) {
+        if (db.rows((uint8_t)n) != per_node) ok = false;
+    }
+
+    std::mt19937_64 rng(1);
+    const uint64_t day_ms = 86400000ull;
+    const uint64_t span_ms = per_node * step_ms;
+    auto random_from = [&] { return start_ms + rng() % (span_ms > day_ms ? span_ms - day_ms : 1); };
+
+    // ---- Páginas tocadas: poucas consultas num mapeamento novo, cada uma em
+    // outro nó/trecho, contando page faults (o kernel mapeia vizinhas junto) ----
+    unsigned probes = 0;
+    long probe_faults = 0;
+    {
+        TsdbReader cold;
+        if (!cold.open(dir)) return 1;
+        for (unsigned n = 1; n <= nodes; n++, probes++) {
+            uint64_t from = random_from();
+            long f0 = minor_faults();
+            cold.scan((uint8_t)n, from, from + day_ms, [](const TsdbRow &) {});
+            probe_faults += minor_faults() - f0;
+        }
+    }
+    printf("consulta de 1 dia num mapeamento novo: %.1f page faults (de %zu paginas mapeadas)\n",
+           (double)probe_faults / probes, bytes / (size_t)sysconf(_SC_PAGESIZE));
+
+    // ---- Consultas de um dia em pontos aleatórios ----
+    uint64_t q_rows = 0;
+    t0 = Clock::now();
+    for (unsigned q = 0; q < queries; q++) {
+        uint8_t n = (uint8_t)(1 + rng() % nodes);
+        uint64_t from = random_from();
+        int64_t temp_sum = 0;
+        uint64_t got = db.scan(n, from, from + day_ms, [&](const TsdbRow &r) { temp_sum += r.temperatura; });
+        q_rows += got;
+
+        // Esperado: linhas i com from <= start + i*step + n*37 < from + dia
+        uint64_t lo = from > start_ms + n * 37 ? (from - start_ms - n * 37 + step_ms - 1) / step_ms : 0;
+        uint64_t hi = (from + day_ms - start_ms - n * 37 + step_ms - 1) / step_ms;
+        if (hi > per_node) hi = per_node;
+        TsdbSummary s = db.summarize(n, from, from + day_ms);
+        if (got != hi - lo || s.count != got || s.temp_sum != temp_sum) ok = false;
+    }
+    double query_s = seconds_since(t0);
+    printf("%u consultas de 1 dia (varredura + resumo): %.1f us cada, %llu leituras\n", queries,
+           query_s / queries * 1e6, (unsigned long long)q_rows);
+
+    // ---- Varredura completa ----
+    t0 = Clock::now();
+    uint64_t scanned = 0;
+    int64_t checksum = 0;
+    for (unsigned n = 1; n <= nodes; n++) {
+        scanned += db.scan((uint8_t)n, 0, UINT64_MAX, [&](const TsdbRow &r) { checksum += r.temperatura + r.umidade; });
+    }
+    double scan_s = seconds_since(t0);
+    printf("varredura completa (linha a linha): %.2f M leituras/s\n", scanned / scan_s / 1e6);
+
+    t0 = Clock::now();
+    uint64_t summarized = 0;
+    int64_t summary_sum = 0;
+    for (unsigned n = 1; n <= nodes; n++) {
+        TsdbSummary s = db.summarize((uint8_t)n, 0, UINT64_MAX);
+        summarized += s.count;
+        summary_sum += s.temp_sum + s.umid_sum;
+    }
+    double sum_s = seconds_since(t0);
+    printf("resumo completo (por coluna): %.2f M leituras/s\n", summarized / sum_s / 1e6);
+
+    if (scanned != total || summarized != total || summary_sum != checksum) ok = false;
+    printf("verificacao: %s\n", ok ? "OK" : "FALHOU");
+
+    if (!keep) nftw(dir.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    else printf("dados mantidos em %s\n", dir.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+// tsdb_query.cpp
+//
+// Consulta o armazenamento colunar gravado pelo lora_gateway --db: lista as
+// leituras de um intervalo em CSV ou, com --resumo, contagem, mínimo, médio
+// e máximo por nó. Instantes em ms desde a época (coluna host_ms do gateway).
+//
+// Uso: tsdb_query [--node N] [--from ms] [--to ms] [--resumo] dir
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <getopt.h>
+
+#include "reading.hpp"
+#include "tsdb.hpp"
+
+namespace {
+
+void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--node N] [--from ms] [--to ms] [--resumo] dir\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int node = -1;
+    uint64_t from_ms = 0, to_ms = UINT64_MAX;
+    bool summary = false;
+    static const option long_opts[] = {
+        { "node",   required_argument, nullptr, 'n' },
+        { "from",   required_argument, nullptr, 'f' },
+        { "to",     required_argument, nullptr, 't' },
+        { "resumo", no_argument,       nullptr, 'r' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "n:f:t:r", long_opts, nullptr)) != -1) {
+        switch (c) {
+        case 'n': node = atoi(optarg); break;
+        case 'f': from_ms = strtoull(optarg, nullptr, 10); break;
+        case 't': to_ms = strtoull(optarg, nullptr, 10); break;
+        case 'r': summary = true; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind != argc - 1 || node > 255) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    TsdbReader db;
+    if (!db.open(argv[optind])) {
+        perror(argv[optind]);
+        return 1;
+    }
+    std::vector<uint8_t> nodes = db.nodes();
+    if (node >= 0) nodes.assign(1, (uint8_t)node);
+
+    char t[8], u[8];
+    if (summary) {
+        printf("node_id,leituras,primeiro_ms,ultimo_ms,temp_min,temp_media,temp_max,umid_min,umid_media,umid_max\n");
+        for (uint8_t id : nodes) {
+            TsdbSummary s = db.summarize(id, from_ms, to_ms);
+            if (s.count == 0) continue;
+            char tm[8], tx[8], um[8], ux[8];
+            printf("%u,%llu,%llu,%llu,%s,%s,%s,%s,%s,%s\n", id, (unsigned long long)s.count,
+                   (unsigned long long)s.first_ms, (unsigned long long)s.last_ms, centi(tm, s.temp_min),
+                   centi(t, (int16_t)(s.temp_sum / (int64_t)s.count)), centi(tx, s.temp_max), centi(um, s.umid_min),
+                   centi(u, (int16_t)(s.umid_sum / (int64_t)s.count)), centi(ux, s.umid_max));
+        }
+        return 0;
+    }
+
+    static char out_buf[1 << 16];
+    setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+    printf("host_ms,node_id,seq,temperatura,umidade,rssi_dbm\n");
+    for (uint8_t id : nodes) {
+        db.scan(id, from_ms, to_ms, [&](const TsdbRow &r) {
+            printf("%llu,%u,%u,%s,%s,%d\n", (unsigned long long)r.ts_ms, id, r.seq, centi(t, r.temperatura),
+                   centi(u, r.umidade), r.rssi_dbm);
+        });
+    }
+    return 0;
+}
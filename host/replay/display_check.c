@@ -0,0 +1,241 @@
+// display_check.c
+//
+// Confere o log de eventos da BitDogLab (bitdoglab/inc/logview.c), que rola
+// a tela mudando a start line do SSD1306 e enviando só a página nova, contra
+// o display emulado de ssd1306_sim.c. O driver de verdade (ssd1306.c) fala
+// com o emulador pelas mesmas transferências I2C do hardware.
+//
+// A cada tick entram de 0 a --rajada linhas (leituras, erros de CRC, linhas
+// longas demais), o log envia o que mudou e a imagem visível do emulador
+// precisa ser igual à tela desenhada do zero: as últimas linhas, de cima
+// para baixo, com o ssd1306_draw_string original. A cada --troca ticks outra
+// tela ocupa o display, como no receptor, e também é conferida. No fim a
+// rolagem contínua (ssd1306_scroll_start/stop) é ligada e desligada em cada
+// direção, conferindo o opcode que o emulador recebeu, e os bytes I2C são
+// comparados com enviar a tela inteira a cada tick. Sai com erro se alguma
+// tela ou rolagem não bater.
+//
+// Uso: display_check [--ticks N] [--rajada K] [--troca T] [--seed N] [--tela]
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hardware/i2c.h"
+#include "ssd1306.h"
+#include "logview.h"
+#include "ssd1306_sim.h"
+
+#define WIDTH  128
+#define HEIGHT 64
+#define PAGES  (HEIGHT / 8)
+
+// I2C: tudo vai para o display emulado
+static struct i2c_inst { int unused; } i2c1_inst;
+i2c_inst_t *i2c1 = &i2c1_inst;
+static ssd1306_sim_t sim;
+static uint64_t i2c_bytes;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c; (void)addr; (void)nostop;
+    i2c_bytes += len;
+    ssd1306_sim_write(&sim, src, len);
+    return (int)len;
+}
+
+// Referência: as últimas PAGES linhas, guardadas aqui à parte do logview
+static char ref_lines[PAGES][LOGVIEW_COLS + 1];
+static unsigned ref_count;
+
+static void ref_add(const char *text) {
+    memmove(ref_lines[0], ref_lines[1], sizeof(ref_lines) - sizeof(ref_lines[0]));
+    snprintf(ref_lines[PAGES - 1], sizeof(ref_lines[0]), "%.*s", LOGVIEW_COLS, text);
+    if (ref_count < PAGES) ref_count++;
+}
+
+static void ref_draw(ssd1306_t *ref) {
+    ssd1306_clear(ref);
+    for (unsigned page = PAGES - ref_count; page < PAGES; page++) {
+        ssd1306_draw_string(ref, 0, page * 8, 1, ref_lines[page]);
+    }
+}
+
+static void print_screen(const char *title, const uint8_t *buf) {
+    fprintf(stderr, "%s\n", title);
+    for (unsigned y = 0; y < HEIGHT; y++) {
+        char row[WIDTH + 1];
+        for (unsigned x = 0; x < WIDTH; x++) row[x] = (buf[x + WIDTH * (y >> 3)] >> (y & 7)) & 1 ? '#' : '.';
+        row[WIDTH] = '\0';
+        fprintf(stderr, "%s\n", row);
+    }
+}
+
+// Tela visível do emulador igual a expected? Na primeira diferença mostra as duas.
+static bool check_screen(const uint8_t *expected, unsigned tick, const char *what, unsigned *mismatches) {
+    uint8_t visible[WIDTH * PAGES];
+    ssd1306_sim_visible(&sim, visible, WIDTH, PAGES);
+    if (memcmp(visible, expected, sizeof(visible)) == 0) return true;
+    if ((*mismatches)++ == 0) {
+        fprintf(stderr, "display_check: tick %u, %s diferente (start line %u)\n", tick, what, sim.start_line);
+        print_screen("esperado:", expected);
+        print_screen("visivel:", visible);
+    }
+    return false;
+}
+
+static void make_line(char *out, size_t size) {
+    int kind = rand() % 10;
+    if (kind == 0) {
+        snprintf(out, size, "CRC %dB %d", 5 + rand() % 20, -90 - rand() % 30);
+    } else if (kind == 1) {
+        snprintf(out, size, "%d sem noticias ha muito tempo", rand() % 256); // cortada em LOGVIEW_COLS
+    } else {
+        int t = rand() % 6000 - 1000;
+        snprintf(out, size, "%d %s%d.%dC %d%% %d", rand() % 256, t < 0 ? "-" : "", abs(t) / 10, abs(t) % 10,
+                 rand() % 101, -40 - rand() % 90);
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--ticks N] [--rajada K] [--troca T] [--seed N] [--tela]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    unsigned ticks = 2000, burst = 3, swap_every = 50, seed = 1;
+    bool show = false;
+    static const struct option opts[] = {
+        { "ticks",  required_argument, NULL, 'n' },
+        { "rajada", required_argument, NULL, 'k' },
+        { "troca",  required_argument, NULL, 't' },
+        { "seed",   required_argument, NULL, 's' },
+        { "tela",   no_argument,       NULL, 'v' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "n:k:t:s:v", opts, NULL)) != -1) {
+        switch (c) {
+        case 'n': ticks = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'k': burst = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 't': swap_every = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 's': seed = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'v': show = true; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (ticks == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    srand(seed);
+
+    ssd1306_t disp = { .external_vcc = false };
+    ssd1306_sim_init(&sim);
+    if (!ssd1306_init(&disp, WIDTH, HEIGHT, 0x3C, i2c1)) {
+        perror("ssd1306_init");
+        return 1;
+    }
+    // Tela de referência: mesmo desenho, sem I2C
+    ssd1306_t ref = disp;
+    ref.buffer = calloc(1, disp.bufsize);
+    if (!ref.buffer) {
+        perror("calloc");
+        return 1;
+    }
+
+    logview_t lv;
+    logview_init(&lv);
+    logview_show(&lv, &disp);
+    bool on_log = true;
+    unsigned mismatches = 0, lines = 0, log_ticks = 0, log_ticks_with_lines = 0;
+    uint64_t log_bytes = 0;
+
+    for (unsigned tick = 0; tick < ticks; tick++) {
+        unsigned n = burst ? (unsigned)rand() % (burst + 1) : 0;
+        for (unsigned i = 0; i < n; i++) {
+            char line[64];
+            make_line(line, sizeof(line));
+            logview_add(&lv, &disp, line);
+            ref_add(line);
+            lines++;
+        }
+
+        if (swap_every && tick % swap_every == swap_every - 1) {
+            on_log = !on_log;
+            if (on_log) {
+                logview_show(&lv, &disp);
+            } else {
+                // Outra tela, desenhada inteira com a start line em 0
+                logview_hide(&lv, &disp);
+                ssd1306_clear(&disp);
+                ssd1306_draw_string(&disp, 0, 24, 2, "outra tela");
+                ssd1306_show(&disp);
+                check_screen(disp.buffer, tick, "outra tela", &mismatches);
+            }
+        }
+        if (!on_log) continue;
+
+        uint64_t before = i2c_bytes;
+        logview_flush(&lv, &disp);
+        log_ticks++;
+        if (n) {
+            log_ticks_with_lines++;
+            log_bytes += i2c_bytes - before;
+        }
+        ref_draw(&ref);
+        check_screen(ref.buffer, tick, "log", &mismatches);
+    }
+
+    // Rolagem contínua nas quatro direções: cada uma precisa chegar com o
+    // opcode certo e os comandos inteiros, e a RAM não pode ser escrita com
+    // ela ativa
+    static const struct {
+        bool left;
+        uint8_t vertical, opcode;
+    } scrolls[] = { { false, 0, 0x26 }, { true, 0, 0x27 }, { false, 1, 0x29 }, { true, 3, 0x2A } };
+    bool scroll_ok = true;
+    for (unsigned i = 0; i < sizeof(scrolls) / sizeof(scrolls[0]); i++) {
+        ssd1306_scroll_start(&disp, scrolls[i].left, (uint8_t)i, PAGES - 1, SSD1306_SCROLL_25_FRAMES,
+                             scrolls[i].vertical);
+        bool ok = sim.scrolling && sim.cmd_len == 0 && sim.scroll_cmd == scrolls[i].opcode &&
+                  sim.scroll_vertical == scrolls[i].vertical;
+        if (!ok) {
+            fprintf(stderr, "display_check: rolagem %s%s enviou 0x%02X (esperado 0x%02X)\n",
+                    scrolls[i].vertical ? "vertical e " : "", scrolls[i].left ? "esquerda" : "direita",
+                    sim.scroll_cmd, scrolls[i].opcode);
+        }
+        scroll_ok = scroll_ok && ok;
+        ssd1306_scroll_stop(&disp);
+    }
+    scroll_ok = scroll_ok && !sim.scrolling && sim.writes_while_scrolling == 0 && sim.bad_transfers == 0 &&
+                sim.unknown_cmds == 0;
+    if (on_log) {
+        logview_show(&lv, &disp); // a RAM ficou rolada: a tela é enviada de novo
+        ref_draw(&ref);
+        check_screen(ref.buffer, ticks, "log depois da rolagem continua", &mismatches);
+    }
+
+    // Tela inteira: 6 comandos de endereço (2 bytes cada) e 1 + 1024 bytes de dados
+    unsigned full = 6 * 2 + 1 + (unsigned)disp.bufsize;
+    printf("display_check: %u ticks, %u linhas (rajadas de ate %u), troca de tela a cada %u ticks\n", ticks, lines,
+           burst, swap_every);
+    printf("log: %lu rolagens pela start line, %lu telas inteiras; %.1f bytes I2C por tick com linhas novas "
+           "(tela inteira: %u)\n",
+           (unsigned long)lv.scrolls, (unsigned long)lv.redraws,
+           log_ticks_with_lines ? (double)log_bytes / log_ticks_with_lines : 0.0, full);
+    printf("emulador: %u transferencias, %u bytes de comando, %u de dados, %u trocas de start line, "
+           "%u transferencias invalidas, %u comandos desconhecidos\n",
+           sim.transfers, sim.cmd_bytes, sim.data_bytes, sim.start_line_changes, sim.bad_transfers,
+           sim.unknown_cmds);
+    printf("rolagem continua: %s\n", scroll_ok ? "ok" : "FALHOU");
+    printf("telas conferidas: %u ticks no log, %u diferentes\n", log_ticks, mismatches);
+    if (show) {
+        uint8_t visible[WIDTH * PAGES];
+        ssd1306_sim_visible(&sim, visible, WIDTH, PAGES);
+        print_screen("tela final:", visible);
+    }
+    free(ref.buffer);
+    ssd1306_deinit(&disp);
+    return mismatches == 0 && scroll_ok ? 0 : 1;
+}
@@ -0,0 +1,276 @@
+// flashlog_check.c
+//
+// Corta a energia do log circular da BitDogLab (bitdoglab/inc/flash_log.c)
+// em pontos aleatórios, sobre uma flash NOR emulada. O flash_log.c de
+// verdade grava leituras numeradas; depois de um número sorteado de
+// operações de flash a energia cai no meio de uma delas: a gravação de
+// página fica rasgada (só os primeiros bytes programados) e o apagamento de
+// setor fica pela metade. O buffer em RAM se perde, o log é reiniciado
+// (flash_log_init) e o dump é conferido:
+//   - só leituras que foram gravadas, com o conteúdo certo;
+//   - em ordem de gravação, sem repetições;
+//   - todas as páginas cuja gravação terminou e cujo setor não começou a
+//     ser apagado depois (os dados mais novos não podem se perder).
+// Também conta gravações sobre páginas não apagadas. Sai com erro se alguma
+// conferência falhar.
+//
+// Uso: flashlog_check [--cortes N] [--ops-max N] [--flush P] [--seed N]
+
+#include <getopt.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "flash_log.h"
+
+#define LOG_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_LOG_SECTORS * FLASH_SECTOR_SIZE)
+
+// Páginas que precisam estar no dump: gravação terminada, setor não apagado depois
+typedef struct {
+    bool durable;
+    uint32_t first_id;
+    uint8_t count;
+} expected_page_t;
+
+uint8_t mock_flash[PICO_FLASH_SIZE_BYTES];
+static expected_page_t expected[FLASH_LOG_PAGES];
+static uint64_t now_us;
+static jmp_buf power_cut;
+static uint32_t ops_left;           // operações de flash até o próximo corte
+static uint32_t torn_programs, torn_erases, dirty_programs;
+// Sobrevivem ao longjmp do corte de energia
+static uint32_t next_id;
+static unsigned failures;
+static uint32_t missing_pages;
+static uint64_t pages_after_boot, recovery_reads;
+
+// ============================
+// PICO SDK EMULADO
+// ============================
+
+uint64_t time_us_64(void) {
+    return now_us;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+
+// Decide se a energia cai nesta operação; se cair, quantos bytes chegam a ser escritos
+static bool cut_now(size_t count, size_t *done) {
+    if (ops_left == 0 || --ops_left > 0) return false;
+    *done = (size_t)rand() % count;
+    return true;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    size_t done = count;
+    bool cut = cut_now(count, &done);
+    if (done > 0 && flash_offs >= LOG_OFFSET) {
+        uint32_t first = (flash_offs - LOG_OFFSET) / FLASH_PAGE_SIZE;
+        for (uint32_t p = first; p < first + count / FLASH_PAGE_SIZE; p++) expected[p].durable = false;
+    }
+    memset(mock_flash + flash_offs, 0xFF, done);
+    if (cut) {
+        torn_erases++;
+        longjmp(power_cut, 1);
+    }
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (mock_flash[flash_offs + i] != 0xFF) {
+            dirty_programs++;
+            break;
+        }
+    }
+    size_t done = count;
+    bool cut = cut_now(count, &done);
+    for (size_t i = 0; i < done; i++) mock_flash[flash_offs + i] &= data[i]; // só desce bits, como a NOR
+    if (cut) {
+        torn_programs++;
+        longjmp(power_cut, 1);
+    }
+    const flash_log_page_t *page = (const flash_log_page_t *)data;
+    expected_page_t *e = &expected[(flash_offs - LOG_OFFSET) / FLASH_PAGE_SIZE];
+    e->durable = true;
+    e->first_id = page->rec[0].rx_ms;
+    e->count = page->hdr.count;
+}
+
+// ============================
+// LEITURAS NUMERADAS
+// ============================
+
+// Conteúdo determinístico de cada leitura, para conferir o que volta do dump
+static flash_log_record_t record_of(uint32_t id) {
+    uint32_t h = id * 2654435761u;
+    flash_log_record_t r = {
+        .rx_ms = id,
+        .timestamp_ms = h,
+        .temperatura = (int16_t)(h >> 16),
+        .umidade = (int16_t)h,
+        .node_id = (uint8_t)(1 + id % 200),
+        .seq = (uint8_t)id,
+        .rssi_neg_dbm = (uint8_t)(40 + h % 90),
+        .snr_qdb = (int8_t)(h >> 8),
+    };
+    return r;
+}
+
+static uint32_t *seen;              // seen[id] == check_no: a leitura apareceu no dump desta conferência
+static uint32_t seen_size;
+
+// Garante espaço em seen para a leitura id
+static bool seen_reserve(uint32_t id) {
+    if (id < seen_size) return true;
+    uint32_t size = seen_size ? seen_size : 1u << 16;
+    while (size <= id) size *= 2;
+    uint32_t *grown = realloc(seen, size * sizeof(*seen));
+    if (!grown) return false;
+    memset(grown + seen_size, 0, (size - seen_size) * sizeof(*seen));
+    seen = grown;
+    seen_size = size;
+    return true;
+}
+static uint32_t check_no;
+static int64_t last_id;
+static uint32_t dump_pages, dump_records, bad_records, out_of_order;
+
+static void collect_page(const uint8_t *data, size_t len) {
+    (void)len;
+    const flash_log_page_t *page = (const flash_log_page_t *)data;
+    dump_pages++;
+    for (unsigned i = 0; i < page->hdr.count; i++) {
+        const flash_log_record_t *r = &page->rec[i];
+        flash_log_record_t want = record_of(r->rx_ms);
+        if (r->rx_ms >= seen_size || memcmp(r, &want, sizeof(want)) != 0) {
+            bad_records++;
+            continue;
+        }
+        if ((int64_t)r->rx_ms <= last_id) out_of_order++;
+        last_id = r->rx_ms;
+        seen[r->rx_ms] = check_no;
+        dump_records++;
+    }
+}
+
+// Dump depois de um boot: tudo que é durável tem que estar lá, em ordem
+static bool check_dump(uint32_t cut) {
+    check_no++;
+    last_id = -1;
+    dump_pages = dump_records = bad_records = out_of_order = 0;
+    flash_log_dump(collect_page);
+
+    uint32_t missing = 0;
+    for (uint32_t p = 0; p < FLASH_LOG_PAGES; p++) {
+        const expected_page_t *e = &expected[p];
+        if (!e->durable) continue;
+        for (uint32_t id = e->first_id; id < e->first_id + e->count; id++) {
+            if (seen[id] != check_no) {
+                missing++;
+                break;
+            }
+        }
+    }
+    missing_pages += missing;
+    if (missing || bad_records || out_of_order) {
+        fprintf(stderr, "flashlog_check: corte %u: %u paginas duraveis faltando, %u leituras invalidas, "
+                "%u fora de ordem\n", cut, missing, bad_records, out_of_order);
+        return false;
+    }
+    return true;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--cortes N] [--ops-max N] [--flush P] [--seed N]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    static unsigned cuts = 400, ops_max = 3000, flush_every = 200, seed = 1; // static: sobrevivem ao longjmp
+    static const struct option opts[] = {
+        { "cortes",  required_argument, NULL, 'c' },
+        { "ops-max", required_argument, NULL, 'o' },
+        { "flush",   required_argument, NULL, 'f' },
+        { "seed",    required_argument, NULL, 's' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "c:o:f:s:", opts, NULL)) != -1) {
+        switch (c) {
+        case 'c': cuts = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'o': ops_max = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'f': flush_every = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 's': seed = (unsigned)strtoul(optarg, NULL, 0); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (ops_max == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    srand(seed);
+
+    memset(mock_flash, 0xFF, sizeof(mock_flash));
+
+    volatile unsigned cut = 0;
+    flash_log_stats_t st;
+
+    // Cada volta do laço é um boot: grava até a energia cair
+    setjmp(power_cut);
+    while (cut <= cuts) {
+        flash_log_init();
+        flash_log_get_stats(&st);
+        recovery_reads += st.recovery_reads;
+        if (cut > 0) {
+            if (!check_dump(cut)) failures++;
+            pages_after_boot += dump_pages;
+        }
+        if (cut == cuts) break;
+        cut++;
+        ops_left = 1 + (uint32_t)rand() % ops_max;
+        while (true) {
+            if (!seen_reserve(next_id + FLASH_LOG_RECORDS_PER_PAGE)) {
+                perror("realloc");
+                return 1;
+            }
+            flash_log_record_t r = record_of(next_id);
+            next_id++;
+            now_us += 1000;
+            flash_log_append(&r);
+            if (flush_every && rand() % flush_every == 0) flash_log_flush();
+        }
+    }
+
+    // Sem corte: grava o que ficou em RAM e confere mais uma vez
+    ops_left = 0;
+    if (!seen_reserve(next_id + FLASH_LOG_RECORDS_PER_PAGE)) {
+        perror("realloc");
+        return 1;
+    }
+    for (unsigned i = 0; i < FLASH_LOG_RECORDS_PER_PAGE; i++) {
+        flash_log_record_t r = record_of(next_id);
+        next_id++;
+        flash_log_append(&r);
+    }
+    flash_log_flush();
+    if (!check_dump(cut + 1)) failures++;
+
+    printf("flashlog_check: %u cortes de energia (%u gravacoes de pagina rasgadas, %u apagamentos pela metade), "
+           "%u leituras gravadas\n", cuts, torn_programs, torn_erases, next_id);
+    printf("dump apos cada boot: %.1f paginas em media (anel de %u), %.1f cabecalhos lidos na recuperacao\n",
+           cuts ? (double)pages_after_boot / cuts : 0.0, FLASH_LOG_PAGES,
+           (double)recovery_reads / (cuts + 1));
+    printf("%u paginas duraveis perdidas, %u gravacoes sobre pagina nao apagada, %u conferencias com erro\n",
+           missing_pages, dirty_programs, failures);
+    free(seen);
+    return failures == 0 && dirty_programs == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+// history_check.c
+//
+// Confere o histórico das grandezas (bitdoglab/inc/history.c) e o gráfico
+// rolado no display (bitdoglab/inc/sparkline.c) contra versões de força
+// bruta, com leituras sorteadas: passeio aleatório com saltos, patamares de
+// ruído e valores extremos de int16.
+//   - Depois de cada leitura, contagem, leituras por idade, mínimo, máximo e
+//     média da janela são recalculados varrendo as últimas HISTORY_LEN.
+//   - Dois gráficos (2 páginas, como no receptor, e SPARKLINE_MAX_PAGES)
+//     são rolados no mesmo framebuffer; depois de cada leitura o buffer
+//     precisa ser byte a byte igual ao gráfico desenhado do zero, pixel a
+//     pixel, na escala que o sparkline está usando, e as páginas fora dos
+//     gráficos não podem mudar.
+// Sai com erro na primeira diferença de cada tipo.
+//
+// Uso: history_check [--leituras N] [--seed N]
+
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "history.h"
+#include "sparkline.h"
+
+#define WIDTH   128
+#define PAGES   8
+#define FILL    0xA5   // páginas fora dos gráficos
+
+// ============================
+// REFERÊNCIAS DE FORÇA BRUTA
+// ============================
+
+static int16_t *readings;   // todas as leituras, em ordem
+
+static bool check_history(const history_t *h, uint32_t n, uint32_t *errors) {
+    uint32_t count = n < HISTORY_LEN ? n : HISTORY_LEN;
+    int16_t lo = 0, hi = 0;
+    int64_t sum = 0;
+    bool ok = history_count(h) == count;
+    for (uint32_t age = 0; age < count; age++) {
+        int16_t v = readings[n - 1 - age];
+        if (age == 0 || v < lo) lo = v;
+        if (age == 0 || v > hi) hi = v;
+        sum += v;
+        ok = ok && history_get(h, (uint16_t)age) == v;
+    }
+    int16_t mean = count ? (int16_t)llround((double)sum / count) : 0;
+    ok = ok && history_min(h) == lo && history_max(h) == hi && history_mean(h) == mean;
+    if (!ok && (*errors)++ == 0) {
+        fprintf(stderr, "history_check: leitura %u: min %d/%d max %d/%d media %d/%d contagem %u/%u "
+                "(history.c/forca bruta)\n", n, history_min(h), lo, history_max(h), hi, history_mean(h), mean,
+                history_count(h), count);
+    }
+    return ok;
+}
+
+// Linha de v na escala lo..hi, arredondada (0 = topo da faixa)
+static int ref_row(int16_t v, int16_t lo, int16_t hi, int rows) {
+    int bottom = rows - 1;
+    if (v <= lo) return bottom;
+    if (v >= hi) return 0;
+    return bottom - (int)floor((double)(v - lo) * bottom / (hi - lo) + 0.5);
+}
+
+// Gráfico desenhado pixel a pixel: cada coluna liga a leitura anterior à
+// atual; a coluna mais antiga visível é só um ponto
+static void ref_graph(uint8_t *buf, const sparkline_t *s, uint32_t n) {
+    uint32_t count = n < HISTORY_LEN ? n : HISTORY_LEN;
+    int rows = s->pages * 8;
+    memset(&buf[WIDTH * s->page0], 0, (size_t)WIDTH * s->pages);
+    for (uint32_t x = 0; x < WIDTH; x++) {
+        uint32_t age = WIDTH - 1 - x;
+        if (age >= count) continue;
+        int16_t cur = readings[n - 1 - age];
+        int16_t prev = age + 1 < count ? readings[n - 2 - age] : cur;
+        int a = ref_row(prev, s->lo, s->hi, rows), b = ref_row(cur, s->lo, s->hi, rows);
+        for (int y = a < b ? a : b; y <= (a < b ? b : a); y++) {
+            buf[x + WIDTH * (s->page0 + y / 8)] |= (uint8_t)(1u << (y % 8));
+        }
+    }
+}
+
+static bool check_graph(const ssd1306_t *disp, const sparkline_t *s, uint32_t n, const char *name,
+                        uint32_t *errors) {
+    static uint8_t expected[WIDTH * PAGES];
+    ref_graph(expected, s, n);
+    const uint8_t *got = &disp->buffer[WIDTH * s->page0], *want = &expected[WIDTH * s->page0];
+    if (memcmp(got, want, (size_t)WIDTH * s->pages) == 0) return true;
+    if ((*errors)++ == 0) {
+        size_t i = 0;
+        while (got[i] == want[i]) i++;
+        fprintf(stderr, "history_check: leitura %u, grafico %s (escala %d..%d): coluna %zu da pagina %zu "
+                "0x%02X, esperado 0x%02X\n", n, name, s->lo, s->hi, i % WIDTH, s->page0 + i / WIDTH, got[i],
+                want[i]);
+    }
+    return false;
+}
+
+// ============================
+// LEITURAS SORTEADAS
+// ============================
+
+static int16_t next_reading(int32_t *level) {
+    int r = rand() % 2000;
+    if (r == 0) return rand() % 2 ? INT16_MIN : INT16_MAX;              // extremo isolado
+    if (r < 4) *level = rand() % 10000 - 4000;                          // salto
+    else if (r < 1000) *level += rand() % 61 - 30;                      // passeio
+    if (*level < -4000) *level = -4000;
+    if (*level > 10000) *level = 10000;
+    return (int16_t)(*level + (r % 7 == 0 ? rand() % 5 - 2 : 0));       // ruído
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--leituras N] [--seed N]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    unsigned total = 100000, seed = 1;
+    static const struct option opts[] = {
+        { "leituras", required_argument, NULL, 'n' },
+        { "seed",     required_argument, NULL, 's' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "n:s:", opts, NULL)) != -1) {
+        switch (c) {
+        case 'n': total = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 's': seed = (unsigned)strtoul(optarg, NULL, 0); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (total == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    srand(seed);
+
+    readings = malloc(total * sizeof(*readings));
+    uint8_t *buffer = malloc(WIDTH * PAGES);
+    if (!readings || !buffer) {
+        perror("malloc");
+        return 1;
+    }
+    memset(buffer, FILL, WIDTH * PAGES);
+    ssd1306_t disp = { .width = WIDTH, .height = PAGES * 8, .pages = PAGES, .buffer = buffer,
+                       .bufsize = WIDTH * PAGES };
+
+    history_t h;
+    history_init(&h);
+    sparkline_t small, tall;
+    sparkline_init(&small, 2, 2, 50);                   // como no receptor (temperatura)
+    sparkline_init(&tall, 4, SPARKLINE_MAX_PAGES, 100);
+
+    uint32_t hist_errors = 0, graph_errors = 0, other_errors = 0;
+    int32_t level = 2500;
+    for (uint32_t n = 1; n <= total; n++) {
+        readings[n - 1] = next_reading(&level);
+        history_push(&h, readings[n - 1]);
+        check_history(&h, n, &hist_errors);
+
+        sparkline_push(&small, &disp, &h);
+        sparkline_push(&tall, &disp, &h);
+        check_graph(&disp, &small, n, "de 2 paginas", &graph_errors);
+        check_graph(&disp, &tall, n, "de 4 paginas", &graph_errors);
+        for (size_t i = 0; i < (size_t)WIDTH * small.page0; i++) {
+            if (buffer[i] != FILL) {
+                other_errors++;
+                break;
+            }
+        }
+    }
+
+    printf("history_check: %u leituras, janela de %u\n", total, HISTORY_LEN);
+    printf("historico: %u diferencas contra a forca bruta (min, max, media, leituras)\n", hist_errors);
+    printf("grafico de 2 paginas: %lu rolagens, %lu redesenhos; de 4 paginas: %lu rolagens, %lu redesenhos\n",
+           (unsigned long)small.scrolls, (unsigned long)small.redraws, (unsigned long)tall.scrolls,
+           (unsigned long)tall.redraws);
+    printf("framebuffer: %u diferencas contra o desenho do zero, %u leituras com paginas vizinhas alteradas\n",
+           graph_errors, other_errors);
+    free(readings);
+    free(buffer);
+    return hist_errors == 0 && graph_errors == 0 && other_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1 @@
+// blink.pio.h (host/replay): o programa PIO não é usado na recepção
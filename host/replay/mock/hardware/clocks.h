@@ -0,0 +1,39 @@
+// hardware/clocks.h (host/replay): registradores de gating sem efeito
+
+#ifndef REPLAY_HARDWARE_CLOCKS_H_
+#define REPLAY_HARDWARE_CLOCKS_H_
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    volatile uint32_t sleep_en0;
+    volatile uint32_t sleep_en1;
+} clocks_hw_t;
+
+extern clocks_hw_t *clocks_hw;
+
+#define CLOCKS_SLEEP_EN0_CLK_SYS_SRAM3_BITS     (1u << 31)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_SRAM2_BITS     (1u << 30)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_SRAM1_BITS     (1u << 29)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_SRAM0_BITS     (1u << 28)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_RESETS_BITS    (1u << 21)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_PSM_BITS       (1u << 14)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_PLL_USB_BITS   (1u << 13)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_PLL_SYS_BITS   (1u << 12)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS      (1u << 11)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS        (1u << 8)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_CLOCKS_BITS    (1u << 3)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_BUSFABRIC_BITS (1u << 2)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_BUSCTRL_BITS   (1u << 1)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_SIO_BITS       (1u << 22)
+#define CLOCKS_SLEEP_EN1_CLK_SYS_XOSC_BITS      (1u << 14)
+#define CLOCKS_SLEEP_EN1_CLK_SYS_WATCHDOG_BITS  (1u << 13)
+#define CLOCKS_SLEEP_EN1_CLK_USB_USBCTRL_BITS   (1u << 12)
+#define CLOCKS_SLEEP_EN1_CLK_SYS_USBCTRL_BITS   (1u << 11)
+#define CLOCKS_SLEEP_EN1_CLK_SYS_UART0_BITS     (1u << 8)
+#define CLOCKS_SLEEP_EN1_CLK_PERI_UART0_BITS    (1u << 7)
+#define CLOCKS_SLEEP_EN1_CLK_SYS_TIMER_BITS     (1u << 5)
+#define CLOCKS_SLEEP_EN1_CLK_SYS_SRAM5_BITS     (1u << 1)
+#define CLOCKS_SLEEP_EN1_CLK_SYS_SRAM4_BITS     (1u << 0)
+
+#endif // REPLAY_HARDWARE_CLOCKS_H_
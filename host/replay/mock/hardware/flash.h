@@ -0,0 +1,14 @@
+// hardware/flash.h (host/replay): apagamento e gravação sobre mock_flash
+
+#ifndef REPLAY_HARDWARE_FLASH_H_
+#define REPLAY_HARDWARE_FLASH_H_
+
+#include "pico/stdlib.h"
+
+#define FLASH_PAGE_SIZE   256u
+#define FLASH_SECTOR_SIZE 4096u
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif // REPLAY_HARDWARE_FLASH_H_
@@ -0,0 +1,14 @@
+// hardware/i2c.h (host/replay): as escritas vão para o display emulado (ssd1306_sim.h)
+
+#ifndef REPLAY_HARDWARE_I2C_H_
+#define REPLAY_HARDWARE_I2C_H_
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *i2c1;
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif // REPLAY_HARDWARE_I2C_H_
@@ -0,0 +1,2 @@
+// hardware/pio.h (host/replay): declarações em pico/stdlib.h
+#include "pico/stdlib.h"
@@ -0,0 +1,16 @@
+// hardware/spi.h (host/replay): as transações vão para o rádio emulado (sx1276_sim.h)
+
+#ifndef REPLAY_HARDWARE_SPI_H_
+#define REPLAY_HARDWARE_SPI_H_
+
+#include "pico/stdlib.h"
+
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t *spi0;
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len);
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len);
+
+#endif // REPLAY_HARDWARE_SPI_H_
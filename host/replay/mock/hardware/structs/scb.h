@@ -0,0 +1,16 @@
+// hardware/structs/scb.h (host/replay): SCR sem efeito (o __wfi é emulado)
+
+#ifndef REPLAY_HARDWARE_STRUCTS_SCB_H_
+#define REPLAY_HARDWARE_STRUCTS_SCB_H_
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t scr;
+} armv6m_scb_hw_t;
+
+extern armv6m_scb_hw_t *scb_hw;
+
+#define M0PLUS_SCR_SLEEPDEEP_BITS 0x4u
+
+#endif // REPLAY_HARDWARE_STRUCTS_SCB_H_
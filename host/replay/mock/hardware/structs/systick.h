@@ -0,0 +1,17 @@
+// hardware/structs/systick.h (host/replay): SysTick parado (o contador não anda)
+
+#ifndef REPLAY_HARDWARE_STRUCTS_SYSTICK_H_
+#define REPLAY_HARDWARE_STRUCTS_SYSTICK_H_
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t csr;
+    volatile uint32_t rvr;
+    volatile uint32_t cvr;
+    volatile uint32_t calib;
+} systick_hw_t;
+
+extern systick_hw_t *systick_hw;
+
+#endif // REPLAY_HARDWARE_STRUCTS_SYSTICK_H_
@@ -0,0 +1,2 @@
+// hardware/uart.h (host/replay): declarações em pico/stdlib.h
+#include "pico/stdlib.h"
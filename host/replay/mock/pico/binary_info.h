@@ -0,0 +1 @@
+// pico/binary_info.h (host/replay): sem metadados de binário no host
@@ -0,0 +1,10 @@
+// pico/rand.h (host/replay): sequência pseudoaleatória fixa, para repetibilidade
+
+#ifndef REPLAY_PICO_RAND_H_
+#define REPLAY_PICO_RAND_H_
+
+#include <stdint.h>
+
+uint32_t get_rand_32(void);
+
+#endif // REPLAY_PICO_RAND_H_
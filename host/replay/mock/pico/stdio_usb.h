@@ -0,0 +1,14 @@
+// pico/stdio_usb.h (host/replay): a saída USB vai para a saída padrão
+
+#ifndef REPLAY_PICO_STDIO_USB_H_
+#define REPLAY_PICO_STDIO_USB_H_
+
+typedef struct stdio_driver {
+    void (*out_chars)(const char *buf, int len);
+    void (*out_flush)(void);
+    int (*in_chars)(char *buf, int len);
+} stdio_driver_t;
+
+extern stdio_driver_t stdio_usb;
+
+#endif // REPLAY_PICO_STDIO_USB_H_
@@ -0,0 +1,79 @@
+// pico/stdlib.h (host/replay)
+//
+// Subconjunto do Pico SDK usado pelo firmware da BitDogLab, implementado em
+// host/replay/mock_hal.c sobre um relógio virtual. Só o que o firmware chama.
+
+#ifndef REPLAY_PICO_STDLIB_H_
+#define REPLAY_PICO_STDLIB_H_
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;   // microssegundos desde o boot
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t events);
+
+#define PICO_ERROR_NONE      0
+#define PICO_ERROR_GENERIC   -1
+#define PICO_ERROR_TIMEOUT   -2
+
+#define GPIO_IN              false
+#define GPIO_OUT             true
+#define GPIO_FUNC_SPI        1
+#define GPIO_FUNC_I2C        3
+#define GPIO_IRQ_EDGE_FALL   0x4u
+#define GPIO_IRQ_EDGE_RISE   0x8u
+
+// Flash emulada: as leituras via XIP caem neste vetor
+#define PICO_FLASH_SIZE_BYTES (2u * 1024 * 1024)
+extern uint8_t mock_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE             ((uintptr_t)mock_flash)
+
+// ---- stdio ----
+bool stdio_init_all(void);
+void stdio_flush(void);
+int getchar_timeout_us(uint32_t timeout_us);
+
+// ---- GPIO ----
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_function(uint gpio, int fn);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback);
+
+// ---- Tempo ----
+uint64_t time_us_64(void);
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) { return t + ms * 1000ull; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return time_us_64() + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return time_us_64() + ms * 1000ull; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+static inline bool time_reached(absolute_time_t t) { return time_us_64() >= t; }
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+// Nos laços de espera ativa o relógio virtual salta para o próximo evento
+void tight_loop_contents(void);
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t id);
+
+// ---- Núcleo ----
+void __wfi(void);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+#endif // REPLAY_PICO_STDLIB_H_
@@ -0,0 +1,345 @@
+// mock_hal.c
+//
+// Implementação no host do subconjunto do Pico SDK declarado em mock/.
+
+#include <setjmp.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "pico/rand.h"
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include "hardware/structs/scb.h"
+#include "hardware/structs/systick.h"
+#include "mock_hal.h"
+#include "ssd1306_sim.h"
+#include "sx1276_sim.h"
+
+#define MAX_ALARMS 8
+
+typedef struct {
+    bool active;
+    alarm_id_t id;
+    uint64_t at_us;
+    alarm_callback_t callback;
+    void *user_data;
+} mock_alarm_t;
+
+// Periféricos que o firmware referencia por ponteiro
+static struct spi_inst { int unused; } spi0_inst;
+static struct i2c_inst { int unused; } i2c1_inst;
+static clocks_hw_t clocks_regs;
+static armv6m_scb_hw_t scb_regs;
+static systick_hw_t systick_regs;
+spi_inst_t *spi0 = &spi0_inst;
+i2c_inst_t *i2c1 = &i2c1_inst;
+clocks_hw_t *clocks_hw = &clocks_regs;
+armv6m_scb_hw_t *scb_hw = &scb_regs;
+systick_hw_t *systick_hw = &systick_regs;
+uint8_t mock_flash[PICO_FLASH_SIZE_BYTES];
+
+static bool paced;
+static uint64_t now_us;
+static uint64_t real_t0_ns;
+static bool dispatching;
+static mock_alarm_t alarms[MAX_ALARMS];
+static alarm_id_t next_alarm_id = 1;
+static const char *console_input;
+static uint32_t rand_state = 0x2545F491u;
+static mock_stats_t stats;
+static jmp_buf finish_jmp;
+static ssd1306_sim_t display;   // o SSD1306 no I2C, endereço MOCK_DISPLAY_ADDR
+
+// GPIO: níveis de saída, IRQ do DIO0 e o pino que está em chip select
+static uint64_t gpio_levels;
+static uint64_t gpio_irq_enabled;
+static gpio_irq_callback_t gpio_callback;
+static int dio0_pin = -1;
+static int cs_pin = -1;
+
+// ============================
+// RELÓGIO VIRTUAL E EVENTOS
+// ============================
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Entrega os eventos vencidos: rádio (pode disparar o DIO0) e alarmes
+static void dispatch(void) {
+    if (dispatching) return; // chamada de dentro de um callback
+    dispatching = true;
+    sx1276_advance(now_us);
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        mock_alarm_t *a = &alarms[i];
+        if (a->active && a->at_us <= now_us) {
+            a->active = false;
+            a->callback(a->id, a->user_data); // o firmware só usa alarmes de disparo único
+        }
+    }
+    dispatching = false;
+}
+
+static uint64_t next_event(void) {
+    uint64_t t = sx1276_next_event();
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (alarms[i].active && alarms[i].at_us < t) t = alarms[i].at_us;
+    }
+    return t;
+}
+
+// Avança o relógio até target passando por cada evento no caminho
+static void advance_to(uint64_t target) {
+    while (true) {
+        uint64_t t = next_event();
+        if (t > target) t = target;
+        if (t > now_us) {
+            if (paced) {
+                uint64_t due_ns = real_t0_ns + t * 1000, real = mono_ns();
+                if (due_ns > real) {
+                    struct timespec ts = { (time_t)((due_ns - real) / 1000000000ull), (long)((due_ns - real) % 1000000000ull) };
+                    nanosleep(&ts, NULL);
+                    stats.sleep_ns += due_ns - real;
+                }
+            }
+            now_us = t;
+        }
+        dispatch();
+        if (t >= target) return;
+    }
+}
+
+uint64_t time_us_64(void) {
+    if (paced) {
+        uint64_t real_us = (mono_ns() - real_t0_ns) / 1000;
+        if (real_us > now_us) now_us = real_us;
+    }
+    dispatch();
+    return now_us;
+}
+
+void sleep_us(uint64_t us) {
+    advance_to(time_us_64() + us);
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us(ms * 1000ull);
+}
+
+void tight_loop_contents(void) {
+    uint64_t t = next_event();
+    advance_to(t == SX_NEVER ? now_us + 1000 : t);
+}
+
+// O primeiro sono marca o fim da inicialização: a captura começa a tocar
+void __wfi(void) {
+    stats.wfi_calls++;
+    if (!sx1276_started()) sx1276_start(time_us_64());
+    if (sx1276_finished()) longjmp(finish_jmp, 1);
+    uint64_t t = next_event();
+    if (t == SX_NEVER) {
+        stats.stalled = true;
+        longjmp(finish_jmp, 1);
+    }
+    advance_to(t);
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    if (time <= time_us_64()) {
+        if (fire_if_past) callback(0, user_data);
+        return 0;
+    }
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (!alarms[i].active) {
+            alarms[i] = (mock_alarm_t){ true, next_alarm_id++, time, callback, user_data };
+            return alarms[i].id;
+        }
+    }
+    return PICO_ERROR_GENERIC;
+}
+
+bool cancel_alarm(alarm_id_t id) {
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (alarms[i].active && alarms[i].id == id) {
+            alarms[i].active = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================
+// GPIO E SPI
+// ============================
+
+void gpio_init(uint gpio) { (void)gpio; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+void gpio_set_function(uint gpio, int fn) { (void)gpio; (void)fn; }
+void gpio_pull_up(uint gpio) { (void)gpio; }
+void gpio_pull_down(uint gpio) { (void)gpio; }
+
+// Uma borda de descida abre uma transação SPI, e a subida do mesmo pino a
+// fecha: assim o chip select não precisa ser configurado no replay
+void gpio_put(uint gpio, bool value) {
+    bool was = (gpio_levels >> gpio) & 1;
+    if (value) gpio_levels |= 1ull << gpio;
+    else gpio_levels &= ~(1ull << gpio);
+
+    if (was && !value && cs_pin < 0) {
+        cs_pin = (int)gpio;
+        sx1276_select(true);
+    } else if (!was && value && (int)gpio == cs_pin) {
+        cs_pin = -1;
+        sx1276_select(false);
+    }
+}
+
+bool gpio_get(uint gpio) {
+    return (gpio_levels >> gpio) & 1;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) {
+    (void)events;
+    if (enabled) gpio_irq_enabled |= 1ull << gpio;
+    else gpio_irq_enabled &= ~(1ull << gpio);
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    gpio_callback = callback;
+    dio0_pin = (int)gpio; // o driver registra o callback no DIO0
+    gpio_set_irq_enabled(gpio, events, enabled);
+}
+
+void mock_dio0_edge(void) {
+    if (dio0_pin >= 0 && gpio_callback && ((gpio_irq_enabled >> dio0_pin) & 1)) {
+        gpio_callback((uint)dio0_pin, GPIO_IRQ_EDGE_RISE);
+    }
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    (void)spi;
+    return baudrate;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    (void)spi;
+    for (size_t i = 0; i < len; i++) sx1276_transfer(src[i]);
+    return (int)len;
+}
+
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len) {
+    (void)spi;
+    for (size_t i = 0; i < len; i++) dst[i] = sx1276_transfer(src[i]);
+    return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len) {
+    (void)spi;
+    for (size_t i = 0; i < len; i++) dst[i] = sx1276_transfer(repeated_tx_data);
+    return (int)len;
+}
+
+// ============================
+// I2C, FLASH, STDIO E RAND
+// ============================
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    (void)i2c;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c; (void)nostop;
+    stats.i2c_bytes += len;
+    if (addr == MOCK_DISPLAY_ADDR) ssd1306_sim_write(&display, src, len);
+    return (int)len;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    memset(mock_flash + flash_offs, 0xFF, count);
+    stats.flash_erases++;
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    for (size_t i = 0; i < count; i++) mock_flash[flash_offs + i] &= data[i]; // só desce bits, como a NOR
+    stats.flash_programs++;
+}
+
+static void usb_out_chars(const char *buf, int len) {
+    fwrite(buf, 1, (size_t)len, stdout);
+    stats.usb_bytes += (uint64_t)len;
+}
+
+static void usb_out_flush(void) {
+    fflush(stdout);
+}
+
+stdio_driver_t stdio_usb = { usb_out_chars, usb_out_flush, NULL };
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+void stdio_flush(void) {
+    fflush(stdout);
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    (void)timeout_us;
+    if (!console_input || !*console_input) return PICO_ERROR_TIMEOUT;
+    return (unsigned char)*console_input++;
+}
+
+uint32_t get_rand_32(void) {
+    rand_state ^= rand_state << 13; // xorshift32
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+// ============================
+// CONTROLE PELO RX_REPLAY
+// ============================
+
+void mock_hal_init(bool pace, const char *console) {
+    paced = pace;
+    now_us = 0;
+    real_t0_ns = mono_ns();
+    memset(alarms, 0, sizeof(alarms));
+    memset(&stats, 0, sizeof(stats));
+    memset(mock_flash, 0xFF, sizeof(mock_flash));
+    console_input = console;
+    ssd1306_sim_init(&display);
+}
+
+bool mock_hal_run(int (*firmware_main)(void)) {
+    if (setjmp(finish_jmp) == 0) firmware_main();
+    fflush(stdout);
+    return !stats.stalled;
+}
+
+uint64_t mock_hal_now_us(void) {
+    return now_us;
+}
+
+void mock_hal_get_stats(mock_stats_t *out) {
+    *out = stats;
+}
+
+const ssd1306_sim_t *mock_hal_display(void) {
+    return &display;
+}
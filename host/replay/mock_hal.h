@@ -0,0 +1,52 @@
+// mock_hal.h
+//
+// Controle do Pico SDK emulado (mock/ e mock_hal.c) pelo rx_replay. O tempo
+// é virtual: avança só quando o firmware dorme (__wfi, sleep_ms) ou espera
+// ativamente (tight_loop_contents), e então salta para o próximo evento
+// (chegada de pacote, TxDone, alarme). No ritmo original o salto espera o
+// tempo real correspondente; no modo rápido é imediato.
+
+#ifndef MOCK_HAL_H_
+#define MOCK_HAL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ssd1306_sim.h"
+
+#define MOCK_DISPLAY_ADDR 0x3C   // SSD1306 da BitDogLab
+
+typedef struct {
+    uint64_t i2c_bytes;        // display SSD1306
+    uint64_t usb_bytes;        // saída binária (stdio_usb.out_chars)
+    uint64_t flash_erases;
+    uint64_t flash_programs;
+    uint64_t wfi_calls;
+    uint64_t sleep_ns;         // tempo real dormido no ritmo original
+    bool stalled;              // o firmware parou de receber antes do fim da captura
+} mock_stats_t;
+
+/**
+ * @brief Prepara o HAL emulado (flash apagada, relógio em zero).
+ * @param paced true = segue o tempo real; false = salta direto aos eventos.
+ * @param console Texto entregue ao getchar do firmware (comandos separados por '\n'), ou NULL.
+ */
+void mock_hal_init(bool paced, const char *console);
+
+/**
+ * @brief Roda o main() do firmware até a captura do sx1276_sim acabar e o
+ * último pacote ser lido. O firmware nunca retorna; a saída é por longjmp
+ * a partir do __wfi.
+ * @return false se o firmware travou (nenhum evento pendente e pacotes por entregar).
+ */
+bool mock_hal_run(int (*firmware_main)(void));
+
+uint64_t mock_hal_now_us(void);
+void mock_hal_get_stats(mock_stats_t *out);
+
+/**
+ * @brief O display emulado (ssd1306_sim.h), que recebe as escritas I2C do firmware.
+ */
+const ssd1306_sim_t *mock_hal_display(void);
+
+#endif // MOCK_HAL_H_
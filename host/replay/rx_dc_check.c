@@ -0,0 +1,88 @@
+// rx_dc_check.c
+//
+// Confere o dimensionamento da recepção por ciclos da BitDogLab
+// (lora_rx_duty_cycle_sleep_us em bitdoglab/inc/lora_RFM95.c) contra o
+// SX1276 emulado de sx1276_sim.c. O driver de verdade é inicializado sobre o
+// rádio emulado para cada janela de escuta, e a duração do símbolo usada na
+// conta vem da decodificação que o emulador faz dos registradores
+// programados, não do driver.
+//
+// Para cada preâmbulo, o pior caso é um pacote cujo preâmbulo começa logo
+// depois de uma janela fechar: a janela seguinte abre depois do sleep e do
+// atraso do laço (LORA_RX_DC_MARGIN_US) e ainda precisa de uma janela
+// inteira de preâmbulo para detectá-lo. Ou seja,
+//   janela + sleep + margem + janela <= preâmbulo   (em tempo)
+// Sai com erro se algum par (preâmbulo, janela) com sleep > 0 violar isso.
+//
+// Uso: rx_dc_check [--janela-max N] [--preambulo-max N]
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lora_RFM95.h"
+#include "mock_hal.h"
+#include "sx1276_sim.h"
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--janela-max N] [--preambulo-max N]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    unsigned window_max = 16, preamble_max = 256;
+    static const struct option opts[] = {
+        { "janela-max",    required_argument, NULL, 'j' },
+        { "preambulo-max", required_argument, NULL, 'p' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "j:p:", opts, NULL)) != -1) {
+        switch (c) {
+        case 'j': window_max = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'p': preamble_max = (unsigned)strtoul(optarg, NULL, 0); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (window_max == 0 || preamble_max < 6 || preamble_max > 0xFFFF) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    sx1276_init(NULL, 0, true);
+    mock_hal_init(false, NULL);
+
+    unsigned checked = 0, failures = 0, symbol_mismatch = 0;
+    int64_t min_slack_us = INT64_MAX;
+    for (unsigned window = 1; window <= window_max; window++) {
+        lora_config_t cfg = {
+            .spi_instance = spi0, .pin_miso = 16, .pin_cs = 17, .pin_sck = 18, .pin_mosi = 19,
+            .pin_rst = 20, .pin_dio0 = 8, .frequency = 915000000, .rx_window_symbols = (uint16_t)window,
+        };
+        if (!lora_init(cfg)) {
+            fprintf(stderr, "rx_dc_check: lora_init falhou\n");
+            return 1;
+        }
+        uint32_t sym = sx1276_symbol_us();
+        if (lora_symbol_us() != sym) symbol_mismatch++;
+        for (unsigned preamble = 6; preamble <= preamble_max; preamble++) {
+            uint32_t sleep_us = lora_rx_duty_cycle_sleep_us((uint16_t)preamble);
+            if (sleep_us == 0) continue; // RX contínuo
+            checked++;
+            int64_t slack = (int64_t)preamble * sym -
+                            ((int64_t)2 * window * sym + sleep_us + LORA_RX_DC_MARGIN_US);
+            if (slack < min_slack_us) min_slack_us = slack;
+            if (slack < 0 && failures++ < 5) {
+                fprintf(stderr, "rx_dc_check: preambulo %u, janela %u: sleep %lu us deixa o preambulo passar "
+                                "(faltam %lld us)\n",
+                        preamble, window, (unsigned long)sleep_us, (long long)-slack);
+            }
+        }
+    }
+
+    printf("rx_dc_check: simbolo %lu us (driver %lu us), janelas 1..%u, preambulos 6..%u\n",
+           (unsigned long)sx1276_symbol_us(), (unsigned long)lora_symbol_us(), window_max, preamble_max);
+    printf("%u combinacoes com sleep, %u falhas, menor folga %lld us; %u janelas com simbolo diferente do radio\n",
+           checked, failures, checked ? (long long)min_slack_us : 0LL, symbol_mismatch);
+    return failures == 0 && symbol_mismatch == 0 ? 0 : 1;
+}
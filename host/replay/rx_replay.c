@@ -0,0 +1,292 @@
+// rx_replay.c
+//
+// Reproduz uma captura de recepção da BitDogLab (comando "captura" no
+// console: registros LORA_STREAM_TYPE_CAPTURE no fluxo USB) através do
+// firmware de verdade: lora_RFM95.c decodifica cada pacote pelas mesmas
+// transações SPI, agora contra o rádio emulado de sx1276_sim.c, e o laço de
+// bitdoglab_tarefa5.c trata o pacote (dedup, log em flash, display, saída
+// de texto ou binária) sobre o Pico SDK emulado de mock_hal.c.
+//
+// A saída padrão recebe exatamente o que o firmware mandaria pela USB (pode
+// ir para o stream_decode com --comandos bin); o resumo vai para stderr.
+// Sem captura, --sintetico gera N amostras de --nos nós, uma a cada
+// --intervalo-ms, que podem ser gravadas com --salvar no formato de captura.
+//
+// Por padrão os pacotes chegam no ritmo original; com --rapido o relógio
+// virtual salta direto ao próximo evento, e a vazão medida é a do caminho
+// de recepção do firmware rodando no host.
+//
+// O display é o SSD1306 emulado de ssd1306_sim.c: --tela mostra no fim o
+// que estaria visível no vidro.
+//
+// Uso: rx_replay [--rapido] [--repetir N] [--comandos "bin,captura"]
+//                [--sintetico N] [--nos N] [--intervalo-ms M] [--salvar arquivo]
+//                [--tela] [captura...]
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cobs.h"
+#include "lora_proto.h"
+#include "lora_stream.h"
+#include "mock_hal.h"
+#include "sx1276_sim.h"
+
+// main() de bitdoglab_tarefa5.c, renomeado na compilação
+int bitdoglab_main(void);
+
+#define MAX_FRAME COBS_MAX_ENCODED(LORA_STREAM_MAX_RECORD)
+
+typedef struct {
+    sx_packet_t *items;
+    size_t count, cap;
+} packet_list_t;
+
+static sx_packet_t *push_packet(packet_list_t *l) {
+    if (l->count == l->cap) {
+        l->cap = l->cap ? l->cap * 2 : 1024;
+        l->items = realloc(l->items, l->cap * sizeof(*l->items));
+        if (!l->items) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    sx_packet_t *p = &l->items[l->count++];
+    memset(p, 0, sizeof(*p));
+    return p;
+}
+
+// Lê os registros de captura de um arquivo do fluxo USB (o resto é ignorado).
+// O instante de cada pacote é o rx_time_us sem a volta dos 32 bits, relativo
+// ao primeiro pacote da lista.
+static bool load_capture(const char *path, packet_list_t *l, unsigned long *skipped) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    static uint8_t frame[MAX_FRAME], rec[MAX_FRAME];
+    size_t len = 0;
+    int c, overflow = 0;
+    uint64_t base = l->count ? l->items[l->count - 1].at_us + 1000000 : 0; // arquivos seguidos, 1 s de intervalo
+    uint64_t rx_us = 0;
+    uint32_t last_rx = 0;
+    bool first = true;
+    while ((c = fgetc(f)) != EOF) {
+        if (c != 0) {
+            if (len < sizeof(frame)) frame[len++] = (uint8_t)c;
+            else overflow = 1;
+            continue;
+        }
+        size_t n = (len && !overflow) ? cobs_decode(frame, len, rec) : 0;
+        len = 0;
+        overflow = 0;
+        if (n == 0) continue;
+
+        lora_stream_capture_t h;
+        const uint8_t *fifo;
+        n = lora_stream_check(rec, n);
+        if (n == 0 || !lora_stream_parse_capture(rec, n, &h, &fifo)) {
+            (*skipped)++;
+            continue;
+        }
+        if (!first) rx_us += (uint32_t)(h.rx_time_us - last_rx);
+        first = false;
+        last_rx = h.rx_time_us;
+
+        sx_packet_t *p = push_packet(l);
+        p->at_us = base + rx_us;
+        p->irq_flags = h.irq_flags;
+        memcpy(p->regs, h.regs, sizeof(p->regs));
+        p->len = h.len;
+        memcpy(p->fifo, fifo, h.len);
+    }
+    fclose(f);
+    return true;
+}
+
+// Amostras tipadas de vários nós com RxDone|ValidHeader, RSSI -80 dBm e SNR 7.5 dB
+static void make_synthetic(packet_list_t *l, unsigned long n, unsigned nodes, unsigned interval_ms) {
+    for (unsigned long i = 0; i < n; i++) {
+        unsigned node = 1 + (unsigned)(i % nodes);
+        lora_sample_t s = {
+            .temperatura = (int16_t)(2000 + (i * 7) % 1000),
+            .umidade = (int16_t)(5000 + (i * 13) % 3000),
+            .timestamp_ms = (uint32_t)(i * interval_ms),
+            .node_id = (uint8_t)node,
+            .seq = (uint8_t)(i / nodes),
+        };
+        sx_packet_t *p = push_packet(l);
+        p->at_us = (uint64_t)i * interval_ms * 1000;
+        p->irq_flags = 0x50;
+        p->len = lora_proto_sample_frame(&s, p->fifo);
+        p->regs[0x13 - LORA_CAPTURE_FIRST_REG] = p->len;      // RX_NB_BYTES
+        p->regs[0x19 - LORA_CAPTURE_FIRST_REG] = 30;          // SNR * 4
+        p->regs[0x1A - LORA_CAPTURE_FIRST_REG] = 157 - 80;    // RSSI + 157
+    }
+}
+
+// Grava a lista como registros de captura, como o receptor os enviaria
+static bool save_capture(const char *path, const packet_list_t *l) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    static uint8_t rec[LORA_STREAM_MAX_RECORD], frame[MAX_FRAME + 2];
+    for (size_t i = 0; i < l->count; i++) {
+        const sx_packet_t *p = &l->items[i];
+        lora_stream_capture_t h = {
+            .type = LORA_STREAM_TYPE_CAPTURE,
+            .irq_flags = p->irq_flags,
+            .seq = (uint16_t)i,
+            .rx_time_us = (uint32_t)p->at_us,
+            .len = p->len,
+        };
+        memcpy(h.regs, p->regs, sizeof(h.regs));
+        size_t n = sizeof(h);
+        memcpy(rec, &h, n);
+        memcpy(rec + n, p->fifo, p->len);
+        n += p->len;
+        uint16_t crc = crc16_ccitt(rec, n);
+        rec[n++] = (uint8_t)crc;
+        rec[n++] = (uint8_t)(crc >> 8);
+        frame[0] = 0x00;
+        size_t out = 1 + cobs_encode(rec, n, frame + 1);
+        frame[out++] = 0x00;
+        fwrite(frame, 1, out, f);
+    }
+    return fclose(f) == 0;
+}
+
+static double seconds_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--rapido] [--repetir N] [--comandos \"bin,captura\"] [--sintetico N] [--nos N]\n"
+                    "       [--intervalo-ms M] [--salvar arquivo] [--tela] [captura...]\n", prog);
+}
+
+// Imagem visível do display emulado, um caractere por pixel
+static void print_display(const ssd1306_sim_t *d) {
+    for (uint32_t y = 0; y < SSD1306_SIM_ROWS; y++) {
+        char row[SSD1306_SIM_COLS + 1];
+        for (uint32_t x = 0; x < SSD1306_SIM_COLS; x++) row[x] = ssd1306_sim_pixel(d, x, y) ? '#' : '.';
+        row[SSD1306_SIM_COLS] = '\0';
+        fprintf(stderr, "%s\n", row);
+    }
+}
+
+int main(int argc, char **argv) {
+    bool fast = false, show_display = false;
+    unsigned repeat = 1, nodes = 4, interval_ms = 2000;
+    unsigned long synthetic = 0;
+    const char *save_path = NULL;
+    char *commands = NULL;
+    static const struct option opts[] = {
+        { "rapido",       no_argument,       NULL, 'r' },
+        { "repetir",      required_argument, NULL, 'R' },
+        { "comandos",     required_argument, NULL, 'c' },
+        { "sintetico",    required_argument, NULL, 's' },
+        { "nos",          required_argument, NULL, 'n' },
+        { "intervalo-ms", required_argument, NULL, 'i' },
+        { "salvar",       required_argument, NULL, 'o' },
+        { "tela",         no_argument,       NULL, 'T' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "rR:c:s:n:i:o:T", opts, NULL)) != -1) {
+        switch (c) {
+        case 'r': fast = true; break;
+        case 'R': repeat = (unsigned)atoi(optarg); break;
+        case 'c': commands = optarg; break;
+        case 's': synthetic = strtoul(optarg, NULL, 10); break;
+        case 'n': nodes = (unsigned)atoi(optarg); break;
+        case 'i': interval_ms = (unsigned)atoi(optarg); break;
+        case 'o': save_path = optarg; break;
+        case 'T': show_display = true; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (repeat == 0 || nodes == 0 || nodes > 255 || (synthetic == 0 && optind >= argc)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    packet_list_t packets = { 0 };
+    unsigned long skipped = 0;
+    if (synthetic) make_synthetic(&packets, synthetic, nodes, interval_ms);
+    for (int i = optind; i < argc; i++) {
+        if (!load_capture(argv[i], &packets, &skipped)) {
+            perror(argv[i]);
+            return 1;
+        }
+    }
+    if (packets.count == 0) {
+        fprintf(stderr, "rx_replay: nenhum registro de captura (%lu outros registros)\n", skipped);
+        return 1;
+    }
+    if (save_path && !save_capture(save_path, &packets)) {
+        perror(save_path);
+        return 1;
+    }
+
+    // Repetições seguidas, com o mesmo espaçamento do fim ao começo
+    size_t one = packets.count;
+    uint64_t span = packets.items[one - 1].at_us + (one > 1 ? packets.items[1].at_us - packets.items[0].at_us : 1000);
+    for (unsigned r = 1; r < repeat; r++) {
+        for (size_t i = 0; i < one; i++) {
+            sx_packet_t *p = push_packet(&packets);
+            *p = packets.items[i];
+            p->at_us += r * span;
+        }
+    }
+
+    // Comandos do console, um por linha
+    if (commands) {
+        for (char *p = commands; *p; p++) {
+            if (*p == ',') *p = '\n';
+        }
+    }
+    char console[256];
+    snprintf(console, sizeof(console), "%s\n", commands ? commands : "");
+
+    sx1276_init(packets.items, packets.count, fast);
+    mock_hal_init(!fast, commands ? console : NULL);
+    double t0 = seconds_now();
+    bool ok = mock_hal_run(bitdoglab_main);
+    double wall = seconds_now() - t0;
+
+    sx_stats_t sx;
+    mock_stats_t hal;
+    sx1276_get_stats(&sx);
+    mock_hal_get_stats(&hal);
+    double cpu = wall - hal.sleep_ns * 1e-9;
+    double n = sx.consumed ? (double)sx.consumed : 1.0;
+    fprintf(stderr, "rx_replay: %zu pacotes (%zu x %u), %llu entregues ao radio, %llu lidos pelo firmware, "
+                    "%llu sobrescritos, %llu adiados (radio fora de RX), %lu registros ignorados\n",
+            packets.count, one, repeat, (unsigned long long)sx.injected, (unsigned long long)sx.consumed,
+            (unsigned long long)sx.overwritten, (unsigned long long)sx.deferred, skipped);
+    fprintf(stderr, "tempo: %.1f s virtuais em %.3f s reais (%s), CPU do firmware %.3f s\n",
+            mock_hal_now_us() / 1e6, wall, fast ? "rapido" : "ritmo original", cpu);
+    fprintf(stderr, "vazao: %.0f pacotes/s, %.2f us de CPU por pacote\n", sx.consumed / (cpu > 0 ? cpu : 1e-9),
+            cpu * 1e6 / n);
+    fprintf(stderr, "por pacote: %.1f transacoes SPI (%.1f bytes), %.0f bytes I2C, %.1f bytes USB; "
+                    "%llu TX do firmware, %llu paginas e %llu setores de flash\n",
+            sx.spi_transactions / n, sx.spi_bytes / n, hal.i2c_bytes / n, hal.usb_bytes / n,
+            (unsigned long long)sx.tx_packets, (unsigned long long)hal.flash_programs,
+            (unsigned long long)hal.flash_erases);
+    const ssd1306_sim_t *display = mock_hal_display();
+    fprintf(stderr, "display: %u transferencias I2C (%u bytes de comando, %u de dados), start line %u, "
+                    "%u trocas de start line, %u transferencias invalidas, %u comandos desconhecidos, "
+                    "%u bytes escritos com rolagem ativa\n",
+            display->transfers, display->cmd_bytes, display->data_bytes, display->start_line,
+            display->start_line_changes, display->bad_transfers, display->unknown_cmds,
+            display->writes_while_scrolling);
+    if (show_display) print_display(display);
+    if (!ok) fprintf(stderr, "rx_replay: o firmware parou de receber antes do fim da captura\n");
+    free(packets.items);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+// ssd1306_sim.c
+
+#include <string.h>
+
+#include "ssd1306_sim.h"
+
+void ssd1306_sim_init(ssd1306_sim_t *d) {
+    memset(d, 0, sizeof(*d));
+    d->mux = SSD1306_SIM_ROWS - 1;
+    d->mode = 2;
+    d->col_hi = SSD1306_SIM_COLS - 1;
+    d->page_hi = SSD1306_SIM_PAGES - 1;
+}
+
+// Parâmetros que cada comando espera depois do primeiro byte
+static uint8_t params_of(uint8_t c) {
+    switch (c) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22: case 0xA3:
+        return 2;
+    case 0x29: case 0x2A:
+        return 5;
+    case 0x26: case 0x27:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+// Opcodes de um byte (sem contar parâmetros) que o controlador reconhece
+static bool known_command(uint8_t c) {
+    // Coluna, endereçamento, start line e página em modo página
+    if (c <= 0x22 || (c >= 0x40 && c <= 0x7F) || (c >= 0xB0 && c <= 0xB7)) return true;
+    switch (c) {
+    case 0x26: case 0x27: case 0x29: case 0x2A: case 0x2E: case 0x2F:
+    case 0x81: case 0x8D: case 0xA0: case 0xA1: case 0xA3: case 0xA4: case 0xA5:
+    case 0xA6: case 0xA7: case 0xA8: case 0xAE: case 0xAF: case 0xC0: case 0xC8:
+    case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB: case 0xE3:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void run_command(ssd1306_sim_t *d) {
+    const uint8_t *c = d->cmd;
+    if (c[0] <= 0x0F) {
+        d->col = (uint8_t)((d->col & 0xF0) | c[0]);        // modo página: nibble baixo da coluna
+    } else if (c[0] <= 0x1F) {
+        d->col = (uint8_t)((d->col & 0x0F) | (c[0] & 0x07) << 4);
+    } else if (c[0] >= 0x40 && c[0] <= 0x7F) {
+        d->start_line = c[0] & 0x3F;
+        d->start_line_changes++;
+    } else if (c[0] >= 0xB0 && c[0] <= 0xB7) {
+        d->page = c[0] & 0x07;
+    } else {
+        switch (c[0]) {
+        case 0x20: d->mode = c[1] & 0x03; break;
+        case 0x21:
+            d->col_lo = c[1] & 0x7F;
+            d->col_hi = c[2] & 0x7F;
+            d->col = d->col_lo;
+            break;
+        case 0x22:
+            d->page_lo = c[1] & 0x07;
+            d->page_hi = c[2] & 0x07;
+            d->page = d->page_lo;
+            break;
+        case 0xA8: d->mux = c[1] & 0x3F; break;
+        case 0xD3: d->offset = c[1] & 0x3F; break;
+        case 0xA6: case 0xA7: d->inverted = c[0] & 1; break;
+        case 0xAE: case 0xAF: d->on = c[0] & 1; break;
+        case 0x26: case 0x27:
+            d->scroll_cmd = c[0];
+            d->scroll_vertical = 0;
+            break;
+        case 0x29: case 0x2A:
+            d->scroll_cmd = c[0];
+            d->scroll_vertical = c[5] & 0x3F;
+            break;
+        case 0x2E: d->scrolling = false; break;
+        case 0x2F:
+            d->scrolling = true;
+            d->scroll_starts++;
+            break;
+        default: // contraste, remapeamentos, clock etc.: não mudam a imagem em coordenadas do buffer
+            if (!known_command(c[0])) d->unknown_cmds++;
+            break;
+        }
+    }
+}
+
+static void command_byte(ssd1306_sim_t *d, uint8_t b) {
+    d->cmd_bytes++;
+    if (d->cmd_len == 0) d->cmd_need = params_of(b);
+    d->cmd[d->cmd_len++] = b;
+    if (d->cmd_len > d->cmd_need) {
+        run_command(d);
+        d->cmd_len = 0;
+    }
+}
+
+static void data_byte(ssd1306_sim_t *d, uint8_t b) {
+    d->data_bytes++;
+    if (d->scrolling) d->writes_while_scrolling++;
+    d->ram[d->page & 0x07][d->col & 0x7F] = b;
+    switch (d->mode) {
+    case 0: // horizontal: coluna, depois página, dentro da janela
+        if (d->col++ >= d->col_hi) {
+            d->col = d->col_lo;
+            if (d->page++ >= d->page_hi) d->page = d->page_lo;
+        }
+        break;
+    case 1: // vertical: página, depois coluna
+        if (d->page++ >= d->page_hi) {
+            d->page = d->page_lo;
+            if (d->col++ >= d->col_hi) d->col = d->col_lo;
+        }
+        break;
+    default: // página: só a coluna anda (o driver não usa este modo)
+        d->col = (uint8_t)((d->col + 1) & 0x7F);
+        break;
+    }
+}
+
+void ssd1306_sim_write(ssd1306_sim_t *d, const uint8_t *src, size_t len) {
+    d->transfers++;
+    size_t i = 0;
+    while (i < len) {
+        uint8_t control = src[i++];
+        if (control & 0x3F) {
+            d->bad_transfers++;
+            return;
+        }
+        bool data = control & 0x40;
+        // Co = 1: só o próximo byte é deste tipo, depois vem outro byte de controle
+        size_t end = (control & 0x80) ? (i + 1 < len ? i + 1 : len) : len;
+        for (; i < end; i++) {
+            if (data) data_byte(d, src[i]);
+            else command_byte(d, src[i]);
+        }
+    }
+}
+
+bool ssd1306_sim_pixel(const ssd1306_sim_t *d, uint32_t x, uint32_t y) {
+    if (!d->on || x >= SSD1306_SIM_COLS || y > d->mux) return false;
+    uint32_t row = (y + d->start_line + d->offset) % SSD1306_SIM_ROWS;
+    bool lit = (d->ram[row >> 3][x] >> (row & 7)) & 1;
+    return lit != d->inverted;
+}
+
+void ssd1306_sim_visible(const ssd1306_sim_t *d, uint8_t *out, uint32_t width, uint32_t pages) {
+    memset(out, 0, (size_t)width * pages);
+    for (uint32_t y = 0; y < pages * 8; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            if (ssd1306_sim_pixel(d, x, y)) out[x + width * (y >> 3)] |= (uint8_t)(1u << (y & 7));
+        }
+    }
+}
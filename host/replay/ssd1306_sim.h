@@ -0,0 +1,68 @@
+// ssd1306_sim.h
+//
+// SSD1306 emulado no host: recebe as transferências I2C do driver
+// (ssd1306.c) e mantém a RAM de 128x64 como o controlador, com os modos de
+// endereçamento, as janelas de coluna e página, a start line e o offset. A
+// imagem visível é a RAM vista a partir da start line, nas coordenadas do
+// framebuffer do driver (o remapeamento de segmentos e de COM só gira a tela
+// no vidro, igual para tudo). A rolagem contínua só é registrada: a imagem
+// dela depende do tempo, e escrever na RAM com ela ativa é contado como erro,
+// como proíbe o datasheet.
+
+#ifndef SSD1306_SIM_H_
+#define SSD1306_SIM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SSD1306_SIM_COLS  128
+#define SSD1306_SIM_PAGES 8
+#define SSD1306_SIM_ROWS  (SSD1306_SIM_PAGES * 8)
+
+typedef struct {
+    uint8_t ram[SSD1306_SIM_PAGES][SSD1306_SIM_COLS];
+    uint8_t start_line, offset, mux;
+    uint8_t mode;                       // 0 horizontal, 1 vertical, 2 página
+    uint8_t col, page;                  // ponteiro da RAM
+    uint8_t col_lo, col_hi, page_lo, page_hi;
+    bool on, inverted;
+    bool scrolling;                     // rolagem contínua ativa (0x2F)
+    uint8_t scroll_cmd;                 // última configuração da rolagem (0x26, 0x27, 0x29 ou 0x2A)
+    uint8_t scroll_vertical;            // deslocamento vertical por passo (0x29/0x2A)
+    // comando em montagem (os parâmetros chegam nos bytes seguintes)
+    uint8_t cmd[8];
+    uint8_t cmd_len, cmd_need;
+    // contadores
+    uint32_t transfers;
+    uint32_t cmd_bytes, data_bytes;
+    uint32_t start_line_changes;
+    uint32_t scroll_starts;
+    uint32_t bad_transfers;             // byte de controle desconhecido
+    uint32_t unknown_cmds;              // opcodes que o SSD1306 não tem
+    uint32_t writes_while_scrolling;    // bytes de RAM escritos com a rolagem ativa
+} ssd1306_sim_t;
+
+/**
+ * @brief Estado depois do reset do controlador (RAM zerada, display desligado).
+ */
+void ssd1306_sim_init(ssd1306_sim_t *d);
+
+/**
+ * @brief Uma transferência I2C para o display: byte de controle (0x00
+ * comandos, 0x40 dados) e o resto.
+ */
+void ssd1306_sim_write(ssd1306_sim_t *d, const uint8_t *src, size_t len);
+
+/**
+ * @brief Pixel aceso na linha y da tela (0 = topo), coluna x.
+ */
+bool ssd1306_sim_pixel(const ssd1306_sim_t *d, uint32_t x, uint32_t y);
+
+/**
+ * @brief Imagem visível no formato do framebuffer do driver: pages páginas
+ * de width bytes, bit y & 7 da página y >> 3.
+ */
+void ssd1306_sim_visible(const ssd1306_sim_t *d, uint8_t *out, uint32_t width, uint32_t pages);
+
+#endif // SSD1306_SIM_H_
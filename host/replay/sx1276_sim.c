@@ -0,0 +1,265 @@
+// sx1276_sim.c
+
+#include <string.h>
+#include "sx1276_sim.h"
+
+// Registradores usados pelo driver (mesmos nomes de lora_RFM95.c)
+#define REG_FIFO                 0x00
+#define REG_OP_MODE              0x01
+#define REG_FIFO_ADDR_PTR        0x0D
+#define REG_FIFO_RX_CURRENT_ADDR 0x10
+#define REG_IRQ_FLAGS            0x12
+#define REG_MODEM_CONFIG_1       0x1D
+#define REG_MODEM_CONFIG_2       0x1E
+#define REG_SYMB_TIMEOUT_LSB     0x1F
+#define REG_PREAMBLE_MSB         0x20
+#define REG_PREAMBLE_LSB         0x21
+#define REG_PAYLOAD_LENGTH       0x22
+#define REG_MODEM_CONFIG_3       0x26
+#define REG_DIO_MAPPING_1        0x40
+#define REG_VERSION              0x42
+
+#define MODE_MASK                0x07
+#define MODE_SLEEP               0x00
+#define MODE_STDBY               0x01
+#define MODE_TX                  0x03
+#define MODE_RX_CONTINUOUS       0x05
+#define MODE_RX_SINGLE           0x06
+
+#define IRQ_TX_DONE_MASK         0x08
+#define IRQ_RX_TIMEOUT_MASK      0x80
+
+// DIO0 (bits 7:6 de REG_DIO_MAPPING_1): 00 = RxDone, 01 = TxDone
+#define DIO0_MAP(r)              ((r) >> 6)
+
+static struct {
+    uint8_t regs[0x80];
+    uint8_t fifo[256];
+    const sx_packet_t *packets;
+    size_t count, next;
+    uint64_t base_us;           // instante do início da reprodução
+    bool started;
+    uint64_t now_us;            // último instante visto em sx1276_advance
+    uint64_t tx_done_at;
+    uint64_t rx_timeout_at;
+    bool rx_unread;             // pacote no FIFO ainda não lido
+    bool next_deferred;         // packets[next] já contado como adiado
+    bool hold_until_read;       // o próximo pacote espera o driver ler o anterior
+    uint64_t last_inject_us;
+    // transação SPI em andamento
+    bool selected, have_addr, write;
+    uint8_t addr;
+    sx_stats_t stats;
+} sx;
+
+static uint8_t mode(void) {
+    return sx.regs[REG_OP_MODE] & MODE_MASK;
+}
+
+static bool receiving(void) {
+    return mode() == MODE_RX_CONTINUOUS || mode() == MODE_RX_SINGLE;
+}
+
+// Duração do símbolo em ns, pelo SF e pela BW configurados
+static uint64_t symbol_ns(void) {
+    static const uint32_t bw_hz[10] = { 7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000 };
+    unsigned bw = sx.regs[REG_MODEM_CONFIG_1] >> 4;
+    unsigned sf = sx.regs[REG_MODEM_CONFIG_2] >> 4;
+    if (bw > 9) bw = 9;
+    if (sf < 6) sf = 6;
+    return (1000000000ull << sf) / bw_hz[bw];
+}
+
+// Tempo no ar de um pacote de len bytes (seção 4.1.1.7 do datasheet)
+static uint64_t airtime_us(uint8_t len) {
+    int sf = sx.regs[REG_MODEM_CONFIG_2] >> 4;
+    int cr = (sx.regs[REG_MODEM_CONFIG_1] >> 1) & 0x07;
+    int implicit = sx.regs[REG_MODEM_CONFIG_1] & 0x01;
+    int crc = (sx.regs[REG_MODEM_CONFIG_2] >> 2) & 0x01;
+    int de = (sx.regs[REG_MODEM_CONFIG_3] >> 3) & 0x01;
+    unsigned preamble = (unsigned)sx.regs[REG_PREAMBLE_MSB] << 8 | sx.regs[REG_PREAMBLE_LSB];
+
+    int num = 8 * len - 4 * sf + 28 + 16 * crc - 20 * implicit;
+    int den = 4 * (sf - 2 * de);
+    int payload_symbols = 8 + (num > 0 ? (num + den - 1) / den * (cr + 4) : 0);
+    // (preâmbulo + 4.25 + símbolos do payload) * Tsym
+    return ((preamble * 4 + 17 + payload_symbols * 4ull) * symbol_ns()) / 4000;
+}
+
+static void set_mode(uint8_t value) {
+    sx.regs[REG_OP_MODE] = value;
+    sx.tx_done_at = SX_NEVER;
+    sx.rx_timeout_at = SX_NEVER;
+    switch (mode()) {
+    case MODE_TX:
+        sx.tx_done_at = sx.now_us + airtime_us(sx.regs[REG_PAYLOAD_LENGTH]);
+        sx.stats.tx_packets++;
+        break;
+    case MODE_RX_SINGLE: {
+        unsigned symbols = (unsigned)(sx.regs[REG_MODEM_CONFIG_2] & 0x03) << 8 | sx.regs[REG_SYMB_TIMEOUT_LSB];
+        sx.rx_timeout_at = sx.now_us + symbols * symbol_ns() / 1000;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void write_reg(uint8_t addr, uint8_t value) {
+    switch (addr) {
+    case REG_FIFO:
+        sx.fifo[sx.regs[REG_FIFO_ADDR_PTR]++] = value;
+        break;
+    case REG_OP_MODE:
+        set_mode(value);
+        break;
+    case REG_IRQ_FLAGS:
+        sx.regs[REG_IRQ_FLAGS] &= (uint8_t)~value; // escrever 1 limpa a flag
+        break;
+    case REG_VERSION:
+        break;
+    default:
+        sx.regs[addr] = value;
+        break;
+    }
+}
+
+static uint8_t read_reg(uint8_t addr) {
+    if (addr != REG_FIFO) return sx.regs[addr];
+    if (sx.rx_unread) {
+        sx.rx_unread = false;
+        sx.stats.consumed++;
+    }
+    return sx.fifo[sx.regs[REG_FIFO_ADDR_PTR]++];
+}
+
+// Registradores de estado da janela capturada; os de configuração no meio
+// dela (ModemConfig, preâmbulo, ...) continuam os escritos pelo driver
+static bool capture_status_reg(uint8_t reg) {
+    return reg == REG_FIFO_RX_CURRENT_ADDR || (reg >= 0x13 && reg <= 0x1C) || reg == 0x25 ||
+           (reg >= 0x28 && reg <= 0x2A);
+}
+
+// Restaura a recepção gravada: registradores de estado, FIFO e flags
+static void inject(const sx_packet_t *p) {
+    for (unsigned i = 0; i < LORA_CAPTURE_REGS; i++) {
+        uint8_t reg = (uint8_t)(LORA_CAPTURE_FIRST_REG + i);
+        if (capture_status_reg(reg)) sx.regs[reg] = p->regs[i];
+    }
+    uint8_t at = sx.regs[REG_FIFO_RX_CURRENT_ADDR];
+    for (unsigned i = 0; i < p->len; i++) sx.fifo[(uint8_t)(at + i)] = p->fifo[i];
+    sx.regs[REG_IRQ_FLAGS] |= p->irq_flags;
+
+    if (sx.rx_unread) sx.stats.overwritten++;
+    sx.rx_unread = true;
+    sx.last_inject_us = sx.now_us;
+    sx.stats.injected++;
+    if (mode() == MODE_RX_SINGLE) set_mode((uint8_t)((sx.regs[REG_OP_MODE] & ~MODE_MASK) | MODE_STDBY));
+    if (DIO0_MAP(sx.regs[REG_DIO_MAPPING_1]) == 0) mock_dio0_edge();
+}
+
+void sx1276_init(const sx_packet_t *packets, size_t count, bool hold_until_read) {
+    memset(&sx, 0, sizeof(sx));
+    sx.packets = packets;
+    sx.count = count;
+    sx.hold_until_read = hold_until_read;
+    sx.tx_done_at = SX_NEVER;
+    sx.rx_timeout_at = SX_NEVER;
+    // Valores de reset usados pelo cálculo do tempo no ar
+    sx.regs[REG_MODEM_CONFIG_1] = 0x72;
+    sx.regs[REG_MODEM_CONFIG_2] = 0x70;
+    sx.regs[REG_PREAMBLE_LSB] = 0x08;
+    sx.regs[REG_VERSION] = 0x12;
+}
+
+void sx1276_start(uint64_t now_us) {
+    sx.base_us = now_us;
+    sx.started = true;
+}
+
+bool sx1276_started(void) {
+    return sx.started;
+}
+
+bool sx1276_finished(void) {
+    return sx.next == sx.count && !sx.rx_unread;
+}
+
+// Um pacote atrasado (adiado pelo TX, ou vencido junto com o anterior)
+// espera o anterior ser lido; só um pacote que chega de fato depois do
+// anterior ainda não lido o sobrescreve
+static bool packet_ready(uint64_t at) {
+    return !(sx.rx_unread && (sx.hold_until_read || at <= sx.last_inject_us));
+}
+
+uint64_t sx1276_next_event(void) {
+    uint64_t t = sx.tx_done_at < sx.rx_timeout_at ? sx.tx_done_at : sx.rx_timeout_at;
+    // Fora de RX o próximo pacote espera a volta ao RX, que vem de outro evento
+    if (sx.started && sx.next < sx.count && receiving()) {
+        uint64_t at = sx.base_us + sx.packets[sx.next].at_us;
+        if (packet_ready(at)) {
+            if (at < sx.now_us) at = sx.now_us;
+            if (at < t) t = at;
+        }
+    }
+    return t;
+}
+
+void sx1276_advance(uint64_t now_us) {
+    sx.now_us = now_us;
+    if (sx.tx_done_at <= now_us) {
+        sx.tx_done_at = SX_NEVER;
+        sx.regs[REG_IRQ_FLAGS] |= IRQ_TX_DONE_MASK;
+        set_mode((uint8_t)((sx.regs[REG_OP_MODE] & ~MODE_MASK) | MODE_STDBY));
+        if (DIO0_MAP(sx.regs[REG_DIO_MAPPING_1]) == 1) mock_dio0_edge();
+    }
+    if (sx.rx_timeout_at <= now_us) {
+        sx.rx_timeout_at = SX_NEVER;
+        sx.regs[REG_IRQ_FLAGS] |= IRQ_RX_TIMEOUT_MASK; // vai para o DIO1, não ligado
+        set_mode((uint8_t)((sx.regs[REG_OP_MODE] & ~MODE_MASK) | MODE_STDBY));
+    }
+    while (sx.started && sx.next < sx.count && sx.base_us + sx.packets[sx.next].at_us <= now_us) {
+        if (!receiving()) {
+            if (!sx.next_deferred) sx.stats.deferred++;
+            sx.next_deferred = true;
+            break;
+        }
+        if (!packet_ready(sx.base_us + sx.packets[sx.next].at_us)) break;
+        sx.next_deferred = false;
+        inject(&sx.packets[sx.next++]);
+        if (!receiving()) break; // RX single termina no primeiro pacote
+    }
+}
+
+void sx1276_select(bool active) {
+    if (active && !sx.selected) {
+        sx.have_addr = false;
+        sx.stats.spi_transactions++;
+    }
+    sx.selected = active;
+}
+
+uint8_t sx1276_transfer(uint8_t mosi) {
+    if (!sx.selected) return 0;
+    sx.stats.spi_bytes++;
+    if (!sx.have_addr) {
+        sx.have_addr = true;
+        sx.write = mosi & 0x80;
+        sx.addr = mosi & 0x7F;
+        return 0;
+    }
+    // Em modo LoRa o endereço avança a cada byte, exceto no FIFO
+    uint8_t miso = 0;
+    if (sx.write) write_reg(sx.addr, mosi);
+    else miso = read_reg(sx.addr);
+    if (sx.addr != REG_FIFO) sx.addr = (sx.addr + 1) & 0x7F;
+    return miso;
+}
+
+uint32_t sx1276_symbol_us(void) {
+    return (uint32_t)(symbol_ns() / 1000);
+}
+
+void sx1276_get_stats(sx_stats_t *out) {
+    *out = sx.stats;
+}
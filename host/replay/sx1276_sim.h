@@ -0,0 +1,67 @@
+// sx1276_sim.h
+//
+// SX1276 emulado no nível de registradores para o host/replay: o driver
+// lora_RFM95.c conversa com ele pelas mesmas transações SPI do hardware. Os
+// pacotes de uma captura (LORA_STREAM_TYPE_CAPTURE) chegam nos instantes
+// gravados: a rajada de registradores e o FIFO são restaurados como estavam,
+// as flags de IRQ sobem e o DIO0 dispara se estiver mapeado para RxDone.
+// O TxDone sobe depois do tempo no ar calculado pela modulação configurada.
+
+#ifndef SX1276_SIM_H_
+#define SX1276_SIM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lora_stream.h"
+
+#define SX_NEVER UINT64_MAX
+
+// Um pacote a entregar ao driver
+typedef struct {
+    uint64_t at_us;                      // chegada, relativa ao início da reprodução
+    uint8_t irq_flags;
+    uint8_t regs[LORA_CAPTURE_REGS];
+    uint8_t len;
+    uint8_t fifo[255];
+} sx_packet_t;
+
+typedef struct {
+    uint64_t injected;      // pacotes colocados no FIFO
+    uint64_t consumed;      // pacotes cujo FIFO o driver leu
+    uint64_t overwritten;   // chegaram antes de o anterior ser lido
+    uint64_t deferred;      // chegaram com o rádio fora de RX (entregues um a um na volta ao RX)
+    uint64_t tx_packets;    // transmissões do firmware (beacons, repasses)
+    uint64_t spi_transactions;
+    uint64_t spi_bytes;
+} sx_stats_t;
+
+// Emulador. Com hold_until_read, um pacote nunca sobrescreve outro ainda não
+// lido (no modo rápido o firmware não gasta tempo virtual, e pacotes com o
+// mesmo instante se sobrescreveriam sem que isso dissesse algo do firmware).
+void sx1276_init(const sx_packet_t *packets, size_t count, bool hold_until_read);
+// Começa a contar os instantes dos pacotes a partir de now_us
+void sx1276_start(uint64_t now_us);
+bool sx1276_started(void);
+// Todos os pacotes foram entregues e lidos
+bool sx1276_finished(void);
+
+// Próximo evento do rádio (chegada, TxDone, RxTimeout), SX_NEVER se nenhum
+uint64_t sx1276_next_event(void);
+// Processa os eventos vencidos até now_us
+void sx1276_advance(uint64_t now_us);
+
+// Transação SPI: chip select e um byte em cada sentido
+void sx1276_select(bool active);
+uint8_t sx1276_transfer(uint8_t mosi);
+
+// Duração do símbolo decodificada de REG_MODEM_CONFIG_1/2 (SF e BW programados)
+uint32_t sx1276_symbol_us(void);
+
+void sx1276_get_stats(sx_stats_t *out);
+
+// Chamado pelo emulador numa borda de subida do DIO0 (implementado em mock_hal.c)
+void mock_dio0_edge(void);
+
+#endif // SX1276_SIM_H_
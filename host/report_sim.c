@@ -0,0 +1,196 @@
+// report_sim.c
+//
+// Passa as amostras de capturas do fluxo binário da BitDogLab (modo "bin" ou
+// comando "captura") pela política de envio por exceção (common/report_policy.h)
+// e informa, por nó, quantos quadros teriam saído e o tempo no ar economizado.
+//
+// Cada nó é simulado em separado, na ordem das amostras e com o timestamp_ms
+// delas (sem sincronismo, vale o RxDone). Cópias da mesma amostra (repetidor,
+// pacote e captura do mesmo RxDone) contam uma vez. O tempo no ar original é
+// o dos quadros como foram recebidos; com a política, cada quadro enviado é um
+// LORA_PAYLOAD_REPORT (LORA_PROTO_SAMPLE_LEN bytes). Também mostra o maior
+// silêncio entre envios e o maior desvio entre a leitura real e o valor que o
+// receptor mantém durante o silêncio (limitado pela banda morta).
+//
+// Uso: report_sim [--banda-temp N] [--banda-umid N] [--heartbeat-s N] [captura...]
+//      (bandas em centésimos; sem captura, lê da entrada padrão)
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cobs.h"
+#include "lora_proto.h"
+#include "lora_stream.h"
+#include "report_policy.h"
+
+#define MAX_FRAME COBS_MAX_ENCODED(LORA_STREAM_MAX_RECORD)
+
+typedef struct {
+    bool seen, have_seq;
+    uint8_t last_seq;
+    report_policy_t policy;
+    uint64_t airtime_us, kept_airtime_us;
+    uint32_t last_sent_ms, max_gap_ms;
+    int max_err_temp, max_err_umid;   // centésimos
+} node_sim_t;
+
+static node_sim_t nodes[256];
+static report_cfg_t cfg;
+static unsigned long samples, copies, records;
+
+// rx_time_us é de 32 bits: desdobrado por arquivo
+static uint32_t last_rx_us;
+static uint64_t rx_ext_us;
+static bool have_rx;
+
+static uint64_t unwrap_rx(uint32_t rx_us) {
+    if (have_rx) rx_ext_us += (uint32_t)(rx_us - last_rx_us);
+    else rx_ext_us = rx_us;
+    have_rx = true;
+    last_rx_us = rx_us;
+    return rx_ext_us;
+}
+
+static void on_frame(const uint8_t *frame, uint8_t len, uint32_t rx_us) {
+    uint64_t rx_ext = unwrap_rx(rx_us);
+
+    lora_relay_hdr_t relay;
+    const uint8_t *inner;
+    uint8_t inner_len;
+    lora_sample_t s;
+    if (!lora_proto_relay_parse(frame, len, &relay, &inner, &inner_len) || !lora_proto_sample(inner, inner_len, &s)) return;
+
+    node_sim_t *n = &nodes[s.node_id];
+    if (n->have_seq && s.seq == n->last_seq) {
+        copies++;
+        return;
+    }
+    n->have_seq = true;
+    n->last_seq = s.seq;
+    if (!n->seen) {
+        report_policy_init(&n->policy, &cfg);
+        n->seen = true;
+    }
+    samples++;
+
+    uint32_t now_ms = s.timestamp_ms ? s.timestamp_ms : (uint32_t)(rx_ext / 1000);
+    n->airtime_us += lora_proto_airtime_us(LORA_PROTO_NODE_PREAMBLE, inner_len);
+
+    // Desvio do valor mantido pelo receptor antes desta amostra
+    if (n->policy.have_last) {
+        int et = abs(s.temperatura - n->policy.last_temp), eu = abs(s.umidade - n->policy.last_umid);
+        report_reason_t why = report_policy_update(&n->policy, s.temperatura, s.umidade, now_ms);
+        if (why == REPORT_SKIP) {
+            if (et > n->max_err_temp) n->max_err_temp = et;
+            if (eu > n->max_err_umid) n->max_err_umid = eu;
+            return;
+        }
+        if (now_ms - n->last_sent_ms > n->max_gap_ms) n->max_gap_ms = now_ms - n->last_sent_ms;
+    } else {
+        report_policy_update(&n->policy, s.temperatura, s.umidade, now_ms);
+    }
+    n->last_sent_ms = now_ms;
+    n->kept_airtime_us += lora_proto_airtime_us(LORA_PROTO_NODE_PREAMBLE, LORA_PROTO_SAMPLE_LEN);
+}
+
+static void handle_record(const uint8_t *enc, size_t len) {
+    uint8_t rec[MAX_FRAME];
+    if (len == 0) return;
+    size_t n = cobs_decode(enc, len, rec);
+    if (n == 0 || (n = lora_stream_check(rec, n)) == 0) return;
+    records++;
+
+    lora_stream_packet_t ph;
+    lora_stream_capture_t ch;
+    const uint8_t *payload;
+    if (lora_stream_parse_packet(rec, n, &ph, &payload)) {
+        if (ph.flags & LORA_STREAM_FLAG_CRC_OK) on_frame(payload, ph.len, ph.rx_time_us);
+    } else if (lora_stream_parse_capture(rec, n, &ch, &payload)) {
+        if (!(ch.irq_flags & 0x20)) on_frame(payload, ch.len, ch.rx_time_us); // PayloadCrcError
+    }
+}
+
+static void read_stream(FILE *in) {
+    uint8_t frame[MAX_FRAME];
+    size_t len = 0;
+    int c, overflow = 0;
+    have_rx = false;
+    while ((c = fgetc(in)) != EOF) {
+        if (c == 0) {
+            if (!overflow) handle_record(frame, len);
+            len = 0;
+            overflow = 0;
+        } else if (len < sizeof(frame)) {
+            frame[len++] = (uint8_t)c;
+        } else {
+            overflow = 1;
+        }
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--banda-temp N] [--banda-umid N] [--heartbeat-s N] [captura...]\n", prog);
+    fprintf(stderr, "  bandas em centesimos (padrao %u e %u), heartbeat em segundos (padrao %u, 0 desliga)\n",
+            REPORT_DEADBAND_TEMP, REPORT_DEADBAND_UMID, REPORT_HEARTBEAT_S);
+}
+
+int main(int argc, char **argv) {
+    cfg = report_default_cfg();
+    static const struct option opts[] = {
+        { "banda-temp", required_argument, NULL, 't' },
+        { "banda-umid", required_argument, NULL, 'u' },
+        { "heartbeat-s", required_argument, NULL, 'b' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "t:u:b:", opts, NULL)) != -1) {
+        switch (c) {
+        case 't': cfg.deadband_temp = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'u': cfg.deadband_umid = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'b': cfg.heartbeat_s = (uint16_t)strtoul(optarg, NULL, 0); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (optind >= argc) read_stream(stdin);
+    for (int i = optind; i < argc; i++) {
+        FILE *f = fopen(argv[i], "rb");
+        if (!f) {
+            perror(argv[i]);
+            return 1;
+        }
+        read_stream(f);
+        fclose(f);
+    }
+    if (samples == 0) {
+        fprintf(stderr, "report_sim: nenhuma amostra encontrada (%lu registros)\n", records);
+        return 1;
+    }
+
+    printf("banda morta T %.2f C, U %.2f %%, heartbeat %u s; %lu amostras, %lu copias ignoradas\n",
+           cfg.deadband_temp / 100.0, cfg.deadband_umid / 100.0, cfg.heartbeat_s, samples, copies);
+    printf("%4s %9s %9s %9s %9s %11s %11s %8s %11s %8s %8s\n", "no", "amostras", "enviadas", "mudanca", "heartbeat",
+           "ar_orig_s", "ar_exc_s", "econ_%", "silencio_s", "err_T_C", "err_U_%");
+    uint64_t total_air = 0, total_kept = 0;
+    unsigned long total_sent = 0;
+    for (int id = 0; id < 256; id++) {
+        const node_sim_t *n = &nodes[id];
+        if (!n->seen) continue;
+        const report_policy_t *p = &n->policy;
+        unsigned long sent = p->readings - p->sent[REPORT_SKIP];
+        printf("%4d %9lu %9lu %9lu %9lu %11.1f %11.1f %8.1f %11.1f %8.2f %8.2f\n", id, (unsigned long)p->readings, sent,
+               (unsigned long)(p->sent[REPORT_FIRST] + p->sent[REPORT_CHANGE]), (unsigned long)p->sent[REPORT_HEARTBEAT],
+               n->airtime_us / 1e6, n->kept_airtime_us / 1e6,
+               100.0 * (1.0 - (double)n->kept_airtime_us / (double)n->airtime_us), n->max_gap_ms / 1000.0,
+               n->max_err_temp / 100.0, n->max_err_umid / 100.0);
+        total_air += n->airtime_us;
+        total_kept += n->kept_airtime_us;
+        total_sent += sent;
+    }
+    printf("total: %lu de %lu amostras enviadas, tempo no ar %.1f s -> %.1f s (economia de %.1f%%)\n", total_sent,
+           samples, total_air / 1e6, total_kept / 1e6, 100.0 * (1.0 - (double)total_kept / (double)total_air));
+    return 0;
+}
@@ -0,0 +1,120 @@
+// stream_decode.c
+//
+// Decodifica o fluxo binário da BitDogLab (comando "bin" no console) em CSV.
+// Lê de um arquivo capturado ou direto da porta serial:
+//   stty -F /dev/ttyACM0 raw && ./stream_decode /dev/ttyACM0
+//
+// Uso: stream_decode [arquivo]   (sem arquivo, lê da entrada padrão)
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cobs.h"
+#include "lora_proto.h"
+#include "lora_stream.h"
+#include "tlog_text.h"
+
+#define MAX_FRAME COBS_MAX_ENCODED(LORA_STREAM_MAX_RECORD)
+
+typedef struct {
+    unsigned long frames, packets, logs, bad_cobs, bad_crc, oversize, lost;
+    int have_seq;
+    uint16_t next_seq;
+} decode_stats_t;
+
+static void print_packet(const lora_stream_packet_t *h, const uint8_t *payload) {
+    printf("%u,%u,%s,%s,%d,%.2f,%d,%u,", h->seq, h->rx_time_us,
+           (h->flags & LORA_STREAM_FLAG_CRC_OK) ? "ok" : "erro",
+           (h->flags & LORA_STREAM_FLAG_DUPLICATE) ? "sim" : "nao",
+           h->rssi_dbm, h->snr_qdb / 4.0, h->freq_error_hz, h->len);
+
+    // Amostra (direta ou repassada, tipada ou antiga): decodifica os campos
+    lora_relay_hdr_t relay;
+    const uint8_t *inner;
+    uint8_t inner_len;
+    lora_sample_t s;
+    if ((h->flags & LORA_STREAM_FLAG_CRC_OK) &&
+        lora_proto_relay_parse(payload, h->len, &relay, &inner, &inner_len) &&
+        lora_proto_sample(inner, inner_len, &s)) {
+        printf("%u,%u,%u,%.2f,%.2f,%u,", s.node_id, s.seq, relay.hops, s.temperatura / 100.0,
+               s.umidade / 100.0, s.timestamp_ms);
+    } else {
+        printf(",,,,,,");
+    }
+    for (unsigned i = 0; i < h->len; i++) printf("%02X", payload[i]);
+    printf("\n");
+}
+
+static void handle_frame(decode_stats_t *st, const uint8_t *enc, size_t len) {
+    uint8_t rec[MAX_FRAME];
+    if (len == 0) return; // delimitadores seguidos
+    st->frames++;
+
+    size_t n = cobs_decode(enc, len, rec);
+    if (n == 0) {
+        st->bad_cobs++;
+        return;
+    }
+    n = lora_stream_check(rec, n);
+    if (n == 0) {
+        st->bad_crc++;
+        return;
+    }
+
+    if (n < 4) return; // curto demais para ter tipo e seq
+    // O seq conta registros de todos os tipos (capturas incluídas)
+    uint16_t seq = (uint16_t)(rec[2] | rec[3] << 8);
+    if (st->have_seq && seq != st->next_seq) st->lost += (uint16_t)(seq - st->next_seq);
+    st->have_seq = 1;
+    st->next_seq = (uint16_t)(seq + 1);
+
+    // Mensagens do log tokenizado vão expandidas para o stderr, fora do CSV
+    lora_stream_log_t lh;
+    uint32_t args[TLOG_MAX_ARGS];
+    if (lora_stream_parse_log(rec, n, &lh, args, TLOG_MAX_ARGS)) {
+        char text[256];
+        tlog_expand(lh.id, args, lh.nargs, text, sizeof(text));
+        fprintf(stderr, "[%u] %s\n", lh.time_us, text);
+        st->logs++;
+        return;
+    }
+
+    lora_stream_packet_t h;
+    const uint8_t *payload;
+    if (!lora_stream_parse_packet(rec, n, &h, &payload)) return; // captura ou tipo desconhecido
+    st->packets++;
+    print_packet(&h, payload);
+}
+
+int main(int argc, char **argv) {
+    FILE *in = stdin;
+    if (argc > 1 && !(in = fopen(argv[1], "rb"))) {
+        perror(argv[1]);
+        return 1;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0); // linhas saem assim que chegam da serial
+
+    decode_stats_t st = { 0 };
+    uint8_t frame[MAX_FRAME];
+    size_t len = 0;
+    int c, overflow = 0;
+
+    printf("seq,rx_time_us,crc,duplicado,rssi_dbm,snr_db,fei_hz,len,node_id,node_seq,saltos,temperatura,umidade,timestamp_ms,payload\n");
+    while ((c = fgetc(in)) != EOF) {
+        if (c == 0) {
+            if (overflow) st.oversize++;
+            else handle_frame(&st, frame, len);
+            len = 0;
+            overflow = 0;
+        } else if (len < sizeof(frame)) {
+            frame[len++] = (uint8_t)c;
+        } else {
+            overflow = 1; // texto solto longo: descarta até o próximo delimitador
+        }
+    }
+
+    fprintf(stderr, "%lu pacotes, %lu mensagens de log; quadros: %lu, COBS invalido %lu, CRC invalido %lu, longos %lu; registros perdidos %lu\n",
+            st.packets, st.logs, st.frames, st.bad_cobs, st.bad_crc, st.oversize, st.lost);
+    return 0;
+}
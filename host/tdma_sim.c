@@ -0,0 +1,213 @@
+// tdma_sim.c
+//
+// Cenário com N nós FPGA (padrão 50) e um receptor BitDogLab. Compara o envio
+// livre atual (cada nó transmite quando o comando send roda, ALOHA puro) com
+// o superquadro TDMA. Usa o timesync.c/tdma.c do FPGA e o tdma_master.c da
+// BitDogLab, então a agenda simulada é a mesma dos firmwares.
+//
+// Uso: tdma_sim [--nodes N] [--superframes S] [--drift-ppm P] [--jitter-us J]
+//               [--loss L] [--seed N]
+
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lora_proto.h"
+#include "tdma.h"
+#include "tdma_master.h"
+#include "timesync.h"
+
+#define MAX_NODES LORA_PROTO_MAX_SLOTS
+#define MAX_TX    (MAX_NODES + 2)
+
+typedef struct {
+    int nodes;
+    int superframes;
+    double drift_ppm;   // drift máximo (cada nó sorteia em [-P, +P])
+    double jitter_us;   // atraso do polling do RxDone no FPGA
+    double loss;        // probabilidade de um nó perder um beacon
+    unsigned seed;
+} sim_config_t;
+
+typedef struct {
+    double drift;        // fator de drift (ppm * 1e-6)
+    double boot_us;      // instante (tempo real) em que o nó ligou
+    timesync_t clock;
+    tdma_t tdma;
+} node_t;
+
+typedef struct {
+    double start, end;
+    int node;            // 0 = beacon, -1 = JOIN
+    int join_node;
+} tx_t;
+
+typedef struct {
+    unsigned long offered, delivered, collided, joins_sent, joins_lost;
+} stats_t;
+
+static double uniform(void) {
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static uint64_t local_clock_us(const node_t *n, double true_us) {
+    return (uint64_t)llround((true_us - n->boot_us) * (1.0 + n->drift));
+}
+
+// Instante real em que o nó acredita estar em net_target (o erro varia devagar)
+static double true_time_for_net(const node_t *n, uint64_t net_target) {
+    uint64_t est;
+    timesync_local_to_net(&n->clock, local_clock_us(n, (double)net_target), &est);
+    return (double)net_target - ((double)est - (double)net_target);
+}
+
+// Marca como colididos os pacotes que se sobrepõem no ar
+static void resolve(tx_t *tx, int count, int *ok) {
+    for (int i = 0; i < count; i++) ok[i] = 1;
+    for (int i = 0; i < count; i++)
+        for (int j = i + 1; j < count; j++)
+            if (tx[i].start < tx[j].end && tx[j].start < tx[i].end) ok[i] = ok[j] = 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--nodes N] [--superframes S] [--drift-ppm P] [--jitter-us J] "
+                    "[--loss L] [--seed N]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    sim_config_t cfg = { 50, 40, 50.0, 500.0, 0.02, 1 };
+
+    static const struct option opts[] = {
+        { "nodes",       required_argument, NULL, 'n' },
+        { "superframes", required_argument, NULL, 'f' },
+        { "drift-ppm",   required_argument, NULL, 'd' },
+        { "jitter-us",   required_argument, NULL, 'j' },
+        { "loss",        required_argument, NULL, 'l' },
+        { "seed",        required_argument, NULL, 's' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "n:f:d:j:l:s:", opts, NULL)) != -1) {
+        switch (c) {
+        case 'n': cfg.nodes = atoi(optarg); break;
+        case 'f': cfg.superframes = atoi(optarg); break;
+        case 'd': cfg.drift_ppm = atof(optarg); break;
+        case 'j': cfg.jitter_us = atof(optarg); break;
+        case 'l': cfg.loss = atof(optarg); break;
+        case 's': cfg.seed = (unsigned)atoi(optarg); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (cfg.nodes < 1 || cfg.nodes > MAX_NODES) {
+        fprintf(stderr, "--nodes deve estar entre 1 e %d\n", MAX_NODES);
+        return 1;
+    }
+    srand(cfg.seed);
+
+    static node_t nodes[MAX_NODES + 1];
+    tdma_master_t master;
+    tdma_master_init(&master, (uint8_t)cfg.nodes);
+
+    const double sample_toa = lora_proto_airtime_us(LORA_PROTO_NODE_PREAMBLE, LORA_PROTO_SAMPLE_LEN);
+    const double join_toa = lora_proto_airtime_us(LORA_PROTO_NODE_PREAMBLE, sizeof(lora_join_t));
+    const double superframe = tdma_master_superframe_us(&master);
+
+    for (int i = 1; i <= cfg.nodes; i++) {
+        nodes[i].drift = (uniform() * 2.0 - 1.0) * cfg.drift_ppm * 1e-6;
+        nodes[i].boot_us = uniform() * 10e6;
+        timesync_init(&nodes[i].clock);
+        tdma_init(&nodes[i].tdma, (uint8_t)i);
+    }
+
+    printf("# %d nos, %d superquadros de %.1f s (slot %.0f ms, amostra no ar %.0f ms)\n",
+           cfg.nodes, cfg.superframes, superframe / 1e6, master.slot_us / 1e3, sample_toa / 1e3);
+    printf("# drift +-%.0f ppm, jitter %.0f us, perda de beacon %.0f%%\n",
+           cfg.drift_ppm, cfg.jitter_us, cfg.loss * 100);
+
+    stats_t aloha = { 0 }, tdma = { 0 }, tdma_steady = { 0 };
+    int all_joined_at = -1;
+    tx_t tx[MAX_TX];
+    int ok[MAX_TX];
+
+    for (int sf = 0; sf < cfg.superframes; sf++) {
+        double t0 = 20e6 + sf * superframe;
+        uint8_t beacon[sizeof(lora_beacon_t) + LORA_PROTO_MAX_SLOTS];
+        size_t beacon_len = tdma_master_build_beacon(&master, (uint64_t)t0, beacon);
+        lora_beacon_t hdr;
+        memcpy(&hdr, beacon, sizeof(hdr));
+        double beacon_toa = lora_proto_airtime_us(LORA_PROTO_PREAMBLE, (uint8_t)beacon_len);
+
+        // Recepção do beacon em cada nó
+        for (int i = 1; i <= cfg.nodes; i++) {
+            if (uniform() < cfg.loss) continue;
+            double seen = t0 + beacon_toa + uniform() * cfg.jitter_us;
+            timesync_on_beacon(&nodes[i].clock, local_clock_us(&nodes[i], seen), (uint64_t)(t0 + beacon_toa));
+            tdma_on_beacon(&nodes[i].tdma, &hdr, beacon + sizeof(hdr));
+        }
+
+        // --- TDMA: uma amostra por nó no próprio slot, nós sem slot disputam o JOIN
+        int count = 0;
+        tx[count++] = (tx_t){ t0, t0 + beacon_toa, 0, 0 };
+        for (int i = 1; i <= cfg.nodes; i++) {
+            node_t *n = &nodes[i];
+            uint64_t now_net, start;
+            if (!n->clock.synced || !n->tdma.have_schedule) continue;
+            timesync_local_to_net(&n->clock, local_clock_us(n, t0), &now_net);
+            uint32_t guard = lora_proto_guard_us((uint32_t)sample_toa);
+            if (tdma_next_slot(&n->tdma, now_net, &start)) {
+                double at = true_time_for_net(n, start + guard);
+                tx[count++] = (tx_t){ at, at + sample_toa, i, 0 };
+            } else if (tdma_next_join(&n->tdma, now_net, (uint32_t)rand() ^ ((uint32_t)rand() << 16), &start)) {
+                double at = true_time_for_net(n, start + lora_proto_guard_us((uint32_t)join_toa));
+                tx[count++] = (tx_t){ at, at + join_toa, -1, i };
+            }
+        }
+        resolve(tx, count, ok);
+        stats_t *st = all_joined_at >= 0 ? &tdma_steady : &tdma;
+        for (int k = 1; k < count; k++) {
+            if (tx[k].node > 0) {
+                st->offered++;
+                if (ok[k]) st->delivered++; else st->collided++;
+            } else {
+                st->joins_sent++;
+                if (ok[k]) tdma_master_on_join(&master, (uint8_t)tx[k].join_node);
+                else st->joins_lost++;
+            }
+        }
+        if (all_joined_at < 0) {
+            int assigned = 0;
+            for (int i = 0; i < master.n_slots; i++) assigned += master.slots[i] != LORA_PROTO_SLOT_FREE;
+            if (assigned == cfg.nodes) all_joined_at = sf + 1;
+        }
+
+        // --- Envio livre: mesma carga (uma amostra por nó por superquadro), instante aleatório
+        count = 0;
+        for (int i = 1; i <= cfg.nodes; i++) {
+            double at = t0 + uniform() * superframe;
+            tx[count++] = (tx_t){ at, at + sample_toa, i, 0 };
+        }
+        resolve(tx, count, ok);
+        for (int k = 0; k < count; k++) {
+            aloha.offered++;
+            if (ok[k]) aloha.delivered++; else aloha.collided++;
+        }
+    }
+
+    double total_s = cfg.superframes * superframe / 1e6;
+    printf("\n%-26s %8s %10s %9s %12s\n", "modo", "enviadas", "entregues", "colisoes", "vazao(pkt/h)");
+    printf("%-26s %8lu %10lu %9lu %12.1f\n", "envio livre (ALOHA)", aloha.offered, aloha.delivered,
+           aloha.collided, aloha.delivered * 3600.0 / total_s);
+    unsigned long td = tdma.delivered + tdma_steady.delivered;
+    printf("%-26s %8lu %10lu %9lu %12.1f\n", "TDMA (total)", tdma.offered + tdma_steady.offered, td,
+           tdma.collided + tdma_steady.collided, td * 3600.0 / total_s);
+    printf("%-26s %8lu %10lu %9lu\n", "TDMA (apos todos entrarem)", tdma_steady.offered, tdma_steady.delivered,
+           tdma_steady.collided);
+    printf("\nJOIN: %lu pedidos, %lu colididos; ", tdma.joins_sent + tdma_steady.joins_sent,
+           tdma.joins_lost + tdma_steady.joins_lost);
+    if (all_joined_at >= 0) printf("todos os nos com slot apos %d superquadros\n", all_joined_at);
+    else printf("nem todos os nos conseguiram slot\n");
+    return 0;
+}
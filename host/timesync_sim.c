@@ -0,0 +1,119 @@
+// timesync_sim.c
+//
+// Simula um nó FPGA disciplinando seu relógio pelos beacons da BitDogLab e
+// mede o erro do tempo de rede estimado. Usa o mesmo timesync.c do firmware.
+//
+// Uso: timesync_sim [--drift-ppm P] [--interval-s S] [--jitter-us J]
+//                   [--duration-s D] [--seed N]
+
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lora_proto.h"
+#include "timesync.h"
+
+typedef struct {
+    double drift_ppm;     // quanto o cristal do nó adianta em relação ao receptor
+    double interval_s;    // período dos beacons
+    double jitter_us;     // atraso máximo entre o RxDone e o polling perceber
+    double duration_s;    // tempo simulado
+    double loss;          // probabilidade de perder um beacon
+    unsigned seed;
+} sim_config_t;
+
+// Relógio local do nó: adianta drift_ppm e começou 'boot_offset' depois do receptor
+static uint64_t local_clock_us(const sim_config_t *cfg, double true_us, double boot_offset_us) {
+    return (uint64_t)llround((true_us - boot_offset_us) * (1.0 + cfg->drift_ppm * 1e-6));
+}
+
+static double uniform(void) {
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--drift-ppm P] [--interval-s S] [--jitter-us J] "
+                    "[--duration-s D] [--loss L] [--seed N]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    sim_config_t cfg = { 40.0, 30.0, 200.0, 3600.0, 0.0, 1 };
+
+    static const struct option opts[] = {
+        { "drift-ppm",  required_argument, NULL, 'd' },
+        { "interval-s", required_argument, NULL, 'i' },
+        { "jitter-us",  required_argument, NULL, 'j' },
+        { "duration-s", required_argument, NULL, 't' },
+        { "loss",       required_argument, NULL, 'l' },
+        { "seed",       required_argument, NULL, 's' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "d:i:j:t:l:s:", opts, NULL)) != -1) {
+        switch (c) {
+        case 'd': cfg.drift_ppm = atof(optarg); break;
+        case 'i': cfg.interval_s = atof(optarg); break;
+        case 'j': cfg.jitter_us = atof(optarg); break;
+        case 't': cfg.duration_s = atof(optarg); break;
+        case 'l': cfg.loss = atof(optarg); break;
+        case 's': cfg.seed = (unsigned)atoi(optarg); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    srand(cfg.seed);
+
+    const double boot_offset_us = 12.345e6;  // nó ligou 12 s depois do receptor
+    const double toa_us = lora_proto_airtime_us(LORA_PROTO_PREAMBLE, sizeof(lora_beacon_t));
+    const double step_us = 100e3;            // amostragem do erro a cada 100 ms
+    const double interval_us = cfg.interval_s * 1e6;
+
+    timesync_t ts;
+    timesync_init(&ts);
+
+    double next_beacon_us = boot_offset_us + 1e6;
+    double max_err = 0, sum_err = 0, sum_sq = 0;
+    unsigned long samples = 0, beacons_sent = 0;
+    int warmup = 2; // ignora o erro até o segundo beacon (sem drift estimado)
+
+    printf("# drift=%.1f ppm intervalo=%.1f s jitter=%.0f us perda=%.0f%% beacon ToA=%.0f ms\n",
+           cfg.drift_ppm, cfg.interval_s, cfg.jitter_us, cfg.loss * 100, toa_us / 1000);
+    printf("# beacon  erro_previsao_us  drift_estimado_ppb\n");
+
+    for (double t = boot_offset_us; t < boot_offset_us + cfg.duration_s * 1e6; t += step_us) {
+        while (next_beacon_us <= t) {
+            beacons_sent++;
+            // Beacon carimbado no início do TX; o nó percebe o RxDone após ToA + jitter
+            double rx_true = next_beacon_us + toa_us;
+            double seen_true = rx_true + uniform() * cfg.jitter_us;
+            if (uniform() >= cfg.loss) {
+                uint64_t net_rx = (uint64_t)llround(next_beacon_us) + (uint64_t)toa_us;
+                timesync_on_beacon(&ts, local_clock_us(&cfg, seen_true, boot_offset_us), net_rx);
+                printf("%7lu  %16ld  %18ld\n", beacons_sent, (long)ts.last_error_us, (long)ts.drift_ppb);
+                if (warmup > 0 && ts.beacons >= 2) warmup--;
+            }
+            next_beacon_us += interval_us;
+        }
+        if (warmup > 0) continue;
+
+        uint64_t net;
+        timesync_local_to_net(&ts, local_clock_us(&cfg, t, boot_offset_us), &net);
+        double err = fabs((double)net - t);
+        if (err > max_err) max_err = err;
+        sum_err += err;
+        sum_sq += err * err;
+        samples++;
+    }
+
+    if (samples == 0) {
+        printf("Sem amostras após a convergência; aumente --duration-s.\n");
+        return 1;
+    }
+    printf("\nErro do tempo de rede (após 2 beacons): medio %.1f us, rms %.1f us, max %.1f us\n",
+           sum_err / samples, sqrt(sum_sq / samples), max_err);
+    // drift_ppb é o quanto o tempo de rede anda a mais que o relógio local
+    printf("Drift real %.0f ppb, estimado %ld ppb\n", (1.0 / (1.0 + cfg.drift_ppm * 1e-6) - 1.0) * 1e9,
+           (long)ts.drift_ppb);
+    return 0;
+}
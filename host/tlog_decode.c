@@ -0,0 +1,113 @@
+// tlog_decode.c
+//
+// Expande o log tokenizado das placas (common/tlog_ring.h): troca cada linha
+// "@L <tempo_us> <id> <args...>" do console da BitDogLab ou do FPGA pelo
+// texto da mensagem, usando a tabela TLOG_MESSAGES compilada nesta
+// ferramenta. As demais linhas passam sem mudança, de modo que o log pode
+// ser lido direto da serial:
+//   stty -F /dev/ttyUSB0 115200 raw && ./tlog_decode --tempo /dev/ttyUSB0
+//
+// Com --tempo cada mensagem leva o instante do ponto de log (segundos desde
+// o boot da placa); --tabela lista os IDs e formatos conhecidos.
+//
+// Uso: tlog_decode [--tempo] [--tabela] [log...]   (sem log, lê da entrada padrão)
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tlog_text.h"
+
+typedef struct {
+    bool with_time;
+    bool have_time;
+    uint32_t last_us;
+    uint64_t ext_us;        // tempo desdobrado (volta dos 32 bits a cada ~71 min)
+    unsigned long messages, unknown;
+} decode_state_t;
+
+static bool decode_line(decode_state_t *st, const char *line) {
+    const char *p = strstr(line, "@L ");
+    if (!p) return false;
+
+    char *end;
+    unsigned long ts = strtoul(p + 3, &end, 16);
+    if (end == p + 3) return false;
+    p = end;
+    unsigned long id = strtoul(p, &end, 10);
+    if (end == p) return false;
+    p = end;
+
+    uint32_t args[TLOG_MAX_ARGS];
+    unsigned nargs = 0;
+    while (nargs < TLOG_MAX_ARGS) {
+        unsigned long v = strtoul(p, &end, 16);
+        if (end == p) break;
+        args[nargs++] = (uint32_t)v;
+        p = end;
+    }
+
+    if (st->have_time) st->ext_us += (uint32_t)((uint32_t)ts - st->last_us);
+    else st->ext_us = (uint32_t)ts;
+    st->have_time = true;
+    st->last_us = (uint32_t)ts;
+    st->messages++;
+    if (id >= TLOG_N_IDS) st->unknown++;
+
+    char text[256];
+    tlog_expand((unsigned)id, args, nargs, text, sizeof(text));
+    if (st->with_time) printf("[%12.6f] %s\n", st->ext_us / 1e6, text);
+    else printf("%s\n", text);
+    return true;
+}
+
+static void decode(decode_state_t *st, FILE *f) {
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        if (!decode_line(st, line)) fputs(line, stdout);
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--tempo] [--tabela] [log...]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    decode_state_t st = { 0 };
+    bool table = false;
+    static const struct option opts[] = {
+        { "tempo",  no_argument, NULL, 't' },
+        { "tabela", no_argument, NULL, 'T' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "tT", opts, NULL)) != -1) {
+        switch (c) {
+        case 't': st.with_time = true; break;
+        case 'T': table = true; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (table) {
+        for (unsigned id = 0; id < TLOG_N_IDS; id++) printf("%u,%s,\"%s\"\n", id, tlog_names[id], tlog_formats[id]);
+        return 0;
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0); // linhas saem assim que chegam da serial
+    if (optind >= argc) decode(&st, stdin);
+    for (int i = optind; i < argc; i++) {
+        FILE *f = fopen(argv[i], "r");
+        if (!f) {
+            perror(argv[i]);
+            return 1;
+        }
+        decode(&st, f);
+        fclose(f);
+    }
+    fprintf(stderr, "%lu mensagens expandidas, %lu com ID desconhecido\n", st.messages, st.unknown);
+    return 0;
+}
@@ -0,0 +1,75 @@
+// tlog_text.h
+//
+// Expansão das mensagens do log tokenizado (common/tlog_ring.h) no host: a
+// tabela de formatos é a mesma TLOG_MESSAGES do firmware, compilada aqui.
+// Usado pelo tlog_decode (linhas "@L") e pelo stream_decode (registros
+// LORA_STREAM_TYPE_LOG).
+
+#ifndef TLOG_TEXT_H_
+#define TLOG_TEXT_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tlog_ring.h"
+
+#define TLOG_FORMAT(id, fmt) fmt,
+static const char *const tlog_formats[TLOG_N_IDS] = { TLOG_MESSAGES(TLOG_FORMAT) };
+#undef TLOG_FORMAT
+
+#define TLOG_NAME(id, fmt) #id,
+static const char *const tlog_names[TLOG_N_IDS] = { TLOG_MESSAGES(TLOG_NAME) };
+#undef TLOG_NAME
+
+/**
+ * @brief Expande uma mensagem em texto. Cada conversão do formato consome um
+ * argumento de 32 bits, com o sinal que a conversão pede; modificadores de
+ * tamanho (l, h) são ignorados. IDs fora da tabela e argumentos faltando
+ * aparecem como "?".
+ */
+static inline void tlog_expand(unsigned id, const uint32_t *args, unsigned nargs, char *out, size_t n) {
+    if (n == 0) return;
+    out[0] = 0;
+    if (id >= TLOG_N_IDS) {
+        size_t k = (size_t)snprintf(out, n, "[LOG] mensagem %u desconhecida:", id);
+        for (unsigned i = 0; i < nargs && k < n; i++) k += (size_t)snprintf(out + k, n - k, " %lx", (unsigned long)args[i]);
+        return;
+    }
+
+    const char *f = tlog_formats[id];
+    size_t k = 0;
+    unsigned a = 0;
+    while (*f && k + 1 < n) {
+        if (*f != '%') {
+            out[k++] = *f++;
+            continue;
+        }
+        if (f[1] == '%') {
+            out[k++] = '%';
+            f += 2;
+            continue;
+        }
+        // Copia flags, largura e precisão; descarta o tamanho
+        char spec[16];
+        size_t s = 0;
+        spec[s++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && s < sizeof(spec) - 3) spec[s++] = *f++;
+        while (*f == 'l' || *f == 'h') f++;
+        char conv = *f ? *f++ : 'd';
+        spec[s++] = conv;
+        spec[s] = 0;
+
+        int w;
+        if (a >= nargs) w = snprintf(out + k, n - k, "?");
+        else if (conv == 'd' || conv == 'i') w = snprintf(out + k, n - k, spec, (int)(int32_t)args[a++]);
+        else if (conv == 'u' || conv == 'x' || conv == 'X' || conv == 'o' || conv == 'c') w = snprintf(out + k, n - k, spec, (unsigned)args[a++]);
+        else w = snprintf(out + k, n - k, "?");
+        if (w < 0) break;
+        k += (size_t)w;
+        if (k >= n) k = n - 1;
+    }
+    out[k] = 0;
+}
+
+#endif // TLOG_TEXT_H_
@@ -0,0 +1,231 @@
+// trace_json.c
+//
+// Converte os despejos do trace (comando "trace" no console da BitDogLab ou
+// do FPGA, firmware compilado com o trace ligado, ver common/trace_ring.h)
+// numa linha do tempo no formato Chrome trace, que abre no Perfetto
+// (ui.perfetto.dev) ou em chrome://tracing. Cada placa vira um processo; os
+// tempos são convertidos de ticks para microssegundos e contados a partir do
+// primeiro evento da placa.
+//
+// O resto do texto capturado é ignorado, e despejos seguidos da mesma placa
+// continuam a mesma linha do tempo. Os carimbos de 32 bits são desdobrados
+// supondo menos de uma volta entre eventos seguidos (~71 min na BitDogLab,
+// ~71 s no FPGA a 60 MHz).
+//
+// No stderr sai um resumo por placa e por ID: quantidade, tempo total, médio
+// e máximo, e a fração do tempo do laço principal.
+//
+// Uso: trace_json [--saida arquivo.json] [log...]   (sem log, lê da entrada padrão)
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Só os IDs e nomes dos eventos; o anel é coisa do firmware
+#undef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#include "trace_ring.h"
+
+#define MAX_BOARDS 8
+#define MAX_IDS    256
+#define MAX_DEPTH  8   // aninhamento do mesmo ID
+
+#define TRACE_NAME(id, name) name,
+static const char *const event_names[TRACE_N_IDS] = { TRACE_EVENTS(TRACE_NAME) };
+#undef TRACE_NAME
+
+typedef struct {
+    unsigned long count;
+    uint64_t total, max;           // ticks
+    uint64_t open[MAX_DEPTH];      // inícios ainda sem fim
+    int depth;
+} id_stats_t;
+
+typedef struct {
+    char name[32];
+    unsigned long hz;
+    bool have_ts;
+    uint32_t last_ts;
+    uint64_t ext_ts, first_ts;     // carimbo desdobrado e o do primeiro evento
+    unsigned long events, lost, unmatched;
+    id_stats_t ids[MAX_IDS];
+} board_t;
+
+static board_t boards[MAX_BOARDS];
+static int n_boards;
+static FILE *out;
+static bool first_json = true;
+
+static const char *event_name(unsigned id, char *buf, size_t n) {
+    if (id < TRACE_N_IDS) return event_names[id];
+    snprintf(buf, n, "id %u", id);
+    return buf;
+}
+
+static void json_sep(void) {
+    fputs(first_json ? "\n" : ",\n", out);
+    first_json = false;
+}
+
+static board_t *find_board(const char *name) {
+    for (int i = 0; i < n_boards; i++) {
+        if (strcmp(boards[i].name, name) == 0) return &boards[i];
+    }
+    if (n_boards == MAX_BOARDS) return NULL;
+    board_t *b = &boards[n_boards++];
+    snprintf(b->name, sizeof(b->name), "%s", name);
+    json_sep();
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}", n_boards, b->name);
+    return b;
+}
+
+static void on_event(board_t *b, uint32_t ts, unsigned id, char kind, unsigned arg) {
+    if (b->have_ts) b->ext_ts += (uint32_t)(ts - b->last_ts);
+    else b->ext_ts = b->first_ts = ts;
+    b->have_ts = true;
+    b->last_ts = ts;
+    b->events++;
+    if (id >= MAX_IDS) return;
+
+    id_stats_t *s = &b->ids[id];
+    if (kind == TRACE_KIND_BEGIN) {
+        if (s->depth < MAX_DEPTH) s->open[s->depth] = b->ext_ts;
+        s->depth++;
+    } else if (kind == TRACE_KIND_END) {
+        // Fim sem início: o início ficou antes do anel ou do último despejo
+        if (s->depth == 0) {
+            b->unmatched++;
+            return;
+        }
+        s->depth--;
+        if (s->depth < MAX_DEPTH) {
+            uint64_t d = b->ext_ts - s->open[s->depth];
+            s->count++;
+            s->total += d;
+            if (d > s->max) s->max = d;
+        }
+    } else if (kind != TRACE_KIND_MARK) {
+        return;
+    }
+
+    char buf[16];
+    double us = (double)(b->ext_ts - b->first_ts) * 1e6 / (double)b->hz;
+    json_sep();
+    fprintf(out, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":1",
+            event_name(id, buf, sizeof(buf)), b->name, kind, us, (int)(b - boards) + 1);
+    if (kind == TRACE_KIND_MARK) fprintf(out, ",\"s\":\"t\",\"args\":{\"arg\":%u}", arg);
+    fputs("}", out);
+}
+
+static void parse(FILE *f, unsigned long *blocks, unsigned long *bad) {
+    char line[256], name[32];
+    board_t *b = NULL;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long hz, n, lost;
+        if (sscanf(line, "TRACE INICIO %31s %lu %lu %lu", name, &hz, &n, &lost) == 4) {
+            b = find_board(name);
+            if (!b) fprintf(stderr, "trace_json: placas demais, ignorando %s\n", name);
+            else if (hz == 0) b = NULL;
+            else {
+                b->hz = hz;
+                b->lost += lost;
+                // Inícios abertos não sobrevivem ao despejo, que esvazia o anel
+                for (int i = 0; i < MAX_IDS; i++) b->ids[i].depth = 0;
+                (*blocks)++;
+            }
+            continue;
+        }
+        if (strncmp(line, "TRACE FIM", 9) == 0) {
+            b = NULL;
+            continue;
+        }
+        if (!b) continue;
+
+        unsigned long ts;
+        unsigned id, arg;
+        char kind;
+        if (sscanf(line, "%lx %u %c %u", &ts, &id, &kind, &arg) == 4) on_event(b, (uint32_t)ts, id, kind, arg);
+        else (*bad)++;
+    }
+}
+
+static void print_summary(void) {
+    for (int i = 0; i < n_boards; i++) {
+        board_t *b = &boards[i];
+        double us_per_tick = 1e6 / (double)b->hz;
+        uint64_t loop = b->ids[TRACE_ID_LOOP].total;
+        fprintf(stderr, "%s: %lu eventos (%lu sobrescritos no anel, %lu fins sem inicio), %.1f ms cobertos\n",
+                b->name, b->events, b->lost, b->unmatched, (double)(b->ext_ts - b->first_ts) * us_per_tick / 1000);
+        fprintf(stderr, "  %-24s %8s %12s %10s %10s %7s\n", "evento", "n", "total_us", "media_us", "max_us", "%laco");
+
+        // Maior tempo total primeiro
+        bool done[MAX_IDS] = { false };
+        while (true) {
+            int best = -1;
+            for (int id = 0; id < MAX_IDS; id++) {
+                if (!done[id] && b->ids[id].count && (best < 0 || b->ids[id].total > b->ids[best].total)) best = id;
+            }
+            if (best < 0) break;
+            done[best] = true;
+            const id_stats_t *s = &b->ids[best];
+            char buf[16];
+            fprintf(stderr, "  %-24s %8lu %12.1f %10.1f %10.1f", event_name((unsigned)best, buf, sizeof(buf)), s->count,
+                    s->total * us_per_tick, s->total * us_per_tick / s->count, s->max * us_per_tick);
+            if (loop) fprintf(stderr, " %6.1f%%\n", 100.0 * s->total / loop);
+            else fprintf(stderr, " %7s\n", "-");
+        }
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--saida arquivo.json] [log...]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = NULL;
+    static const struct option opts[] = {
+        { "saida", required_argument, NULL, 'o' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "o:", opts, NULL)) != -1) {
+        switch (c) {
+        case 'o': out_path = optarg; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+
+    out = stdout;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        perror(out_path);
+        return 1;
+    }
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", out);
+
+    unsigned long blocks = 0, bad = 0;
+    if (optind >= argc) parse(stdin, &blocks, &bad);
+    for (int i = optind; i < argc; i++) {
+        FILE *f = fopen(argv[i], "r");
+        if (!f) {
+            perror(argv[i]);
+            return 1;
+        }
+        parse(f, &blocks, &bad);
+        fclose(f);
+    }
+    fputs("\n]}\n", out);
+    if (out != stdout && fclose(out) != 0) {
+        perror(out_path);
+        return 1;
+    }
+
+    if (blocks == 0) {
+        fprintf(stderr, "trace_json: nenhum despejo de trace encontrado\n");
+        return 1;
+    }
+    fprintf(stderr, "%lu despejos, %lu linhas invalidas\n", blocks, bad);
+    print_summary();
+    return 0;
+}